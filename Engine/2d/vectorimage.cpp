@@ -9,6 +9,9 @@
 #define  NANOSVG_IMPLEMENTATION
 #include "thirdparty/nanosvg.h"
 
+#include <algorithm>
+#include <cstring>
+
 using namespace Tempest;
 
 void VectorImage::beginPaint(bool clr, uint32_t w, uint32_t h) {
@@ -95,6 +98,43 @@ void VectorImage::clear() {
   slock.clear();
   }
 
+void VectorImage::append(const VectorImage& src, size_t begin, size_t end) {
+  if(begin>=end)
+    return;
+  // first block, that ends after 'begin'
+  auto b = std::upper_bound(src.blocks.begin(),src.blocks.end(),begin,[](size_t v, const Block& b){
+    return v<b.begin+b.size;
+    });
+  buf.reserve(buf.size()+(end-begin));
+  for(; b!=src.blocks.end() && b->begin<end; ++b) {
+    const size_t b0 = std::max(begin,b->begin);
+    const size_t b1 = std::min(end,  b->begin+b->size);
+    if(b0>=b1)
+      continue;
+    implSetState(*b);
+    buf.insert(buf.end(),src.buf.begin()+ptrdiff_t(b0),src.buf.begin()+ptrdiff_t(b1));
+    blocks.back().size += (b1-b0);
+    if(!b->tex.sprite.isEmpty())
+      slock.insert(b->tex.sprite);
+    }
+  }
+
+void VectorImage::implSetState(const Block& b) {
+  // blocks.size()>0, see VectorImage::clear()
+  Block& cur = blocks.back();
+  if(static_cast<const State&>(cur)==b && cur.hasImg==b.hasImg)
+    return;
+  if(cur.size==0) {
+    static_cast<State&>(cur) = b;
+    cur.hasImg = b.hasImg;
+    return;
+    }
+  blocks.emplace_back(static_cast<const State&>(b));
+  blocks.back().begin  = buf.size();
+  blocks.back().size   = 0;
+  blocks.back().hasImg = b.hasImg;
+  }
+
 void VectorImage::addPoint(const PaintDevice::Point &p) {
   buf.push_back(p);
   blocks.back().size++;
@@ -174,10 +214,34 @@ bool VectorImage::load(const char *file) {
   }
 
 
+void VectorImage::Mesh::upload(Device& dev, const VectorImage& src, BufferHeap heap) {
+  const size_t size = src.buf.size();
+  if(size>vbo.size()) {
+    // grow with reserve, so small changes of ui don't reallocate
+    shadow.assign(src.buf.begin(),src.buf.end());
+    shadow.resize(size+size/2);
+    vbo  = dev.vbo(heap,shadow);
+    used = size;
+    return;
+    }
+
+  size_t first = 0;
+  while(first<size && first<used && std::memcmp(&shadow[first],&src.buf[first],sizeof(Point))==0)
+    ++first;
+  size_t last = size;
+  if(size==used) {
+    while(last>first && std::memcmp(&shadow[last-1],&src.buf[last-1],sizeof(Point))==0)
+      --last;
+    }
+  used = size;
+  if(first>=last)
+    return;
+  std::memcpy(&shadow[first],&src.buf[first],(last-first)*sizeof(Point));
+  vbo.update(&src.buf[first],first*sizeof(Point),(last-first)*sizeof(Point));
+  }
+
 void VectorImage::Mesh::update(Device& dev, const VectorImage& src, BufferHeap heap) {
-  if(vbo.size()==src.buf.size())
-    vbo.update(src.buf); else
-    vbo=dev.vbo(heap,src.buf);
+  upload(dev,src,heap);
 
   blocks.resize(src.blocks.size());
 
@@ -23,6 +23,8 @@ class VectorImage : public Tempest::PaintDevice {
         void draw  (Encoder<CommandBuffer>& cmd) const;
 
       private:
+        void   upload(Device& dev, const VectorImage& src, BufferHeap heap);
+
         struct Block {
           size_t                begin = 0;
           size_t                size  = 0;
@@ -33,6 +35,9 @@ class VectorImage : public Tempest::PaintDevice {
           Sprite                sprite;
           };
         Tempest::VertexBuffer<Point> vbo;
+        // copy of vbo content; only changed range is uploaded
+        std::vector<Point>           shadow;
+        size_t                       used = 0;
         std::vector<Block>           blocks;
       };
 
@@ -42,6 +47,10 @@ class VectorImage : public Tempest::PaintDevice {
     bool     load(const char* path);
     void     clear() override;
 
+    size_t   vertexCount() const { return buf.size(); }
+    // appends vertices [begin,end) of src, together with their render state
+    void     append(const VectorImage& src, size_t begin, size_t end);
+
   private:
     void   addPoint(const Point& p) override;
     void   commitPoints() override;
@@ -124,5 +133,6 @@ class VectorImage : public Tempest::PaintDevice {
 
     template<class T,T State::*param>
     void setState(const T& t);
+    void implSetState(const Block& b);
   };
 }
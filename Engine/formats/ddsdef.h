@@ -110,9 +110,80 @@ namespace Tempest {
       DWORD      dwTextureStage;
       };
 
+    const DWORD DDSD_CAPS        = 0x00000001;
+    const DWORD DDSD_HEIGHT      = 0x00000002;
+    const DWORD DDSD_WIDTH       = 0x00000004;
+    const DWORD DDSD_PIXELFORMAT = 0x00001000;
+    const DWORD DDSD_MIPMAPCOUNT = 0x00020000;
+    const DWORD DDSD_LINEARSIZE  = 0x00080000;
+
+    const DWORD DDPF_FOURCC      = 0x00000004;
+
+    const DWORD DDSCAPS_COMPLEX  = 0x00000008;
+    const DWORD DDSCAPS_TEXTURE  = 0x00001000;
+    const DWORD DDSCAPS_MIPMAP   = 0x00400000;
+
+    const DWORD DDSCAPS2_CUBEMAP  = 0x00000200;
+
     const unsigned int FOURCC_DXT1 = 827611204;
     const unsigned int FOURCC_DXT3 = 861165636;
     const unsigned int FOURCC_DXT5 = 894720068;
+    const unsigned int FOURCC_ATI1 = 826889281;
+    const unsigned int FOURCC_ATI2 = 843666497;
+    const unsigned int FOURCC_BC4U = 1429488450;
+    const unsigned int FOURCC_BC5U = 1429553986;
+    const unsigned int FOURCC_DX10 = 808540228;
+
+    // follows DDSURFACEDESC2, if dwFourCC is FOURCC_DX10
+    struct DDS_HEADER_DXT10 {
+      DWORD       dxgiFormat;
+      DWORD       resourceDimension;
+      DWORD       miscFlag;
+      DWORD       arraySize;
+      DWORD       miscFlags2;
+      };
+
+    const DWORD DDS_DIMENSION_TEXTURE2D      = 3;
+    const DWORD DDS_RESOURCE_MISC_TEXTURECUBE = 0x4;
+
+    // subset of DXGI_FORMAT
+    enum DxgiFormat : DWORD {
+      DXGI_R32G32B32A32_FLOAT = 2,
+      DXGI_R32G32B32A32_UINT  = 3,
+      DXGI_R32G32B32_FLOAT    = 6,
+      DXGI_R32G32B32_UINT     = 7,
+      DXGI_R16G16B16A16_FLOAT = 10,
+      DXGI_R16G16B16A16_UNORM = 11,
+      DXGI_R32G32_FLOAT       = 16,
+      DXGI_R32G32_UINT        = 17,
+      DXGI_R11G11B10_FLOAT    = 26,
+      DXGI_R8G8B8A8_UNORM     = 28,
+      DXGI_R8G8B8A8_UNORM_SRGB= 29,
+      DXGI_R16G16_UNORM       = 35,
+      DXGI_R32_FLOAT          = 41,
+      DXGI_R32_UINT           = 42,
+      DXGI_R8G8_UNORM         = 49,
+      DXGI_R16_UNORM          = 56,
+      DXGI_R8_UNORM           = 61,
+      DXGI_BC1_TYPELESS       = 70,
+      DXGI_BC1_UNORM          = 71,
+      DXGI_BC1_UNORM_SRGB     = 72,
+      DXGI_BC2_TYPELESS       = 73,
+      DXGI_BC2_UNORM          = 74,
+      DXGI_BC2_UNORM_SRGB     = 75,
+      DXGI_BC3_TYPELESS       = 76,
+      DXGI_BC3_UNORM          = 77,
+      DXGI_BC3_UNORM_SRGB     = 78,
+      DXGI_BC4_TYPELESS       = 79,
+      DXGI_BC4_UNORM          = 80,
+      DXGI_BC5_TYPELESS       = 82,
+      DXGI_BC5_UNORM          = 83,
+      DXGI_BC6H_TYPELESS      = 94,
+      DXGI_BC6H_UF16          = 95,
+      DXGI_BC7_TYPELESS       = 97,
+      DXGI_BC7_UNORM          = 98,
+      DXGI_BC7_UNORM_SRGB     = 99,
+      };
     }
 #pragma pack(pop)
   }
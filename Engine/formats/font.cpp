@@ -116,38 +116,29 @@ struct FontElement::Impl {
     if(filename==nullptr)
       return;
 
-    RFile file(filename);
-    size = uint32_t(file.size());
-    data = new uint8_t[size];
-
-    if(file.read(data,size)!=size) {
-      delete[] data;
-      throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
-      }
-    if(stbtt_InitFont(&info,data,0)==0) {
-      delete[] data;
-      throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
-      }
-    stbtt_GetFontVMetrics(&info,&metrics0.ascent,&metrics0.descent,&lineGap);
+    // ttf is used in place: mapping lives as long as font
+    file.reset(new MappedFile(filename));
+    init(file->data(),file->size());
     }
 
   Impl(const void *d, size_t sz) {
-    size = sz;
-    data = new uint8_t[size];
-    std::memcpy(data, d, size);
-
-    if(stbtt_InitFont(&info,data,0)==0) {
-      delete[] data;
-      throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
-      }
-    stbtt_GetFontVMetrics(&info,&metrics0.ascent,&metrics0.descent,&lineGap);
+    copy.reset(new uint8_t[sz]);
+    std::memcpy(copy.get(), d, sz);
+    init(copy.get(),sz);
     }
 
   ~Impl() {
-    delete[] data;
     std::free(rasterBuf);
     }
 
+  void init(const uint8_t* d, size_t sz) {
+    data = d;
+    size = sz;
+    if(stbtt_InitFont(&info,data,0)==0)
+      throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+    stbtt_GetFontVMetrics(&info,&metrics0.ascent,&metrics0.descent,&lineGap);
+    }
+
   uint8_t* ttfMalloc(size_t sz){
     if(sz<rasterSz)
       return rasterBuf;
@@ -287,7 +278,9 @@ struct FontElement::Impl {
     return m;
     }
 
-  uint8_t*       data=nullptr;
+  std::unique_ptr<MappedFile> file;
+  std::unique_ptr<uint8_t[]>  copy;
+  const uint8_t* data=nullptr;
   size_t         size=0;
   stbtt_fontinfo info={};
 
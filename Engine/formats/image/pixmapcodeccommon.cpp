@@ -200,6 +200,10 @@ uint8_t* PixmapCodecCommon::load(PixmapCodec::Context &ctx, uint32_t &ow, uint32
     case TextureFormat::DXT1:
     case TextureFormat::DXT3:
     case TextureFormat::DXT5:
+    case TextureFormat::BC4:
+    case TextureFormat::BC5:
+    case TextureFormat::BC6H:
+    case TextureFormat::BC7:
       // not supported by common codec
       throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
     }
@@ -256,6 +260,10 @@ bool PixmapCodecCommon::save(ODevice &f, const char *ext, const uint8_t* cdata,
     case TextureFormat::DXT1:
     case TextureFormat::DXT3:
     case TextureFormat::DXT5:
+    case TextureFormat::BC4:
+    case TextureFormat::BC5:
+    case TextureFormat::BC6H:
+    case TextureFormat::BC7:
       break;
     case TextureFormat::R11G11B10UF:
     case TextureFormat::RGBA16F:
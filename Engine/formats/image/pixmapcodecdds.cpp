@@ -1,12 +1,13 @@
 #include "pixmapcodecdds.h"
 
 #include <Tempest/IDevice>
+#include <Tempest/ODevice>
 
 #include <algorithm>
 #include <cstring>
 
-#include "thirdparty/squish/squish.h"
 #include "../ddsdef.h"
+#include "../texturefile.h"
 
 using namespace Tempest;
 
@@ -20,71 +21,86 @@ bool PixmapCodecDDS::testFormat(const PixmapCodec::Context &c) const {
 
 uint8_t* PixmapCodecDDS::load(PixmapCodec::Context &c, uint32_t &ow, uint32_t &oh,
                               TextureFormat& frm, uint32_t& mipCnt, size_t& dataSz, uint32_t &bpp) const {
-  using namespace Tempest::Detail;
+  Detail::TextureFile tex(c.device);
 
-  auto& f = c.device;
-  uint8_t head[4]={};
-  if(f.read(head,4)!=4)
+  // only first layer of array/cube is loaded into pixmap
+  const size_t size = tex.layerSize();
+  uint8_t*     ddsv = reinterpret_cast<uint8_t*>(std::malloc(size));
+  if(!ddsv || !tex.readLayer(ddsv,0)) {
+    std::free(ddsv);
     return nullptr;
+    }
 
-  DDSURFACEDESC2 ddsd={};
-  if(f.read(&ddsd,sizeof(ddsd))!=sizeof(ddsd))
-    return nullptr;
-  ow = ddsd.dwWidth;
-  oh = ddsd.dwHeight;
+  ow     = tex.w();
+  oh     = tex.h();
+  frm    = tex.format();
+  mipCnt = tex.mipCount();
+  bpp    = uint32_t(Pixmap::bppForFormat(frm));
+  dataSz = size;
+  return ddsv;
+  }
 
-  int compressType = squish::kDxt1;
-  switch(ddsd.ddpfPixelFormat.dwFourCC) {
-    case FOURCC_DXT1:
-      bpp          = 3;
-      compressType = squish::kDxt1;
-      frm          = TextureFormat::DXT1;
-      break;
+bool PixmapCodecDDS::save(ODevice& f, const char* ext, const uint8_t *data, size_t dataSz,
+                          uint32_t w, uint32_t h, TextureFormat frm) const {
+  using namespace Tempest::Detail;
 
-    case FOURCC_DXT3:
-      bpp          = 4;
-      compressType = squish::kDxt3;
-      frm          = TextureFormat::DXT3;
-      break;
+  // ext is lower-cased by PixmapCodec::save, so "DDS" matches as well
+  if(ext!=nullptr && std::strcmp("dds",ext)!=0)
+    return false;
 
-    case FOURCC_DXT5:
-      bpp          = 4;
-      compressType = squish::kDxt5;
-      frm          = TextureFormat::DXT5;
+  DDSURFACEDESC2 ddsd={};
+  switch(frm) {
+    case TextureFormat::DXT1:
+      ddsd.ddpfPixelFormat.dwFourCC = FOURCC_DXT1;
+      break;
+    case TextureFormat::DXT3:
+      ddsd.ddpfPixelFormat.dwFourCC = FOURCC_DXT3;
+      break;
+    case TextureFormat::DXT5:
+      ddsd.ddpfPixelFormat.dwFourCC = FOURCC_DXT5;
       break;
-
     default:
-      return nullptr;
+      return false;
     }
 
-  if( ddsd.dwLinearSize == 0 ) {
-    //return false;
+  // mip count is not stored in pixmap explicitly - restore it from data size
+  const size_t blocksize = Pixmap::blockSizeForFormat(frm);
+  uint32_t     mipCnt    = 0;
+  size_t       mipSz     = 0;
+  uint32_t     mw = w, mh = h;
+  while(mipSz<dataSz) {
+    Size bsz = Pixmap::blockCount(frm,mw,mh);
+    mipSz += size_t(bsz.w)*size_t(bsz.h)*blocksize;
+    mipCnt++;
+    if(mw==1 && mh==1)
+      break;
+    mw = std::max(1u,mw/2);
+    mh = std::max(1u,mh/2);
     }
-
-  mipCnt            = std::max(1u, ddsd.dwMipMapCount);
-  size_t blocksize  = (compressType==squish::kDxt1) ? 8 : 16;
-  size_t bufferSize = 0;
-
-  size_t w = size_t(ow), h = size_t(oh);
-  for(size_t i=0; i<mipCnt; i++){
-    size_t blockcount = ((w+3)/4)*((h+3)/4);
-    bufferSize += blockcount*blocksize;
-    w = std::max<size_t>(1,w/2);
-    h = std::max<size_t>(1,h/2);
+  if(mipSz!=dataSz)
+    mipCnt = 1;
+
+  const Size bsz = Pixmap::blockCount(frm,w,h);
+  ddsd.dwSize                 = sizeof(ddsd);
+  ddsd.dwFlags                = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_LINEARSIZE;
+  ddsd.dwHeight               = h;
+  ddsd.dwWidth                = w;
+  ddsd.dwLinearSize           = DWORD(size_t(bsz.w)*size_t(bsz.h)*blocksize);
+  ddsd.ddpfPixelFormat.dwSize = sizeof(DDPIXELFORMAT);
+  ddsd.ddpfPixelFormat.dwFlags= DDPF_FOURCC;
+  ddsd.ddsCaps.dwCaps         = DDSCAPS_TEXTURE;
+  if(mipCnt>1) {
+    ddsd.dwFlags       |= DDSD_MIPMAPCOUNT;
+    ddsd.dwMipMapCount  = mipCnt;
+    ddsd.ddsCaps.dwCaps|= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
     }
 
-  uint8_t* ddsv = reinterpret_cast<uint8_t*>(std::malloc(bufferSize));
-  if(!ddsv || f.read(ddsv,bufferSize)!=bufferSize) {
-    std::free(ddsv);
-    return nullptr;
-    }
-
-  bpp    = 0;
-  dataSz = bufferSize;
-  return ddsv;
-  }
-
-bool PixmapCodecDDS::save(ODevice &, const char* /*ext*/, const uint8_t *data, size_t dataSz,
-                          uint32_t w, uint32_t h, TextureFormat frm) const {
-  return false;
+  const size_t levelsSz = (mipCnt>1) ? dataSz : size_t(ddsd.dwLinearSize);
+  if(f.write("DDS ",4)!=4)
+    return false;
+  if(f.write(&ddsd,sizeof(ddsd))!=sizeof(ddsd))
+    return false;
+  if(f.write(data,levelsSz)!=levelsSz)
+    return false;
+  return true;
   }
@@ -5,20 +5,10 @@
 #include <algorithm>
 #include <cstring>
 
-using namespace Tempest;
-
-static void rgbe2float(float& red, float& green, float& blue, uint8_t rgbe[4]) {
-  if(rgbe[3]) {
-    // nonzero pixel
-    float f = float(std::ldexp(1.0,rgbe[3]-(int)(128+8)));
-    red   = rgbe[0] * f;
-    green = rgbe[1] * f;
-    blue  = rgbe[2] * f;
-    } else {
-    red = green = blue = 0.0;
-    }
-  }
+#include "../pixelconv.h"
 
+using namespace Tempest;
+using namespace Tempest::Detail;
 
 PixmapCodecHDR::PixmapCodecHDR() {
   }
@@ -98,12 +88,8 @@ bool PixmapCodecHDR::readData(IDevice& d, float* data, size_t count) {
   if(d.read(rgbe,count*4)!=count*4)
     return false;
 
-  for(size_t i=0; i<count; ++i) {
-    float rgba[3];
-    rgbe2float(rgba[0],rgba[1],rgba[2],rgbe+i*4);
-    std::memcpy(data+i*3, rgba, 3*sizeof(float));
-    }
-
+  // decoded in place: rgbe occupies tail of the output
+  PixelConv::rgbeToFloat(data,rgbe,count);
   return true;
   }
 
@@ -111,7 +97,8 @@ bool PixmapCodecHDR::readDataRLE(IDevice& d, float* data, size_t width, size_t h
   if(width<8 || width>0x7fff)
     return readData(d,data,width*height);
 
-  uint8_t* buffer = (uint8_t*)std::malloc(width*4);
+  // planar scanline, followed by same scanline interleaved
+  uint8_t* buffer = (uint8_t*)std::malloc(width*8);
   if(buffer==nullptr)
     return false;
 
@@ -124,7 +111,7 @@ bool PixmapCodecHDR::readDataRLE(IDevice& d, float* data, size_t width, size_t h
 
     if(rgbe[0]!=2 || rgbe[1]!=2 || (rgbe[2] & 0x80)!=0) {
       // non compressed
-      rgbe2float(data[0],data[1],data[2],rgbe);
+      PixelConv::rgbeToFloat(data,rgbe,1);
       std::free(buffer);
       return readData(d,data+3,width*height-1);
       }
@@ -169,14 +156,15 @@ bool PixmapCodecHDR::readDataRLE(IDevice& d, float* data, size_t width, size_t h
         }
       }
 
+    uint8_t* line = buffer + width*4;
     for(size_t i=0; i<width; ++i) {
-      rgbe[0] = buffer[i+0*width];
-      rgbe[1] = buffer[i+1*width];
-      rgbe[2] = buffer[i+2*width];
-      rgbe[3] = buffer[i+3*width];
-      rgbe2float(data[0],data[1],data[2],rgbe);
-      data += 3;
+      line[i*4+0] = buffer[i+0*width];
+      line[i*4+1] = buffer[i+1*width];
+      line[i*4+2] = buffer[i+2*width];
+      line[i*4+3] = buffer[i+3*width];
       }
+    PixelConv::rgbeToFloat(data,line,width);
+    data += width*3;
     }
   free(buffer);
   return true;
@@ -0,0 +1,43 @@
+#include "pixmapcodecktx.h"
+
+#include <Tempest/IDevice>
+
+#include <cstring>
+
+#include "../ktxdef.h"
+#include "../texturefile.h"
+
+using namespace Tempest;
+
+PixmapCodecKTX::PixmapCodecKTX() {
+  }
+
+bool PixmapCodecKTX::testFormat(const PixmapCodec::Context &c) const {
+  uint8_t buf[sizeof(Detail::KTX2_IDENTIFIER)]={};
+  return c.peek(buf,sizeof(buf))==sizeof(buf) && std::memcmp(buf,Detail::KTX2_IDENTIFIER,sizeof(buf))==0;
+  }
+
+uint8_t* PixmapCodecKTX::load(PixmapCodec::Context &c, uint32_t &ow, uint32_t &oh,
+                              TextureFormat& frm, uint32_t& mipCnt, size_t& dataSz, uint32_t &bpp) const {
+  Detail::TextureFile tex(c.device);
+
+  // only first layer of array/cube is loaded into pixmap
+  const size_t size = tex.layerSize();
+  uint8_t*     ktx  = reinterpret_cast<uint8_t*>(std::malloc(size));
+  if(!ktx || !tex.readLayer(ktx,0)) {
+    std::free(ktx);
+    return nullptr;
+    }
+
+  ow     = tex.w();
+  oh     = tex.h();
+  frm    = tex.format();
+  mipCnt = tex.mipCount();
+  bpp    = uint32_t(Pixmap::bppForFormat(frm));
+  dataSz = size;
+  return ktx;
+  }
+
+bool PixmapCodecKTX::save(ODevice&, const char*, const uint8_t*, size_t, uint32_t, uint32_t, TextureFormat) const {
+  return false;
+  }
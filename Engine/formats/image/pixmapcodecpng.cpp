@@ -6,6 +6,8 @@
 #include <png.h>
 #include <cstring>
 
+#include "../pixelconv.h"
+
 using namespace Tempest;
 
 struct PixmapCodecPng::Impl {
@@ -73,7 +75,7 @@ struct PixmapCodecPng::Impl {
       }
 
     if(bitDepth==16) {
-      png_set_swap(png_ptr);
+      // byte order is fixed up after decoding, see PixelConv::byteSwap16
       outBpp*=2;
       frm = TextureFormat(uint8_t(TextureFormat::R16)+uint8_t(frm)-uint8_t(TextureFormat::R8));
       }
@@ -92,6 +94,8 @@ struct PixmapCodecPng::Impl {
       }
 
     png_read_end(png_ptr, info_ptr);
+    if(bitDepth==16)
+      Detail::PixelConv::byteSwap16(reinterpret_cast<uint16_t*>(out),size_t(outW)*size_t(outH)*outBpp/2);
     return true;
     }
 
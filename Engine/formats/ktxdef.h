@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Tempest {
+  namespace Detail {
+    static const uint8_t KTX2_IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+#pragma pack(push,1)
+    struct KTX2Header {
+      uint8_t  identifier[12];
+      uint32_t vkFormat;
+      uint32_t typeSize;
+      uint32_t pixelWidth;
+      uint32_t pixelHeight;
+      uint32_t pixelDepth;
+      uint32_t layerCount;
+      uint32_t faceCount;
+      uint32_t levelCount;
+      uint32_t supercompressionScheme;
+
+      uint32_t dfdByteOffset;
+      uint32_t dfdByteLength;
+      uint32_t kvdByteOffset;
+      uint32_t kvdByteLength;
+      uint64_t sgdByteOffset;
+      uint64_t sgdByteLength;
+      };
+
+    struct KTX2LevelIndex {
+      uint64_t byteOffset;
+      uint64_t byteLength;
+      uint64_t uncompressedByteLength;
+      };
+#pragma pack(pop)
+
+    // subset of VkFormat
+    enum KtxFormat : uint32_t {
+      KTX_R8_UNORM            = 9,
+      KTX_R8G8_UNORM          = 16,
+      KTX_R8G8B8_UNORM        = 23,
+      KTX_R8G8B8A8_UNORM      = 37,
+      KTX_R8G8B8A8_SRGB       = 43,
+      KTX_R16_UNORM           = 70,
+      KTX_R16G16_UNORM        = 77,
+      KTX_R16G16B16_UNORM     = 84,
+      KTX_R16G16B16A16_UNORM  = 91,
+      KTX_R16G16B16A16_SFLOAT = 97,
+      KTX_R32_UINT            = 98,
+      KTX_R32_SFLOAT          = 100,
+      KTX_R32G32_UINT         = 101,
+      KTX_R32G32_SFLOAT       = 103,
+      KTX_R32G32B32_UINT      = 104,
+      KTX_R32G32B32_SFLOAT    = 106,
+      KTX_R32G32B32A32_UINT   = 107,
+      KTX_R32G32B32A32_SFLOAT = 109,
+      KTX_B10G11R11_UFLOAT    = 122,
+      KTX_BC1_RGB_UNORM       = 131,
+      KTX_BC1_RGB_SRGB        = 132,
+      KTX_BC1_RGBA_UNORM      = 133,
+      KTX_BC1_RGBA_SRGB       = 134,
+      KTX_BC2_UNORM           = 135,
+      KTX_BC2_SRGB            = 136,
+      KTX_BC3_UNORM           = 137,
+      KTX_BC3_SRGB            = 138,
+      KTX_BC4_UNORM           = 139,
+      KTX_BC5_UNORM           = 141,
+      KTX_BC6H_UFLOAT         = 143,
+      KTX_BC7_UNORM           = 145,
+      KTX_BC7_SRGB            = 146,
+      };
+    }
+  }
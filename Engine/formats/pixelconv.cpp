@@ -0,0 +1,760 @@
+#include "pixelconv.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define TEMPEST_PIXCONV_X86
+#  include <immintrin.h>
+#  if defined(_MSC_VER) && !defined(__clang__)
+#    include <intrin.h>
+#    define T_TARGET(t)
+#  else
+#    include <cpuid.h>
+#    define T_TARGET(t) __attribute__((target(t)))
+#  endif
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#  define TEMPEST_PIXCONV_NEON
+#  include <arm_neon.h>
+#endif
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+namespace {
+
+using Swizzle8Fn = void(*)(uint8_t*, uint8_t, const uint8_t*, uint8_t, const int8_t*, size_t);
+
+struct Kernels {
+  PixelConv::Isa isa;
+  Swizzle8Fn     swizzle8;
+  void         (*unorm16ToUnorm8)(uint8_t*,  const uint16_t*, size_t);
+  void         (*floatToUnorm8)  (uint8_t*,  const float*,    size_t);
+  void         (*unorm8ToFloat)  (float*,    const uint8_t*,  size_t);
+  void         (*floatToHalf)    (uint16_t*, const float*,    size_t);
+  void         (*halfToFloat)    (float*,    const uint16_t*, size_t);
+  void         (*byteSwap16)     (uint16_t*, size_t);
+  void         (*rgbeToFloat)    (float*,    const uint8_t*,  size_t);
+  };
+
+}
+
+// scalar reference
+template<uint8_t dc, uint8_t sc>
+static void swizzleT(uint8_t* dst, const uint8_t* src, const int8_t* map, size_t count) {
+  uint8_t val[dc] = {};
+  for(uint8_t c=0; c<dc; ++c)
+    val[c] = map[c]==PixelConv::One ? 255 : 0;
+  for(size_t i=0; i<count; ++i) {
+    for(uint8_t c=0; c<dc; ++c)
+      dst[c] = map[c]>=0 ? src[map[c]] : val[c];
+    dst += dc;
+    src += sc;
+    }
+  }
+
+template<uint8_t dc>
+static void swizzleDst(uint8_t* dst, const uint8_t* src, uint8_t sc, const int8_t* map, size_t count) {
+  switch(sc) {
+    case 1: swizzleT<dc,1>(dst,src,map,count); return;
+    case 2: swizzleT<dc,2>(dst,src,map,count); return;
+    case 3: swizzleT<dc,3>(dst,src,map,count); return;
+    case 4: swizzleT<dc,4>(dst,src,map,count); return;
+    }
+  }
+
+static void swizzleScalar(uint8_t* dst, uint8_t dc, const uint8_t* src, uint8_t sc, const int8_t* map, size_t count) {
+  switch(dc) {
+    case 1: swizzleDst<1>(dst,src,sc,map,count); return;
+    case 2: swizzleDst<2>(dst,src,sc,map,count); return;
+    case 3: swizzleDst<3>(dst,src,sc,map,count); return;
+    case 4: swizzleDst<4>(dst,src,sc,map,count); return;
+    }
+  }
+
+static void unorm16ToUnorm8Scalar(uint8_t* dst, const uint16_t* src, size_t count) {
+  for(size_t i=0; i<count; ++i)
+    dst[i] = uint8_t(src[i]>>8);
+  }
+
+static void floatToUnorm8Scalar(uint8_t* dst, const float* src, size_t count) {
+  for(size_t i=0; i<count; ++i)
+    dst[i] = uint8_t(std::fmax(0.f,std::fmin(src[i],1.f))*255.f);
+  }
+
+static void unorm8ToFloatScalar(float* dst, const uint8_t* src, size_t count) {
+  for(size_t i=0; i<count; ++i)
+    dst[i] = src[i]/255.f;
+  }
+
+static uint16_t floatToHalf(float f) {
+  // round to nearest even, same as F16C and NEON
+  uint32_t x = 0;
+  std::memcpy(&x,&f,4);
+  const uint32_t sign = (x>>16) & 0x8000;
+  x &= 0x7FFFFFFF;
+
+  uint16_t ret = 0;
+  if(x>=0x47800000) {
+    // overflow, inf or nan
+    ret = uint16_t(x>0x7F800000 ? 0x7E00 : 0x7C00);
+    }
+  else if(x<0x38800000) {
+    // denormal or zero: let fpu do the rounding
+    const uint32_t magic = 126u<<23;
+    float          fm = 0, fx = 0;
+    std::memcpy(&fm,&magic,4);
+    std::memcpy(&fx,&x,4);
+    fx += fm;
+    std::memcpy(&x,&fx,4);
+    ret = uint16_t(x-magic);
+    }
+  else {
+    const uint32_t odd = (x>>13) & 1;
+    x += (uint32_t(15-127)<<23) + 0xFFF + odd;
+    ret = uint16_t(x>>13);
+    }
+  return uint16_t(ret | sign);
+  }
+
+static float halfToFloat(uint16_t h) {
+  const uint32_t sign = uint32_t(h & 0x8000)<<16;
+  const uint32_t exp  = (h>>10) & 0x1F;
+  const uint32_t mant = h & 0x3FF;
+
+  uint32_t x = 0;
+  if(exp==0) {
+    float f = float(mant)*(1.f/16777216.f); // mant * 2^-24, exact
+    std::memcpy(&x,&f,4);
+    x |= sign;
+    }
+  else if(exp==31) {
+    x = sign | 0x7F800000 | (mant<<13);
+    }
+  else {
+    x = sign | ((exp+112)<<23) | (mant<<13);
+    }
+  float ret = 0;
+  std::memcpy(&ret,&x,4);
+  return ret;
+  }
+
+static void floatToHalfScalar(uint16_t* dst, const float* src, size_t count) {
+  for(size_t i=0; i<count; ++i)
+    dst[i] = floatToHalf(src[i]);
+  }
+
+static void halfToFloatScalar(float* dst, const uint16_t* src, size_t count) {
+  for(size_t i=0; i<count; ++i)
+    dst[i] = halfToFloat(src[i]);
+  }
+
+static void byteSwap16Scalar(uint16_t* data, size_t count) {
+  for(size_t i=0; i<count; ++i)
+    data[i] = uint16_t((data[i]<<8) | (data[i]>>8));
+  }
+
+static void rgbeToFloatScalar(float* dst, const uint8_t* src, size_t count) {
+  for(size_t i=0; i<count; ++i) {
+    uint8_t rgbe[4];
+    std::memcpy(rgbe,src+i*4,4);
+
+    float rgb[3] = {};
+    if(rgbe[3]!=0) {
+      const float f = float(std::ldexp(1.0,rgbe[3]-(int)(128+8)));
+      rgb[0] = rgbe[0] * f;
+      rgb[1] = rgbe[1] * f;
+      rgb[2] = rgbe[2] * f;
+      }
+    std::memcpy(dst+i*3,rgb,sizeof(rgb));
+    }
+  }
+
+// pshufb/tbl mask, that moves as many whole pixels as fit into 16 bytes
+static uint8_t buildShuffle(uint8_t* mask, uint8_t* ones, uint8_t dc, uint8_t sc, const int8_t* map) {
+  const uint8_t px = uint8_t(16/std::max(dc,sc));
+  for(int i=0; i<16; ++i) {
+    mask[i] = 0x80;
+    ones[i] = 0;
+    }
+  for(uint8_t p=0; p<px; ++p)
+    for(uint8_t c=0; c<dc; ++c) {
+      const int8_t m = map[c];
+      mask[p*dc+c] = m>=0 ? uint8_t(p*sc+m) : uint8_t(0x80);
+      ones[p*dc+c] = m==PixelConv::One ? 0xFF : 0;
+      }
+  return px;
+  }
+
+#if defined(TEMPEST_PIXCONV_X86)
+static void cpuid(uint32_t out[4], uint32_t leaf, uint32_t sub) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int r[4] = {};
+  __cpuidex(r,int(leaf),int(sub));
+  for(int i=0; i<4; ++i)
+    out[i] = uint32_t(r[i]);
+#else
+  __cpuid_count(leaf,sub,out[0],out[1],out[2],out[3]);
+#endif
+  }
+
+static uint64_t xgetbv0() {
+#if defined(_MSC_VER) && !defined(__clang__)
+  return _xgetbv(0);
+#else
+  uint32_t lo = 0, hi = 0;
+  __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+  return (uint64_t(hi)<<32) | lo;
+#endif
+  }
+
+T_TARGET("sse4.1")
+static void swizzleSse4(uint8_t* dst, uint8_t dc, const uint8_t* src, uint8_t sc, const int8_t* map, size_t count) {
+  alignas(16) uint8_t mask[16], ones[16];
+  const uint8_t px  = buildShuffle(mask,ones,dc,sc,map);
+  const __m128i shf = _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+  const __m128i one = _mm_load_si128(reinterpret_cast<const __m128i*>(ones));
+
+  // loads and stores are 16 bytes wide, but only 'px' pixels are consumed
+  size_t i = 0;
+  for(; i+px<=count && i*sc+16<=count*sc && i*dc+16<=count*dc; i+=px) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src+i*sc));
+    v = _mm_or_si128(_mm_shuffle_epi8(v,shf),one);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+i*dc),v);
+    }
+  swizzleScalar(dst+i*dc,dc,src+i*sc,sc,map,count-i);
+  }
+
+T_TARGET("sse4.1")
+static void unorm16ToUnorm8Sse4(uint8_t* dst, const uint16_t* src, size_t count) {
+  size_t i = 0;
+  for(; i+16<=count; i+=16) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src+i));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src+i+8));
+    a = _mm_srli_epi16(a,8);
+    b = _mm_srli_epi16(b,8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+i),_mm_packus_epi16(a,b));
+    }
+  unorm16ToUnorm8Scalar(dst+i,src+i,count-i);
+  }
+
+T_TARGET("sse4.1")
+static inline __m128i toUnorm8Sse4(const float* src) {
+  const __m128 v = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(src),_mm_set1_ps(1.f)),_mm_setzero_ps());
+  return _mm_cvttps_epi32(_mm_mul_ps(v,_mm_set1_ps(255.f)));
+  }
+
+T_TARGET("sse4.1")
+static void floatToUnorm8Sse4(uint8_t* dst, const float* src, size_t count) {
+  size_t i = 0;
+  for(; i+16<=count; i+=16) {
+    const __m128i a = _mm_packs_epi32(toUnorm8Sse4(src+i+0), toUnorm8Sse4(src+i+4));
+    const __m128i b = _mm_packs_epi32(toUnorm8Sse4(src+i+8), toUnorm8Sse4(src+i+12));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+i),_mm_packus_epi16(a,b));
+    }
+  floatToUnorm8Scalar(dst+i,src+i,count-i);
+  }
+
+T_TARGET("sse4.1")
+static void unorm8ToFloatSse4(float* dst, const uint8_t* src, size_t count) {
+  const __m128 k = _mm_set1_ps(255.f);
+  size_t i = 0;
+  for(; i+16<=count; i+=16) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src+i));
+    _mm_storeu_ps(dst+i+0, _mm_div_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(v)),                   k));
+    _mm_storeu_ps(dst+i+4, _mm_div_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(v,4))), k));
+    _mm_storeu_ps(dst+i+8, _mm_div_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(v,8))), k));
+    _mm_storeu_ps(dst+i+12,_mm_div_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(v,12))),k));
+    }
+  unorm8ToFloatScalar(dst+i,src+i,count-i);
+  }
+
+T_TARGET("sse4.1")
+static void byteSwap16Sse4(uint16_t* data, size_t count) {
+  size_t i = 0;
+  for(; i+8<=count; i+=8) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data+i));
+    v = _mm_or_si128(_mm_slli_epi16(v,8),_mm_srli_epi16(v,8));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data+i),v);
+    }
+  byteSwap16Scalar(data+i,count-i);
+  }
+
+// 2^(e-136) is split into two normal factors, so result stays exact for small exponents
+T_TARGET("sse4.1")
+static inline __m128 rgbeMulSse4(__m128 c, __m128i t) {
+  const __m128i bias = _mm_set1_epi32(127);
+  const __m128i ha   = _mm_srai_epi32(_mm_add_epi32(t,_mm_set1_epi32(1)),1);
+  const __m128i hb   = _mm_srai_epi32(t,1);
+  const __m128  a    = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(ha,bias),23));
+  const __m128  b    = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(hb,bias),23));
+  return _mm_mul_ps(_mm_mul_ps(c,a),b);
+  }
+
+T_TARGET("sse4.1")
+static void rgbeStore4Sse4(float* dst, __m128 r, __m128 g, __m128 b) {
+  __m128 w = _mm_setzero_ps();
+  _MM_TRANSPOSE4_PS(r,g,b,w);
+  // overlapping stores: 4th lane is overwritten by next pixel
+  _mm_storeu_ps(dst+0,r);
+  _mm_storeu_ps(dst+3,g);
+  _mm_storeu_ps(dst+6,b);
+  _mm_storeu_ps(dst+9,w);
+  }
+
+T_TARGET("sse4.1")
+static void rgbeToFloatSse4(float* dst, const uint8_t* src, size_t count) {
+  const __m128i m   = _mm_set1_epi32(0xFF);
+  const __m128i off = _mm_set1_epi32(128+8);
+  size_t i = 0;
+  // stores spill 1 float ahead, see rgbeStore4Sse4
+  for(; i+5<=count; i+=4) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src+i*4));
+    const __m128i e = _mm_srli_epi32(v,24);
+    const __m128i t = _mm_sub_epi32(e,off);
+    const __m128  z = _mm_castsi128_ps(_mm_cmpeq_epi32(e,_mm_setzero_si128()));
+
+    const __m128  r = _mm_andnot_ps(z,rgbeMulSse4(_mm_cvtepi32_ps(_mm_and_si128(v,m)),                 t));
+    const __m128  g = _mm_andnot_ps(z,rgbeMulSse4(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(v,8),m)), t));
+    const __m128  b = _mm_andnot_ps(z,rgbeMulSse4(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(v,16),m)),t));
+    rgbeStore4Sse4(dst+i*3,r,g,b);
+    }
+  rgbeToFloatScalar(dst+i*3,src+i*4,count-i);
+  }
+
+T_TARGET("avx2,f16c")
+static void swizzleAvx2(uint8_t* dst, uint8_t dc, const uint8_t* src, uint8_t sc, const int8_t* map, size_t count) {
+  if(dc!=4)
+    return swizzleSse4(dst,dc,src,sc,map,count);
+
+  alignas(16) uint8_t mask[16], ones[16];
+  buildShuffle(mask,ones,dc,sc,map);
+  const __m256i shf = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(mask)));
+  const __m256i one = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(ones)));
+
+  // 4 pixels per 128-bit lane, since pshufb doesn't cross lanes
+  size_t i = 0;
+  for(; i+8<=count && (i+4)*sc+16<=count*sc; i+=8) {
+    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src+i*sc));
+    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src+(i+4)*sc));
+    __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo),hi,1);
+    v = _mm256_or_si256(_mm256_shuffle_epi8(v,shf),one);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst+i*4),v);
+    }
+  swizzleSse4(dst+i*dc,dc,src+i*sc,sc,map,count-i);
+  }
+
+T_TARGET("avx2,f16c")
+static void unorm16ToUnorm8Avx2(uint8_t* dst, const uint16_t* src, size_t count) {
+  size_t i = 0;
+  for(; i+32<=count; i+=32) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src+i));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src+i+16));
+    a = _mm256_srli_epi16(a,8);
+    b = _mm256_srli_epi16(b,8);
+    const __m256i v = _mm256_permute4x64_epi64(_mm256_packus_epi16(a,b),0xD8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst+i),v);
+    }
+  unorm16ToUnorm8Sse4(dst+i,src+i,count-i);
+  }
+
+T_TARGET("avx2,f16c")
+static inline __m256i toUnorm8Avx2(const float* src) {
+  const __m256 v = _mm256_max_ps(_mm256_min_ps(_mm256_loadu_ps(src),_mm256_set1_ps(1.f)),_mm256_setzero_ps());
+  return _mm256_cvttps_epi32(_mm256_mul_ps(v,_mm256_set1_ps(255.f)));
+  }
+
+T_TARGET("avx2,f16c")
+static void floatToUnorm8Avx2(uint8_t* dst, const float* src, size_t count) {
+  const __m256i order = _mm256_setr_epi32(0,4,1,5,2,6,3,7);
+  size_t i = 0;
+  for(; i+32<=count; i+=32) {
+    const __m256i a = _mm256_packs_epi32(toUnorm8Avx2(src+i+0), toUnorm8Avx2(src+i+8));
+    const __m256i b = _mm256_packs_epi32(toUnorm8Avx2(src+i+16),toUnorm8Avx2(src+i+24));
+    const __m256i v = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(a,b),order);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst+i),v);
+    }
+  floatToUnorm8Sse4(dst+i,src+i,count-i);
+  }
+
+T_TARGET("avx2,f16c")
+static void unorm8ToFloatAvx2(float* dst, const uint8_t* src, size_t count) {
+  const __m256 k = _mm256_set1_ps(255.f);
+  size_t i = 0;
+  for(; i+16<=count; i+=16) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src+i));
+    _mm256_storeu_ps(dst+i+0,_mm256_div_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(v)),                  k));
+    _mm256_storeu_ps(dst+i+8,_mm256_div_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(v,8))),k));
+    }
+  unorm8ToFloatScalar(dst+i,src+i,count-i);
+  }
+
+T_TARGET("avx2,f16c")
+static void floatToHalfAvx2(uint16_t* dst, const float* src, size_t count) {
+  size_t i = 0;
+  for(; i+8<=count; i+=8) {
+    const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src+i),_MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+i),h);
+    }
+  floatToHalfScalar(dst+i,src+i,count-i);
+  }
+
+T_TARGET("avx2,f16c")
+static void halfToFloatAvx2(float* dst, const uint16_t* src, size_t count) {
+  size_t i = 0;
+  for(; i+8<=count; i+=8) {
+    const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src+i));
+    _mm256_storeu_ps(dst+i,_mm256_cvtph_ps(h));
+    }
+  halfToFloatScalar(dst+i,src+i,count-i);
+  }
+
+T_TARGET("avx2,f16c")
+static void byteSwap16Avx2(uint16_t* data, size_t count) {
+  size_t i = 0;
+  for(; i+16<=count; i+=16) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data+i));
+    v = _mm256_or_si256(_mm256_slli_epi16(v,8),_mm256_srli_epi16(v,8));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(data+i),v);
+    }
+  byteSwap16Sse4(data+i,count-i);
+  }
+
+T_TARGET("avx2,f16c")
+static inline __m256 rgbeMulAvx2(__m256 c, __m256i t) {
+  const __m256i bias = _mm256_set1_epi32(127);
+  const __m256i ha   = _mm256_srai_epi32(_mm256_add_epi32(t,_mm256_set1_epi32(1)),1);
+  const __m256i hb   = _mm256_srai_epi32(t,1);
+  const __m256  a    = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(ha,bias),23));
+  const __m256  b    = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(hb,bias),23));
+  return _mm256_mul_ps(_mm256_mul_ps(c,a),b);
+  }
+
+T_TARGET("avx2,f16c")
+static void rgbeToFloatAvx2(float* dst, const uint8_t* src, size_t count) {
+  const __m256i m   = _mm256_set1_epi32(0xFF);
+  const __m256i off = _mm256_set1_epi32(128+8);
+  size_t i = 0;
+  // both halves are loaded before anything is stored: 'src' may alias tail of 'dst'
+  for(; i+9<=count; i+=8) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src+i*4));
+    const __m256i e = _mm256_srli_epi32(v,24);
+    const __m256i t = _mm256_sub_epi32(e,off);
+    const __m256  z = _mm256_castsi256_ps(_mm256_cmpeq_epi32(e,_mm256_setzero_si256()));
+
+    const __m256  r = _mm256_andnot_ps(z,rgbeMulAvx2(_mm256_cvtepi32_ps(_mm256_and_si256(v,m)),                    t));
+    const __m256  g = _mm256_andnot_ps(z,rgbeMulAvx2(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(v,8),m)), t));
+    const __m256  b = _mm256_andnot_ps(z,rgbeMulAvx2(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(v,16),m)),t));
+    rgbeStore4Sse4(dst+i*3,   _mm256_castps256_ps128(r),  _mm256_castps256_ps128(g),  _mm256_castps256_ps128(b));
+    rgbeStore4Sse4(dst+i*3+12,_mm256_extractf128_ps(r,1), _mm256_extractf128_ps(g,1), _mm256_extractf128_ps(b,1));
+    }
+  rgbeToFloatSse4(dst+i*3,src+i*4,count-i);
+  }
+#endif
+
+#if defined(TEMPEST_PIXCONV_NEON)
+static void swizzleNeon(uint8_t* dst, uint8_t dc, const uint8_t* src, uint8_t sc, const int8_t* map, size_t count) {
+  uint8_t mask[16], ones[16];
+  const uint8_t    px  = buildShuffle(mask,ones,dc,sc,map);
+  const uint8x16_t shf = vld1q_u8(mask);
+  const uint8x16_t one = vld1q_u8(ones);
+
+  size_t i = 0;
+  for(; i+px<=count && i*sc+16<=count*sc && i*dc+16<=count*dc; i+=px) {
+    const uint8x16_t v = vqtbl1q_u8(vld1q_u8(src+i*sc),shf);
+    vst1q_u8(dst+i*dc,vorrq_u8(v,one));
+    }
+  swizzleScalar(dst+i*dc,dc,src+i*sc,sc,map,count-i);
+  }
+
+static void unorm16ToUnorm8Neon(uint8_t* dst, const uint16_t* src, size_t count) {
+  size_t i = 0;
+  for(; i+16<=count; i+=16) {
+    const uint8x8_t a = vshrn_n_u16(vld1q_u16(src+i),  8);
+    const uint8x8_t b = vshrn_n_u16(vld1q_u16(src+i+8),8);
+    vst1q_u8(dst+i,vcombine_u8(a,b));
+    }
+  unorm16ToUnorm8Scalar(dst+i,src+i,count-i);
+  }
+
+static inline uint32x4_t toUnorm8Neon(const float* src) {
+  // vminnm/vmaxnm pick the number over NaN, same as fmin/fmax
+  const float32x4_t v = vmaxnmq_f32(vminnmq_f32(vld1q_f32(src),vdupq_n_f32(1.f)),vdupq_n_f32(0.f));
+  return vcvtq_u32_f32(vmulq_n_f32(v,255.f));
+  }
+
+static void floatToUnorm8Neon(uint8_t* dst, const float* src, size_t count) {
+  size_t i = 0;
+  for(; i+16<=count; i+=16) {
+    const uint16x8_t a = vcombine_u16(vmovn_u32(toUnorm8Neon(src+i+0)), vmovn_u32(toUnorm8Neon(src+i+4)));
+    const uint16x8_t b = vcombine_u16(vmovn_u32(toUnorm8Neon(src+i+8)), vmovn_u32(toUnorm8Neon(src+i+12)));
+    vst1q_u8(dst+i,vcombine_u8(vmovn_u16(a),vmovn_u16(b)));
+    }
+  floatToUnorm8Scalar(dst+i,src+i,count-i);
+  }
+
+static void unorm8ToFloatNeon(float* dst, const uint8_t* src, size_t count) {
+  const float32x4_t k = vdupq_n_f32(255.f);
+  size_t i = 0;
+  for(; i+16<=count; i+=16) {
+    const uint8x16_t v  = vld1q_u8(src+i);
+    const uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+    const uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+    vst1q_f32(dst+i+0, vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16 (lo))),k));
+    vst1q_f32(dst+i+4, vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))),k));
+    vst1q_f32(dst+i+8, vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16 (hi))),k));
+    vst1q_f32(dst+i+12,vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))),k));
+    }
+  unorm8ToFloatScalar(dst+i,src+i,count-i);
+  }
+
+static void floatToHalfNeon(uint16_t* dst, const float* src, size_t count) {
+  size_t i = 0;
+  for(; i+4<=count; i+=4)
+    vst1_u16(dst+i,vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(src+i))));
+  floatToHalfScalar(dst+i,src+i,count-i);
+  }
+
+static void halfToFloatNeon(float* dst, const uint16_t* src, size_t count) {
+  size_t i = 0;
+  for(; i+4<=count; i+=4)
+    vst1q_f32(dst+i,vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src+i))));
+  halfToFloatScalar(dst+i,src+i,count-i);
+  }
+
+static void byteSwap16Neon(uint16_t* data, size_t count) {
+  size_t i = 0;
+  for(; i+8<=count; i+=8) {
+    const uint8x16_t v = vrev16q_u8(vreinterpretq_u8_u16(vld1q_u16(data+i)));
+    vst1q_u16(data+i,vreinterpretq_u16_u8(v));
+    }
+  byteSwap16Scalar(data+i,count-i);
+  }
+
+static inline float32x4_t rgbeMulNeon(uint16x4_t c, int32x4_t t, uint32x4_t zero) {
+  const int32x4_t   bias = vdupq_n_s32(127);
+  const int32x4_t   ha   = vshrq_n_s32(vaddq_s32(t,vdupq_n_s32(1)),1);
+  const int32x4_t   hb   = vshrq_n_s32(t,1);
+  const float32x4_t a    = vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(ha,bias),23));
+  const float32x4_t b    = vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(hb,bias),23));
+  const float32x4_t v    = vmulq_f32(vmulq_f32(vcvtq_f32_u32(vmovl_u16(c)),a),b);
+  return vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(v),zero));
+  }
+
+static void rgbeToFloatNeon(float* dst, const uint8_t* src, size_t count) {
+  size_t i = 0;
+  for(; i+8<=count; i+=8) {
+    const uint8x8x4_t v = vld4_u8(src+i*4);
+    const uint16x8_t  r = vmovl_u8(v.val[0]);
+    const uint16x8_t  g = vmovl_u8(v.val[1]);
+    const uint16x8_t  b = vmovl_u8(v.val[2]);
+    const uint16x8_t  e = vmovl_u8(v.val[3]);
+
+    for(int half=0; half<2; ++half) {
+      const uint16x4_t eh = half==0 ? vget_low_u16(e) : vget_high_u16(e);
+      const int32x4_t  t  = vsubq_s32(vreinterpretq_s32_u32(vmovl_u16(eh)),vdupq_n_s32(128+8));
+      const uint32x4_t z  = vceqq_u32(vmovl_u16(eh),vdupq_n_u32(0));
+
+      float32x4x3_t out;
+      out.val[0] = rgbeMulNeon(half==0 ? vget_low_u16(r) : vget_high_u16(r),t,z);
+      out.val[1] = rgbeMulNeon(half==0 ? vget_low_u16(g) : vget_high_u16(g),t,z);
+      out.val[2] = rgbeMulNeon(half==0 ? vget_low_u16(b) : vget_high_u16(b),t,z);
+      vst3q_f32(dst+i*3+half*12,out);
+      }
+    }
+  rgbeToFloatScalar(dst+i*3,src+i*4,count-i);
+  }
+#endif
+
+static const Kernels scalarKernels = {
+  PixelConv::Scalar,
+  swizzleScalar,
+  unorm16ToUnorm8Scalar,
+  floatToUnorm8Scalar,
+  unorm8ToFloatScalar,
+  floatToHalfScalar,
+  halfToFloatScalar,
+  byteSwap16Scalar,
+  rgbeToFloatScalar,
+  };
+
+#if defined(TEMPEST_PIXCONV_X86)
+static const Kernels sse4Kernels = {
+  PixelConv::Sse4,
+  swizzleSse4,
+  unorm16ToUnorm8Sse4,
+  floatToUnorm8Sse4,
+  unorm8ToFloatSse4,
+  floatToHalfScalar,
+  halfToFloatScalar,
+  byteSwap16Sse4,
+  rgbeToFloatSse4,
+  };
+
+static const Kernels avx2Kernels = {
+  PixelConv::Avx2,
+  swizzleAvx2,
+  unorm16ToUnorm8Avx2,
+  floatToUnorm8Avx2,
+  unorm8ToFloatAvx2,
+  floatToHalfAvx2,
+  halfToFloatAvx2,
+  byteSwap16Avx2,
+  rgbeToFloatAvx2,
+  };
+#endif
+
+#if defined(TEMPEST_PIXCONV_NEON)
+static const Kernels neonKernels = {
+  PixelConv::Neon,
+  swizzleNeon,
+  unorm16ToUnorm8Neon,
+  floatToUnorm8Neon,
+  unorm8ToFloatNeon,
+  floatToHalfNeon,
+  halfToFloatNeon,
+  byteSwap16Neon,
+  rgbeToFloatNeon,
+  };
+#endif
+
+static PixelConv::Isa detectIsa() {
+#if defined(TEMPEST_PIXCONV_X86)
+  uint32_t r0[4] = {}, r1[4] = {}, r7[4] = {};
+  cpuid(r0,0,0);
+  if(r0[0]<1)
+    return PixelConv::Scalar;
+  cpuid(r1,1,0);
+  if(r0[0]>=7)
+    cpuid(r7,7,0);
+
+  const bool ssse3   = (r1[2] & (1u<<9))!=0;
+  const bool sse41   = (r1[2] & (1u<<19))!=0;
+  const bool osxsave = (r1[2] & (1u<<27))!=0;
+  const bool avx     = (r1[2] & (1u<<28))!=0;
+  const bool f16c    = (r1[2] & (1u<<29))!=0;
+  const bool avx2    = (r7[1] & (1u<<5))!=0;
+  // os must preserve ymm registers
+  const bool ymm     = osxsave && avx && (xgetbv0() & 0x6)==0x6;
+
+  if(ssse3 && sse41 && ymm && avx2 && f16c)
+    return PixelConv::Avx2;
+  if(ssse3 && sse41)
+    return PixelConv::Sse4;
+  return PixelConv::Scalar;
+#elif defined(TEMPEST_PIXCONV_NEON)
+  return PixelConv::Neon;
+#else
+  return PixelConv::Scalar;
+#endif
+  }
+
+static PixelConv::Isa bestIsa() {
+  static const PixelConv::Isa isa = detectIsa();
+  return isa;
+  }
+
+static const Kernels& kernelsFor(PixelConv::Isa isa) {
+  switch(isa) {
+#if defined(TEMPEST_PIXCONV_X86)
+    case PixelConv::Sse4: return sse4Kernels;
+    case PixelConv::Avx2: return avx2Kernels;
+#endif
+#if defined(TEMPEST_PIXCONV_NEON)
+    case PixelConv::Neon: return neonKernels;
+#endif
+    default:
+      return scalarKernels;
+    }
+  }
+
+static std::atomic<const Kernels*> activeKernels{nullptr};
+
+static const Kernels& kernels() {
+  if(auto k = activeKernels.load(std::memory_order_acquire))
+    return *k;
+  const Kernels* k = &kernelsFor(bestIsa());
+  activeKernels.store(k,std::memory_order_release);
+  return *k;
+  }
+
+PixelConv::Isa PixelConv::isa() {
+  return kernels().isa;
+  }
+
+PixelConv::Isa PixelConv::setIsa(Isa i) {
+  const Isa best = bestIsa();
+  if(i!=Scalar && i!=best && !(i==Sse4 && best==Avx2))
+    i = best;
+  activeKernels.store(&kernelsFor(i),std::memory_order_release);
+  return i;
+  }
+
+const char* PixelConv::isaName(Isa i) {
+  switch(i) {
+    case Scalar: return "scalar";
+    case Sse4:   return "sse4";
+    case Avx2:   return "avx2";
+    case Neon:   return "neon";
+    }
+  return "";
+  }
+
+void PixelConv::swizzle8(uint8_t* dst, uint8_t dstComp, const uint8_t* src, uint8_t srcComp, const int8_t* map, size_t count) {
+  assert(1<=dstComp && dstComp<=4);
+  assert(1<=srcComp && srcComp<=4);
+  for(uint8_t c=0; c<dstComp; ++c)
+    assert(map[c]==Zero || map[c]==One || (0<=map[c] && map[c]<srcComp));
+  kernels().swizzle8(dst,dstComp,src,srcComp,map,count);
+  }
+
+void PixelConv::rgb8ToRgba8(uint8_t* dst, const uint8_t* src, size_t count) {
+  static const int8_t map[4] = {0,1,2,One};
+  kernels().swizzle8(dst,4,src,3,map,count);
+  }
+
+void PixelConv::rgba8ToRgb8(uint8_t* dst, const uint8_t* src, size_t count) {
+  static const int8_t map[3] = {0,1,2};
+  kernels().swizzle8(dst,3,src,4,map,count);
+  }
+
+void PixelConv::r8ToRgba8(uint8_t* dst, const uint8_t* src, size_t count) {
+  static const int8_t map[4] = {0,Zero,Zero,One};
+  kernels().swizzle8(dst,4,src,1,map,count);
+  }
+
+void PixelConv::bgra8ToRgba8(uint8_t* dst, const uint8_t* src, size_t count) {
+  static const int8_t map[4] = {2,1,0,3};
+  kernels().swizzle8(dst,4,src,4,map,count);
+  }
+
+void PixelConv::unorm16ToUnorm8(uint8_t* dst, const uint16_t* src, size_t count) {
+  kernels().unorm16ToUnorm8(dst,src,count);
+  }
+
+void PixelConv::floatToUnorm8(uint8_t* dst, const float* src, size_t count) {
+  kernels().floatToUnorm8(dst,src,count);
+  }
+
+void PixelConv::unorm8ToFloat(float* dst, const uint8_t* src, size_t count) {
+  kernels().unorm8ToFloat(dst,src,count);
+  }
+
+void PixelConv::floatToHalf(uint16_t* dst, const float* src, size_t count) {
+  kernels().floatToHalf(dst,src,count);
+  }
+
+void PixelConv::halfToFloat(float* dst, const uint16_t* src, size_t count) {
+  kernels().halfToFloat(dst,src,count);
+  }
+
+void PixelConv::byteSwap16(uint16_t* data, size_t count) {
+  kernels().byteSwap16(data,count);
+  }
+
+void PixelConv::rgbeToFloat(float* dst, const uint8_t* src, size_t count) {
+  kernels().rgbeToFloat(dst,src,count);
+  }
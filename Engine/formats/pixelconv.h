@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Tempest {
+namespace Detail {
+
+// Pixel format conversion kernels. Instruction set is picked at runtime, on first use;
+// every kernel has a scalar reference, that produces bit-exact same result.
+class PixelConv final {
+  public:
+    enum Isa : uint8_t {
+      Scalar,
+      Sse4,  // SSSE3 + SSE4.1
+      Avx2,  // AVX2  + F16C
+      Neon,  // AArch64 only
+      };
+
+    // swizzle map entries: index of source channel, or one of these constants
+    enum Channel : int8_t {
+      Zero = -1,
+      One  = -2,
+      };
+
+    static Isa  isa();
+    // for tests and benchmarks: falls back to best supported set, if 'i' is not available
+    static Isa  setIsa(Isa i);
+    static const char* isaName(Isa i);
+
+    // dst[i*dstComp+c] = src[i*srcComp+map[c]]; 'count' is number of pixels
+    static void swizzle8(uint8_t* dst, uint8_t dstComp, const uint8_t* src, uint8_t srcComp, const int8_t* map, size_t count);
+    static void rgb8ToRgba8(uint8_t* dst, const uint8_t* src, size_t count);
+    static void rgba8ToRgb8(uint8_t* dst, const uint8_t* src, size_t count);
+    static void r8ToRgba8  (uint8_t* dst, const uint8_t* src, size_t count);
+    static void bgra8ToRgba8(uint8_t* dst, const uint8_t* src, size_t count);
+
+    // per-channel conversions; 'count' is number of channels
+    static void unorm16ToUnorm8(uint8_t*  dst, const uint16_t* src, size_t count);
+    static void floatToUnorm8  (uint8_t*  dst, const float*    src, size_t count);
+    static void unorm8ToFloat  (float*    dst, const uint8_t*  src, size_t count);
+    static void floatToHalf    (uint16_t* dst, const float*    src, size_t count);
+    static void halfToFloat    (float*    dst, const uint16_t* src, size_t count);
+    static void byteSwap16     (uint16_t* data, size_t count);
+
+    // Radiance RGBE into RGB32F; 'src' may occupy tail of 'dst' (last count*4 bytes) for in-place decoding
+    static void rgbeToFloat(float* dst, const uint8_t* src, size_t count);
+  };
+
+}
+}
@@ -4,13 +4,42 @@
 #include <Tempest/Except>
 
 #include "pixmapcodec.h"
+#include "pixelconv.h"
 #include "thirdparty/squish/squish.h"
 
+#include <algorithm>
+#include <atomic>
 #include <vector>
+#include <thread>
 #include <cstring>
 #include <cassert>
 
 using namespace Tempest;
+using namespace Tempest::Detail;
+
+static bool isUnorm8(TextureFormat f) {
+  switch (f) {
+    case R8:
+    case RG8:
+    case RGB8:
+    case RGBA8:
+      return true;
+    default:
+      return false;
+    }
+  }
+
+static bool isUnorm16(TextureFormat f) {
+  switch (f) {
+    case R16:
+    case RG16:
+    case RGB16:
+    case RGBA16:
+      return true;
+    default:
+      return false;
+    }
+  }
 
 static bool isFloat32Frm(TextureFormat f) {
   switch (f) {
@@ -36,6 +65,11 @@ struct Pixmap::Impl {
     std::memset(data,0,dataSz);
     }
 
+  Impl(uint8_t* data, size_t size, uint32_t w, uint32_t h, TextureFormat frm, uint32_t mipCnt,
+       void (*release)(void*), void* owner)
+    :data(data),w(w),h(h),dataSz(size),frm(frm),mipCnt(mipCnt),release(release),owner(owner) {
+    }
+
   Impl(const Impl& other):w(other.w),h(other.h),dataSz(other.dataSz),frm(other.frm),mipCnt(other.mipCnt){
     data   = reinterpret_cast<uint8_t*>(std::malloc(dataSz));
     if(!data)
@@ -50,73 +84,297 @@ struct Pixmap::Impl {
       throw std::bad_alloc();
     dataSz = size;
 
-    if(frm==TextureFormat::RGBA8 && other.frm==TextureFormat::RGB8) {
-      // specialize a common case
-      const size_t sz = size_t(w)*size_t(h);
-      for(size_t i=0;i<sz;++i) {
-        uint32_t&       pix=reinterpret_cast<uint32_t*>(data)[i];
-        const uint8_t*  s  =other.data+i*3;
-        pix = uint32_t(s[0])<<0 | uint32_t(s[1])<<8 | uint32_t(s[2])<<16 | uint32_t(255)<<24;
+    convertPixels(data,frm,other.data,other.frm,w,h);
+    }
+
+  Impl(IDevice& f){
+    uint32_t bpp = 0;
+    frm  = TextureFormat::RGBA8;
+    data = PixmapCodec::loadImg(f,w,h,frm,mipCnt,bpp,dataSz);
+
+    if(data==nullptr && bpp==0)
+      throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+    }
+
+  ~Impl(){
+    if(release!=nullptr)
+      release(owner); else
+      PixmapCodec::freeImg(data);
+    }
+
+  Impl* addRef() const {
+    refCnt.fetch_add(1,std::memory_order_relaxed);
+    return const_cast<Impl*>(this);
+    }
+
+  bool  isShared() const {
+    return refCnt.load(std::memory_order_acquire)>1;
+    }
+
+  static size_t calcDataSize(uint32_t w, uint32_t h, TextureFormat frm) {
+    auto bsz = blockCount(frm,w,h);
+    auto bpb = blockSizeForFormat(frm);
+    return size_t(bsz.w)*size_t(bsz.h)*size_t(bpb);
+    }
+
+  static std::unique_ptr<Impl,Deleter> convert(const Impl& other, TextureFormat frm, bool mips) {
+    if(other.frm==frm)
+      return std::unique_ptr<Impl,Deleter>(other.addRef()); // shared, until first write
+
+    if((isCompressed(frm) && squishFormat(frm)==0) || (isCompressed(other.frm) && squishFormat(other.frm)==0)) {
+      // BC4-BC7: no software codec
+      throw std::runtime_error("unimplemented");
+      }
+
+    if(isCompressed(frm)) {
+      if(other.frm!=TextureFormat::RGBA8) {
+        Impl tmp(other,TextureFormat::RGBA8);
+        return compress(tmp,frm,mips);
         }
-      return;
+      return compress(other,frm,mips);
       }
 
     if(isCompressed(other.frm)) {
-      assert(frm==TextureFormat::RGB8 || frm==TextureFormat::RGBA8); // rest is handled outside of this function
+      if(frm!=TextureFormat::RGB8 && frm!=TextureFormat::RGBA8) {
+        // cross-conversion: DDS -> RGBA -> frm
+        Impl tmp(other,TextureFormat::RGBA8);
+        return std::unique_ptr<Impl,Deleter>(new Impl(tmp,frm));
+        }
+      }
+
+    return std::unique_ptr<Impl,Deleter>(new Impl(other,frm));
+    }
+
+  struct Level {
+    const uint8_t* rgba = nullptr;
+    uint8_t*       dst  = nullptr;
+    uint32_t       w    = 0;
+    uint32_t       h    = 0;
+    };
+
+  static std::unique_ptr<Impl,Deleter> compress(const Impl& rgba, TextureFormat frm, bool mips) {
+    const int      flags  = squishFormat(frm);
+    const uint32_t mipCnt = mips ? mipCount(rgba.w,rgba.h) : 1;
+
+    size_t size = 0;
+    for(uint32_t i=0, mw=rgba.w, mh=rgba.h; i<mipCnt; ++i) {
+      size += calcDataSize(mw,mh,frm);
+      mw = std::max(1u,mw/2);
+      mh = std::max(1u,mh/2);
+      }
+
+    std::unique_ptr<Impl,Deleter> ret(new Impl());
+    ret->data = reinterpret_cast<uint8_t*>(std::malloc(size));
+    if(ret->data==nullptr)
+      throw std::bad_alloc();
+    ret->w      = rgba.w;
+    ret->h      = rgba.h;
+    ret->frm    = frm;
+    ret->dataSz = size;
+    ret->mipCnt = mipCnt;
+
+    // box-filter whole chain upfront; it's cheap, compared to block encoding
+    std::vector<std::vector<uint8_t>> chain(mipCnt-1);
+    std::vector<Level>                level(mipCnt);
+    const uint8_t* src = rgba.data;
+    uint8_t*       dst = ret->data;
+    uint32_t       mw  = rgba.w, mh = rgba.h;
+    for(uint32_t i=0; i<mipCnt; ++i) {
+      level[i].rgba = src;
+      level[i].dst  = dst;
+      level[i].w    = mw;
+      level[i].h    = mh;
+      dst += calcDataSize(mw,mh,frm);
+      if(i+1==mipCnt)
+        break;
+      downsample(chain[i],src,mw,mh);
+      src = chain[i].data();
+      mw  = std::max(1u,mw/2);
+      mh  = std::max(1u,mh/2);
+      }
+
+    // block rows of all levels share one queue, served by single set of workers
+    std::vector<std::pair<uint32_t,uint32_t>> rows;
+    for(uint32_t i=0; i<mipCnt; ++i)
+      for(uint32_t by=0; by<(level[i].h+3)/4; ++by)
+        rows.emplace_back(i,by);
+    parallelFor(rows.size(), [&](size_t i) {
+      compressRow(level[rows[i].first],rows[i].second,flags);
+      });
+    return ret;
+    }
+
+  static void compressLevel(uint8_t* dst, const uint8_t* rgba, uint32_t w, uint32_t h, int flags) {
+    Level l;
+    l.rgba = rgba;
+    l.dst  = dst;
+    l.w    = w;
+    l.h    = h;
+    parallelFor((h+3)/4, [&](size_t by) {
+      compressRow(l,uint32_t(by),flags);
+      });
+    }
+
+  static void compressRow(const Level& l, uint32_t by, int flags) {
+    const uint32_t bw        = (l.w+3)/4;
+    const size_t   blocksize = (flags==squish::kDxt1) ? 8 : 16;
+
+    squish::u8 pixels[16][4] = {};
+    for(uint32_t bx=0; bx<bw; ++bx) {
+      int mask = 0;
+      for(uint32_t y=0; y<4; ++y)
+        for(uint32_t x=0; x<4; ++x) {
+          const uint32_t px = bx*4+x, py = by*4+y;
+          if(px>=l.w || py>=l.h)
+            continue;
+          std::memcpy(pixels[y*4+x], &l.rgba[(size_t(py)*l.w+px)*4], 4);
+          mask |= (1 << (y*4+x));
+          }
+      squish::CompressMasked(&pixels[0][0], mask, &l.dst[(size_t(by)*bw+bx)*blocksize], flags);
+      }
+    }
+
+  static void downsample(std::vector<uint8_t>& out, const uint8_t* rgba, uint32_t w, uint32_t h) {
+    const uint32_t nw = std::max(1u,w/2);
+    const uint32_t nh = std::max(1u,h/2);
+    out.resize(size_t(nw)*nh*4);
+
+    for(size_t y=0; y<nh; ++y) {
+      const size_t y0 = std::min<size_t>(y*2,  h-1);
+      const size_t y1 = std::min<size_t>(y*2+1,h-1);
+      for(size_t x=0; x<nw; ++x) {
+        const size_t x0 = std::min<size_t>(x*2,  w-1);
+        const size_t x1 = std::min<size_t>(x*2+1,w-1);
+        for(size_t c=0; c<4; ++c) {
+          uint32_t v = uint32_t(rgba[(y0*w+x0)*4+c]) + rgba[(y0*w+x1)*4+c] +
+                       uint32_t(rgba[(y1*w+x0)*4+c]) + rgba[(y1*w+x1)*4+c];
+          out[(y*nw+x)*4+c] = uint8_t((v+2)/4);
+          }
+        }
+      }
+    }
+
+  // runs fn(i) for i in [0..count), on at most hardware_concurrency threads; spawned once per call
+  template<class Fn>
+  static void parallelFor(size_t count, const Fn& fn) {
+    const size_t minPerThread = 16;
+    size_t       th           = std::max(1u, std::thread::hardware_concurrency());
+    th = std::min(th, count/minPerThread);
+    if(th<=1) {
+      for(size_t i=0; i<count; ++i)
+        fn(i);
+      return;
+      }
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+      for(size_t i=next.fetch_add(1); i<count; i=next.fetch_add(1))
+        fn(i);
+      };
+
+    std::vector<std::thread> pool;
+    pool.reserve(th-1);
+    for(size_t i=1; i<th; ++i)
+      pool.emplace_back(worker);
+    worker();
+    for(auto& i:pool)
+      i.join();
+    }
+
+  static uint32_t mipCount(uint32_t w, uint32_t h) {
+    uint32_t s = std::max(w,h);
+    uint32_t n = 1;
+    while(s>1) {
+      ++n;
+      s = s/2;
+      }
+    return n;
+    }
+
+  static int squishFormat(TextureFormat frm) {
+    switch(frm) {
+      case TextureFormat::DXT1: return squish::kDxt1;
+      case TextureFormat::DXT3: return squish::kDxt3;
+      case TextureFormat::DXT5: return squish::kDxt5;
+      default:
+        return 0;
+      }
+    }
+
+  static void convertPixels(uint8_t* dst, TextureFormat dfrm, const uint8_t* src, TextureFormat sfrm, uint32_t w, uint32_t h) {
+    if(isCompressed(dfrm)) {
+      // single level: encoder works on RGBA8 only
+      if(squishFormat(dfrm)==0)
+        throw std::runtime_error("unimplemented");
+      if(sfrm==TextureFormat::RGBA8) {
+        compressLevel(dst,src,w,h,squishFormat(dfrm));
+        return;
+        }
+      std::vector<uint8_t> rgba(size_t(w)*size_t(h)*4);
+      convertPixels(rgba.data(),TextureFormat::RGBA8,src,sfrm,w,h);
+      compressLevel(dst,rgba.data(),w,h,squishFormat(dfrm));
+      return;
+      }
+
+    if(isCompressed(sfrm)) {
+      assert(dfrm==TextureFormat::RGB8 || dfrm==TextureFormat::RGBA8); // rest is handled outside of this function
       static const int kfrm[] = {squish::kDxt1,squish::kDxt3,squish::kDxt5};
-      if(frm==TextureFormat::RGB8)
-        ddsToRgba(data,other.data,w,h,kfrm[uint8_t(other.frm)-uint8_t(TextureFormat::DXT1)],3); else
-        ddsToRgba(data,other.data,w,h,kfrm[uint8_t(other.frm)-uint8_t(TextureFormat::DXT1)],4);
+      if(dfrm==TextureFormat::RGB8)
+        ddsToRgba(dst,src,w,h,kfrm[uint8_t(sfrm)-uint8_t(TextureFormat::DXT1)],3); else
+        ddsToRgba(dst,src,w,h,kfrm[uint8_t(sfrm)-uint8_t(TextureFormat::DXT1)],4);
       return;
       }
 
-    if(isCompressed(frm)) {
-      // TODO: image compression
-      throw std::runtime_error("unimplemented");
+    if(sfrm==TextureFormat::RGBA16F || dfrm==TextureFormat::RGBA16F) {
+      convertHalf(dst,dfrm,src,sfrm,w,h);
+      return;
       }
 
+    if(convertSimd(dst,dfrm,src,sfrm,size_t(w)*size_t(h)))
+      return;
+
     // noncompressed, non-packed
-    const uint8_t compDst = Pixmap::componentCount(frm);
-    const uint8_t compSrc = Pixmap::componentCount(other.frm);
+    const uint8_t compDst = Pixmap::componentCount(dfrm);
+    const uint8_t compSrc = Pixmap::componentCount(sfrm);
 
-    const uint8_t byteDst = bytesPerChannel(frm);
-    const uint8_t byteSrc = bytesPerChannel(other.frm);
+    const uint8_t byteDst = bytesPerChannel(dfrm);
+    const uint8_t byteSrc = bytesPerChannel(sfrm);
 
     switch(byteDst) {
       case 1:{
         switch(byteSrc) {
-          case 1: noncompresedConv<uint8_t,uint8_t> (w,h, data,other.data, compDst, compSrc); return;
-          case 2: noncompresedConv<uint8_t,uint16_t>(w,h, data,other.data, compDst, compSrc); return;
+          case 1: noncompresedConv<uint8_t,uint8_t> (w,h, dst,src, compDst, compSrc); return;
+          case 2: noncompresedConv<uint8_t,uint16_t>(w,h, dst,src, compDst, compSrc); return;
           case 4:
-            if(isFloat32Frm(other.frm))
-              noncompresedConv<uint8_t,float>   (w,h, data,other.data, compDst, compSrc); else
-              noncompresedConv<uint8_t,uint32_t>(w,h, data,other.data, compDst, compSrc);
+            if(isFloat32Frm(sfrm))
+              noncompresedConv<uint8_t,float>   (w,h, dst,src, compDst, compSrc); else
+              noncompresedConv<uint8_t,uint32_t>(w,h, dst,src, compDst, compSrc);
             return;
           }
         }
       case 2:{
         switch(byteSrc) {
-          case 1: noncompresedConv<uint16_t,uint8_t> (w,h, data,other.data, compDst, compSrc); return;
-          case 2: noncompresedConv<uint16_t,uint16_t>(w,h, data,other.data, compDst, compSrc); return;
+          case 1: noncompresedConv<uint16_t,uint8_t> (w,h, dst,src, compDst, compSrc); return;
+          case 2: noncompresedConv<uint16_t,uint16_t>(w,h, dst,src, compDst, compSrc); return;
           case 4:
-            if(isFloat32Frm(other.frm))
-              noncompresedConv<uint16_t,float>   (w,h, data,other.data, compDst, compSrc); else
-              noncompresedConv<uint16_t,uint32_t>(w,h, data,other.data, compDst, compSrc);
+            if(isFloat32Frm(sfrm))
+              noncompresedConv<uint16_t,float>   (w,h, dst,src, compDst, compSrc); else
+              noncompresedConv<uint16_t,uint32_t>(w,h, dst,src, compDst, compSrc);
             return;
           }
         }
       case 4:{
         switch(byteSrc) {
-          case 1: noncompresedConv<float,uint8_t> (w,h, data,other.data, compDst, compSrc); return;
-          case 2: noncompresedConv<float,uint16_t>(w,h, data,other.data, compDst, compSrc); return;
+          case 1: noncompresedConv<float,uint8_t> (w,h, dst,src, compDst, compSrc); return;
+          case 2: noncompresedConv<float,uint16_t>(w,h, dst,src, compDst, compSrc); return;
           case 4:
-            if(isFloat32Frm(frm) && isFloat32Frm(other.frm))
-              noncompresedConv<float,float>(w,h, data,other.data, compDst, compSrc); else
-            if(isFloat32Frm(frm))
-                noncompresedConv<float,uint32_t>(w,h, data,other.data, compDst, compSrc); else
-            if(isFloat32Frm(other.frm))
-              noncompresedConv<uint32_t,float>(w,h, data,other.data, compDst, compSrc); else
-              noncompresedConv<uint32_t,uint32_t>(w,h, data,other.data, compDst, compSrc);
+            if(isFloat32Frm(dfrm) && isFloat32Frm(sfrm))
+              noncompresedConv<float,float>(w,h, dst,src, compDst, compSrc); else
+            if(isFloat32Frm(dfrm))
+                noncompresedConv<float,uint32_t>(w,h, dst,src, compDst, compSrc); else
+            if(isFloat32Frm(sfrm))
+              noncompresedConv<uint32_t,float>(w,h, dst,src, compDst, compSrc); else
+              noncompresedConv<uint32_t,uint32_t>(w,h, dst,src, compDst, compSrc);
             return;
           }
         }
@@ -126,38 +384,62 @@ struct Pixmap::Impl {
     throw std::runtime_error("unimplemented");
     }
 
-  Impl(IDevice& f){
-    uint32_t bpp = 0;
-    frm  = TextureFormat::RGBA8;
-    data = PixmapCodec::loadImg(f,w,h,frm,mipCnt,bpp,dataSz);
-
-    if(data==nullptr && bpp==0)
-      throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
-    }
-
-  ~Impl(){
-    PixmapCodec::freeImg(data);
-    }
+  // half-float goes through RGBA32F
+  static void convertHalf(uint8_t* dst, TextureFormat dfrm, const uint8_t* src, TextureFormat sfrm, uint32_t w, uint32_t h) {
+    const size_t count = size_t(w)*size_t(h)*4;
+    if(sfrm==dfrm) {
+      std::memcpy(dst,src,count*2);
+      return;
+      }
+    if(sfrm==TextureFormat::RGBA16F && dfrm==TextureFormat::RGBA32F) {
+      PixelConv::halfToFloat(reinterpret_cast<float*>(dst),reinterpret_cast<const uint16_t*>(src),count);
+      return;
+      }
+    if(sfrm==TextureFormat::RGBA32F && dfrm==TextureFormat::RGBA16F) {
+      PixelConv::floatToHalf(reinterpret_cast<uint16_t*>(dst),reinterpret_cast<const float*>(src),count);
+      return;
+      }
 
-  static size_t calcDataSize(uint32_t w, uint32_t h, TextureFormat frm) {
-    auto bsz = blockCount(frm,w,h);
-    auto bpb = blockSizeForFormat(frm);
-    return size_t(bsz.w)*size_t(bsz.h)*size_t(bpb);
+    std::vector<float> tmp(count);
+    auto*              tmpData = reinterpret_cast<uint8_t*>(tmp.data());
+    if(sfrm==TextureFormat::RGBA16F) {
+      convertHalf  (tmpData,TextureFormat::RGBA32F,src,sfrm,w,h);
+      convertPixels(dst,dfrm,tmpData,TextureFormat::RGBA32F,w,h);
+      } else {
+      convertPixels(tmpData,TextureFormat::RGBA32F,src,sfrm,w,h);
+      convertHalf  (dst,dfrm,tmpData,TextureFormat::RGBA32F,w,h);
+      }
     }
 
-  static std::unique_ptr<Impl,Deleter> convert(const Impl& other, TextureFormat frm) {
-    if(other.frm==frm)
-      return std::unique_ptr<Impl,Deleter>(new Impl(other)); //copy
+  // vectorized kernels for common pairs; false, if pair is not covered
+  static bool convertSimd(uint8_t* dst, TextureFormat dfrm, const uint8_t* src, TextureFormat sfrm, size_t count) {
+    const uint8_t dc = Pixmap::componentCount(dfrm);
+    const uint8_t sc = Pixmap::componentCount(sfrm);
 
-    if(isCompressed(other.frm)) {
-      if(frm!=TextureFormat::RGB8 && frm!=TextureFormat::RGBA8) {
-        // cross-conversion: DDS -> RGBA -> frm
-        Impl tmp(other,TextureFormat::RGBA8);
-        return std::unique_ptr<Impl,Deleter>(new Impl(tmp,frm));
-        }
+    if(isUnorm8(dfrm) && isUnorm8(sfrm)) {
+      // same as noncompresedConv: missing channels are 0, alpha is 1
+      int8_t map[4] = {};
+      for(uint8_t c=0; c<dc; ++c)
+        map[c] = c<sc ? int8_t(c) : int8_t(c==3 ? PixelConv::One : PixelConv::Zero);
+      PixelConv::swizzle8(dst,dc,src,sc,map,count);
+      return true;
       }
 
-    return std::unique_ptr<Impl,Deleter>(new Impl(other,frm));
+    if(dc!=sc)
+      return false;
+    if(isUnorm8(dfrm) && isUnorm16(sfrm)) {
+      PixelConv::unorm16ToUnorm8(dst,reinterpret_cast<const uint16_t*>(src),count*sc);
+      return true;
+      }
+    if(isUnorm8(dfrm) && isFloat32Frm(sfrm)) {
+      PixelConv::floatToUnorm8(dst,reinterpret_cast<const float*>(src),count*sc);
+      return true;
+      }
+    if(isFloat32Frm(dfrm) && isUnorm8(sfrm)) {
+      PixelConv::unorm8ToFloat(reinterpret_cast<float*>(dst),src,count*sc);
+      return true;
+      }
+    return false;
     }
 
   template<class T>
@@ -250,6 +532,10 @@ struct Pixmap::Impl {
       case TextureFormat::DXT1:    return 0;
       case TextureFormat::DXT3:    return 0;
       case TextureFormat::DXT5:    return 0;
+      case TextureFormat::BC4:     return 0;
+      case TextureFormat::BC5:     return 0;
+      case TextureFormat::BC6H:    return 0;
+      case TextureFormat::BC7:     return 0;
       //---
       default:
         return uint8_t(Pixmap::bppForFormat(frm)/Pixmap::componentCount(frm));
@@ -257,9 +543,7 @@ struct Pixmap::Impl {
     }
 
   static bool isCompressed(TextureFormat frm) {
-    return frm==TextureFormat::DXT1 ||
-           frm==TextureFormat::DXT3 ||
-           frm==TextureFormat::DXT5;
+    return isCompressedFormat(frm);
     }
 
   void save(ODevice& f,const char* ext){
@@ -292,13 +576,21 @@ struct Pixmap::Impl {
   TextureFormat frm    = TextureFormat::RGB8;
   uint32_t      mipCnt = 1;
 
+  // external storage, adopted by Pixmap::fromBuffer
+  void        (*release)(void*) = nullptr;
+  void*         owner  = nullptr;
+
+  mutable std::atomic<uint32_t> refCnt{1};
+
   static Impl   zero;
   };
 
 Pixmap::Impl Pixmap::Impl::zero;
 
 void Pixmap::Deleter::operator()(Pixmap::Impl *ptr) {
-  if(ptr!=&Pixmap::Impl::zero)
+  if(ptr==&Pixmap::Impl::zero)
+    return;
+  if(ptr->refCnt.fetch_sub(1,std::memory_order_acq_rel)==1)
     delete ptr;
   }
 
@@ -306,7 +598,11 @@ Pixmap::Pixmap():impl(&Impl::zero){
   }
 
 Pixmap::Pixmap(const Pixmap &src, TextureFormat conv)
-  :impl(Impl::convert(*src.impl,conv)){
+  :impl(Impl::convert(*src.impl,conv,false)){
+  }
+
+Pixmap::Pixmap(const Pixmap& src, TextureFormat conv, bool mips)
+  :impl(Impl::convert(*src.impl,conv,mips)){
   }
 
 Pixmap::Pixmap(uint32_t w, uint32_t h, TextureFormat frm)
@@ -314,22 +610,22 @@ Pixmap::Pixmap(uint32_t w, uint32_t h, TextureFormat frm)
   }
 
 Pixmap::Pixmap(const char* path) {
-  RFile f(path);
+  MappedFile f(path);
   impl.reset(new Impl(f));
   }
 
 Pixmap::Pixmap(const std::string &path) {
-  RFile f(path);
+  MappedFile f(path);
   impl.reset(new Impl(f));
   }
 
 Pixmap::Pixmap(const char16_t *path) {
-  RFile f(path);
+  MappedFile f(path);
   impl.reset(new Impl(f));
   }
 
 Pixmap::Pixmap(const std::u16string &path) {
-  RFile f(path);
+  MappedFile f(path);
   impl.reset(new Impl(f));
   }
 
@@ -338,7 +634,7 @@ Pixmap::Pixmap(IDevice &input) {
   }
 
 Pixmap::Pixmap(const Pixmap &src)
-  :impl(new Impl(*src.impl)){
+  :impl(src.impl->addRef()){
   }
 
 Pixmap::Pixmap(Pixmap &&p)
@@ -351,12 +647,63 @@ Pixmap& Pixmap::operator=(Pixmap &&p) {
   }
 
 Pixmap& Pixmap::operator=(const Pixmap &p) {
-  if(p.impl.get()==&Impl::zero)
-    impl.reset(&Impl::zero); else
-    impl.reset(new Impl(*p.impl));
+  impl.reset(p.impl->addRef());
   return *this;
   }
 
+static size_t adoptedSize(size_t size, uint32_t w, uint32_t h, TextureFormat frm, uint32_t mips) {
+  size_t need = 0;
+  for(uint32_t i=0; i<mips; ++i) {
+    auto bsz = Pixmap::blockCount(frm,std::max(1u,w>>i),std::max(1u,h>>i));
+    need += size_t(bsz.w)*size_t(bsz.h)*Pixmap::blockSizeForFormat(frm);
+    }
+  if(mips==0 || need==0 || size<need)
+    return 0;
+  return need;
+  }
+
+Pixmap Pixmap::fromBuffer(void* data, size_t size, uint32_t w, uint32_t h, TextureFormat frm, uint32_t mips,
+                          void (*release)(void*)) {
+  const size_t sz = adoptedSize(size,w,h,frm,mips);
+  if(data==nullptr || sz==0) {
+    if(release!=nullptr)
+      release(data);
+    throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+    }
+
+  if(release==nullptr)
+    release = [](void*){}; // not owned
+
+  Pixmap ret;
+  try {
+    ret.impl.reset(new Impl(reinterpret_cast<uint8_t*>(data),sz,w,h,frm,mips,release,data));
+    }
+  catch(...) {
+    release(data);
+    throw;
+    }
+  return ret;
+  }
+
+Pixmap Pixmap::fromBuffer(std::vector<uint8_t>&& data, uint32_t w, uint32_t h, TextureFormat frm, uint32_t mips) {
+  const size_t sz = adoptedSize(data.size(),w,h,frm,mips);
+  if(sz==0)
+    throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+
+  auto owner = new std::vector<uint8_t>(std::move(data));
+  auto free  = [](void* v) { delete reinterpret_cast<std::vector<uint8_t>*>(v); };
+
+  Pixmap ret;
+  try {
+    ret.impl.reset(new Impl(owner->data(),sz,w,h,frm,mips,free,owner));
+    }
+  catch(...) {
+    free(owner);
+    throw;
+    }
+  return ret;
+  }
+
 Pixmap::~Pixmap() {
   }
 
@@ -402,6 +749,9 @@ const void *Pixmap::data() const {
   }
 
 void *Pixmap::data() {
+  // copy-on-write
+  if(impl->isShared() && impl.get()!=&Impl::zero)
+    impl.reset(new Impl(*impl));
   return impl->data;
   }
 
@@ -455,6 +805,11 @@ size_t Pixmap::blockSizeForFormat(TextureFormat frm) {
     //---
     case TextureFormat::R11G11B10UF: return 4;
     case TextureFormat::RGBA16F:     return 8;
+    //---
+    case TextureFormat::BC4:         return 8;
+    case TextureFormat::BC5:         return 16;
+    case TextureFormat::BC6H:        return 16;
+    case TextureFormat::BC7:         return 16;
     }
   return 0;
   }
@@ -495,6 +850,11 @@ uint8_t Pixmap::componentCount(TextureFormat frm) {
     //---
     case TextureFormat::R11G11B10UF: return 3;
     case TextureFormat::RGBA16F:     return 4;
+    //---
+    case TextureFormat::BC4:         return 1;
+    case TextureFormat::BC5:         return 2;
+    case TextureFormat::BC6H:        return 3;
+    case TextureFormat::BC7:         return 4;
     }
   return 0;
   }
@@ -530,6 +890,10 @@ Size Pixmap::blockCount(TextureFormat frm, uint32_t w, uint32_t h) {
     case TextureFormat::DXT1:
     case TextureFormat::DXT3:
     case TextureFormat::DXT5:
+    case TextureFormat::BC4:
+    case TextureFormat::BC5:
+    case TextureFormat::BC6H:
+    case TextureFormat::BC7:
       return Size((w+3)/4,(h+3)/4);
       break;
     }
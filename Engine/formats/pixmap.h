@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstdlib>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <Tempest/AbstractGraphicsApi>
 
@@ -14,6 +16,8 @@ class Pixmap final {
   public:
     Pixmap();
     Pixmap(const Pixmap& src, TextureFormat conv);
+    // for DXT targets 'mips' builds full mip chain, before compression
+    Pixmap(const Pixmap& src, TextureFormat conv, bool mips);
     Pixmap(uint32_t w, uint32_t h, TextureFormat frm);
     Pixmap(const char* path);
     Pixmap(const std::string& path);
@@ -21,6 +25,8 @@ class Pixmap final {
     Pixmap(const std::u16string& path);
     Pixmap(IDevice& input);
 
+    // pixel data is shared between copies, until one of them calls non-const data();
+    // don't keep pointer from non-const data() across copies
     Pixmap(const Pixmap& src);
     Pixmap(Pixmap&& p);
     Pixmap& operator=(Pixmap&& p);
@@ -28,6 +34,12 @@ class Pixmap final {
 
     ~Pixmap();
 
+    // adopts 'data' without copying; 'release(data)' is called, once last reference is gone.
+    // with release==nullptr buffer is not owned and must outlive all copies
+    static Pixmap fromBuffer(void* data, size_t size, uint32_t w, uint32_t h, TextureFormat frm, uint32_t mips = 1,
+                             void (*release)(void*) = std::free);
+    static Pixmap fromBuffer(std::vector<uint8_t>&& data, uint32_t w, uint32_t h, TextureFormat frm, uint32_t mips = 1);
+
     void        save(const char* path, const char* ext=nullptr) const;
     void        save(ODevice&    fout, const char *ext=nullptr) const;
 
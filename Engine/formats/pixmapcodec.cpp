@@ -3,6 +3,7 @@
 #include "image/pixmapcodeccommon.h"
 #include "image/pixmapcodecpng.h"
 #include "image/pixmapcodecdds.h"
+#include "image/pixmapcodecktx.h"
 #include "image/pixmapcodechdr.h"
 
 #include <Tempest/IDevice>
@@ -31,6 +32,7 @@ struct PixmapCodec::Impl {
   Impl() {
     // thread-safe init, because PixmapCodec::instance
     codec.emplace_back(std::make_unique<PixmapCodecDDS>());
+    codec.emplace_back(std::make_unique<PixmapCodecKTX>());
     codec.emplace_back(std::make_unique<PixmapCodecPng>());
     codec.emplace_back(std::make_unique<PixmapCodecHDR>());
     codec.emplace_back(std::make_unique<PixmapCodecCommon>());
@@ -0,0 +1,284 @@
+#include "texturefile.h"
+
+#include <Tempest/IDevice>
+#include <Tempest/Pixmap>
+#include <Tempest/Except>
+
+#include <algorithm>
+#include <cstring>
+
+#include "ddsdef.h"
+#include "ktxdef.h"
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+static TextureFormat fourCCFormat(uint32_t fourCC) {
+  switch(fourCC) {
+    case FOURCC_DXT1: return TextureFormat::DXT1;
+    case FOURCC_DXT3: return TextureFormat::DXT3;
+    case FOURCC_DXT5: return TextureFormat::DXT5;
+    case FOURCC_ATI1:
+    case FOURCC_BC4U: return TextureFormat::BC4;
+    case FOURCC_ATI2:
+    case FOURCC_BC5U: return TextureFormat::BC5;
+    }
+  return TextureFormat::Undefined;
+  }
+
+static TextureFormat dxgiFormat(uint32_t frm) {
+  // NOTE: engine has no sRGB formats - sRGB data is sampled as UNORM, same as png/jpg
+  switch(frm) {
+    case DXGI_R8_UNORM:            return TextureFormat::R8;
+    case DXGI_R8G8_UNORM:          return TextureFormat::RG8;
+    case DXGI_R8G8B8A8_UNORM:
+    case DXGI_R8G8B8A8_UNORM_SRGB: return TextureFormat::RGBA8;
+    case DXGI_R16_UNORM:           return TextureFormat::R16;
+    case DXGI_R16G16_UNORM:        return TextureFormat::RG16;
+    case DXGI_R16G16B16A16_UNORM:  return TextureFormat::RGBA16;
+    case DXGI_R16G16B16A16_FLOAT:  return TextureFormat::RGBA16F;
+    case DXGI_R32_FLOAT:           return TextureFormat::R32F;
+    case DXGI_R32G32_FLOAT:        return TextureFormat::RG32F;
+    case DXGI_R32G32B32_FLOAT:     return TextureFormat::RGB32F;
+    case DXGI_R32G32B32A32_FLOAT:  return TextureFormat::RGBA32F;
+    case DXGI_R32_UINT:            return TextureFormat::R32U;
+    case DXGI_R32G32_UINT:         return TextureFormat::RG32U;
+    case DXGI_R32G32B32_UINT:      return TextureFormat::RGB32U;
+    case DXGI_R32G32B32A32_UINT:   return TextureFormat::RGBA32U;
+    case DXGI_R11G11B10_FLOAT:     return TextureFormat::R11G11B10UF;
+    case DXGI_BC1_TYPELESS:
+    case DXGI_BC1_UNORM:
+    case DXGI_BC1_UNORM_SRGB:      return TextureFormat::DXT1;
+    case DXGI_BC2_TYPELESS:
+    case DXGI_BC2_UNORM:
+    case DXGI_BC2_UNORM_SRGB:      return TextureFormat::DXT3;
+    case DXGI_BC3_TYPELESS:
+    case DXGI_BC3_UNORM:
+    case DXGI_BC3_UNORM_SRGB:      return TextureFormat::DXT5;
+    case DXGI_BC4_TYPELESS:
+    case DXGI_BC4_UNORM:           return TextureFormat::BC4;
+    case DXGI_BC5_TYPELESS:
+    case DXGI_BC5_UNORM:           return TextureFormat::BC5;
+    case DXGI_BC6H_TYPELESS:
+    case DXGI_BC6H_UF16:           return TextureFormat::BC6H;
+    case DXGI_BC7_TYPELESS:
+    case DXGI_BC7_UNORM:
+    case DXGI_BC7_UNORM_SRGB:      return TextureFormat::BC7;
+    }
+  return TextureFormat::Undefined;
+  }
+
+static TextureFormat ktxFormat(uint32_t frm) {
+  switch(frm) {
+    case KTX_R8_UNORM:            return TextureFormat::R8;
+    case KTX_R8G8_UNORM:          return TextureFormat::RG8;
+    case KTX_R8G8B8_UNORM:        return TextureFormat::RGB8;
+    case KTX_R8G8B8A8_UNORM:
+    case KTX_R8G8B8A8_SRGB:       return TextureFormat::RGBA8;
+    case KTX_R16_UNORM:           return TextureFormat::R16;
+    case KTX_R16G16_UNORM:        return TextureFormat::RG16;
+    case KTX_R16G16B16_UNORM:     return TextureFormat::RGB16;
+    case KTX_R16G16B16A16_UNORM:  return TextureFormat::RGBA16;
+    case KTX_R16G16B16A16_SFLOAT: return TextureFormat::RGBA16F;
+    case KTX_R32_UINT:            return TextureFormat::R32U;
+    case KTX_R32_SFLOAT:          return TextureFormat::R32F;
+    case KTX_R32G32_UINT:         return TextureFormat::RG32U;
+    case KTX_R32G32_SFLOAT:       return TextureFormat::RG32F;
+    case KTX_R32G32B32_UINT:      return TextureFormat::RGB32U;
+    case KTX_R32G32B32_SFLOAT:    return TextureFormat::RGB32F;
+    case KTX_R32G32B32A32_UINT:   return TextureFormat::RGBA32U;
+    case KTX_R32G32B32A32_SFLOAT: return TextureFormat::RGBA32F;
+    case KTX_B10G11R11_UFLOAT:    return TextureFormat::R11G11B10UF;
+    case KTX_BC1_RGB_UNORM:
+    case KTX_BC1_RGB_SRGB:
+    case KTX_BC1_RGBA_UNORM:
+    case KTX_BC1_RGBA_SRGB:       return TextureFormat::DXT1;
+    case KTX_BC2_UNORM:
+    case KTX_BC2_SRGB:            return TextureFormat::DXT3;
+    case KTX_BC3_UNORM:
+    case KTX_BC3_SRGB:            return TextureFormat::DXT5;
+    case KTX_BC4_UNORM:           return TextureFormat::BC4;
+    case KTX_BC5_UNORM:           return TextureFormat::BC5;
+    case KTX_BC6H_UFLOAT:         return TextureFormat::BC6H;
+    case KTX_BC7_UNORM:
+    case KTX_BC7_SRGB:            return TextureFormat::BC7;
+    }
+  return TextureFormat::Undefined;
+  }
+
+static size_t levelSize(TextureFormat frm, uint32_t w, uint32_t h) {
+  const Size bsz = Pixmap::blockCount(frm,w,h);
+  return size_t(bsz.w)*size_t(bsz.h)*Pixmap::blockSizeForFormat(frm);
+  }
+
+TextureFile::TextureFile(IDevice& dev)
+  :dev(dev) {
+  uint8_t head[12] = {};
+  if(dev.read(head,sizeof(head))!=sizeof(head) || dev.unget(sizeof(head))!=sizeof(head))
+    throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+
+  if(std::memcmp(head,"DDS ",4)==0)
+    parseDds();
+  else if(std::memcmp(head,KTX2_IDENTIFIER,sizeof(KTX2_IDENTIFIER))==0)
+    parseKtx2();
+  else
+    throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+  validate();
+  }
+
+bool TextureFile::isTextureFile(const void* head, size_t size) {
+  if(size>=4 && std::memcmp(head,"DDS ",4)==0)
+    return true;
+  if(size>=sizeof(KTX2_IDENTIFIER) && std::memcmp(head,KTX2_IDENTIFIER,sizeof(KTX2_IDENTIFIER))==0)
+    return true;
+  return false;
+  }
+
+void TextureFile::readHeader(void* out, size_t size) {
+  if(dev.read(out,size)!=size)
+    throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+  cursor += size;
+  }
+
+void TextureFile::parseDds() {
+  uint8_t magic[4] = {};
+  readHeader(magic,sizeof(magic));
+
+  DDSURFACEDESC2 ddsd = {};
+  readHeader(&ddsd,sizeof(ddsd));
+
+  width  = ddsd.dwWidth;
+  height = ddsd.dwHeight;
+  mipCnt = std::max(1u, ddsd.dwMipMapCount);
+
+  if(ddsd.ddpfPixelFormat.dwFourCC==FOURCC_DX10) {
+    DDS_HEADER_DXT10 dx10 = {};
+    readHeader(&dx10,sizeof(dx10));
+    if(dx10.resourceDimension!=DDS_DIMENSION_TEXTURE2D)
+      throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+    frm      = dxgiFormat(dx10.dxgiFormat);
+    cube     = (dx10.miscFlag & DDS_RESOURCE_MISC_TEXTURECUBE)!=0;
+    layerCnt = std::max(1u, dx10.arraySize)*(cube ? 6 : 1);
+    } else {
+    frm      = fourCCFormat(ddsd.ddpfPixelFormat.dwFourCC);
+    cube     = (ddsd.ddsCaps.dwCaps2 & DDSCAPS2_CUBEMAP)!=0;
+    layerCnt = cube ? 6 : 1;
+    }
+
+  if(frm==TextureFormat::Undefined || mipCnt>32)
+    throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+
+  // each layer holds full mip chain
+  size_t at = cursor;
+  lvl.resize(size_t(layerCnt)*mipCnt);
+  for(uint32_t layer=0; layer<layerCnt; ++layer) {
+    uint32_t w = width, h = height;
+    for(uint32_t mip=0; mip<mipCnt; ++mip) {
+      Level& l = lvl[layer*mipCnt+mip];
+      l.w      = w;
+      l.h      = h;
+      l.size   = levelSize(frm,w,h);
+      l.offset = at;
+      at      += l.size;
+      w = std::max(1u,w/2);
+      h = std::max(1u,h/2);
+      }
+    }
+
+  order.resize(mipCnt);
+  for(uint32_t i=0; i<mipCnt; ++i)
+    order[i] = i;
+  }
+
+void TextureFile::parseKtx2() {
+  KTX2Header hdr = {};
+  readHeader(&hdr,sizeof(hdr));
+
+  // zstd/basis payloads and 3d textures are not supported
+  if(hdr.supercompressionScheme!=0 || hdr.pixelDepth>1)
+    throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+
+  const uint32_t faces = std::max(1u, hdr.faceCount);
+  frm      = ktxFormat(hdr.vkFormat);
+  width    = hdr.pixelWidth;
+  height   = std::max(1u, hdr.pixelHeight);
+  mipCnt   = std::max(1u, hdr.levelCount);
+  cube     = (faces==6);
+  layerCnt = std::max(1u, hdr.layerCount)*faces;
+
+  if(frm==TextureFormat::Undefined || mipCnt>32)
+    throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+
+  std::vector<KTX2LevelIndex> index(mipCnt);
+  readHeader(index.data(),index.size()*sizeof(KTX2LevelIndex));
+
+  // level holds all layers (and faces) of one mip
+  lvl.resize(size_t(layerCnt)*mipCnt);
+  for(uint32_t mip=0; mip<mipCnt; ++mip) {
+    const uint32_t w  = std::max(1u,width >>mip);
+    const uint32_t h  = std::max(1u,height>>mip);
+    const size_t   sz = levelSize(frm,w,h);
+    if(index[mip].byteLength<sz*layerCnt || index[mip].byteOffset<cursor)
+      throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+    for(uint32_t layer=0; layer<layerCnt; ++layer) {
+      Level& l = lvl[layer*mipCnt+mip];
+      l.w      = w;
+      l.h      = h;
+      l.size   = sz;
+      l.offset = size_t(index[mip].byteOffset) + layer*sz;
+      }
+    }
+
+  order.resize(mipCnt);
+  for(uint32_t i=0; i<mipCnt; ++i)
+    order[i] = i;
+  std::sort(order.begin(),order.end(),[this](uint32_t a, uint32_t b){
+    return lvl[a].offset<lvl[b].offset;
+    });
+  }
+
+void TextureFile::validate() const {
+  if(width==0 || height==0 || lvl.empty())
+    throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+  }
+
+size_t TextureFile::layerSize() const {
+  size_t sz = 0;
+  for(uint32_t i=0; i<mipCnt; ++i)
+    sz += lvl[i].size;
+  return sz;
+  }
+
+bool TextureFile::read(void* out, size_t offset, size_t size) {
+  if(offset<cursor) {
+    // KTX2 stores smallest mip first; rewind is cheap for memory-backed devices
+    const size_t back = cursor-offset;
+    if(dev.unget(back)!=back)
+      return false;
+    cursor = offset;
+    }
+  if(offset>cursor) {
+    const size_t skip = offset-cursor;
+    if(dev.seek(skip)!=skip)
+      return false;
+    cursor = offset;
+    }
+  if(dev.read(out,size)!=size)
+    return false;
+  cursor += size;
+  return true;
+  }
+
+bool TextureFile::readLayer(void* out, uint32_t layer) {
+  size_t dst[32] = {};
+  for(uint32_t i=1; i<mipCnt; ++i)
+    dst[i] = dst[i-1] + level(layer,i-1).size;
+
+  auto px = reinterpret_cast<uint8_t*>(out);
+  for(auto i:order) {
+    auto& l = level(layer,i);
+    if(!read(px+dst[i],l.offset,l.size))
+      return false;
+    }
+  return true;
+  }
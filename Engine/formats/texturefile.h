@@ -0,0 +1,72 @@
+#pragma once
+
+#include <Tempest/AbstractGraphicsApi>
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace Tempest {
+
+class IDevice;
+
+namespace Detail {
+
+// DDS (legacy or DX10) and KTX2 containers. Texel data is not converted and is read
+// straight from the device, so block-compressed mips can be copied into staging memory as is
+class TextureFile final {
+  public:
+    struct Level {
+      uint32_t w      = 0;
+      uint32_t h      = 0;
+      size_t   offset = 0; // absolute position in file
+      size_t   size   = 0;
+      };
+
+    // parses header; throws UnableToLoadAsset, if container or format is not supported
+    explicit TextureFile(IDevice& dev);
+
+    static bool   isTextureFile(const void* head, size_t size);
+
+    TextureFormat format()   const { return frm;      }
+    uint32_t      w()        const { return width;    }
+    uint32_t      h()        const { return height;   }
+    uint32_t      mipCount() const { return mipCnt;   }
+    // array layers; cube faces are counted as separate layers
+    uint32_t      layers()   const { return layerCnt; }
+    bool          isCube()   const { return cube;     }
+
+    const Level&  level(uint32_t layer, uint32_t mip) const { return lvl[layer*mipCnt+mip]; }
+    // mip indices, sorted by file position: KTX2 stores smallest mip first
+    const std::vector<uint32_t>& readOrder() const { return order; }
+    // size of one layer with all mips, packed tightly
+    size_t        layerSize() const;
+
+    // bytes consumed from device so far
+    size_t        position() const { return cursor; }
+    // device is forward-only: 'offset' must not be behind position()
+    bool          read(void* out, size_t offset, size_t size);
+    // all mips of 'layer', packed tightly in mip order - same layout as Pixmap
+    bool          readLayer(void* out, uint32_t layer);
+
+  private:
+    IDevice&              dev;
+    size_t                cursor   = 0;
+
+    TextureFormat         frm      = TextureFormat::Undefined;
+    uint32_t              width    = 0;
+    uint32_t              height   = 0;
+    uint32_t              mipCnt   = 1;
+    uint32_t              layerCnt = 1;
+    bool                  cube     = false;
+    std::vector<Level>    lvl;
+    std::vector<uint32_t> order;
+
+    void                  readHeader(void* out, size_t size);
+    void                  parseDds();
+    void                  parseKtx2();
+    void                  validate() const;
+  };
+
+}
+}
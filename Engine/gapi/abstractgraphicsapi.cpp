@@ -83,6 +83,26 @@ void AbstractGraphicsApi::CommandBuffer::barrier(Texture& tex, ResourceAccess pr
   barrier(&b,1);
   }
 
+bool AbstractGraphicsApi::Device::memoryStats(MemoryStats& out) {
+  (void)out;
+  return false;
+  }
+
+bool AbstractGraphicsApi::Device::setMemoryCallback(std::function<void(const MemoryEvent&)> cb) {
+  (void)cb;
+  return false;
+  }
+
+size_t AbstractGraphicsApi::Device::defragment(size_t maxBytes) {
+  (void)maxBytes;
+  return 0;
+  }
+
+bool AbstractGraphicsApi::Device::setMemoryPageSize(size_t size) {
+  (void)size;
+  return false;
+  }
+
 void AbstractGraphicsApi::CommandBuffer::barrier(const Buffer& buf, ResourceAccess prev, ResourceAccess next) {
   AbstractGraphicsApi::BarrierDesc b;
   b.buffer   = &buf;
@@ -100,6 +120,13 @@ void AbstractGraphicsApi::CommandBuffer::setDebugMarker(std::string_view tag) {
   (void)tag;
   }
 
+void AbstractGraphicsApi::CommandBuffer::beginZone(std::string_view name) {
+  (void)name;
+  }
+
+void AbstractGraphicsApi::CommandBuffer::endZone() {
+  }
+
 void AbstractGraphicsApi::CommandBuffer::dispatchMesh(size_t x, size_t y, size_t z) {
   throw std::system_error(Tempest::GraphicsErrc::UnsupportedExtension);
   }
@@ -108,15 +135,32 @@ void AbstractGraphicsApi::CommandBuffer::dispatchMeshIndirect(const Buffer& indi
   throw std::system_error(Tempest::GraphicsErrc::UnsupportedExtension);
   }
 
+void AbstractGraphicsApi::CommandBuffer::updateTlas(AccelerationStructure& tlas, const Buffer& instances, size_t offset, size_t count, bool refit) {
+  throw std::system_error(Tempest::GraphicsErrc::UnsupportedExtension);
+  }
+
 AbstractGraphicsApi::AccelerationStructure* AbstractGraphicsApi::createBottomAccelerationStruct(Device* d, const RtGeometry* geom, size_t geomSize) {
   throw std::system_error(Tempest::GraphicsErrc::UnsupportedExtension);
   }
 
+void AbstractGraphicsApi::createBottomAccelerationStructs(Device* d, const RtGeometry* geom, const size_t* geomSize, size_t count,
+                                                         bool /*compact*/, Detail::DSharedPtr<AccelerationStructure*>* out) {
+  for(size_t i=0; i<count; ++i) {
+    if(geomSize[i]>0)
+      out[i] = Detail::DSharedPtr<AccelerationStructure*>(createBottomAccelerationStruct(d,geom,geomSize[i]));
+    geom += geomSize[i];
+    }
+  }
+
 AbstractGraphicsApi::AccelerationStructure*
   AbstractGraphicsApi::createTopAccelerationStruct(Device* d, const RtInstance* geom, AccelerationStructure*const* as, size_t geomSize) {
   throw std::system_error(Tempest::GraphicsErrc::UnsupportedExtension);
   }
 
+AbstractGraphicsApi::AccelerationStructure* AbstractGraphicsApi::createTopAccelerationStruct(Device* d, size_t maxInstances) {
+  throw std::system_error(Tempest::GraphicsErrc::UnsupportedExtension);
+  }
+
 void AbstractGraphicsApi::Desc::set(size_t id, Texture** tex, size_t cnt, const Sampler& smp, uint32_t mipLevel) {
   throw std::system_error(Tempest::GraphicsErrc::UnsupportedExtension);
   }
@@ -6,6 +6,7 @@
 #include <Tempest/Vec>
 
 #include <initializer_list>
+#include <functional>
 #include <memory>
 #include <atomic>
 #include <vector>
@@ -20,6 +21,8 @@ namespace Tempest {
   class Color;
   class RenderState;
   class Device;
+  class MemoryStats;
+  struct MemoryEvent;
 
   namespace Decl {
   enum ComponentType:uint8_t {
@@ -69,8 +72,10 @@ namespace Tempest {
   }
 
   enum class ApiFlags : uint16_t{
-    NoFlags   =0,
-    Validation=1
+    NoFlags             =0,
+    Validation          =1,
+    MeshEmulation       =2, // emulate mesh shaders with compute, when not supported natively (vulkan only)
+    DeferredMeshShading =4, // emulated mesh shaders: keep only indices in memory, recompute vertices in vertex stage
     };
 
   inline ApiFlags operator | (ApiFlags a, ApiFlags b){
@@ -129,6 +134,10 @@ namespace Tempest {
     DXT5,
     R11G11B10UF,
     RGBA16F,
+    BC4,
+    BC5,
+    BC6H,
+    BC7,
     Last
     };
 
@@ -160,6 +169,10 @@ namespace Tempest {
       case DXT5:        return "DXT5";
       case R11G11B10UF: return "R11G11B10UF";
       case RGBA16F:     return "RGBA16F";
+      case BC4:         return "BC4";
+      case BC5:         return "BC5";
+      case BC6H:        return "BC6H";
+      case BC7:         return "BC7";
       case Last:
         break;
       }
@@ -171,7 +184,8 @@ namespace Tempest {
     }
 
   inline bool isCompressedFormat(TextureFormat f){
-    return f==TextureFormat::DXT1 || f==TextureFormat::DXT3 || f==TextureFormat::DXT5;
+    return f==TextureFormat::DXT1 || f==TextureFormat::DXT3 || f==TextureFormat::DXT5 ||
+           f==TextureFormat::BC4  || f==TextureFormat::BC5  || f==TextureFormat::BC6H || f==TextureFormat::BC7;
     }
 
   enum class ComponentSwizzle {
@@ -283,6 +297,8 @@ namespace Tempest {
       }
 
     class ResourceState;
+    class TextureFile;
+    class GpuProfiler;
     }
 
   class Attachment;
@@ -405,7 +421,8 @@ namespace Tempest {
             } descriptors;
 
           struct {
-            bool rayQuery = false;
+            bool rayQuery   = false;
+            bool compaction = false; // RtBuildFlags::Compact is honored
             } raytracing;
 
           struct {
@@ -461,6 +478,15 @@ namespace Tempest {
       struct Device:NoCopy {
         virtual ~Device()=default;
         virtual void        waitIdle() = 0;
+        // nullptr, if GPU profiling is not supported
+        virtual Detail::GpuProfiler* profiler() { return nullptr; }
+        // false, if memory statistics are not supported
+        virtual bool        memoryStats(MemoryStats& out);
+        virtual bool        setMemoryCallback(std::function<void(const MemoryEvent&)> cb);
+        // returns bytes moved; 0, if not supported
+        virtual size_t      defragment(size_t maxBytes);
+        // false, if page size is not configurable
+        virtual bool        setMemoryPageSize(size_t size);
         };
       struct Fence:NoCopy {
         virtual ~Fence()=default;
@@ -509,7 +535,9 @@ namespace Tempest {
         };
       struct BlasBuildCtx {};
       struct AccelerationStructure:Shared {
-
+        virtual ~AccelerationStructure()=default;
+        virtual uint64_t deviceAddress() const { return 0; }
+        virtual uint64_t byteSize()      const { return 0; }
         };
       struct Desc:NoCopy   {
         virtual ~Desc()=default;
@@ -554,6 +582,7 @@ namespace Tempest {
 
         virtual void generateMipmap(Texture& image, uint32_t texWidth, uint32_t texHeight, uint32_t mipLevels) = 0;
         virtual void copy(Buffer& dest, size_t offset, Texture& src, uint32_t width, uint32_t height, uint32_t mip) = 0;
+        virtual void copy(Buffer& dest, size_t offsetDest, const Buffer& src, size_t offsetSrc, size_t size) = 0;
 
         virtual bool isRecording() const = 0;
         virtual void begin(bool tranfer);
@@ -573,6 +602,8 @@ namespace Tempest {
         virtual void setViewport(const Rect& r)=0;
         virtual void setScissor (const Rect& r)=0;
         virtual void setDebugMarker(std::string_view tag);
+        virtual void beginZone(std::string_view name);
+        virtual void endZone();
 
         virtual void draw        (const Buffer* vbo, size_t stride, size_t offset, size_t vertexCount,
                                   size_t firstInstance, size_t instanceCount) = 0;
@@ -587,6 +618,8 @@ namespace Tempest {
 
         virtual void dispatch(size_t x, size_t y, size_t z) = 0;
         virtual void dispatchIndirect(const Buffer& indirect, size_t offset) = 0;
+
+        virtual void updateTlas(AccelerationStructure& tlas, const Buffer& instances, size_t offset, size_t count, bool refit);
         };
 
       using PBuffer       = Detail::DSharedPtr<Buffer*>;
@@ -625,12 +658,18 @@ namespace Tempest {
 
       virtual PBuffer    createBuffer (Device* d, const void* mem, size_t size, MemUsage usage, BufferHeap flg) = 0;
       virtual PTexture   createTexture(Device* d, const Pixmap& p, TextureFormat frm, uint32_t mips) = 0;
+      // first layer of 'f'; mips, that are not present in file, are generated
+      virtual PTexture   createTexture(Device* d, Detail::TextureFile& f, uint32_t mips) = 0;
       virtual PTexture   createTexture(Device* d, const uint32_t w, const uint32_t h, uint32_t mips, TextureFormat frm) = 0;
       virtual PTexture   createStorage(Device* d, const uint32_t w, const uint32_t h, uint32_t mips, TextureFormat frm) = 0;
       virtual PTexture   createStorage(Device* d, const uint32_t w, const uint32_t h, const uint32_t depth, uint32_t mips, TextureFormat frm) = 0;
 
       virtual AccelerationStructure* createBottomAccelerationStruct(Device* d, const RtGeometry* geom, size_t geomSize);
+      // geom holds geometries of all BLAS'es back to back, geomSize[i] - geometry count of i-th one
+      virtual void       createBottomAccelerationStructs(Device* d, const RtGeometry* geom, const size_t* geomSize, size_t count,
+                                                         bool compact, Detail::DSharedPtr<AccelerationStructure*>* out);
       virtual AccelerationStructure* createTopAccelerationStruct(Device* d, const RtInstance* geom, AccelerationStructure*const* as, size_t geomSize);
+      virtual AccelerationStructure* createTopAccelerationStruct(Device* d, size_t maxInstances);
 
       virtual void       readPixels   (Device* d, Pixmap& out, const PTexture t,
                                        TextureFormat frm, const uint32_t w, const uint32_t h, uint32_t mip, bool storageImg) = 0;
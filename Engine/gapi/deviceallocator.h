@@ -2,8 +2,10 @@
 
 #include <cstdint>
 #include <forward_list>
+#include <functional>
 #include <mutex>
 #include <algorithm>
+#include <vector>
 
 namespace Tempest {
 namespace Detail {
@@ -33,13 +35,54 @@ class DeviceAllocator {
       size_t offset=0,size=0;
       };
 
+    struct Stats {
+      size_t   allocated        = 0;
+      size_t   used             = 0;
+      size_t   largestFreeBlock = 0;
+      uint32_t pages            = 0;
+      uint32_t dedicated        = 0;
+      };
+
+    struct Event {
+      enum Type : uint8_t {
+        Alloc,
+        Free,
+        PageAlloc,
+        PageFree,
+        };
+      Type     type      = Alloc;
+      uint32_t heapId    = 0;
+      uint32_t typeId    = 0;
+      size_t   size      = 0;
+      bool     dedicated = false;
+      };
+    // invoked with allocator lock held
+    using Callback = std::function<void(const Event&)>;
+
     Allocation alloc(size_t size, size_t align, uint32_t heapId, uint32_t typeId, bool hostVisible) {
       std::lock_guard<std::mutex> guard(sync);
+      // densest page first: sparse pages have a chance to drain and be released
+      Page* best = nullptr;
       for(auto& i:pages){
-        if(i.heapId==heapId && i.allocated+size<=i.allSize){
+        if(i.heapId==heapId && !i.evacuate && i.allocated+size<=i.allSize){
+          if(best==nullptr || best->allocated<i.allocated)
+            best = &i;
+          }
+        }
+      if(best!=nullptr) {
+        auto ret=best->alloc(size,align,device);
+        if(ret.page!=nullptr) {
+          notify(Event::Alloc,*ret.page,ret.size);
+          return ret;
+          }
+        }
+      for(auto& i:pages){
+        if(i.heapId==heapId && &i!=best && !i.evacuate && i.allocated+size<=i.allSize){
           auto ret=i.alloc(size,align,device);
-          if(ret.page!=nullptr)
+          if(ret.page!=nullptr) {
+            notify(Event::Alloc,*ret.page,ret.size);
             return ret;
+            }
           }
         }
       return rawAlloc(size,align,heapId,typeId,hostVisible,false);
@@ -48,7 +91,9 @@ class DeviceAllocator {
     void free(const Allocation& a){
       std::lock_guard<std::mutex> guard(sync);
       a.page->free(a);
+      notify(Event::Free,*a.page,a.size);
       if(a.page->allocated==0){
+        notify(Event::PageFree,*a.page,a.page->allSize);
         device.free(a.page->memory,a.page->size,a.page->typeId);
         pages.remove(*a.page);
         }
@@ -60,9 +105,89 @@ class DeviceAllocator {
       }
 
     void setDefaultPageSize(uint32_t sz) {
+      std::lock_guard<std::mutex> guard(sync);
       defPageSize = sz;
       }
 
+    void setCallback(Callback cb) {
+      std::lock_guard<std::mutex> guard(sync);
+      callback = std::move(cb);
+      }
+
+    // marks pages, that are less than 'occupancy' full, for evacuation; new allocations avoid them.
+    // densest of sparse pages of each heapId (memory type and tiling pool) stays, as destination. Dedicated pages are never marked
+    size_t beginDefrag(float occupancy) {
+      std::lock_guard<std::mutex> guard(sync);
+      for(auto& i:pages)
+        i.evacuate = false;
+
+      size_t ret = 0;
+      for(auto& p:pages) {
+        if(!isSparse(p,occupancy))
+          continue;
+        for(auto& q:pages) {
+          if(&p==&q || q.heapId!=p.heapId || !isSparse(q,occupancy))
+            continue;
+          if(q.allocated>p.allocated || (q.allocated==p.allocated && std::less<const Page*>()(&q,&p))) {
+            p.evacuate = true;
+            ++ret;
+            break;
+            }
+          }
+        }
+      return ret;
+      }
+
+    void endDefrag() {
+      std::lock_guard<std::mutex> guard(sync);
+      for(auto& i:pages)
+        i.evacuate = false;
+      }
+
+    bool isEvacuating(const Allocation& a) {
+      std::lock_guard<std::mutex> guard(sync);
+      return a.page!=nullptr && a.page->evacuate;
+      }
+
+    // new place for content of 'a', in existing page of same heapId, that is not evacuated;
+    // no new pages are created. Old allocation stays valid, until freed by caller
+    Allocation relocate(const Allocation& a, size_t size, size_t align) {
+      std::lock_guard<std::mutex> guard(sync);
+      std::vector<Page*> dst;
+      for(auto& i:pages) {
+        if(&i==a.page || i.evacuate || i.dedicated || i.heapId!=a.page->heapId)
+          continue;
+        if(i.allocated+size<=i.allSize)
+          dst.push_back(&i);
+        }
+      std::sort(dst.begin(),dst.end(),[](const Page* l, const Page* r){ return l->allocated>r->allocated; });
+      for(auto i:dst) {
+        auto ret = i->alloc(size,align,device);
+        if(ret.page!=nullptr) {
+          notify(Event::Alloc,*ret.page,ret.size);
+          return ret;
+          }
+        }
+      return Allocation();
+      }
+
+    // accumulates usage of pages into out[typeId]; pages of typeId>=count are skipped
+    void stats(Stats* out, size_t count) {
+      std::lock_guard<std::mutex> guard(sync);
+      for(auto& i:pages) {
+        if(i.typeId>=count)
+          continue;
+        auto& s = out[i.typeId];
+        s.allocated += i.allSize;
+        s.used      += i.allocated;
+        s.pages     += 1;
+        if(i.dedicated)
+          s.dedicated += 1;
+        for(const Block* b=&i; b!=nullptr; b=b->next)
+          s.largestFreeBlock = std::max<size_t>(s.largestFreeBlock,b->size);
+        }
+      }
+
   private:
     Allocation rawAlloc(size_t size, size_t align, uint32_t heapId, uint32_t typeId, bool hostVisible, bool dedicated){
       const uint32_t pgSize = (dedicated ? uint32_t(size) : std::max<uint32_t>(defPageSize,uint32_t(size)));
@@ -71,6 +196,7 @@ class DeviceAllocator {
       pg.typeId      = typeId;
       pg.heapId      = heapId;
       pg.hostVisible = hostVisible;
+      pg.dedicated   = dedicated;
       if(pg.memory==null)
         return Allocation();
       try {
@@ -81,17 +207,39 @@ class DeviceAllocator {
         throw;
         }
       pages.front() = std::move(pg);
-      return pages.front().alloc(size,align,device);
+      notify(Event::PageAlloc,pages.front(),pages.front().allSize);
+
+      auto ret = pages.front().alloc(size,align,device);
+      if(ret.page!=nullptr)
+        notify(Event::Alloc,*ret.page,ret.size);
+      return ret;
       }
 
     void       freeDevMemory(Memory mem){
       return device.free(mem);
       }
 
+    static bool isSparse(const Page& p, float occupancy) {
+      return !p.dedicated && p.allocated>0 && float(p.allocated)<float(p.allSize)*occupancy;
+      }
+
+    void       notify(typename Event::Type t, const Page& pg, size_t size) {
+      if(!callback)
+        return;
+      Event e;
+      e.type      = t;
+      e.heapId    = pg.heapId;
+      e.typeId    = pg.typeId;
+      e.size      = size;
+      e.dedicated = pg.dedicated;
+      callback(e);
+      }
+
     MemoryProvider&         device;
     std::mutex              sync;
     std::forward_list<Page> pages;
     uint32_t                defPageSize = DEFAULT_PAGE_SIZE;
+    Callback                callback;
   };
 
 template<class MemoryProvider>
@@ -114,6 +262,8 @@ struct DeviceAllocator<MemoryProvider>::Page : Block {
   uint32_t   allSize     = 0;
   uint32_t   allocated   = 0;
   bool       hostVisible = false;
+  bool       dedicated   = false;
+  bool       evacuate    = false;
 
   Page(uint32_t sz) noexcept {
     size   =sz;
@@ -128,7 +278,10 @@ struct DeviceAllocator<MemoryProvider>::Page : Block {
     typeId      = p.typeId;
     heapId      = p.heapId;
     allSize     = p.allSize;
+    allocated   = p.allocated;
     hostVisible = p.hostVisible;
+    dedicated   = p.dedicated;
+    evacuate    = p.evacuate;
     }
 
   ~Page(){
@@ -148,7 +301,10 @@ struct DeviceAllocator<MemoryProvider>::Page : Block {
     typeId      = p.typeId;
     heapId      = p.heapId;
     allSize     = p.allSize;
+    allocated   = p.allocated;
     hostVisible = p.hostVisible;
+    dedicated   = p.dedicated;
+    evacuate    = p.evacuate;
     return *this;
     }
 
@@ -98,10 +98,7 @@ DxAccelerationStructure::~DxAccelerationStructure() {
 
 
 DxTopAccelerationStructure::DxTopAccelerationStructure(DxDevice& dx, const RtInstance* inst, AccelerationStructure*const* as, size_t asSize)
-  :owner(dx) {
-  ComPtr<ID3D12Device5> m_dxrDevice;
-  dx.device->QueryInterface(uuid<ID3D12Device5>(), reinterpret_cast<void**>(&m_dxrDevice));
-
+  :owner(dx), maxInstances(uint32_t(asSize)) {
   Detail::DSharedPtr<AbstractGraphicsApi::Buffer*> pBuf;
   if(asSize>0) {
     DxBuffer buf = dx.allocator.alloc(nullptr,asSize*sizeof(D3D12_RAYTRACING_INSTANCE_DESC),
@@ -127,22 +124,15 @@ DxTopAccelerationStructure::DxTopAccelerationStructure(DxDevice& dx, const RtIns
     pBuf.handler->update(&objInstance, i*sizeof(objInstance), sizeof(objInstance));
     }
 
-  D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS tlasInputs = {};
-  tlasInputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
-  tlasInputs.Flags       = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE;
-  tlasInputs.NumDescs    = UINT(asSize);
-  tlasInputs.Type        = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL;
-
-  D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO buildSizesInfo = {};
-  m_dxrDevice->GetRaytracingAccelerationStructurePrebuildInfo(&tlasInputs, &buildSizesInfo);
+  const auto buildSizesInfo = buildSizes(dx, uint32_t(asSize));
   if(buildSizesInfo.ResultDataMaxSizeInBytes<=0)
     throw std::system_error(GraphicsErrc::UnsupportedExtension);
 
-  auto  scratch = dx.dataMgr().allocStagingMemory(nullptr,buildSizesInfo.ScratchDataSizeInBytes,MemUsage::ScratchBuffer,BufferHeap::Device);
+  auto  tmp  = dx.dataMgr().allocStagingMemory(nullptr,buildSizesInfo.ScratchDataSizeInBytes,MemUsage::ScratchBuffer,BufferHeap::Device);
   impl = dx.allocator.alloc(nullptr, buildSizesInfo.ResultDataMaxSizeInBytes, MemUsage::AsStorage, BufferHeap::Device);
 
   DSharedPtr<AbstractGraphicsApi::AccelerationStructure*> pThis(this);
-  DSharedPtr<AbstractGraphicsApi::Buffer*> pScratch(new DxBuffer(std::move(scratch)));
+  DSharedPtr<AbstractGraphicsApi::Buffer*> pScratch(new DxBuffer(std::move(tmp)));
 
   auto& mgr = dx.dataMgr();
   auto  cmd = dx.dataMgr().get();
@@ -150,13 +140,47 @@ DxTopAccelerationStructure::DxTopAccelerationStructure(DxDevice& dx, const RtIns
   cmd->hold(pScratch);
   cmd->hold(pBuf);
   cmd->hold(pThis);
-  cmd->buildTlas(impl, *pBuf.handler, uint32_t(asSize), *pScratch.handler);
+  cmd->buildTlas(impl, *pBuf.handler, 0, uint32_t(asSize), *pScratch.handler, false);
   cmd->end();
 
   mgr.submit(std::move(cmd));
+
+  numInstances = uint32_t(asSize);
+  built        = true;
+  }
+
+DxTopAccelerationStructure::DxTopAccelerationStructure(DxDevice& dx, size_t maxInst)
+  :owner(dx), maxInstances(uint32_t(maxInst)) {
+  const auto buildSizesInfo = buildSizes(dx, maxInstances);
+  if(buildSizesInfo.ResultDataMaxSizeInBytes<=0)
+    throw std::system_error(GraphicsErrc::UnsupportedExtension);
+  impl = dx.allocator.alloc(nullptr, buildSizesInfo.ResultDataMaxSizeInBytes, MemUsage::AsStorage, BufferHeap::Device);
+  allocScratch();
   }
 
 DxTopAccelerationStructure::~DxTopAccelerationStructure() {
   }
 
+D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO DxTopAccelerationStructure::buildSizes(DxDevice& dx, uint32_t numInstances) {
+  ComPtr<ID3D12Device5> m_dxrDevice;
+  dx.device->QueryInterface(uuid<ID3D12Device5>(), reinterpret_cast<void**>(&m_dxrDevice));
+
+  D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS tlasInputs = {};
+  tlasInputs.DescsLayout = D3D12_ELEMENTS_LAYOUT_ARRAY;
+  tlasInputs.Flags       = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE | D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_UPDATE;
+  tlasInputs.NumDescs    = numInstances;
+  tlasInputs.Type        = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL;
+
+  D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO buildSizesInfo = {};
+  m_dxrDevice->GetRaytracingAccelerationStructurePrebuildInfo(&tlasInputs, &buildSizesInfo);
+  return buildSizesInfo;
+  }
+
+void DxTopAccelerationStructure::allocScratch() {
+  // persistent: good for both full rebuild and refit
+  const auto   sz   = buildSizes(owner, maxInstances);
+  const size_t size = size_t(std::max(sz.ScratchDataSizeInBytes, sz.UpdateScratchDataSizeInBytes));
+  scratch = owner.allocator.alloc(nullptr, std::max<size_t>(size,1), MemUsage::ScratchBuffer, BufferHeap::Device);
+  }
+
 #endif
@@ -26,6 +26,9 @@ class DxAccelerationStructure : public AbstractGraphicsApi::AccelerationStructur
     DxAccelerationStructure(DxDevice& owner, const AbstractGraphicsApi::RtGeometry* geom, size_t size);
     ~DxAccelerationStructure();
 
+    uint64_t  deviceAddress() const override { return impl.impl.get()->GetGPUVirtualAddress(); }
+    uint64_t  byteSize()      const override { return impl.sizeInBytes; }
+
     DxDevice& owner;
     DxBuffer  impl;
   };
@@ -33,10 +36,21 @@ class DxAccelerationStructure : public AbstractGraphicsApi::AccelerationStructur
 class DxTopAccelerationStructure : public AbstractGraphicsApi::AccelerationStructure {
   public:
     DxTopAccelerationStructure(DxDevice& owner, const RtInstance* inst, AccelerationStructure* const * as, size_t asSize);
+    DxTopAccelerationStructure(DxDevice& owner, size_t maxInstances);
     ~DxTopAccelerationStructure();
 
+    static D3D12_RAYTRACING_ACCELERATION_STRUCTURE_PREBUILD_INFO buildSizes(DxDevice& owner, uint32_t numInstances);
+    void      allocScratch();
+    uint64_t  byteSize() const override { return impl.sizeInBytes; }
+
     DxDevice& owner;
     DxBuffer  impl;
+
+    // state of GPU-side updates, as of last submit
+    DxBuffer  scratch;
+    uint32_t  maxInstances = 0;
+    uint32_t  numInstances = 0;
+    bool      built        = false;
   };
 
 }
@@ -160,27 +160,31 @@ DxBuffer DxAllocator::alloc(const void* mem, size_t size, MemUsage usage, Buffer
 
   if( MemUsage::StorageBuffer==(usage&MemUsage::StorageBuffer) ||
       MemUsage::TransferDst  ==(usage&MemUsage::TransferDst) ||
-      MemUsage::AsStorage    ==(usage&MemUsage::AsStorage)) {
+      MemUsage::AsStorage    ==(usage&MemUsage::AsStorage) ||
+      MemUsage::ScratchBuffer==(usage&MemUsage::ScratchBuffer)) {
     ret.nonUniqId = nextId();
     }
   return ret;
   }
 
 DxTexture DxAllocator::alloc(const Pixmap& pm, uint32_t mip, DXGI_FORMAT format) {
+  return alloc(pm.w(),pm.h(),mip,format);
+  }
+
+DxTexture DxAllocator::alloc(const uint32_t w, const uint32_t h, const uint32_t mip, DXGI_FORMAT format) {
   ComPtr<ID3D12Resource> ret;
 
   D3D12_RESOURCE_DESC resDesc = {};
   resDesc.MipLevels          = mip;
   resDesc.Format             = format;
-  resDesc.Width              = pm.w();
-  resDesc.Height             = pm.h();
+  resDesc.Width              = w;
+  resDesc.Height             = h;
   resDesc.Flags              = D3D12_RESOURCE_FLAG_NONE;
   resDesc.DepthOrArraySize   = 1;
   resDesc.SampleDesc.Count   = 1;
   resDesc.SampleDesc.Quality = 0;
   resDesc.Dimension          = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-  if(mip>1 &&
-     format!=DXGI_FORMAT_BC1_UNORM && format!=DXGI_FORMAT_BC2_UNORM && format!=DXGI_FORMAT_BC3_UNORM) {
+  if(mip>1 && !nativeIsCompressed(format)) {
     // for mip-maps generator
     resDesc.Flags |= D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
     }
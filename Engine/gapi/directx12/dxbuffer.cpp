@@ -91,6 +91,18 @@ void DxBuffer::read(void* data, size_t off, size_t size) {
   readFromMapped(stage,data,0,size);
   }
 
+bool DxBuffer::stream(const std::function<bool(uint8_t*)>& fn) {
+  ID3D12Resource& ret = *impl;
+
+  void*       mapped=nullptr;
+  dxAssert(ret.Map(0,nullptr,&mapped));
+  const bool ok = fn(reinterpret_cast<uint8_t*>(mapped));
+
+  D3D12_RANGE rgn = {0,sizeInBytes};
+  ret.Unmap(0,&rgn);
+  return ok;
+  }
+
 void DxBuffer::uploadS3TC(const uint8_t* d, uint32_t w, uint32_t h, uint32_t mipCnt, UINT blockSize) {
   ID3D12Resource& ret = *impl;
 
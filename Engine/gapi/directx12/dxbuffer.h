@@ -5,6 +5,8 @@
 #include "comptr.h"
 #include "dxallocator.h"
 
+#include <functional>
+
 namespace Tempest {
 namespace Detail {
 
@@ -24,6 +26,8 @@ class DxBuffer : public AbstractGraphicsApi::Buffer {
     void  read  (      void* data, size_t off, size_t size) override;
 
     void  uploadS3TC(const uint8_t* d, uint32_t w, uint32_t h, uint32_t mip, UINT blockSize);
+    // maps upload buffer and lets 'fn' write into it
+    bool  stream(const std::function<bool(uint8_t* mem)>& fn);
 
     DxDevice*               dev = nullptr;
     DxAllocator::Allocation page={};
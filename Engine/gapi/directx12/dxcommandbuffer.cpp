@@ -394,6 +394,7 @@ DxCommandBuffer::~DxCommandBuffer() {
 void DxCommandBuffer::begin(bool transfer) {
   reset();
   state = Idle;
+  tlasState.clear();
   if(transfer)
     resState.clearReaders();
 
@@ -784,6 +785,9 @@ void DxCommandBuffer::dispatchMeshIndirect(const AbstractGraphicsApi::Buffer& in
 void DxCommandBuffer::copy(AbstractGraphicsApi::Buffer& dstBuf, size_t offsetDest, const AbstractGraphicsApi::Buffer& srcBuf, size_t offsetSrc, size_t size) {
   auto& dst = reinterpret_cast<DxBuffer&>(dstBuf);
   auto& src = reinterpret_cast<const DxBuffer&>(srcBuf);
+
+  resState.onTranferUsage(src.nonUniqId, dst.nonUniqId, false);
+  resState.flush(*this);
   impl->CopyBufferRegion(dst.impl.get(),offsetDest,src.impl.get(),offsetSrc,size);
   }
 
@@ -798,10 +802,8 @@ void DxCommandBuffer::copy(AbstractGraphicsApi::Texture& dstTex, size_t width, s
   foot.Footprint.Width    = UINT(width);
   foot.Footprint.Height   = UINT(height);
   foot.Footprint.Depth    = 1;
-  if(dst.format==DXGI_FORMAT_BC1_UNORM ||
-     dst.format==DXGI_FORMAT_BC2_UNORM ||
-     dst.format==DXGI_FORMAT_BC3_UNORM) {
-    foot.Footprint.RowPitch = UINT((width+3)/4)*(dst.format==DXGI_FORMAT_BC1_UNORM ? 8 : 16);
+  if(nativeIsCompressed(dst.format)) {
+    foot.Footprint.RowPitch = UINT((width+3)/4)*dst.bytePerBlockCount();
     foot.Footprint.RowPitch = ((foot.Footprint.RowPitch+D3D12_TEXTURE_DATA_PITCH_ALIGNMENT-1)
                                /D3D12_TEXTURE_DATA_PITCH_ALIGNMENT)*D3D12_TEXTURE_DATA_PITCH_ALIGNMENT;
     } else {
@@ -853,30 +855,67 @@ void DxCommandBuffer::buildBlas(AbstractGraphicsApi::Buffer& bbo, AbstractGraphi
   }
 
 void DxCommandBuffer::buildTlas(AbstractGraphicsApi::Buffer& tbo,
-                                AbstractGraphicsApi::Buffer& instances, uint32_t numInstances,
-                                AbstractGraphicsApi::Buffer& scratch) {
+                                const AbstractGraphicsApi::Buffer& instances, size_t instOffset, uint32_t numInstances,
+                                AbstractGraphicsApi::Buffer& scratch, bool update) {
   // NOTE: instances must be 16 bytes aligned
-  auto& dest = *reinterpret_cast<DxBuffer&>(tbo).impl;
+  auto& dbo  = reinterpret_cast<DxBuffer&>(tbo);
+  auto& ibo  = reinterpret_cast<const DxBuffer&>(instances);
+  auto& sbo  = reinterpret_cast<DxBuffer&>(scratch);
+  auto& dest = *dbo.impl;
 
   D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_INPUTS tlasInputs = {};
   tlasInputs.Type          = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL;
-  tlasInputs.Flags         = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE;
+  tlasInputs.Flags         = D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PREFER_FAST_TRACE | D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_ALLOW_UPDATE;
   tlasInputs.NumDescs      = numInstances;
   tlasInputs.DescsLayout   = D3D12_ELEMENTS_LAYOUT_ARRAY;
   if(numInstances>0)
-    tlasInputs.InstanceDescs = reinterpret_cast<DxBuffer&>(instances).impl->GetGPUVirtualAddress();
+    tlasInputs.InstanceDescs = ibo.impl.get()->GetGPUVirtualAddress() + instOffset;
+  if(update)
+    tlasInputs.Flags |= D3D12_RAYTRACING_ACCELERATION_STRUCTURE_BUILD_FLAG_PERFORM_UPDATE;
 
   D3D12_BUILD_RAYTRACING_ACCELERATION_STRUCTURE_DESC desc = {};
   desc.DestAccelerationStructureData    = dest.GetGPUVirtualAddress();
   desc.Inputs                           = tlasInputs;
-  desc.SourceAccelerationStructureData  = 0;
-  desc.ScratchAccelerationStructureData = reinterpret_cast<DxBuffer&>(scratch).impl->GetGPUVirtualAddress();
+  desc.SourceAccelerationStructureData  = update ? dest.GetGPUVirtualAddress() : 0;
+  desc.ScratchAccelerationStructureData = sbo.impl->GetGPUVirtualAddress();
 
-  resState.onUavUsage(NonUniqResId::I_None, reinterpret_cast<DxBuffer&>(tbo).nonUniqId, PipelineStage::S_RtAs);
+  // make sure TLAS is not in use; instances can come from compute shader
+  const NonUniqResId read  = (numInstances>0 ? ibo.nonUniqId : NonUniqResId::I_None) | (update ? dbo.nonUniqId : NonUniqResId::I_None);
+  const NonUniqResId write = dbo.nonUniqId | sbo.nonUniqId;
+  resState.onUavUsage(read, write, PipelineStage::S_RtAs);
   resState.flush(*this);
   impl->BuildRaytracingAccelerationStructure(&desc,0,nullptr);
   }
 
+void DxCommandBuffer::updateTlas(AbstractGraphicsApi::AccelerationStructure& as, const AbstractGraphicsApi::Buffer& instances,
+                                 size_t offset, size_t count, bool refit) {
+  auto& tlas = reinterpret_cast<DxTopAccelerationStructure&>(as);
+  if(count>tlas.maxInstances)
+    throw std::system_error(Tempest::GraphicsErrc::InvalidAccelerationStructure);
+  if(tlas.scratch.impl.get()==nullptr)
+    tlas.allocScratch();
+
+  TlasState* st = nullptr;
+  for(auto& i:tlasState)
+    if(i.tlas==&tlas) {
+      st = &i;
+      break;
+      }
+
+  // refit requires the same instance count as previous build
+  bool update = false;
+  if(st!=nullptr) {
+    update = refit && st->count==count;
+    } else {
+    // first use in this command buffer: rely on last submitted build, recheck on submit
+    update = refit && tlas.built && tlas.numInstances==count;
+    tlasState.push_back({&tlas, update, tlas.numInstances, 0});
+    st = &tlasState.back();
+    }
+  buildTlas(tlas.impl, instances, offset, uint32_t(count), tlas.scratch, update);
+  st->count = uint32_t(count);
+  }
+
 void DxCommandBuffer::pushChunk() {
   if(impl.get()!=nullptr) {
     dxAssert(impl->Close());
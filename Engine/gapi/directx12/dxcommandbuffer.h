@@ -19,6 +19,7 @@ namespace Detail {
 class DxDevice;
 class DxBuffer;
 class DxTexture;
+class DxTopAccelerationStructure;
 
 class DxCommandBuffer:public AbstractGraphicsApi::CommandBuffer {
   public:
@@ -79,21 +80,31 @@ class DxCommandBuffer:public AbstractGraphicsApi::CommandBuffer {
     void generateMipmap(AbstractGraphicsApi::Texture& image, uint32_t texWidth, uint32_t texHeight, uint32_t mipLevels) override;
 
     void copyNative(AbstractGraphicsApi::Buffer& dest, size_t offset, const AbstractGraphicsApi::Texture& src, uint32_t width, uint32_t height, uint32_t mip);
-    void copy(AbstractGraphicsApi::Buffer&  dest, size_t offsetDest, const AbstractGraphicsApi::Buffer& src, size_t offsetSrc, size_t size);
+    void copy(AbstractGraphicsApi::Buffer&  dest, size_t offsetDest, const AbstractGraphicsApi::Buffer& src, size_t offsetSrc, size_t size) override;
     void copy(AbstractGraphicsApi::Texture& dest, size_t width, size_t height, size_t mip, const AbstractGraphicsApi::Buffer&  src, size_t offset);
 
     void fill(AbstractGraphicsApi::Texture& dest, uint32_t val);
 
     void buildBlas(AbstractGraphicsApi::Buffer& bbo, AbstractGraphicsApi::BlasBuildCtx& rtctx, AbstractGraphicsApi::Buffer& scratch);
-    void buildTlas(AbstractGraphicsApi::Buffer& tbo, AbstractGraphicsApi::Buffer& instances, uint32_t numInstances,
-                   AbstractGraphicsApi::Buffer& scratch);
+    void buildTlas(AbstractGraphicsApi::Buffer& tbo, const AbstractGraphicsApi::Buffer& instances, size_t instOffset, uint32_t numInstances,
+                   AbstractGraphicsApi::Buffer& scratch, bool update);
+    void updateTlas(AbstractGraphicsApi::AccelerationStructure& tlas, const AbstractGraphicsApi::Buffer& instances,
+                    size_t offset, size_t count, bool refit) override;
 
     ID3D12GraphicsCommandList* get() { return impl.get(); }
 
     struct Chunk {
       ID3D12GraphicsCommandList6* impl = nullptr;
       };
+    // TLAS state left by this command buffer; validated and applied in DxDevice::submit
+    struct TlasState {
+      DxTopAccelerationStructure* tlas  = nullptr;
+      bool                        refit = false; // first update is a refit of tlas, as it was built with 'base' instances
+      uint32_t                    base  = 0;
+      uint32_t                    count = 0;
+      };
     Detail::SmallList<Chunk,32>        chunks;
+    std::vector<TlasState>             tlasState;
 
   private:
     DxDevice&                          dev;
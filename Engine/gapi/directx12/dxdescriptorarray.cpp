@@ -167,6 +167,10 @@ void DxDescriptorArray::setTlas(size_t id, AbstractGraphicsApi::AccelerationStru
     }
 
   placeInHeap(device, prm.rgnType, gpu, heapOffset, tlas);
+
+  // TLAS can be rebuilt in-place by Encoder::updateTlas
+  uav[id].buf     = &tlas.impl;
+  uavUsage.durty |= (tlas.impl.nonUniqId!=0);
   }
 
 void DxDescriptorArray::set(size_t id, AbstractGraphicsApi::Texture** tex, size_t cnt, const Sampler& smp, uint32_t mipLevel) {
@@ -7,6 +7,7 @@
 
 #include "dxshader.h"
 #include "dxpipeline.h"
+#include "dxaccelerationstructure.h"
 #include "builtin_shader.h"
 
 using namespace Tempest;
@@ -332,6 +333,11 @@ void Detail::DxDevice::waitIdle() {
   }
 
 void DxDevice::submit(DxCommandBuffer& cmd, DxFence* sync) {
+  for(auto& t:cmd.tlasState) {
+    // refit recorded against a build, that was replaced or never submitted
+    if(t.refit && !(t.tlas->built && t.tlas->numInstances==t.base))
+      throw std::system_error(Tempest::GraphicsErrc::InvalidAccelerationStructure);
+    }
   sync->reset();
 
   const size_t                                 size = cmd.chunks.size();
@@ -346,6 +352,11 @@ void DxDevice::submit(DxCommandBuffer& cmd, DxFence* sync) {
   std::lock_guard<SpinLock> guard(syncCmdQueue);
   cmdQueue->ExecuteCommandLists(UINT(size), flat.get());
   sync->signal(*cmdQueue);
+
+  for(auto& t:cmd.tlasState) {
+    t.tlas->numInstances = t.count;
+    t.tlas->built        = true;
+    }
   }
 
 void DxDevice::debugReportCallback(
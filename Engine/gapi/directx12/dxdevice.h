@@ -121,10 +121,23 @@ inline DXGI_FORMAT nativeFormat(TextureFormat f) {
       return DXGI_FORMAT_R11G11B10_FLOAT;
     case TextureFormat::RGBA16F:
       return DXGI_FORMAT_R16G16B16A16_FLOAT;
+    case TextureFormat::BC4:
+      return DXGI_FORMAT_BC4_UNORM;
+    case TextureFormat::BC5:
+      return DXGI_FORMAT_BC5_UNORM;
+    case TextureFormat::BC6H:
+      return DXGI_FORMAT_BC6H_UF16;
+    case TextureFormat::BC7:
+      return DXGI_FORMAT_BC7_UNORM;
     }
   return DXGI_FORMAT_UNKNOWN;
   }
 
+inline bool nativeIsCompressed(DXGI_FORMAT frm) {
+  return (DXGI_FORMAT_BC1_TYPELESS<=frm && frm<=DXGI_FORMAT_BC5_SNORM) ||
+         (DXGI_FORMAT_BC6H_TYPELESS<=frm && frm<=DXGI_FORMAT_BC7_UNORM_SRGB);
+  }
+
 inline DXGI_FORMAT nativeSrvFormat(DXGI_FORMAT frm) {
   switch(frm) {
     case DXGI_FORMAT_D16_UNORM:            return DXGI_FORMAT_R16_UNORM;
@@ -18,6 +18,7 @@
 #include "directx12/dxdescriptorarray.h"
 #include "directx12/dxaccelerationstructure.h"
 
+#include "formats/texturefile.h"
 #include <Tempest/Pixmap>
 #include <Tempest/AccelerationStructure>
 
@@ -263,6 +264,66 @@ AbstractGraphicsApi::PTexture DirectX12Api::createTexture(Device* d, const Pixma
   return PTexture(pbuf.handler);
   }
 
+AbstractGraphicsApi::PTexture DirectX12Api::createTexture(Device* d, Detail::TextureFile& f, uint32_t mipCnt) {
+  Detail::DxDevice&   dx     = *reinterpret_cast<Detail::DxDevice*>(d);
+  const TextureFormat frm    = f.format();
+  const DXGI_FORMAT   format = Detail::nativeFormat(frm);
+  const UINT          bpb    = UINT(Pixmap::blockSizeForFormat(frm));
+  const uint32_t      upload = std::min(f.mipCount(),mipCnt);
+
+  // first layer only; rows and sub-resources in staging are aligned, as D3D12 requires
+  UINT pitch [32] = {};
+  UINT offset[32] = {};
+  UINT stageBufferSize = 0;
+  for(uint32_t i=0; i<upload; ++i) {
+    auto& l   = f.level(0,i);
+    Size  bsz = Pixmap::blockCount(frm,l.w,l.h);
+    pitch [i] = alignTo(UINT(bsz.w)*bpb,D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+    offset[i] = stageBufferSize;
+    stageBufferSize = alignTo(stageBufferSize + pitch[i]*UINT(bsz.h),D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+    }
+
+  Detail::DxBuffer  stage  = dx.allocator.alloc(nullptr,stageBufferSize,MemUsage::TransferSrc,BufferHeap::Upload);
+  Detail::DxTexture buf    = dx.allocator.alloc(f.w(),f.h(),mipCnt,format);
+
+  // file -> staging memory, row by row
+  const bool ok = stage.stream([&](uint8_t* mem) {
+    for(auto i:f.readOrder()) {
+      if(i>=upload)
+        continue;
+      auto&        l   = f.level(0,i);
+      const Size   bsz = Pixmap::blockCount(frm,l.w,l.h);
+      const size_t row = size_t(bsz.w)*bpb;
+      for(int y=0; y<bsz.h; ++y) {
+        if(!f.read(mem+offset[i]+size_t(y)*pitch[i], l.offset+size_t(y)*row, row))
+          return false;
+        }
+      }
+    return true;
+    });
+  if(!ok)
+    throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+
+  Detail::DSharedPtr<Buffer*>  pstage(new Detail::DxBuffer (std::move(stage)));
+  Detail::DSharedPtr<Texture*> pbuf  (new Detail::DxTexture(std::move(buf)));
+
+  auto cmd = dx.dataMgr().get();
+  cmd->begin();
+  cmd->hold(pbuf);
+  cmd->hold(pstage); // preserve stage buffer, until gpu side copy is finished
+
+  for(uint32_t i=0; i<upload; ++i) {
+    auto& l = f.level(0,i);
+    cmd->copy(*pbuf.handler,l.w,l.h,i,*pstage.handler,offset[i]);
+    }
+  cmd->barrier(*pbuf.handler, ResourceAccess::TransferDst, ResourceAccess::Sampler, uint32_t(-1));
+  if(upload<mipCnt)
+    cmd->generateMipmap(*pbuf.handler, f.w(), f.h(), mipCnt);
+  cmd->end();
+  dx.dataMgr().submit(std::move(cmd));
+  return PTexture(pbuf.handler);
+  }
+
 AbstractGraphicsApi::PTexture DirectX12Api::createCompressedTexture(Device* d, const Pixmap& p, TextureFormat frm, uint32_t mipCnt) {
   Detail::DxDevice& dx     = *reinterpret_cast<Detail::DxDevice*>(d);
 
@@ -373,6 +434,11 @@ AbstractGraphicsApi::AccelerationStructure* DirectX12Api::createTopAccelerationS
   return new DxTopAccelerationStructure(dx, inst,as,geomSize);
   }
 
+AbstractGraphicsApi::AccelerationStructure* DirectX12Api::createTopAccelerationStruct(Device* d, size_t maxInstances) {
+  auto& dx = *reinterpret_cast<DxDevice*>(d);
+  return new DxTopAccelerationStructure(dx, maxInstances);
+  }
+
 void DirectX12Api::readPixels(Device* d, Pixmap& out, const PTexture t,
                               TextureFormat frm, const uint32_t w, const uint32_t h, uint32_t mip, bool storageImg) {
   Detail::DxDevice&  dx = *reinterpret_cast<Detail::DxDevice*>(d);
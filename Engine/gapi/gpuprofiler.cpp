@@ -0,0 +1,195 @@
+#include "gpuprofiler.h"
+
+#include <Tempest/ODevice>
+
+#include <algorithm>
+#include <cstdio>
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+static void jsonEscape(std::string& out, const std::string& s) {
+  for(char c:s) {
+    switch(c) {
+      case '"':  out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n";  break;
+      case '\t': out += "\\t";  break;
+      default:
+        if(uint8_t(c)<0x20) {
+          char buf[8] = {};
+          std::snprintf(buf,sizeof(buf),"\\u%04x",unsigned(c));
+          out += buf;
+          } else {
+          out += c;
+          }
+      }
+    }
+  }
+
+GpuProfiler::~GpuProfiler() {
+  }
+
+void GpuProfiler::setup(ProfilingFlags f, Callback cb) {
+  std::lock_guard<std::mutex> guard(sync);
+  flg      = f & caps();
+  callback = std::move(cb);
+  if(flg==ProfilingFlags::None) {
+    // results of in-flight submissions are dropped in onResolved; new id, so they can't match a future frame
+    inflight.clear();
+    ++frameId;
+    return;
+    }
+  if(inflight.empty()) {
+    Frame fr;
+    fr.id = frameId;
+    inflight.push_back(std::move(fr));
+    }
+  }
+
+ProfilingFlags GpuProfiler::flags() {
+  std::lock_guard<std::mutex> guard(sync);
+  return flg;
+  }
+
+void GpuProfiler::nextFrame() {
+  if(flags()==ProfilingFlags::None)
+    return;
+
+  poll();
+
+  std::vector<GpuFrame> done;
+  Callback              cb;
+  {
+  std::lock_guard<std::mutex> guard(sync);
+  if(inflight.empty())
+    return;
+  inflight.back().closed = true;
+
+  Frame fr;
+  fr.id = ++frameId;
+  inflight.push_back(std::move(fr));
+
+  // frames are delivered in order; one slow submission holds back following frames
+  while(inflight.front().closed && inflight.front().pending==0) {
+    auto& src = inflight.front();
+    std::stable_sort(src.zones.begin(), src.zones.end(), [](const GpuZone& l, const GpuZone& r){
+      if(l.begin!=r.begin)
+        return l.begin<r.begin;
+      return l.depth<r.depth;
+      });
+
+    GpuFrame f;
+    f.id    = src.id;
+    f.zones = std::move(src.zones);
+    inflight.pop_front();
+
+    if(callback)
+      done.push_back(f);
+    history.push_back(std::move(f));
+    if(history.size()>MaxHistory)
+      history.pop_front();
+    }
+  cb = callback;
+  }
+
+  for(auto& i:done)
+    cb(i);
+  }
+
+void GpuProfiler::saveTrace(ODevice& fout) {
+  std::deque<GpuFrame> frames;
+  {
+  std::lock_guard<std::mutex> guard(sync);
+  frames = history;
+  }
+
+  uint64_t base = uint64_t(-1);
+  for(auto& f:frames)
+    for(auto& z:f.zones)
+      base = std::min(base,z.begin);
+
+  std::string str;
+  str.reserve(4096);
+  str += "{\"traceEvents\":[\n";
+
+  bool first = true;
+  char buf[256] = {};
+  auto event = [&](const std::string& name, uint32_t tid, uint64_t begin, uint64_t end) {
+    if(!first)
+      str += ",\n";
+    first = false;
+    str += "{\"name\":\"";
+    jsonEscape(str,name);
+    std::snprintf(buf,sizeof(buf),"\",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+                  unsigned(tid), double(begin-base)/1000.0, double(end-begin)/1000.0);
+    str += buf;
+    };
+
+  for(auto& f:frames) {
+    if(f.zones.empty())
+      continue;
+    uint64_t fbegin = f.zones[0].begin, fend = f.zones[0].end;
+    for(auto& z:f.zones) {
+      fend = std::max(fend,z.end);
+
+      event(z.name, 0, z.begin, z.end);
+      std::snprintf(buf,sizeof(buf),",\"args\":{\"frame\":%llu,\"depth\":%u",
+                    static_cast<unsigned long long>(f.id), unsigned(z.depth));
+      str += buf;
+      if(z.hasStats) {
+        std::snprintf(buf,sizeof(buf),",\"ia_vertices\":%llu,\"ia_primitives\":%llu,\"vs_invocations\":%llu,"
+                                      "\"clip_primitives\":%llu,\"fs_invocations\":%llu,\"cs_invocations\":%llu",
+                      static_cast<unsigned long long>(z.stats.inputVertices),
+                      static_cast<unsigned long long>(z.stats.inputPrimitives),
+                      static_cast<unsigned long long>(z.stats.vsInvocations),
+                      static_cast<unsigned long long>(z.stats.clipPrimitives),
+                      static_cast<unsigned long long>(z.stats.fsInvocations),
+                      static_cast<unsigned long long>(z.stats.csInvocations));
+        str += buf;
+        }
+      str += "}}";
+      }
+
+    // whole-frame track, for a quick look at frame-to-frame variance
+    event("frame "+std::to_string(f.id), 1, fbegin, fend);
+    str += "}";
+    }
+
+  str += "\n],\"displayTimeUnit\":\"ms\"}\n";
+  fout.write(str.data(),str.size());
+  fout.flush();
+  }
+
+uint64_t GpuProfiler::onSubmit() {
+  std::lock_guard<std::mutex> guard(sync);
+  if(flg==ProfilingFlags::None)
+    return uint64_t(-1);
+  if(inflight.empty() || inflight.back().closed) {
+    Frame fr;
+    fr.id = frameId;
+    inflight.push_back(std::move(fr));
+    }
+  inflight.back().pending++;
+  return inflight.back().id;
+  }
+
+void GpuProfiler::onResolved(uint64_t frame, std::vector<GpuZone>& zones) {
+  std::lock_guard<std::mutex> guard(sync);
+  auto f = findFrame(frame);
+  if(f==nullptr)
+    return;
+  if(f->zones.empty()) {
+    f->zones = std::move(zones);
+    } else {
+    f->zones.insert(f->zones.end(), std::make_move_iterator(zones.begin()), std::make_move_iterator(zones.end()));
+    }
+  f->pending--;
+  }
+
+GpuProfiler::Frame* GpuProfiler::findFrame(uint64_t id) {
+  for(auto& i:inflight)
+    if(i.id==id)
+      return &i;
+  return nullptr;
+  }
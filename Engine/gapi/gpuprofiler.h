@@ -0,0 +1,65 @@
+#pragma once
+
+#include <Tempest/GpuZone>
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace Tempest {
+
+class ODevice;
+
+namespace Detail {
+
+// backend independent part of GPU profiler: frame bookkeeping, delivery and export
+class GpuProfiler {
+  public:
+    using Callback = std::function<void(const GpuFrame&)>;
+
+    GpuProfiler() = default;
+    virtual ~GpuProfiler();
+
+    void           setup(ProfilingFlags flg, Callback cb);
+    ProfilingFlags flags();
+
+    // closes current frame; delivers all completed frames, without waiting for GPU
+    void           nextFrame();
+    void           saveTrace(ODevice& fout);
+
+  protected:
+    // backend: registers submission in current frame; returns frame id
+    uint64_t       onSubmit();
+    // backend: submission results are available; empty 'zones' is fine
+    void           onResolved(uint64_t frame, std::vector<GpuZone>& zones);
+    // backend: non-blocking; calls onResolved for every completed submission
+    virtual void   poll() = 0;
+    // backend: flags, that are supported by device
+    virtual ProfilingFlags caps() const = 0;
+
+  private:
+    enum {
+      MaxHistory = 256,
+      };
+
+    struct Frame {
+      uint64_t             id      = 0;
+      uint32_t             pending = 0;
+      bool                 closed  = false;
+      std::vector<GpuZone> zones;
+      };
+
+    Frame*                 findFrame(uint64_t id);
+
+    std::mutex             sync;
+    ProfilingFlags         flg     = ProfilingFlags::None;
+    Callback               callback;
+    uint64_t               frameId = 0;
+    std::deque<Frame>      inflight;
+    std::deque<GpuFrame>   history;
+  };
+
+}
+}
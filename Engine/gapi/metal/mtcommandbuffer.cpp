@@ -639,6 +639,19 @@ void MtCommandBuffer::copy(AbstractGraphicsApi::Buffer& dest, size_t offset,
                            MTL::Origin(0,0,0),MTL::Size(width,height,1),
                            d.impl.get(),
                            offset, bpp*width,bpp*width*height);
+  if(d.impl->storageMode()==MTL::StorageModeManaged)
+    encBlit->synchronizeResource(d.impl.get());
+  }
+
+void MtCommandBuffer::copy(AbstractGraphicsApi::Buffer& dest, size_t offsetDest,
+                           const AbstractGraphicsApi::Buffer& src, size_t offsetSrc, size_t size) {
+  setEncoder(E_Blit,nullptr);
+
+  auto& s = reinterpret_cast<const MtBuffer&>(src);
+  auto& d = reinterpret_cast<MtBuffer&>      (dest);
+  encBlit->copyFromBuffer(s.impl.get(),offsetSrc,d.impl.get(),offsetDest,size);
+  if(d.impl->storageMode()==MTL::StorageModeManaged)
+    encBlit->synchronizeResource(d.impl.get());
   }
 
 #endif
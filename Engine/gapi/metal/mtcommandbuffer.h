@@ -67,6 +67,8 @@ class MtCommandBuffer : public AbstractGraphicsApi::CommandBuffer {
     void generateMipmap(AbstractGraphicsApi::Texture& image, uint32_t texWidth, uint32_t texHeight, uint32_t mipLevels) override;
     void copy          (AbstractGraphicsApi::Buffer& dst, size_t offset,
                         AbstractGraphicsApi::Texture& src, uint32_t width, uint32_t height, uint32_t mip) override;
+    void copy          (AbstractGraphicsApi::Buffer& dst, size_t offsetDest,
+                        const AbstractGraphicsApi::Buffer& src, size_t offsetSrc, size_t size) override;
 
   private:
     enum EncType:uint8_t {
@@ -73,6 +73,14 @@ inline MTL::PixelFormat nativeFormat(TextureFormat frm) {
       return MTL::PixelFormatRG11B10Float;
     case RGBA16F:
       return MTL::PixelFormatRGBA16Float;
+    case BC4:
+      return MTL::PixelFormatBC4_RUnorm;
+    case BC5:
+      return MTL::PixelFormatBC5_RGUnorm;
+    case BC6H:
+      return MTL::PixelFormatBC6H_RGBUfloat;
+    case BC7:
+      return MTL::PixelFormatBC7_RGBAUnorm;
     }
   return MTL::PixelFormatInvalid;
   }
@@ -128,7 +128,8 @@ void MtDevice::deductProps(AbstractGraphicsApi::Props& prop, MTL::Device& dev) {
     dsBit  |= uint64_t(1) << uint64_t(i);
 
   if(dev.supportsBCTextureCompression()) {
-    static const TextureFormat bc[] = {TextureFormat::DXT1, TextureFormat::DXT3, TextureFormat::DXT5};
+    static const TextureFormat bc[] = {TextureFormat::DXT1, TextureFormat::DXT3, TextureFormat::DXT5,
+                                       TextureFormat::BC4,  TextureFormat::BC5,  TextureFormat::BC6H, TextureFormat::BC7};
     for(auto& i:bc)
       smpBit |= uint64_t(1) << uint64_t(i);
     }
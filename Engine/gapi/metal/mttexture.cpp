@@ -7,6 +7,9 @@
 #include <Tempest/Except>
 
 #include "mtdevice.h"
+#include "formats/texturefile.h"
+
+#include <algorithm>
 
 using namespace Tempest;
 using namespace Tempest::Detail;
@@ -73,11 +76,56 @@ MtTexture::MtTexture(MtDevice& dev, const Pixmap& pm, uint32_t mipCnt, TextureFo
   cmd->waitUntilCompleted();
   }
 
+MtTexture::MtTexture(MtDevice& dev, TextureFile& f, uint32_t mipCnt)
+  :dev(dev), mipCnt(mipCnt) {
+  const TextureFormat frm    = f.format();
+  const uint32_t      upload = std::min(f.mipCount(),mipCnt);
+
+  // first layer only
+  size_t offset[32] = {};
+  size_t size       = 0;
+  for(uint32_t i=0; i<upload; ++i) {
+    offset[i] = size;
+    size      = ((size + f.level(0,i).size + 15)/16)*16;
+    }
+
+  // file -> shared buffer, without intermediate copy
+  NsPtr<MTL::Buffer> stage = NsPtr<MTL::Buffer>(dev.impl->newBuffer(size,MTL::ResourceStorageModeShared));
+  if(stage==nullptr)
+    throw std::system_error(GraphicsErrc::OutOfHostMemory);
+  auto mem = reinterpret_cast<uint8_t*>(stage->contents());
+  for(auto i:f.readOrder()) {
+    if(i>=upload)
+      continue;
+    auto& l = f.level(0,i);
+    if(!f.read(mem+offset[i],l.offset,l.size))
+      throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+    }
+
+  impl = alloc(frm,f.w(),f.h(),1,mipCnt,MTL::StorageModePrivate,MTL::TextureUsageShaderRead);
+
+  auto pool = NsPtr<NS::AutoreleasePool>::init();
+  auto cmd  = dev.queue->commandBuffer();
+  auto enc  = cmd->blitCommandEncoder();
+  for(uint32_t i=0; i<upload; ++i) {
+    auto&      l   = f.level(0,i);
+    const Size bsz = Pixmap::blockCount(frm,l.w,l.h);
+    const auto row = NS::UInteger(bsz.w)*Pixmap::blockSizeForFormat(frm);
+    enc->copyFromBuffer(stage.get(),offset[i],row,0,MTL::Size(l.w,l.h,1),impl.get(),0,i,MTL::Origin(0,0,0));
+    }
+  if(upload<mipCnt)
+    enc->generateMipmaps(impl.get());
+  enc->endEncoding();
+  cmd->commit();
+  // TODO: implement proper upload engine
+  cmd->waitUntilCompleted();
+  }
+
 MtTexture::~MtTexture() {
   }
 
 void MtTexture::createCompressedTexture(MTL::Texture& val, const Pixmap& p, TextureFormat frm, uint32_t mipCnt) {
-  uint32_t       blockSize = (frm==TextureFormat::DXT1) ? 8 : 16;
+  uint32_t       blockSize = uint32_t(Pixmap::blockSizeForFormat(frm));
   const uint8_t* pdata     = reinterpret_cast<const uint8_t*>(p.data());
 
   uint32_t w = p.w(), h = p.h();
@@ -9,12 +9,14 @@ namespace Tempest {
 namespace Detail {
 
 class MtDevice;
+class TextureFile;
 
 class MtTexture : public Tempest::AbstractGraphicsApi::Texture {
   public:
     MtTexture(MtDevice &d,
               const uint32_t w, const uint32_t h, const uint32_t depth, uint32_t mips, TextureFormat frm, bool storageTex);
     MtTexture(MtDevice &d, const Pixmap& pm, uint32_t mips, TextureFormat frm);
+    MtTexture(MtDevice &d, TextureFile& f, uint32_t mips);
     ~MtTexture();
 
     uint32_t mipCount() const override;
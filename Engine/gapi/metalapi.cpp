@@ -143,6 +143,12 @@ AbstractGraphicsApi::PTexture MetalApi::createTexture(AbstractGraphicsApi::Devic
   return PTexture(new MtTexture(dev,p,mips,frm));
   }
 
+AbstractGraphicsApi::PTexture MetalApi::createTexture(AbstractGraphicsApi::Device *d,
+                                                      Detail::TextureFile& f, uint32_t mips) {
+  auto& dev = *reinterpret_cast<MtDevice*>(d);
+  return PTexture(new MtTexture(dev,f,mips));
+  }
+
 AbstractGraphicsApi::PTexture MetalApi::createTexture(AbstractGraphicsApi::Device *d,
                                                       const uint32_t w, const uint32_t h, uint32_t mips, TextureFormat frm) {
   auto& dev = *reinterpret_cast<MtDevice*>(d);
@@ -7,6 +7,13 @@ void MeshConverter::exec() {
   analyzeBuiltins();
   traveseVaryings();
 
+  if(options.deferredMeshShading && !canDeferMeshShading())
+    options.deferredMeshShading = false;
+  if(options.deferredMeshShading) {
+    // varyings are recomputed in vertex stage - no need to keep them anywhere
+    options.varyingInSharedMem = false;
+    }
+
   if(options.deferredMeshShading) {
     emitComp(comp);
     emitMVert(vert);
@@ -102,6 +109,130 @@ void MeshConverter::traveseVaryings() {
     }
   }
 
+bool MeshConverter::canDeferMeshShading() {
+  // Deferred mode runs mesh shader second time, as vertex shader: one invocation per output vertex.
+  // Only valid, if vertex N is written by thread N, threads do not communicate and shader has no side effects.
+  if(code.findExecutionModel()!=spv::ExecutionModelMeshEXT)
+    return false;
+
+  uint32_t wgSize[3] = {};
+  uint32_t maxVert   = 0;
+
+  std::unordered_set<uint32_t> const0, storage, varyingPtr;
+  for(auto& i:code) {
+    if(i.op()==spv::OpExecutionMode && i[2]==spv::ExecutionModeLocalSize) {
+      wgSize[0] = i[3];
+      wgSize[1] = i[4];
+      wgSize[2] = i[5];
+      }
+    if(i.op()==spv::OpExecutionMode && i[2]==spv::ExecutionModeOutputVertices) {
+      maxVert = i[3];
+      }
+    if(i.op()==spv::OpDecorate && i[2]==spv::DecorationPerPrimitiveEXT) {
+      return false;
+      }
+    if(i.op()==spv::OpConstant && i[3]==0) {
+      const0.insert(i[2]);
+      }
+    if(i.op()==spv::OpVariable) {
+      if(i[3]==spv::StorageClassWorkgroup || i[3]==spv::StorageClassTaskPayloadWorkgroupEXT)
+        return false;
+      if(i[3]==spv::StorageClassStorageBuffer || i[3]==spv::StorageClassUniform)
+        storage.insert(i[2]);
+      }
+    if(i.op()==spv::OpControlBarrier || i.op()==spv::OpImageWrite || i.op()==spv::OpCopyMemory) {
+      return false;
+      }
+    if((i.op()>spv::OpAtomicLoad && i.op()<=spv::OpAtomicXor) ||
+       i.op()==spv::OpAtomicFAddEXT || i.op()==spv::OpAtomicFMinEXT || i.op()==spv::OpAtomicFMaxEXT) {
+      return false;
+      }
+    }
+
+  // vertex shader can restore only 1d local index
+  if(wgSize[1]!=1 || wgSize[2]!=1 || maxVert==0 || maxVert>wgSize[0])
+    return false;
+
+  // values, that are equal to gl_LocalInvocationIndex; local variables are optimistic, until proven otherwise
+  std::unordered_set<uint32_t> threadId, threadIdPtr, threadIdVec;
+  std::unordered_map<uint32_t,bool> localVar;
+  for(auto& i:code) {
+    if(i.op()==spv::OpVariable && i[3]==spv::StorageClassFunction)
+      localVar[i[2]] = (i.length()<=4);
+    }
+
+  bool changed = true;
+  while(changed) {
+    changed = false;
+    threadId.clear();
+    threadIdPtr.clear();
+    threadIdVec.clear();
+    for(auto& i:code) {
+      switch(i.op()) {
+        case spv::OpAccessChain:
+        case spv::OpInBoundsAccessChain:
+          if(i[3]==gl_LocalInvocationID && i.length()==5 && const0.count(i[4])>0)
+            threadIdPtr.insert(i[2]);
+          break;
+        case spv::OpLoad: {
+          auto v = localVar.find(i[3]);
+          if((gl_LocalInvocationIndex!=0 && i[3]==gl_LocalInvocationIndex) || threadIdPtr.count(i[3])>0 ||
+             (v!=localVar.end() && v->second))
+            threadId.insert(i[2]);
+          if(gl_LocalInvocationID!=0 && i[3]==gl_LocalInvocationID)
+            threadIdVec.insert(i[2]);
+          break;
+          }
+        case spv::OpCompositeExtract:
+          if(i.length()==5 && i[4]==0 && threadIdVec.count(i[3])>0)
+            threadId.insert(i[2]);
+          break;
+        case spv::OpBitcast:
+        case spv::OpCopyObject:
+          if(threadId.count(i[3])>0)
+            threadId.insert(i[2]);
+          break;
+        case spv::OpStore: {
+          auto v = localVar.find(i[1]);
+          if(v!=localVar.end() && v->second && threadId.count(i[2])==0) {
+            v->second = false;
+            changed   = true;
+            }
+          break;
+          }
+        default:
+          break;
+        }
+      }
+    }
+
+  for(auto& i:code) {
+    if(i.op()==spv::OpAccessChain || i.op()==spv::OpInBoundsAccessChain) {
+      if(storage.count(i[3])>0) {
+        storage.insert(i[2]);
+        }
+      if(varying.find(i[3])!=varying.end()) {
+        // [max_vertex] index must be a thread-id
+        if(i.length()<5 || threadId.count(i[4])==0)
+          return false;
+        varyingPtr.insert(i[2]);
+        }
+      }
+    if(i.op()==spv::OpStore) {
+      if(storage.count(i[1])>0)
+        return false;
+      if(varying.find(i[1])!=varying.end())
+        return false;
+      }
+    if(i.op()==spv::OpLoad) {
+      if(varyingPtr.count(i[3])>0 || varying.find(i[3])!=varying.end())
+        return false;
+      }
+    }
+
+  return true;
+  }
+
 uint32_t MeshConverter::typeSizeOf(uint32_t type) {
   if(type==0)
     return 0;
@@ -862,10 +993,9 @@ void MeshConverter::emitSetMeshOutputs(libspirv::MutableBytecode& comp, uint32_t
     fn.insert(spv::OpLoad, {uint_t, rgMaxV, maxV});
     fn.insert(spv::OpLoad, {uint_t, rgMaxP, maxP});
 
-    const uint32_t rg0 = comp.fetchAddBound();
-    fn.insert(spv::OpIMul,    {uint_t, rg0, rgMaxV, constVertSz});
-    fn.insert(spv::OpIMul,    {uint_t, rgIboSize, rgMaxP, indPerPrimitive});
-    fn.insert(spv::OpBitcast, {uint_t, rgAllocSize, rgIboSize});
+    // no varyings in scratch memory - only indices
+    fn.insert(spv::OpIMul,       {uint_t, rgIboSize, rgMaxP, indPerPrimitive});
+    fn.insert(spv::OpCopyObject, {uint_t, rgAllocSize, rgIboSize});
     } else {
     const uint32_t rgMaxV = comp.fetchAddBound();
     const uint32_t rgMaxP = comp.fetchAddBound();
@@ -1989,43 +2119,41 @@ void MeshConverter::emitMVert(libspirv::MutableBytecode& comp) {
   if(gl_VertexIndex!=0) {
     const uint32_t rg_VertexIndexI = vert.fetchAddBound();
     const uint32_t rg_VertexIndexU = vert.fetchAddBound();
+    const uint32_t rg_LocalIndex   = vert.fetchAddBound();
+    const uint32_t rg_WorkGroupX   = vert.fetchAddBound();
 
     auto it = comp.findSectionEnd(libspirv::Bytecode::S_Types);
     const uint32_t wgSize            = workGroupSize[0]*workGroupSize[1]*workGroupSize[2];
     const uint32_t uint_t            = comp.OpTypeInt(it, 32, false);
     const uint32_t int_t             = comp.OpTypeInt(it, 32, true);
-    const uint32_t _ptr_Private_uint = comp.OpTypePointer(it, spv::StorageClassPrivate, uint_t);
+    const uint32_t uvec3_t           = comp.OpTypeVector(it, uint_t, 3);
     const uint32_t constWg           = comp.OpConstant(it,uint_t,wgSize);
 
     it = comp.findOpEntryPoint(spv::ExecutionModelVertex,"main");
     uint32_t mainId = (*it)[2];
 
+    // gl_VertexIndex = gl_WorkGroupID.x*wgSize + gl_LocalInvocationIndex, see emitSetMeshOutputs
     it = comp.findFunction(mainId);
     it.insert(spv::OpLoad,    {int_t,  rg_VertexIndexI, gl_VertexIndex});
     it.insert(spv::OpBitcast, {uint_t, rg_VertexIndexU, rg_VertexIndexI});
+    it.insert(spv::OpUMod,    {uint_t, rg_LocalIndex, rg_VertexIndexU, constWg});
+    it.insert(spv::OpUDiv,    {uint_t, rg_WorkGroupX, rg_VertexIndexU, constWg});
 
     if(gl_LocalInvocationIndex!=0) {
-      const uint32_t tmp0 = vert.fetchAddBound();
-      const uint32_t tmp1 = vert.fetchAddBound();
-      it.insert(spv::OpAccessChain, {_ptr_Private_uint, tmp0, gl_LocalInvocationIndex});
-      it.insert(spv::OpUMod,        {uint_t, tmp1, rg_VertexIndexU, constWg});
-      it.insert(spv::OpStore,       {tmp0, tmp1});
+      it.insert(spv::OpStore, {gl_LocalInvocationIndex, rg_LocalIndex});
       }
 
     if(gl_LocalInvocationID!=0) {
       const uint32_t tmp0 = vert.fetchAddBound();
-      const uint32_t tmp1 = vert.fetchAddBound();
-      it.insert(spv::OpAccessChain, {_ptr_Private_uint, tmp0, gl_LocalInvocationID, constants[0]});
-      it.insert(spv::OpUMod,        {uint_t, tmp1, rg_VertexIndexU, constWg});
-      it.insert(spv::OpStore,       {tmp0, tmp1});
+      it.insert(spv::OpCompositeConstruct, {uvec3_t, tmp0, rg_LocalIndex, constants[0], constants[0]});
+      it.insert(spv::OpStore,              {gl_LocalInvocationID, tmp0});
       }
 
-    if(gl_WorkGroupID!=0) {
+    // NOTE: gl_WorkGroupID is remapped by emitComp, use original id
+    if(usr_WorkGroupID!=0) {
       const uint32_t tmp0 = vert.fetchAddBound();
-      const uint32_t tmp1 = vert.fetchAddBound();
-      it.insert(spv::OpAccessChain, {_ptr_Private_uint, tmp0, gl_WorkGroupID, constants[0]});
-      it.insert(spv::OpUDiv,        {uint_t, tmp1, rg_VertexIndexU, constWg});
-      it.insert(spv::OpStore,       {tmp0, tmp1});
+      it.insert(spv::OpCompositeConstruct, {uvec3_t, tmp0, rg_WorkGroupX, constants[0], constants[0]});
+      it.insert(spv::OpStore,              {usr_WorkGroupID, tmp0});
       }
     }
 
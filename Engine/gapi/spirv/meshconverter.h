@@ -2,6 +2,7 @@
 
 #include <functional>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "libspirv/libspirv.h"
 
@@ -23,6 +24,7 @@ class MeshConverter {
   private:
   void     analyzeBuiltins();
   void     traveseVaryings();
+  bool     canDeferMeshShading();
 
   uint32_t typeSizeOf(uint32_t type);
 
@@ -71,6 +71,13 @@ class TransferCmd : public CmdBuffer {
       CmdBuffer::reset();
       }
 
+    using CmdBuffer::begin;
+    void begin(bool transfer) override {
+      CmdBuffer::begin(transfer);
+      // internal uploads are visible in gpu-profiler, next to user zones
+      CmdBuffer::beginZone("upload");
+      }
+
     Fence               fence;
 
   private:
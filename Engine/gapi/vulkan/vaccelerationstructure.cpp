@@ -5,9 +5,20 @@
 #include "vdevice.h"
 #include "vbuffer.h"
 
+#include <algorithm>
+
 using namespace Tempest;
 using namespace Tempest::Detail;
 
+// upper bound for shared scratch memory of batched BLAS build
+static constexpr VkDeviceSize ScratchArenaSize = 32*1024*1024;
+
+static void pushGeometry(VDevice& dx, VBlasBuildCtx& ctx, const AbstractGraphicsApi::RtGeometry& geom) {
+  auto& vbo = *reinterpret_cast<const VBuffer*>(geom.vbo);
+  auto& ibo = *reinterpret_cast<const VBuffer*>(geom.ibo);
+  ctx.pushGeometry(dx, vbo, geom.vboSz, geom.stride, ibo, geom.iboSz, geom.ioffset, geom.icls);
+  }
+
 void VBlasBuildCtx::pushGeometry(VDevice& dx,
                                  const VBuffer& vbo, size_t vboSz, size_t stride,
                                  const VBuffer& ibo, size_t iboSz, size_t ioffset, IndexClass icls) {
@@ -54,60 +65,38 @@ VkAccelerationStructureBuildSizesInfoKHR VBlasBuildCtx::buildSizes(VDevice& dx)
   return buildSizesInfo;
   }
 
-VkAccelerationStructureBuildGeometryInfoKHR VBlasBuildCtx::buildCmd(VDevice& dx, VkAccelerationStructureKHR dest, VBuffer* scratch) const {
+VkAccelerationStructureBuildGeometryInfoKHR VBlasBuildCtx::buildCmd(VDevice& dx, VkAccelerationStructureKHR dest, VBuffer* scratch, VkDeviceSize scratchOffset) const {
   VkAccelerationStructureBuildGeometryInfoKHR buildGeometryInfo = {};
   buildGeometryInfo.sType                     = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
   buildGeometryInfo.pNext                     = nullptr;
   buildGeometryInfo.type                      = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
-  buildGeometryInfo.flags                     = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
+  buildGeometryInfo.flags                     = flags;
   buildGeometryInfo.mode                      = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
   buildGeometryInfo.srcAccelerationStructure  = VK_NULL_HANDLE;
   buildGeometryInfo.dstAccelerationStructure  = dest;
   buildGeometryInfo.geometryCount             = uint32_t(geometry.size());
   buildGeometryInfo.pGeometries               = geometry.data();
   buildGeometryInfo.ppGeometries              = nullptr;
-  buildGeometryInfo.scratchData.deviceAddress = scratch!=nullptr ? reinterpret_cast<const VBuffer&>(*scratch).toDeviceAddress(dx) : VkDeviceAddress{};
+  buildGeometryInfo.scratchData.deviceAddress = scratch!=nullptr ? scratch->toDeviceAddress(dx) + scratchOffset : VkDeviceAddress{};
   return buildGeometryInfo;
   }
 
 
 VAccelerationStructure::VAccelerationStructure(VDevice& dx, const AbstractGraphicsApi::RtGeometry* geom, size_t size)
   :owner(dx) {
-  auto device                        = dx.device.impl;
-  auto vkCreateAccelerationStructure = dx.vkCreateAccelerationStructure;
-
   VBlasBuildCtx ctx;
-  for(size_t i=0; i<size; ++i) {
-    auto& vbo     = *reinterpret_cast<const VBuffer*>(geom[i].vbo);
-    auto  vboSz   = geom[i].vboSz;
-    auto  stride  = geom[i].stride;
-    auto& ibo     = *reinterpret_cast<const VBuffer*>(geom[i].ibo);
-    auto  iboSz   = geom[i].iboSz;
-    auto  ioffset = geom[i].ioffset;
-    auto  icls    = geom[i].icls;
-    ctx.pushGeometry(dx, vbo, vboSz, stride, ibo, iboSz, ioffset, icls);
-    }
+  for(size_t i=0; i<size; ++i)
+    pushGeometry(dx, ctx, geom[i]);
 
   const auto buildSizesInfo = ctx.buildSizes(dx);
   if(buildSizesInfo.accelerationStructureSize<=0)
     throw std::system_error(GraphicsErrc::UnsupportedExtension);
 
-  data = dx.allocator.alloc(nullptr, buildSizesInfo.accelerationStructureSize, MemUsage::AsStorage, BufferHeap::Device);
+  create(buildSizesInfo.accelerationStructureSize);
   auto scratch = dx.dataMgr().allocStagingMemory(nullptr, buildSizesInfo.buildScratchSize, MemUsage::ScratchBuffer, BufferHeap::Device);
 
   DSharedPtr<AbstractGraphicsApi::Buffer*> pScratch(new VBuffer(std::move(scratch)));
 
-  VkAccelerationStructureCreateInfoKHR createInfo = {};
-  createInfo.sType         = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
-  createInfo.pNext         = nullptr;
-  createInfo.createFlags   = 0;
-  createInfo.buffer        = data.impl;
-  createInfo.offset        = 0;
-  createInfo.size          = buildSizesInfo.accelerationStructureSize;
-  createInfo.type          = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
-  createInfo.deviceAddress = VK_NULL_HANDLE;
-  vkCreateAccelerationStructure(device, &createInfo, nullptr, &impl);
-
   DSharedPtr<AbstractGraphicsApi::AccelerationStructure*> pThis(this);
 
   auto& mgr = dx.dataMgr();
@@ -127,11 +116,171 @@ VAccelerationStructure::VAccelerationStructure(VDevice& dx, const AbstractGraphi
   mgr.submit(std::move(cmd));
   }
 
+VAccelerationStructure::VAccelerationStructure(VDevice& dx, VkDeviceSize size)
+  :owner(dx) {
+  create(size);
+  }
+
 VAccelerationStructure::~VAccelerationStructure() {
   auto device = owner.device.impl;
   owner.vkDestroyAccelerationStructure(device,impl,nullptr);
   }
 
+void VAccelerationStructure::create(VkDeviceSize size) {
+  data = owner.allocator.alloc(nullptr, size, MemUsage::AsStorage, BufferHeap::Device);
+
+  VkAccelerationStructureCreateInfoKHR createInfo = {};
+  createInfo.sType         = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
+  createInfo.pNext         = nullptr;
+  createInfo.createFlags   = 0;
+  createInfo.buffer        = data.impl;
+  createInfo.offset        = 0;
+  createInfo.size          = size;
+  createInfo.type          = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+  createInfo.deviceAddress = VK_NULL_HANDLE;
+  vkAssert(owner.vkCreateAccelerationStructure(owner.device.impl, &createInfo, nullptr, &impl));
+  }
+
+void VAccelerationStructure::build(VDevice& dx, const AbstractGraphicsApi::RtGeometry* geom, const size_t* geomSize, size_t count,
+                                   bool compact, DSharedPtr<AbstractGraphicsApi::AccelerationStructure*>* out) {
+  using PAs = DSharedPtr<AbstractGraphicsApi::AccelerationStructure*>;
+
+  const VkDeviceSize align = std::max<VkDeviceSize>(dx.props.accelerationStructureScratchOffsetAlignment, 1);
+  const auto*        geom0 = geom;
+
+  std::vector<VBlasBuildCtx>           ctx;
+  std::vector<VAccelerationStructure*> blas;
+  std::vector<size_t>                  index;
+  std::vector<VkDeviceSize>            scratchSz, asSz;
+  ctx      .reserve(count);
+  blas     .reserve(count);
+  index    .reserve(count);
+  scratchSz.reserve(count);
+  asSz     .reserve(count);
+
+  VkDeviceSize maxScratch = 0, sumScratch = 0;
+  for(size_t i=0; i<count; ++i) {
+    auto g = geom;
+    geom += geomSize[i];
+    if(geomSize[i]==0)
+      continue;
+
+    VBlasBuildCtx c;
+    if(compact)
+      c.flags |= VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR;
+    for(size_t r=0; r<geomSize[i]; ++r)
+      pushGeometry(dx, c, g[r]);
+
+    const auto sz = c.buildSizes(dx);
+    if(sz.accelerationStructureSize<=0)
+      throw std::system_error(GraphicsErrc::UnsupportedExtension);
+
+    auto as = new VAccelerationStructure(dx, sz.accelerationStructureSize);
+    out[i] = PAs(as);
+
+    const VkDeviceSize scratch = ((sz.buildScratchSize+align-1)/align)*align;
+    maxScratch  = std::max(maxScratch, scratch);
+    sumScratch += scratch;
+
+    ctx      .push_back(std::move(c));
+    blas     .push_back(as);
+    index    .push_back(i);
+    scratchSz.push_back(scratch);
+    asSz     .push_back(sz.accelerationStructureSize);
+    }
+
+  if(blas.empty())
+    return;
+
+  // single scratch arena, reused across builds, once previous batch is done
+  const VkDeviceSize arenaSz  = std::max(maxScratch, std::min(sumScratch, ScratchArenaSize));
+  auto               scratch  = dx.dataMgr().allocStagingMemory(nullptr, size_t(arenaSz), MemUsage::ScratchBuffer, BufferHeap::Device);
+  DSharedPtr<AbstractGraphicsApi::Buffer*> pScratch(new VBuffer(std::move(scratch)));
+
+  auto& mgr = dx.dataMgr();
+  auto  cmd = mgr.get();
+  cmd->begin(true);
+  for(auto g=geom0; g!=geom; ++g) {
+    DSharedPtr<const AbstractGraphicsApi::Buffer*> vbo(g->vbo);
+    DSharedPtr<const AbstractGraphicsApi::Buffer*> ibo(g->ibo);
+    cmd->hold(vbo);
+    cmd->hold(ibo);
+    }
+  cmd->hold(pScratch);
+  for(auto i:index)
+    cmd->hold(out[i]);
+
+  std::vector<VkDeviceSize> offset(blas.size());
+  size_t       first = 0;
+  VkDeviceSize at    = 0;
+  for(size_t i=0; i<blas.size(); ++i) {
+    if(at+scratchSz[i]>arenaSz) {
+      cmd->buildBlas(&blas[first], &ctx[first], &offset[first], i-first, *pScratch.handler);
+      first = i;
+      at    = 0;
+      }
+    offset[i] = at;
+    at       += scratchSz[i];
+    }
+  cmd->buildBlas(&blas[first], &ctx[first], &offset[first], blas.size()-first, *pScratch.handler);
+
+  if(!compact) {
+    cmd->end();
+    mgr.submit(std::move(cmd));
+    return;
+    }
+
+  VkQueryPoolCreateInfo poolInfo = {};
+  poolInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+  poolInfo.queryType  = VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR;
+  poolInfo.queryCount = uint32_t(blas.size());
+
+  auto        device = dx.device.impl;
+  VkQueryPool pool   = VK_NULL_HANDLE;
+  vkAssert(vkCreateQueryPool(device, &poolInfo, nullptr, &pool));
+
+  std::vector<VkDeviceSize> compacted(blas.size());
+  try {
+    cmd->queryCompactedSize(pool, blas.data(), blas.size());
+    cmd->end();
+    // compacted size is known only after build is done
+    mgr.submitAndWait(std::move(cmd));
+    vkAssert(vkGetQueryPoolResults(device, pool, 0, uint32_t(blas.size()),
+                                   compacted.size()*sizeof(VkDeviceSize), compacted.data(), sizeof(VkDeviceSize),
+                                   VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+    }
+  catch(...) {
+    vkDestroyQueryPool(device, pool, nullptr);
+    throw;
+    }
+  vkDestroyQueryPool(device, pool, nullptr);
+
+  std::vector<PAs> tight(blas.size());
+  bool             any = false;
+  for(size_t i=0; i<blas.size(); ++i) {
+    if(compacted[i]==0 || compacted[i]>=asSz[i])
+      continue;
+    tight[i] = PAs(new VAccelerationStructure(dx, compacted[i]));
+    any      = true;
+    }
+  if(!any)
+    return;
+
+  cmd = mgr.get();
+  cmd->begin(true);
+  for(size_t i=0; i<blas.size(); ++i) {
+    if(!tight[i])
+      continue;
+    auto& src = out[index[i]];
+    cmd->hold(src);
+    cmd->hold(tight[i]);
+    cmd->compactBlas(*reinterpret_cast<VAccelerationStructure*>(tight[i].handler), *blas[i]);
+    src = std::move(tight[i]);
+    }
+  cmd->end();
+  mgr.submit(std::move(cmd));
+  }
+
 VkDeviceAddress VAccelerationStructure::toDeviceAddress(VDevice& dx) const {
   auto vkGetAccelerationStructureDeviceAddress = dx.vkGetAccelerationStructureDeviceAddress;
 
@@ -144,11 +293,65 @@ VkDeviceAddress VAccelerationStructure::toDeviceAddress(VDevice& dx) const {
 
 
 VTopAccelerationStructure::VTopAccelerationStructure(VDevice& dx, const RtInstance* inst, AccelerationStructure*const* as, size_t asSize)
-  :owner(dx) {
-  auto device                               = dx.device.impl;
-  auto vkGetAccelerationStructureBuildSizes = dx.vkGetAccelerationStructureBuildSizes;
-  auto vkCreateAccelerationStructure        = dx.vkCreateAccelerationStructure;
+  :owner(dx), maxInstances(uint32_t(asSize)) {
+  const auto buildSizesInfo = buildSizes(dx, maxInstances);
+  create(buildSizesInfo.accelerationStructureSize);
+
+  Detail::DSharedPtr<AbstractGraphicsApi::Buffer*> pBuf;
+  if(asSize>0) {
+    VBuffer buf = dx.allocator.alloc(nullptr,asSize*sizeof(VkAccelerationStructureInstanceKHR),MemUsage::TransferDst | MemUsage::StorageBuffer,BufferHeap::Upload);
+    pBuf = Detail::DSharedPtr<AbstractGraphicsApi::Buffer*>(new Detail::VBuffer(std::move(buf)));
+    }
+
+  for(size_t i=0; i<asSize; ++i) {
+    auto blas = reinterpret_cast<VAccelerationStructure*>(as[i]);
+
+    VkAccelerationStructureInstanceKHR objInstance = {};
+    for(int x=0; x<3; ++x)
+      for(int y=0; y<4; ++y)
+        objInstance.transform.matrix[x][y] = inst[i].mat.at(y,x);
+    objInstance.instanceCustomIndex                    = inst[i].id;
+    objInstance.mask                                   = inst[i].mask;
+    objInstance.instanceShaderBindingTableRecordOffset = 0;
+    objInstance.flags                                  = nativeFormat(inst[i].flags);
+    objInstance.accelerationStructureReference         = blas->toDeviceAddress(dx);
+
+    pBuf.handler->update(&objInstance, i*sizeof(objInstance), sizeof(objInstance));
+    }
+
+  auto  tmp = dx.dataMgr().allocStagingMemory(nullptr,buildSizesInfo.buildScratchSize,MemUsage::ScratchBuffer,BufferHeap::Device);
+  DSharedPtr<AbstractGraphicsApi::Buffer*> pScratch(new VBuffer(std::move(tmp)));
+
+  DSharedPtr<AbstractGraphicsApi::AccelerationStructure*> pThis(this);
+
+  auto cmd = dx.dataMgr().get();
+  cmd->begin();
+  cmd->hold(pScratch);
+  cmd->hold(pBuf);
+  cmd->hold(pThis);
+  cmd->buildTlas(impl,data,*pBuf.handler,0,uint32_t(asSize),*pScratch.handler,false);
+  cmd->end();
+
+  // dx.dataMgr().waitFor(this);
+  dx.dataMgr().submit(std::move(cmd));
 
+  numInstances = uint32_t(asSize);
+  built        = true;
+  }
+
+VTopAccelerationStructure::VTopAccelerationStructure(VDevice& dx, size_t maxInst)
+  :owner(dx), maxInstances(uint32_t(maxInst)) {
+  const auto buildSizesInfo = buildSizes(dx, maxInstances);
+  create(buildSizesInfo.accelerationStructureSize);
+  allocScratch();
+  }
+
+VTopAccelerationStructure::~VTopAccelerationStructure() {
+  auto device = owner.device.impl;
+  owner.vkDestroyAccelerationStructure(device,impl,nullptr);
+  }
+
+VkAccelerationStructureBuildSizesInfoKHR VTopAccelerationStructure::buildSizes(VDevice& dx, uint32_t numInstances) {
   VkAccelerationStructureGeometryInstancesDataKHR geometryInstancesData = {};
   geometryInstancesData.sType                = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
   geometryInstancesData.pNext                = nullptr;
@@ -179,68 +382,34 @@ VTopAccelerationStructure::VTopAccelerationStructure(VDevice& dx, const RtInstan
   buildSizesInfo.sType                       = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
   buildSizesInfo.pNext                       = nullptr;
 
-  uint32_t numInstances = uint32_t(asSize);
-  vkGetAccelerationStructureBuildSizes(device,
-                                       VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
-                                       &buildGeometryInfo,
-                                       &numInstances,
-                                       &buildSizesInfo);
-
-  data = dx.allocator.alloc(nullptr, buildSizesInfo.accelerationStructureSize, MemUsage::AsStorage, BufferHeap::Device);
-
-  Detail::DSharedPtr<AbstractGraphicsApi::Buffer*> pBuf;
-  if(asSize>0) {
-    VBuffer buf = dx.allocator.alloc(nullptr,asSize*sizeof(VkAccelerationStructureInstanceKHR),MemUsage::TransferDst | MemUsage::StorageBuffer,BufferHeap::Upload);
-    pBuf = Detail::DSharedPtr<AbstractGraphicsApi::Buffer*>(new Detail::VBuffer(std::move(buf)));
-    }
-
-  for(size_t i=0; i<asSize; ++i) {
-    auto blas = reinterpret_cast<VAccelerationStructure*>(as[i]);
-
-    VkAccelerationStructureInstanceKHR objInstance = {};
-    for(int x=0; x<3; ++x)
-      for(int y=0; y<4; ++y)
-        objInstance.transform.matrix[x][y] = inst[i].mat.at(y,x);
-    objInstance.instanceCustomIndex                    = inst[i].id;
-    objInstance.mask                                   = inst[i].mask;
-    objInstance.instanceShaderBindingTableRecordOffset = 0;
-    objInstance.flags                                  = nativeFormat(inst[i].flags);
-    objInstance.accelerationStructureReference         = blas->toDeviceAddress(dx);
-
-    pBuf.handler->update(&objInstance, i*sizeof(objInstance), sizeof(objInstance));
-    }
+  dx.vkGetAccelerationStructureBuildSizes(dx.device.impl,
+                                          VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
+                                          &buildGeometryInfo,
+                                          &numInstances,
+                                          &buildSizesInfo);
+  return buildSizesInfo;
+  }
 
-  auto  scratch = dx.dataMgr().allocStagingMemory(nullptr,buildSizesInfo.buildScratchSize,MemUsage::ScratchBuffer,BufferHeap::Device);
-  DSharedPtr<AbstractGraphicsApi::Buffer*> pScratch(new VBuffer(std::move(scratch)));
+void VTopAccelerationStructure::create(VkDeviceSize size) {
+  data = owner.allocator.alloc(nullptr, size, MemUsage::AsStorage, BufferHeap::Device);
 
   VkAccelerationStructureCreateInfoKHR createInfo = {};
-  createInfo.sType         = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR,
+  createInfo.sType         = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
   createInfo.pNext         = nullptr;
   createInfo.createFlags   = 0;
   createInfo.buffer        = data.impl;
   createInfo.offset        = 0;
-  createInfo.size          = buildSizesInfo.accelerationStructureSize;
+  createInfo.size          = size;
   createInfo.type          = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
   createInfo.deviceAddress = VK_NULL_HANDLE;
-  vkCreateAccelerationStructure(device, &createInfo, nullptr, &impl);
-
-  DSharedPtr<AbstractGraphicsApi::AccelerationStructure*> pThis(this);
-
-  auto cmd = dx.dataMgr().get();
-  cmd->begin();
-  cmd->hold(pScratch);
-  cmd->hold(pBuf);
-  cmd->hold(pThis);
-  cmd->buildTlas(impl,data,*pBuf.handler,uint32_t(asSize),*pScratch.handler);
-  cmd->end();
-
-  // dx.dataMgr().waitFor(this);
-  dx.dataMgr().submit(std::move(cmd));
+  vkAssert(owner.vkCreateAccelerationStructure(owner.device.impl, &createInfo, nullptr, &impl));
   }
 
-VTopAccelerationStructure::~VTopAccelerationStructure() {
-  auto device = owner.device.impl;
-  owner.vkDestroyAccelerationStructure(device,impl,nullptr);
+void VTopAccelerationStructure::allocScratch() {
+  // persistent: good for both full rebuild and refit
+  const auto   sz   = buildSizes(owner, maxInstances);
+  const size_t size = size_t(std::max(sz.buildScratchSize, sz.updateScratchSize));
+  scratch = owner.allocator.alloc(nullptr, std::max<size_t>(size,1), MemUsage::ScratchBuffer, BufferHeap::Device);
   }
 
 #endif
@@ -17,8 +17,9 @@ struct VBlasBuildCtx : AbstractGraphicsApi::BlasBuildCtx {
                     const VBuffer& ibo, size_t iboSz, size_t ioffset, IndexClass icls);
 
   VkAccelerationStructureBuildSizesInfoKHR    buildSizes(VDevice& dx) const;
-  VkAccelerationStructureBuildGeometryInfoKHR buildCmd  (VDevice& dx, VkAccelerationStructureKHR dest, VBuffer* scratch) const;
+  VkAccelerationStructureBuildGeometryInfoKHR buildCmd  (VDevice& dx, VkAccelerationStructureKHR dest, VBuffer* scratch, VkDeviceSize scratchOffset = 0) const;
 
+  VkBuildAccelerationStructureFlagsKHR                  flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
   std::vector<VkAccelerationStructureBuildRangeInfoKHR> ranges;
   std::vector<VkAccelerationStructureGeometryKHR>       geometry;
   std::vector<uint32_t>                                 maxPrimitiveCounts;
@@ -27,23 +28,46 @@ struct VBlasBuildCtx : AbstractGraphicsApi::BlasBuildCtx {
 class VAccelerationStructure : public AbstractGraphicsApi::AccelerationStructure {
   public:
     VAccelerationStructure(VDevice& owner, const AbstractGraphicsApi::RtGeometry* geom, size_t size);
+    VAccelerationStructure(VDevice& owner, VkDeviceSize size);
     ~VAccelerationStructure();
 
+    static void                build(VDevice& owner, const AbstractGraphicsApi::RtGeometry* geom, const size_t* geomSize, size_t count,
+                                     bool compact, DSharedPtr<AbstractGraphicsApi::AccelerationStructure*>* out);
+
     VkDeviceAddress            toDeviceAddress(VDevice& owner) const;
+    uint64_t                   deviceAddress() const override { return toDeviceAddress(owner); }
+    uint64_t                   byteSize()      const override { return data.byteSize; }
 
     VDevice&                   owner;
     VkAccelerationStructureKHR impl = VK_NULL_HANDLE;
     VBuffer                    data;
+
+  private:
+    void                       create(VkDeviceSize size);
   };
 
 class VTopAccelerationStructure : public AbstractGraphicsApi::AccelerationStructure {
   public:
     VTopAccelerationStructure(VDevice& owner, const RtInstance* inst, AccelerationStructure* const * as, size_t size);
+    VTopAccelerationStructure(VDevice& owner, size_t maxInstances);
     ~VTopAccelerationStructure();
 
+    static VkAccelerationStructureBuildSizesInfoKHR buildSizes(VDevice& owner, uint32_t numInstances);
+    void                       allocScratch();
+    uint64_t                   byteSize() const override { return data.byteSize; }
+
     VDevice&                   owner;
     VkAccelerationStructureKHR impl = VK_NULL_HANDLE;
     VBuffer                    data;
+
+    // state of GPU-side updates, as of last submit
+    VBuffer                    scratch;
+    uint32_t                   maxInstances = 0;
+    uint32_t                   numInstances = 0;
+    bool                       built        = false;
+
+  private:
+    void                       create(VkDeviceSize size);
   };
 
 }
@@ -105,7 +105,8 @@ VBuffer VAllocator::alloc(const void *mem, size_t size, MemUsage usage, BufferHe
   ret.alloc = this;
   if( MemUsage::StorageBuffer==(usage&MemUsage::StorageBuffer) ||
       MemUsage::TransferDst  ==(usage&MemUsage::TransferDst) ||
-      MemUsage::AsStorage    ==(usage&MemUsage::AsStorage)) {
+      MemUsage::AsStorage    ==(usage&MemUsage::AsStorage) ||
+      MemUsage::ScratchBuffer==(usage&MemUsage::ScratchBuffer)) {
     ret.nonUniqId = nextId();
     }
 
@@ -153,6 +154,8 @@ VBuffer VAllocator::alloc(const void *mem, size_t size, MemUsage usage, BufferHe
     createInfo.usage |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
 
   vkAssert(vkCreateBuffer(dev,&createInfo,nullptr,&ret.impl));
+  ret.usage    = createInfo.usage;
+  ret.byteSize = createInfo.size;
 
   MemRequirements memRq={};
   getMemoryRequirements(memRq,ret.impl);
@@ -199,19 +202,19 @@ VBuffer VAllocator::alloc(const void *mem, size_t size, MemUsage usage, BufferHe
   throw std::system_error(Tempest::GraphicsErrc::OutOfVideoMemory);
   }
 
-VTexture VAllocator::alloc(const Pixmap& pm, uint32_t mip, VkFormat format) {
+VTexture VAllocator::alloc(const uint32_t w, const uint32_t h, const uint32_t mip, TextureFormat frm) {
   VTexture ret;
   ret.alloc     = this;
 
   VkImageCreateInfo imageInfo = {};
   imageInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
   imageInfo.imageType     = VK_IMAGE_TYPE_2D;
-  imageInfo.extent.width  = pm.w();
-  imageInfo.extent.height = pm.h();
+  imageInfo.extent.width  = w;
+  imageInfo.extent.height = h;
   imageInfo.extent.depth  = 1;
   imageInfo.mipLevels     = mip;
   imageInfo.arrayLayers   = 1;
-  imageInfo.format        = format;
+  imageInfo.format        = nativeFormat(frm);
   imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
   imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
   imageInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
@@ -237,7 +240,7 @@ VTexture VAllocator::alloc(const Pixmap& pm, uint32_t mip, VkFormat format) {
 
   ret.format       = imageInfo.format;
   ret.mipCnt       = mip;
-  ret.isFilterable = (provider.device->props.hasFilteredFormat(pm.format()));
+  ret.isFilterable = (provider.device->props.hasFilteredFormat(frm));
   ret.createViews(dev);
   return ret;
   }
@@ -310,6 +313,122 @@ void VAllocator::free(VTexture &buf) {
     allocator.free(buf.page);
   }
 
+void VAllocator::memoryStats(MemoryStats& out) {
+  using Stats = DeviceAllocator<Provider>::Stats;
+  auto accumulate = [](MemoryStats::Usage& u, const Stats& s) {
+    u.allocated       += s.allocated;
+    u.used            += s.used;
+    u.pages           += s.pages;
+    u.dedicated       += s.dedicated;
+    u.largestFreeBlock = std::max<uint64_t>(u.largestFreeBlock,s.largestFreeBlock);
+    };
+
+  std::vector<Stats> st(out.types.size());
+  allocator.stats(st.data(),st.size());
+  for(size_t i=0; i<st.size(); ++i) {
+    auto& t = out.types[i];
+    accumulate(t,st[i]);
+    if(t.heapId<out.heaps.size())
+      accumulate(out.heaps[t.heapId],st[i]);
+    }
+  }
+
+void VAllocator::setCallback(std::function<void(const MemoryEvent&)> cb) {
+  if(cb==nullptr) {
+    allocator.setCallback(nullptr);
+    return;
+    }
+  auto* dev = provider.device;
+  allocator.setCallback([cb,dev](const DeviceAllocator<Provider>::Event& e) {
+    MemoryEvent ev;
+    switch(e.type) {
+      case DeviceAllocator<Provider>::Event::Alloc:     ev.type = MemoryEvent::Allocate;     break;
+      case DeviceAllocator<Provider>::Event::Free:      ev.type = MemoryEvent::Free;         break;
+      case DeviceAllocator<Provider>::Event::PageAlloc: ev.type = MemoryEvent::PageAllocate; break;
+      case DeviceAllocator<Provider>::Event::PageFree:  ev.type = MemoryEvent::PageFree;     break;
+      }
+    // allocator heapId is internal pool key; report vulkan memory heap, as in MemoryStats
+    ev.heapId    = dev->memoryProperties.memoryTypes[e.typeId].heapIndex;
+    ev.typeId    = e.typeId;
+    ev.size      = e.size;
+    ev.dedicated = e.dedicated;
+    cb(ev);
+    });
+  }
+
+void VAllocator::setPageSize(size_t size) {
+  // pages are addressed with 32-bit offsets
+  allocator.setDefaultPageSize(uint32_t(std::min<size_t>(std::max<size_t>(size,1),uint32_t(-1))));
+  }
+
+void VAllocator::setMovable(VBuffer& buf) {
+  std::lock_guard<std::mutex> guard(movableSync);
+  movable.insert(&buf);
+  buf.isMovable = true;
+  }
+
+void VAllocator::unsetMovable(VBuffer& buf) {
+  std::lock_guard<std::mutex> guard(movableSync);
+  movable.erase(&buf);
+  buf.isMovable = false;
+  }
+
+size_t VAllocator::defragment(size_t maxBytes, std::vector<VBuffer*>& moved, std::vector<VBuffer>& old) {
+  std::lock_guard<std::mutex> guard(movableSync);
+  if(allocator.beginDefrag(0.5f)==0) {
+    allocator.endDefrag();
+    return 0;
+    }
+
+  size_t bytes = 0;
+  old.reserve(movable.size());
+  for(auto b:movable) {
+    if(!allocator.isEvacuating(b->page))
+      continue;
+    if(bytes+b->page.size>maxBytes)
+      continue;
+    VBuffer buf = relocate(*b);
+    if(buf.page.page==nullptr)
+      continue;
+    bytes += b->page.size;
+    std::swap(b->impl,buf.impl);
+    std::swap(b->page,buf.page);
+    moved.push_back(b);
+    old.emplace_back(std::move(buf));
+    }
+
+  allocator.endDefrag();
+  return bytes;
+  }
+
+VBuffer VAllocator::relocate(const VBuffer& src) {
+  VBuffer ret;
+  ret.alloc = this;
+
+  VkBufferCreateInfo createInfo={};
+  createInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  createInfo.size        = src.byteSize;
+  createInfo.usage       = src.usage;
+  createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  vkAssert(vkCreateBuffer(dev,&createInfo,nullptr,&ret.impl));
+
+  MemRequirements memRq={};
+  getMemoryRequirements(memRq,ret.impl);
+  if((memRq.memoryTypeBits & (1u << src.page.page->typeId))==0)
+    return ret;
+
+  const size_t align = LCM(memRq.alignment,provider.device->props.nonCoherentAtomSize);
+  ret.page = allocator.relocate(src.page,memRq.size,align);
+  if(ret.page.page==nullptr)
+    return ret;
+
+  if(!commit(ret.page.page->memory,ret.page.page->mmapSync,ret.impl,ret.page.offset,nullptr,0)) {
+    allocator.free(ret.page);
+    ret.page = Allocation();
+    }
+  return ret;
+  }
+
 void VAllocator::getMemoryRequirements(MemRequirements& out,VkBuffer buf) {
   if(provider.device->props.hasMemRq2) {
     VkBufferMemoryRequirementsInfo2KHR bufInfo = {};
@@ -448,6 +567,30 @@ bool VAllocator::update(VBuffer &dest, const void *mem, size_t offset, size_t si
   return true;
   }
 
+bool VAllocator::stream(VBuffer& dest, size_t offset, size_t size, const std::function<bool(uint8_t*)>& fn) {
+  auto& page = dest.page;
+  void* data = nullptr;
+
+  VkMappedMemoryRange rgn={};
+  rgn.sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+  rgn.memory = page.page->memory;
+  rgn.offset = page.offset+offset;
+  rgn.size   = size;
+
+  size_t shift = 0;
+  alignRange(rgn,provider.device->props.nonCoherentAtomSize,shift);
+
+  std::lock_guard<std::mutex> g(page.page->mmapSync);
+  if(vkMapMemory(dev,page.page->memory,rgn.offset,rgn.size,0,&data)!=VK_SUCCESS)
+    return false;
+
+  const bool ret = fn(reinterpret_cast<uint8_t*>(data) + shift);
+
+  vkFlushMappedMemoryRanges(dev,1,&rgn);
+  vkUnmapMemory(dev,page.page->memory);
+  return ret;
+  }
+
 bool VAllocator::read(VBuffer &src, void *mem, size_t offset, size_t size) {
   auto& page = src.page;
   void* data = nullptr;
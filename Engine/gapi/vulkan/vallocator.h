@@ -1,10 +1,16 @@
 #pragma once
 
 #include <Tempest/AbstractGraphicsApi>
+#include <Tempest/MemoryStats>
 #include "vulkan_sdk.h"
 #include "gapi/deviceallocator.h"
 #include "vsamplercache.h"
 
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
 namespace Tempest {
 namespace Detail {
 
@@ -46,28 +52,47 @@ class VAllocator {
     using Allocation=typename Tempest::Detail::DeviceAllocator<Provider>::Allocation;
 
     VBuffer  alloc(const void *mem, size_t size, MemUsage usage, BufferHeap bufHeap);
-    VTexture alloc(const Pixmap &pm, uint32_t mip, VkFormat format);
+    VTexture alloc(const uint32_t w, const uint32_t h, const uint32_t mip, TextureFormat frm);
     VTexture alloc(const uint32_t w, const uint32_t h, const uint32_t d, const uint32_t mip, TextureFormat frm, bool imageStore);
     void     free(Allocation& page);
     void     free(VTexture& buf);
 
     bool     fill  (VBuffer& dest, uint32_t    mem, size_t offset, size_t size);
     bool     update(VBuffer& dest, const void *mem, size_t offset, size_t size);
+    // maps range of host-visible buffer and lets 'fn' write into it
+    bool     stream(VBuffer& dest, size_t offset, size_t size, const std::function<bool(uint8_t* mem)>& fn);
     bool     read  (VBuffer& src,        void *mem, size_t offset, size_t size);
 
     VkSampler updateSampler(const Sampler& s);
 
+    // fills usage fields of out.types and out.heaps; both are expected to be sized and have heapId set
+    void     memoryStats(MemoryStats& out);
+    void     setCallback(std::function<void(const MemoryEvent&)> cb);
+    void     setPageSize(size_t size);
+
+    // buffers, that defragmentation is allowed to move
+    void     setMovable  (VBuffer& buf);
+    void     unsetMovable(VBuffer& buf);
+    // switches movable buffers from sparse pages to new storage; content is not copied.
+    // Previous storage goes to 'old[i]', pairwise with 'moved[i]'; caller copies it and keeps it, while GPU may use it.
+    // Returns bytes moved
+    size_t   defragment(size_t maxBytes, std::vector<VBuffer*>& moved, std::vector<VBuffer>& old);
+
   private:
     VkDevice                          dev=nullptr;
     Provider                          provider;
     VSamplerCache                     samplers;
     Detail::DeviceAllocator<Provider> allocator{provider};
 
+    std::mutex                        movableSync;
+    std::unordered_set<VBuffer*>      movable;
+
     void getMemoryRequirements   (MemRequirements& out, VkBuffer buf);
     void getImgMemoryRequirements(MemRequirements& out, VkImage  img);
     void alignRange(VkMappedMemoryRange& rgn, size_t nonCoherentAtomSize, size_t &shift);
 
     Allocation allocMemory(const MemRequirements& rq, const uint32_t heapId, const uint32_t typeId, bool hostVisible);
+    VBuffer    relocate(const VBuffer& src);
 
     bool commit(VkDeviceMemory dev, std::mutex& mmapSync, VkBuffer dest, size_t offset, const void *mem, size_t size);
     bool commit(VkDeviceMemory dev, std::mutex& mmapSync, VkImage  dest, size_t offset);
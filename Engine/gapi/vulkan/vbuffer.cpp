@@ -14,6 +14,10 @@ VBuffer::VBuffer(VBuffer &&other) {
   }
 
 VBuffer::~VBuffer() {
+  if(isMovable) {
+    alloc->unsetMovable(*this);
+    alloc->device()->onMovableDestroyed(*this);
+    }
   if(impl!=VK_NULL_HANDLE)
     vkDestroyBuffer(alloc->device()->device.impl,impl,nullptr);
   if(alloc!=nullptr)
@@ -21,8 +25,12 @@ VBuffer::~VBuffer() {
   }
 
 VBuffer& VBuffer::operator=(VBuffer&& other) {
+  // registry of movable buffers holds pointers
+  assert(!isMovable && !other.isMovable);
   std::swap(impl,      other.impl);
   std::swap(nonUniqId, other.nonUniqId);
+  std::swap(usage,     other.usage);
+  std::swap(byteSize,  other.byteSize);
   std::swap(alloc,     other.alloc);
   std::swap(page,      other.page);
   return *this;
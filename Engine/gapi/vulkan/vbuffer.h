@@ -26,6 +26,12 @@ class VBuffer : public AbstractGraphicsApi::Buffer {
     VkBuffer               impl      = VK_NULL_HANDLE;
     NonUniqResId           nonUniqId = NonUniqResId::I_None;
 
+    // creation parameters, to recreate buffer on defragmentation
+    VkBufferUsageFlags     usage     = 0;
+    VkDeviceSize           byteSize  = 0;
+    // registered in VAllocator, can be moved by VAllocator::defragment
+    bool                   isMovable = false;
+
   private:
     VAllocator*            alloc=nullptr;
     VAllocator::Allocation page={};
@@ -111,6 +111,9 @@ static void toStage(VDevice& dev, VkPipelineStageFlags2KHR& stage, VkAccessFlagB
       ret |= VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR;
       acc |= VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
       }
+    // ray-query: TLAS is read from shader
+    if((rs&ResourceAccess::UavReadGr)==ResourceAccess::UavReadGr || (rs&ResourceAccess::UavReadComp)==ResourceAccess::UavReadComp)
+      acc |= VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR;
     }
 
   // memory barriers
@@ -187,6 +190,9 @@ VCommandBuffer::VCommandBuffer(VDevice& device, VkCommandPoolCreateFlags flags)
   }
 
 VCommandBuffer::~VCommandBuffer() {
+  if(prof!=nullptr)
+    device.gpuProf->detach(prof);
+
   if(impl!=nullptr) {
     vkFreeCommandBuffers(device.device.impl,pool.impl,1,&impl);
     }
@@ -230,6 +236,7 @@ void VCommandBuffer::begin(bool tranfer) {
   curVbo = VK_NULL_HANDLE;
   if(chunks.size()>0)
     reset();
+  tlasState.clear();
 
   if(tranfer)
     resState.clearReaders();
@@ -243,6 +250,14 @@ void VCommandBuffer::begin(bool tranfer) {
     beginInfo.pInheritanceInfo = nullptr;
     vkAssert(vkBeginCommandBuffer(impl,&beginInfo));
     }
+
+  profStack.clear();
+  statsZone = uint32_t(-1);
+  statsOpen = false;
+  if(device.gpuProf!=nullptr) {
+    device.gpuProf->detach(prof);
+    prof = device.gpuProf->attach();
+    }
   }
 
 void VCommandBuffer::begin() {
@@ -258,6 +273,8 @@ void VCommandBuffer::end() {
   resState.finalize(*this);
   state = NoRecording;
 
+  while(!profStack.empty())
+    endZone();
   pushChunk();
   }
 
@@ -270,6 +287,7 @@ void VCommandBuffer::beginRendering(const AttachmentDesc* desc, size_t descSize,
                                     const TextureFormat* frm,
                                     AbstractGraphicsApi::Texture** att,
                                     AbstractGraphicsApi::Swapchain** sw, const uint32_t* imgId) {
+  statsSuspend();
   for(size_t i=0; i<descSize; ++i) {
     if(sw[i]!=nullptr)
       addDependency(*reinterpret_cast<VSwapchain*>(sw[i]),imgId[i]);
@@ -386,6 +404,7 @@ void VCommandBuffer::beginRendering(const AttachmentDesc* desc, size_t descSize,
     vkCmdBeginRenderPass(impl, &info, VK_SUBPASS_CONTENTS_INLINE);
     }
   state = RenderPass;
+  statsResume();
 
   // setup dynamic state
   // https://www.khronos.org/registry/vulkan/specs/1.1-extensions/html/vkspec.html#pipelines-dynamic-state
@@ -398,12 +417,14 @@ void VCommandBuffer::beginRendering(const AttachmentDesc* desc, size_t descSize,
   }
 
 void VCommandBuffer::endRendering() {
+  statsSuspend();
   if(device.props.hasDynRendering) {
     device.vkCmdEndRenderingKHR(impl);
     } else {
     vkCmdEndRenderPass(impl);
     }
   state = PostRenderPass;
+  statsResume();
   }
 
 void VCommandBuffer::setPipeline(AbstractGraphicsApi::Pipeline& p) {
@@ -591,6 +612,44 @@ void VCommandBuffer::setDebugMarker(std::string_view tag) {
     }
   }
 
+void VCommandBuffer::beginZone(std::string_view name) {
+  if(prof==nullptr)
+    return;
+  const uint32_t depth = uint32_t(profStack.size());
+  const uint32_t id    = device.gpuProf->beginZone(*prof,impl,name,depth);
+  profStack.push_back(id);
+  if(depth==0) {
+    // statistics are collected only for top-level zones: queries of same type can't nest
+    statsZone = id;
+    statsResume();
+    }
+  }
+
+void VCommandBuffer::endZone() {
+  if(prof==nullptr || profStack.empty())
+    return;
+  const uint32_t id = profStack.back();
+  profStack.pop_back();
+  if(profStack.empty()) {
+    statsSuspend();
+    statsZone = uint32_t(-1);
+    }
+  device.gpuProf->endZone(*prof,impl,id);
+  }
+
+void VCommandBuffer::statsSuspend() {
+  if(!statsOpen)
+    return;
+  device.gpuProf->endStats(*prof,impl);
+  statsOpen = false;
+  }
+
+void VCommandBuffer::statsResume() {
+  if(statsOpen || statsZone==uint32_t(-1) || impl==nullptr)
+    return;
+  statsOpen = device.gpuProf->beginStats(*prof,impl,statsZone);
+  }
+
 void VCommandBuffer::copy(AbstractGraphicsApi::Buffer& dstBuf, size_t offsetDest, const AbstractGraphicsApi::Buffer &srcBuf, size_t offsetSrc, size_t size) {
   auto& src = reinterpret_cast<const VBuffer&>(srcBuf);
   auto& dst = reinterpret_cast<VBuffer&>(dstBuf);
@@ -752,16 +811,66 @@ void VCommandBuffer::buildBlas(VkAccelerationStructureKHR dest, AbstractGraphics
   device.vkCmdBuildAccelerationStructures(impl, 1, &buildGeometryInfo, &pbuildRangeInfo);
   }
 
+void VCommandBuffer::buildBlas(VAccelerationStructure* const* dest, const VBlasBuildCtx* ctx, const VkDeviceSize* scratchOffset, size_t cnt,
+                               AbstractGraphicsApi::Buffer& scratch) {
+  auto& sbo = reinterpret_cast<VBuffer&>(scratch);
+
+  // scratch memory is reused from previous batch - WaW
+  resState.onUavUsage(NonUniqResId::I_None, sbo.nonUniqId, PipelineStage::S_RtAs);
+  for(size_t i=0; i<cnt; ++i)
+    resState.onUavUsage(NonUniqResId::I_None, dest[i]->data.nonUniqId, PipelineStage::S_RtAs);
+  resState.flush(*this);
+
+  SmallArray<VkAccelerationStructureBuildGeometryInfoKHR,32> info(cnt);
+  SmallArray<const VkAccelerationStructureBuildRangeInfoKHR*,32> range(cnt);
+  for(size_t i=0; i<cnt; ++i) {
+    info [i] = ctx[i].buildCmd(device, dest[i]->impl, &sbo, scratchOffset[i]);
+    range[i] = ctx[i].ranges.data();
+    }
+  device.vkCmdBuildAccelerationStructures(impl, uint32_t(cnt), info.get(), range.get());
+  }
+
+void VCommandBuffer::queryCompactedSize(VkQueryPool pool, VAccelerationStructure* const* as, size_t cnt) {
+  for(size_t i=0; i<cnt; ++i)
+    resState.onUavUsage(as[i]->data.nonUniqId, NonUniqResId::I_None, PipelineStage::S_RtAs);
+  resState.flush(*this);
+
+  SmallArray<VkAccelerationStructureKHR,32> vas(cnt);
+  for(size_t i=0; i<cnt; ++i)
+    vas[i] = as[i]->impl;
+
+  vkCmdResetQueryPool(impl, pool, 0, uint32_t(cnt));
+  device.vkCmdWriteAccelerationStructuresProperties(impl, uint32_t(cnt), vas.get(),
+                                                    VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR, pool, 0);
+  }
+
+void VCommandBuffer::compactBlas(VAccelerationStructure& dest, const VAccelerationStructure& src) {
+  resState.onUavUsage(src.data.nonUniqId, dest.data.nonUniqId, PipelineStage::S_RtAs);
+  resState.flush(*this);
+
+  VkCopyAccelerationStructureInfoKHR info = {};
+  info.sType = VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR;
+  info.pNext = nullptr;
+  info.src   = src.impl;
+  info.dst   = dest.impl;
+  info.mode  = VK_COPY_ACCELERATION_STRUCTURE_MODE_COMPACT_KHR;
+  device.vkCmdCopyAccelerationStructure(impl, &info);
+  }
+
 void VCommandBuffer::buildTlas(VkAccelerationStructureKHR dest,
                                AbstractGraphicsApi::Buffer& tbo,
-                               const AbstractGraphicsApi::Buffer& instances, uint32_t numInstances,
-                               AbstractGraphicsApi::Buffer& scratch) {
+                               const AbstractGraphicsApi::Buffer& instances, size_t instOffset, uint32_t numInstances,
+                               AbstractGraphicsApi::Buffer& scratch, bool update) {
+  auto& ibo = reinterpret_cast<const VBuffer&>(instances);
+  auto& sbo = reinterpret_cast<const VBuffer&>(scratch);
+  auto& dbo = reinterpret_cast<const VBuffer&>(tbo);
+
   VkAccelerationStructureGeometryInstancesDataKHR geometryInstancesData = {};
   geometryInstancesData.sType                 = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
   geometryInstancesData.pNext                 = NULL;
   geometryInstancesData.arrayOfPointers       = VK_FALSE;
   if(numInstances>0)
-    geometryInstancesData.data.deviceAddress  = reinterpret_cast<const VBuffer&>(instances).toDeviceAddress(device);
+    geometryInstancesData.data.deviceAddress  = ibo.toDeviceAddress(device) + instOffset;
 
   VkAccelerationStructureGeometryKHR geometry = {};
   geometry.sType                              = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
@@ -775,13 +884,13 @@ void VCommandBuffer::buildTlas(VkAccelerationStructureKHR dest,
   buildGeometryInfo.pNext                     = nullptr;
   buildGeometryInfo.type                      = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
   buildGeometryInfo.flags                     = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
-  buildGeometryInfo.mode                      = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
-  buildGeometryInfo.srcAccelerationStructure  = VK_NULL_HANDLE;
+  buildGeometryInfo.mode                      = update ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR : VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+  buildGeometryInfo.srcAccelerationStructure  = update ? dest : VK_NULL_HANDLE;
   buildGeometryInfo.dstAccelerationStructure  = dest;
   buildGeometryInfo.geometryCount             = 1;
   buildGeometryInfo.pGeometries               = &geometry;
   buildGeometryInfo.ppGeometries              = nullptr;
-  buildGeometryInfo.scratchData.deviceAddress = reinterpret_cast<const VBuffer&>(scratch).toDeviceAddress(device);
+  buildGeometryInfo.scratchData.deviceAddress = sbo.toDeviceAddress(device);
 
   VkAccelerationStructureBuildRangeInfoKHR buildRangeInfo = {};
   buildRangeInfo.primitiveCount               = numInstances;
@@ -789,14 +898,45 @@ void VCommandBuffer::buildTlas(VkAccelerationStructureKHR dest,
   buildRangeInfo.firstVertex                  = 0;
   buildRangeInfo.transformOffset              = 0;
 
-  // make sure TLAS is ready
-  resState.onUavUsage(NonUniqResId::I_None, reinterpret_cast<const VBuffer&>(tbo).nonUniqId, PipelineStage::S_RtAs);
+  // make sure TLAS is not in use; instances can come from compute shader
+  const NonUniqResId read  = (numInstances>0 ? ibo.nonUniqId : NonUniqResId::I_None) | (update ? dbo.nonUniqId : NonUniqResId::I_None);
+  const NonUniqResId write = dbo.nonUniqId | sbo.nonUniqId;
+  resState.onUavUsage(read, write, PipelineStage::S_RtAs);
   resState.flush(*this);
 
   VkAccelerationStructureBuildRangeInfoKHR* pbuildRangeInfo = &buildRangeInfo;
   device.vkCmdBuildAccelerationStructures(impl, 1, &buildGeometryInfo, &pbuildRangeInfo);
   }
 
+void VCommandBuffer::updateTlas(AbstractGraphicsApi::AccelerationStructure& as, const AbstractGraphicsApi::Buffer& instances,
+                                size_t offset, size_t count, bool refit) {
+  auto& tlas = reinterpret_cast<VTopAccelerationStructure&>(as);
+  if(count>tlas.maxInstances)
+    throw std::system_error(Tempest::GraphicsErrc::InvalidAccelerationStructure);
+  if(tlas.scratch.impl==VK_NULL_HANDLE)
+    tlas.allocScratch();
+
+  TlasState* st = nullptr;
+  for(auto& i:tlasState)
+    if(i.tlas==&tlas) {
+      st = &i;
+      break;
+      }
+
+  // refit requires the same instance count as previous build
+  bool update = false;
+  if(st!=nullptr) {
+    update = refit && st->count==count;
+    } else {
+    // first use in this command buffer: rely on last submitted build, recheck on submit
+    update = refit && tlas.built && tlas.numInstances==count;
+    tlasState.push_back({&tlas, update, tlas.numInstances, 0});
+    st = &tlasState.back();
+    }
+  buildTlas(tlas.impl, tlas.data, instances, offset, uint32_t(count), tlas.scratch, update);
+  st->count = uint32_t(count);
+  }
+
 void VCommandBuffer::copy(AbstractGraphicsApi::Buffer& dstBuf, size_t offset,
                           AbstractGraphicsApi::Texture& srcTex, uint32_t width, uint32_t height, uint32_t mip) {
   auto& dst = reinterpret_cast<VBuffer&>(dstBuf);
@@ -1027,6 +1167,7 @@ void VCommandBuffer::vkCmdPipelineBarrier2(VkCommandBuffer impl, const VkDepende
 
 void VCommandBuffer::pushChunk() {
   if(impl!=nullptr) {
+    statsSuspend();
     vkAssert(vkEndCommandBuffer(impl));
     Chunk ch;
     ch.impl = impl;
@@ -1106,12 +1247,18 @@ void VMeshCommandBuffer::pushChunk() {
   if(cbTask!=nullptr) {
     auto& ms = *device.meshHelper;
     device.vkCmdDebugMarkerEnd(cbTask);
+    if(prof!=nullptr)
+      device.gpuProf->endZone(*prof,cbTask,taskZone);
 
     VkDebugMarkerMarkerInfoEXT info = {};
     info.sType       = VK_STRUCTURE_TYPE_DEBUG_MARKER_MARKER_INFO_EXT;
     info.pMarkerName = "task-shader-lut";
     device.vkCmdDebugMarkerBegin(cbTask, &info);
+    if(prof!=nullptr)
+      taskZone = device.gpuProf->beginZone(*prof,cbTask,"task-shader-lut",0);
     ms.taskEpiloguePass(cbTask,uint32_t(meshIndirectId));
+    if(prof!=nullptr)
+      device.gpuProf->endZone(*prof,cbTask,taskZone);
     device.vkCmdDebugMarkerEnd(cbTask);
 
     vkAssert(vkEndCommandBuffer(cbTask));
@@ -1124,12 +1271,18 @@ void VMeshCommandBuffer::pushChunk() {
   if(cbMesh!=nullptr) {
     auto& ms = *device.meshHelper;
     device.vkCmdDebugMarkerEnd(cbMesh);
+    if(prof!=nullptr)
+      device.gpuProf->endZone(*prof,cbMesh,meshZone);
 
     VkDebugMarkerMarkerInfoEXT info = {};
     info.sType       = VK_STRUCTURE_TYPE_DEBUG_MARKER_MARKER_INFO_EXT;
     info.pMarkerName = "mesh-shader-sort";
     device.vkCmdDebugMarkerBegin(cbMesh, &info);
+    if(prof!=nullptr)
+      meshZone = device.gpuProf->beginZone(*prof,cbMesh,"mesh-shader-sort",0);
     ms.sortPass(cbMesh,uint32_t(meshIndirectId));
+    if(prof!=nullptr)
+      device.gpuProf->endZone(*prof,cbMesh,meshZone);
     device.vkCmdDebugMarkerEnd(cbMesh);
 
     vkAssert(vkEndCommandBuffer(cbMesh));
@@ -1168,6 +1321,8 @@ void VMeshCommandBuffer::setPipeline(AbstractGraphicsApi::Pipeline& p) {
     info.sType       = VK_STRUCTURE_TYPE_DEBUG_MARKER_MARKER_INFO_EXT;
     info.pMarkerName = "task-shader-emulated";
     device.vkCmdDebugMarkerBegin(cbTask, &info);
+    if(prof!=nullptr)
+      taskZone = device.gpuProf->beginZone(*prof,cbTask,"task-shader-emulated",0);
     }
 
   if(cbMesh==VK_NULL_HANDLE) {
@@ -1188,6 +1343,8 @@ void VMeshCommandBuffer::setPipeline(AbstractGraphicsApi::Pipeline& p) {
     info.sType       = VK_STRUCTURE_TYPE_DEBUG_MARKER_MARKER_INFO_EXT;
     info.pMarkerName = "mesh-shader-emulated";
     device.vkCmdDebugMarkerBegin(cbMesh, &info);
+    if(prof!=nullptr)
+      meshZone = device.gpuProf->beginZone(*prof,cbMesh,"mesh-shader-emulated",0);
     }
 
   if(meshIndirectId==0)
@@ -1237,6 +1394,8 @@ void VMeshCommandBuffer::dispatchMesh(size_t x, size_t y, size_t z) {
   VPipeline& px = reinterpret_cast<VPipeline&>(*curDrawPipeline);
   if(px.meshPipeline()==VK_NULL_HANDLE)
     return;
+  // deferred mesh shading restores only gl_WorkGroupID.x in vertex stage
+  assert(!px.isMeshDeferred() || (y==1 && z==1));
 
   auto& ms = *device.meshHelper;
   ms.drawCompute(cbTask, cbMesh, taskIndirectId, meshIndirectId, x,y,z);
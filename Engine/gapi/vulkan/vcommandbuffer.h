@@ -6,6 +6,7 @@
 #include "gapi/resourcestate.h"
 #include "vcommandpool.h"
 #include "vframebuffermap.h"
+#include "vprofiler.h"
 #include "vswapchain.h"
 
 #include "../utility/smallarray.h"
@@ -20,6 +21,9 @@ class VDescriptorArray;
 class VPipeline;
 class VBuffer;
 class VTexture;
+class VAccelerationStructure;
+class VTopAccelerationStructure;
+struct VBlasBuildCtx;
 
 class VCommandBuffer:public AbstractGraphicsApi::CommandBuffer {
   public:
@@ -54,6 +58,8 @@ class VCommandBuffer:public AbstractGraphicsApi::CommandBuffer {
     void setViewport(const Rect& r) override;
     void setScissor (const Rect& r) override;
     void setDebugMarker(std::string_view tag) override;
+    void beginZone(std::string_view name) override;
+    void endZone() override;
 
     void setPipeline(AbstractGraphicsApi::Pipeline& p) override;
     void setBytes   (AbstractGraphicsApi::Pipeline& p, const void* data, size_t size) override;
@@ -82,7 +88,7 @@ class VCommandBuffer:public AbstractGraphicsApi::CommandBuffer {
     void generateMipmap(AbstractGraphicsApi::Texture& image, uint32_t texWidth, uint32_t texHeight, uint32_t mipLevels) override;
 
     void copy(AbstractGraphicsApi::Texture& dest, size_t width, size_t height, size_t mip, const AbstractGraphicsApi::Buffer&  src, size_t offset);
-    void copy(AbstractGraphicsApi::Buffer&  dest, size_t offsetDest, const AbstractGraphicsApi::Buffer& src, size_t offsetSrc, size_t size);
+    void copy(AbstractGraphicsApi::Buffer&  dest, size_t offsetDest, const AbstractGraphicsApi::Buffer& src, size_t offsetSrc, size_t size) override;
     void copy(AbstractGraphicsApi::Buffer&  dest, size_t offsetDest, const void* src, size_t size);
     void fill(AbstractGraphicsApi::Texture& dest, uint32_t val);
     void fill(AbstractGraphicsApi::Buffer&  dest, size_t offsetDest, uint32_t val, size_t size);
@@ -95,16 +101,31 @@ class VCommandBuffer:public AbstractGraphicsApi::CommandBuffer {
 
     void buildBlas(VkAccelerationStructureKHR dest, AbstractGraphicsApi::Buffer& bbo,
                    AbstractGraphicsApi::BlasBuildCtx& ctx, AbstractGraphicsApi::Buffer& scratch);
+    void buildBlas(VAccelerationStructure* const* dest, const VBlasBuildCtx* ctx, const VkDeviceSize* scratchOffset, size_t cnt,
+                   AbstractGraphicsApi::Buffer& scratch);
+    void queryCompactedSize(VkQueryPool pool, VAccelerationStructure* const* as, size_t cnt);
+    void compactBlas(VAccelerationStructure& dest, const VAccelerationStructure& src);
 
     void buildTlas(VkAccelerationStructureKHR dest, AbstractGraphicsApi::Buffer& tbo,
-                   const AbstractGraphicsApi::Buffer& instances, uint32_t numInstances,
-                   AbstractGraphicsApi::Buffer& scratch);
+                   const AbstractGraphicsApi::Buffer& instances, size_t instOffset, uint32_t numInstances,
+                   AbstractGraphicsApi::Buffer& scratch, bool update);
+    void updateTlas(AbstractGraphicsApi::AccelerationStructure& tlas, const AbstractGraphicsApi::Buffer& instances,
+                    size_t offset, size_t count, bool refit) override;
 
     struct Chunk {
       VkCommandBuffer impl = nullptr;
       };
+    // TLAS state left by this command buffer; validated and applied in VDevice::submit
+    struct TlasState {
+      VTopAccelerationStructure* tlas   = nullptr;
+      bool                       refit  = false; // first update is a refit of tlas, as it was built with 'base' instances
+      uint32_t                   base   = 0;
+      uint32_t                   count  = 0;
+      };
     Detail::SmallList<Chunk,32>    chunks;
     std::vector<VSwapchain::Sync*> swapchainSync;
+    std::vector<TlasState>         tlasState;
+    VProfiler::Batch*              prof = nullptr;
 
   protected:
     void addDependency(VSwapchain& s, size_t imgId);
@@ -116,6 +137,10 @@ class VCommandBuffer:public AbstractGraphicsApi::CommandBuffer {
     virtual void pushChunk();
     virtual void newChunk();
 
+    // pipeline statistics query can't cross render-pass or command-buffer boundaries
+    void statsSuspend();
+    void statsResume();
+
     void bindVbo(const VBuffer& vbo, size_t stride);
 
     struct PipelineInfo:VkPipelineRenderingCreateInfoKHR {
@@ -138,6 +163,10 @@ class VCommandBuffer:public AbstractGraphicsApi::CommandBuffer {
     VkPipelineLayout                        pipelineLayout  = VK_NULL_HANDLE;
 
     bool                                    isDbgRegion = false;
+
+    std::vector<uint32_t>                   profStack;
+    uint32_t                                statsZone = uint32_t(-1);
+    bool                                    statsOpen = false;
   };
 
 class VMeshCommandBuffer:public VCommandBuffer {
@@ -157,6 +186,8 @@ class VMeshCommandBuffer:public VCommandBuffer {
     VkCommandBuffer                         cbMesh         = nullptr;
     uint32_t                                taskIndirectId = 0;
     uint32_t                                meshIndirectId = 0;
+    uint32_t                                taskZone       = uint32_t(-1);
+    uint32_t                                meshZone       = uint32_t(-1);
 
   friend class VMeshletHelper;
   };
@@ -11,6 +11,8 @@
 
 #include "utility/smallarray.h"
 
+#include <algorithm>
+
 using namespace Tempest;
 using namespace Tempest::Detail;
 
@@ -31,30 +33,15 @@ VDescriptorArray::VDescriptorArray(VDevice& device, VPipelineLay& vlay)
       runtimeArrays[i] = lx.arraySize;
       }
     } else {
-    std::lock_guard<Detail::SpinLock> guard(vlay.sync);
-    for(auto& i:vlay.pool) {
-      if(i.freeCount==0)
-        continue;
-      impl = allocDescSet(i.impl,lay.handler->impl);
-      if(impl!=VK_NULL_HANDLE) {
-        pool=&i;
-        pool->freeCount--;
-        return;
-        }
-      }
-
-    vlay.pool.emplace_back();
-    auto& b = vlay.pool.back();
-    b.impl  = allocPool(vlay);
-    impl    = allocDescSet(b.impl,lay.handler->impl);
-    if(impl==VK_NULL_HANDLE)
-      throw std::bad_alloc();
-    pool = &b;
-    pool->freeCount--;
+    allocFromPool();
     }
   }
 
 VDescriptorArray::~VDescriptorArray() {
+  if(isTracked) {
+    std::lock_guard<std::mutex> guard(device.descSync);
+    device.descMovable.erase(this);
+    }
   if(impl==VK_NULL_HANDLE)
     return;
 
@@ -71,6 +58,30 @@ VDescriptorArray::~VDescriptorArray() {
     }
   }
 
+void VDescriptorArray::allocFromPool() {
+  auto& vlay = *lay.handler;
+  std::lock_guard<Detail::SpinLock> guard(vlay.sync);
+  for(auto& i:vlay.pool) {
+    if(i.freeCount==0)
+      continue;
+    impl = allocDescSet(i.impl,vlay.impl);
+    if(impl!=VK_NULL_HANDLE) {
+      pool=&i;
+      pool->freeCount--;
+      return;
+      }
+    }
+
+  vlay.pool.emplace_back();
+  auto& b = vlay.pool.back();
+  b.impl  = allocPool(vlay);
+  impl    = allocDescSet(b.impl,vlay.impl);
+  if(impl==VK_NULL_HANDLE)
+    throw std::bad_alloc();
+  pool = &b;
+  pool->freeCount--;
+  }
+
 VkDescriptorPool VDescriptorArray::allocPool(const VPipelineLay& lay) {
   VkDescriptorPoolSize poolSize[int(ShaderReflection::Class::Count)] = {};
   size_t               pSize=0;
@@ -206,6 +217,7 @@ void VDescriptorArray::set(size_t id, Tempest::AbstractGraphicsApi::Buffer* b, s
 
   uav[id].buf     = b;
   uavUsage.durty |= (buf!=nullptr && buf->nonUniqId!=0);
+  trackMovable(id,&buf,1,offset,false);
   }
 
 void VDescriptorArray::set(size_t id, const Sampler& smp) {
@@ -244,7 +256,10 @@ void VDescriptorArray::setTlas(size_t id, AbstractGraphicsApi::AccelerationStruc
   descriptorWrite.descriptorCount = 1;
 
   vkUpdateDescriptorSets(dev, 1, &descriptorWrite, 0, nullptr);
-  // uavUsage.durty = true;
+
+  // TLAS can be rebuilt on GPU (Encoder::updateTlas)
+  uav[id].buf     = &memory->data;
+  uavUsage.durty |= (memory->data.nonUniqId!=0);
   }
 
 void VDescriptorArray::set(size_t id, AbstractGraphicsApi::Texture** t, size_t cnt, const Sampler& smp, uint32_t mipLevel) {
@@ -339,6 +354,7 @@ void VDescriptorArray::set(size_t id, AbstractGraphicsApi::Buffer** b, size_t cn
   descriptorWrite.pBufferInfo     = bufInfo.get();
 
   vkUpdateDescriptorSets(dev, 1, &descriptorWrite, 0, nullptr);
+  trackMovable(id,reinterpret_cast<VBuffer* const*>(b),cnt,0,true);
   }
 
 void VDescriptorArray::ssboBarriers(ResourceState& res, PipelineStage st) {
@@ -362,6 +378,136 @@ void VDescriptorArray::ssboBarriers(ResourceState& res, PipelineStage st) {
   res.onUavUsage(uavUsage,st);
   }
 
+void VDescriptorArray::onBuffersMoved(const std::vector<VBuffer*>& moved, std::vector<Retired>& retired) {
+  bool affected = false;
+  for(auto& i:movable)
+    affected |= std::binary_search(moved.begin(),moved.end(),i.buf);
+  if(!affected)
+    return;
+
+  // set can be bound in command buffers in flight: it must not be updated, write a patched copy instead
+  VkDevice dev  = device.device.impl;
+  auto&    vlay = *lay.handler;
+  Retired  prev;
+  prev.lay           = lay;
+  prev.pool          = pool;
+  prev.dedicatedPool = dedicatedPool;
+  prev.impl          = impl;
+
+  if(isRuntimeSized()) {
+    auto lx = vlay.create(runtimeArrays);
+    dedicatedPool = allocPool(vlay);
+    impl          = allocDescSet(dedicatedPool,lx.dLay);
+    if(impl==VK_NULL_HANDLE) {
+      vkDestroyDescriptorPool(dev,dedicatedPool,nullptr);
+      dedicatedPool = prev.dedicatedPool;
+      impl          = prev.impl;
+      throw std::bad_alloc();
+      }
+    dedicatedLayout = lx.pLay;
+    } else {
+    try {
+      allocFromPool();
+      }
+    catch(...) {
+      pool = prev.pool;
+      impl = prev.impl;
+      throw;
+      }
+    }
+  retired.push_back(prev);
+
+  SmallArray<VkCopyDescriptorSet,16> cpy(vlay.lay.size());
+  uint32_t                           cnt = 0;
+  for(size_t i=0; i<vlay.lay.size(); ++i) {
+    auto& lx = vlay.lay[i];
+    if(lx.stage==ShaderReflection::None)
+      continue;
+    VkCopyDescriptorSet& cx = cpy[cnt];
+    cx.sType           = VK_STRUCTURE_TYPE_COPY_DESCRIPTOR_SET;
+    cx.pNext           = nullptr;
+    cx.srcSet          = prev.impl;
+    cx.srcBinding      = uint32_t(i);
+    cx.srcArrayElement = 0;
+    cx.dstSet          = impl;
+    cx.dstBinding      = uint32_t(i);
+    cx.dstArrayElement = 0;
+    cx.descriptorCount = lx.runtimeSized ? runtimeArrays[i] : lx.arraySize;
+    if(cx.descriptorCount>0)
+      ++cnt;
+    }
+  vkUpdateDescriptorSets(dev,0,nullptr,cnt,cpy.get());
+
+  for(auto& i:movable) {
+    if(!std::binary_search(moved.begin(),moved.end(),i.buf))
+      continue;
+    auto& slot = vlay.lay[i.id];
+
+    VkDescriptorBufferInfo bufferInfo = {};
+    bufferInfo.buffer = i.buf->impl;
+    bufferInfo.offset = i.offset;
+    bufferInfo.range  = i.array ? VK_WHOLE_SIZE : slot.byteSize;
+
+    VkWriteDescriptorSet descriptorWrite = {};
+    descriptorWrite.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet          = impl;
+    descriptorWrite.dstBinding      = i.id;
+    descriptorWrite.dstArrayElement = i.element;
+    descriptorWrite.descriptorType  = i.array ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : nativeFormat(slot.cls);
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pBufferInfo     = &bufferInfo;
+
+    vkUpdateDescriptorSets(dev, 1, &descriptorWrite, 0, nullptr);
+    }
+  }
+
+void VDescriptorArray::release(VDevice& device, Retired& r) {
+  VkDevice dev = device.device.impl;
+  if(r.dedicatedPool!=VK_NULL_HANDLE) {
+    vkFreeDescriptorSets(dev,r.dedicatedPool,1,&r.impl);
+    vkDestroyDescriptorPool(dev,r.dedicatedPool,nullptr);
+    } else {
+    std::lock_guard<Detail::SpinLock> guard(r.lay.handler->sync);
+    vkFreeDescriptorSets(dev,r.pool->impl,1,&r.impl);
+    r.pool->freeCount++;
+    }
+  r.impl = VK_NULL_HANDLE;
+  r.lay  = DSharedPtr<VPipelineLay*>();
+  }
+
+bool VDescriptorArray::untrackMovable(const VBuffer& buf) {
+  movable.erase(std::remove_if(movable.begin(),movable.end(),[&buf](const MovableBinding& b){
+    return b.buf==&buf;
+    }),movable.end());
+  isTracked = !movable.empty();
+  return isTracked;
+  }
+
+void VDescriptorArray::trackMovable(size_t id, VBuffer* const* buf, size_t cnt, size_t offset, bool array) {
+  std::lock_guard<std::mutex> guard(device.descSync);
+  movable.erase(std::remove_if(movable.begin(),movable.end(),[id](const MovableBinding& b){
+    return b.id==id;
+    }),movable.end());
+
+  for(size_t i=0; i<cnt; ++i) {
+    if(buf[i]==nullptr || !buf[i]->isMovable)
+      continue;
+    MovableBinding b;
+    b.id      = uint32_t(id);
+    b.element = uint32_t(i);
+    b.buf     = buf[i];
+    b.offset  = offset;
+    b.array   = array;
+    movable.push_back(b);
+    }
+
+  if(!movable.empty() && !isTracked)
+    device.descMovable.insert(this);
+  if(movable.empty() && isTracked)
+    device.descMovable.erase(this);
+  isTracked = !movable.empty();
+  }
+
 bool VDescriptorArray::isRuntimeSized() const {
   return runtimeArrays.size()>0;
   }
@@ -11,6 +11,7 @@ namespace Tempest {
 namespace Detail {
 
 class VPipelineLay;
+class VBuffer;
 
 class VDescriptorArray : public AbstractGraphicsApi::Desc {
   public:
@@ -31,6 +32,21 @@ class VDescriptorArray : public AbstractGraphicsApi::Desc {
 
     void                      ssboBarriers(Detail::ResourceState& res, PipelineStage st) override;
 
+    // descriptor set, replaced while it may still be in use by GPU
+    struct Retired {
+      DSharedPtr<VPipelineLay*> lay;
+      VPipelineLay::Pool*       pool          = nullptr;
+      VkDescriptorPool          dedicatedPool = VK_NULL_HANDLE;
+      VkDescriptorSet           impl          = VK_NULL_HANDLE;
+      };
+
+    // buffers were relocated by defragmentation; 'moved' is sorted. Switches to a patched copy of descriptor set,
+    // previous one is appended to 'retired' and has to be released, once command buffers in flight are done
+    void                      onBuffersMoved(const std::vector<VBuffer*>& moved, std::vector<Retired>& retired);
+    static void               release(VDevice& device, Retired& r);
+    // drops bindings of destroyed buffer; returns false, if no movable bindings left. VDevice::descSync must be held
+    bool                      untrackMovable(const VBuffer& buf);
+
     bool                      isRuntimeSized() const;
     VkPipelineLayout          pipelineLayout() { return dedicatedLayout; }
 
@@ -52,10 +68,22 @@ class VDescriptorArray : public AbstractGraphicsApi::Desc {
     SmallArray<UAV,16>        uav;
     ResourceState::Usage      uavUsage;
 
+    struct MovableBinding {
+      uint32_t id      = 0;
+      uint32_t element = 0;
+      VBuffer* buf     = nullptr;
+      size_t   offset  = 0;
+      bool     array   = false;
+      };
+    std::vector<MovableBinding> movable;
+    bool                      isTracked = false;
+
+    void                      allocFromPool();
     VkDescriptorPool          allocPool(const VPipelineLay& lay);
     VkDescriptorSet           allocDescSet(VkDescriptorPool pool, VkDescriptorSetLayout lay);
     static void               addPoolSize(VkDescriptorPoolSize* p, size_t& sz, uint32_t cnt, VkDescriptorType elt);
     void                      reallocSet(size_t id, uint32_t oldRuntimeSz);
+    void                      trackMovable(size_t id, VBuffer* const* buf, size_t cnt, size_t offset, bool array);
   };
 
 }}
@@ -6,12 +6,16 @@
 #include "vfence.h"
 #include "vswapchain.h"
 #include "vmeshlethelper.h"
+#include "vprofiler.h"
+#include "vdescriptorarray.h"
+#include "vaccelerationstructure.h"
 #include "system/api/x11api.h"
 
 #include <Tempest/Log>
 #include <Tempest/Platform>
 #include <cstring>
 #include <array>
+#include <algorithm>
 
 #if defined(__WINDOWS__)
 #  define VK_USE_PLATFORM_WIN32_KHR
@@ -60,7 +64,9 @@ VDevice::VDevice(VulkanInstance &api, std::string_view gpuName)
 
 VDevice::~VDevice(){
   vkDeviceWaitIdle(device.impl);
+  retireDefrag(true);
   data.reset();
+  gpuProf.reset();
   }
 
 void VDevice::implInit(VulkanInstance &api, VkPhysicalDevice pdev) {
@@ -73,6 +79,8 @@ void VDevice::implInit(VulkanInstance &api, VkPhysicalDevice pdev) {
   physicalDevice = pdev;
   allocator.setDevice(*this);
   data.reset(new DataMgr(*this));
+  if(VProfiler::isSupported(*this))
+    gpuProf.reset(new VProfiler(*this));
   }
 
 VkSurfaceKHR VDevice::createSurface(void* hwnd) {
@@ -159,6 +167,8 @@ void VDevice::deviceQueueProps(VulkanInstance::VkProp& prop, VkPhysicalDevice de
 
   prop.graphicsFamily = graphics;
   prop.presentFamily  = present;
+  if(graphics!=uint32_t(-1))
+    prop.timestampValidBits = queueFamilies[graphics].timestampValidBits;
   }
 
 bool VDevice::checkDeviceExtensionSupport(VkPhysicalDevice device) {
@@ -261,6 +271,9 @@ void VDevice::createLogicalDevice(VulkanInstance &api, VkPhysicalDevice pdev) {
   if(props.hasRobustness2) {
     rqExt.push_back(VK_EXT_ROBUSTNESS_2_EXTENSION_NAME);
     }
+  if(props.hasMemoryBudget) {
+    rqExt.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
 
   VkPhysicalDeviceFeatures supportedFeatures={};
   vkGetPhysicalDeviceFeatures(pdev,&supportedFeatures);
@@ -274,6 +287,7 @@ void VDevice::createLogicalDevice(VulkanInstance &api, VkPhysicalDevice pdev) {
 
   deviceFeatures.vertexPipelineStoresAndAtomics = supportedFeatures.vertexPipelineStoresAndAtomics;
   deviceFeatures.fragmentStoresAndAtomics       = supportedFeatures.fragmentStoresAndAtomics;
+  deviceFeatures.pipelineStatisticsQuery        = supportedFeatures.pipelineStatisticsQuery;
 
   VkDeviceCreateInfo createInfo = {};
   createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -408,6 +422,8 @@ void VDevice::createLogicalDevice(VulkanInstance &api, VkPhysicalDevice pdev) {
     vkDestroyAccelerationStructure       = PFN_vkDestroyAccelerationStructureKHR(vkGetDeviceProcAddr(device.impl,"vkDestroyAccelerationStructureKHR"));
     vkGetAccelerationStructureBuildSizes = PFN_vkGetAccelerationStructureBuildSizesKHR(vkGetDeviceProcAddr(device.impl,"vkGetAccelerationStructureBuildSizesKHR"));
     vkCmdBuildAccelerationStructures     = PFN_vkCmdBuildAccelerationStructuresKHR(vkGetDeviceProcAddr(device.impl,"vkCmdBuildAccelerationStructuresKHR"));
+    vkCmdCopyAccelerationStructure       = PFN_vkCmdCopyAccelerationStructureKHR(vkGetDeviceProcAddr(device.impl,"vkCmdCopyAccelerationStructureKHR"));
+    vkCmdWriteAccelerationStructuresProperties = PFN_vkCmdWriteAccelerationStructuresPropertiesKHR(vkGetDeviceProcAddr(device.impl,"vkCmdWriteAccelerationStructuresPropertiesKHR"));
     }
 
   if(props.raytracing.rayQuery && props.hasDeviceAddress) {
@@ -419,6 +435,10 @@ void VDevice::createLogicalDevice(VulkanInstance &api, VkPhysicalDevice pdev) {
     vkCmdDrawMeshTasksIndirect = PFN_vkCmdDrawMeshTasksIndirectEXT(vkGetDeviceProcAddr(device.impl,"vkCmdDrawMeshTasksIndirectEXT"));
     }
 
+  if(props.hasMemoryBudget) {
+    vkGetPhysicalDeviceMemoryProperties2 = PFN_vkGetPhysicalDeviceMemoryProperties2KHR(vkGetInstanceProcAddr(instance,"vkGetPhysicalDeviceMemoryProperties2KHR"));
+    }
+
   if(props.hasDebugMarker) {
     vkCmdDebugMarkerBegin = PFN_vkCmdDebugMarkerBeginEXT(vkGetDeviceProcAddr(device.impl,"vkCmdDebugMarkerBeginEXT"));
     vkCmdDebugMarkerEnd   = PFN_vkCmdDebugMarkerEndEXT  (vkGetDeviceProcAddr(device.impl,"vkCmdDebugMarkerEndEXT"));
@@ -484,6 +504,122 @@ void VDevice::allocMeshletHelper() {
 
 void VDevice::waitIdle() {
   waitIdleSync(queues,sizeof(queues)/sizeof(queues[0]));
+  retireDefrag(true);
+  }
+
+GpuProfiler* VDevice::profiler() {
+  return gpuProf.get();
+  }
+
+bool VDevice::memoryStats(MemoryStats& out) {
+  out.heaps.resize(memoryProperties.memoryHeapCount);
+  out.types.resize(memoryProperties.memoryTypeCount);
+
+  for(uint32_t i=0; i<memoryProperties.memoryHeapCount; ++i) {
+    auto& h = out.heaps[i];
+    h.size        = memoryProperties.memoryHeaps[i].size;
+    h.deviceLocal = (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)!=0;
+    }
+  for(uint32_t i=0; i<memoryProperties.memoryTypeCount; ++i) {
+    auto& t = out.types[i];
+    t.heapId      = memoryProperties.memoryTypes[i].heapIndex;
+    t.deviceLocal = (memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)!=0;
+    t.hostVisible = (memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)!=0;
+    }
+  allocator.memoryStats(out);
+
+  VkPhysicalDeviceMemoryBudgetPropertiesEXT budget = {};
+  budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+  if(vkGetPhysicalDeviceMemoryProperties2!=nullptr) {
+    VkPhysicalDeviceMemoryProperties2KHR mem = {};
+    mem.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR;
+    mem.pNext = &budget;
+    vkGetPhysicalDeviceMemoryProperties2(physicalDevice,&mem);
+    out.hasBudget = true;
+    }
+
+  for(uint32_t i=0; i<memoryProperties.memoryHeapCount; ++i) {
+    auto& h = out.heaps[i];
+    if(out.hasBudget) {
+      h.budget = budget.heapBudget[i];
+      h.usage  = budget.heapUsage[i];
+      } else {
+      h.budget = h.size;
+      h.usage  = h.allocated;
+      }
+    }
+  return true;
+  }
+
+bool VDevice::setMemoryCallback(std::function<void(const MemoryEvent&)> cb) {
+  allocator.setCallback(std::move(cb));
+  return true;
+  }
+
+size_t VDevice::defragment(size_t maxBytes) {
+  retireDefrag(false);
+
+  DefragPass pass;
+  const size_t ret = allocator.defragment(maxBytes,pass.moved,pass.old);
+  if(pass.moved.empty())
+    return ret;
+
+  // no waits for GPU: queue order puts the copy after work in flight, fence tells when old storage is unused
+  pass.cmd = dataMgr().get();
+  pass.cmd->begin(true);
+  for(size_t i=0; i<pass.moved.size(); ++i)
+    pass.cmd->copy(*pass.moved[i],0,pass.old[i],0,size_t(pass.old[i].byteSize));
+  pass.cmd->end();
+  submit(*pass.cmd,&pass.cmd->fence);
+
+  std::sort(pass.moved.begin(),pass.moved.end());
+
+  std::lock_guard<std::mutex> guard(defragSync);
+  defragPending.emplace_back(std::move(pass));
+
+  auto& p = defragPending.back();
+  std::lock_guard<std::mutex> dguard(descSync);
+  for(auto d:descMovable)
+    d->onBuffersMoved(p.moved,p.desc);
+  return ret;
+  }
+
+void VDevice::retireDefrag(bool wait) {
+  std::lock_guard<std::mutex> guard(defragSync);
+  for(size_t i=0; i<defragPending.size();) {
+    auto& p = defragPending[i];
+    if(wait)
+      p.cmd->wait();
+    else if(!p.cmd->wait(0)) {
+      ++i;
+      continue;
+      }
+    for(auto& d:p.desc)
+      VDescriptorArray::release(*this,d);
+    defragPending.erase(defragPending.begin()+ptrdiff_t(i));
+    }
+  }
+
+bool VDevice::setMemoryPageSize(size_t size) {
+  allocator.setPageSize(size);
+  return true;
+  }
+
+void VDevice::onMovableDestroyed(const VBuffer& buf) {
+  {
+  std::lock_guard<std::mutex> guard(defragSync);
+  for(auto& i:defragPending) {
+    // copy into this buffer may be in flight
+    if(std::binary_search(i.moved.begin(),i.moved.end(),&buf))
+      i.cmd->wait();
+    }
+  }
+  std::lock_guard<std::mutex> guard(descSync);
+  for(auto i=descMovable.begin(); i!=descMovable.end();) {
+    if((*i)->untrackMovable(buf))
+      ++i; else
+      i = descMovable.erase(i);
+    }
   }
 
 void VDevice::waitIdleSync(VDevice::Queue* q, size_t n) {
@@ -500,6 +636,12 @@ void VDevice::waitIdleSync(VDevice::Queue* q, size_t n) {
   }
 
 void VDevice::submit(VCommandBuffer& cmd, VFence* sync) {
+  for(auto& t:cmd.tlasState) {
+    // refit recorded against a build, that was replaced or never submitted
+    if(t.refit && !(t.tlas->built && t.tlas->numInstances==t.base))
+      throw std::system_error(Tempest::GraphicsErrc::InvalidAccelerationStructure);
+    }
+
   size_t waitCnt = 0;
   for(auto& s:cmd.swapchainSync) {
     if(s->state!=Detail::VSwapchain::S_Pending)
@@ -524,6 +666,13 @@ void VDevice::submit(VCommandBuffer& cmd, VFence* sync) {
     fence = sync->impl;
     }
 
+  // query pools must be reset before any chunk, including mesh-emulation chunks
+  VkCommandBuffer profReset = VK_NULL_HANDLE;
+  if(cmd.prof!=nullptr && gpuProf!=nullptr)
+    profReset = gpuProf->onSubmit(*cmd.prof);
+  const size_t first = (profReset!=VK_NULL_HANDLE) ? 1 : 0;
+  const size_t count = cmd.chunks.size() + first;
+
   if(vkQueueSubmit2!=nullptr) {
     SmallArray<VkSemaphoreSubmitInfoKHR, 32> wait2(waitCnt);
     for(size_t i=0; i<waitCnt; ++i) {
@@ -534,20 +683,24 @@ void VDevice::submit(VCommandBuffer& cmd, VFence* sync) {
       wait2[i].stageMask   = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
       wait2[i].deviceIndex = 0;
       }
-    SmallArray<VkCommandBufferSubmitInfoKHR,MaxCmdChunks> flat(cmd.chunks.size());
+    SmallArray<VkCommandBufferSubmitInfoKHR,MaxCmdChunks> flat(count);
     auto node = cmd.chunks.begin();
-    for(size_t i=0; i<cmd.chunks.size(); ++i) {
+    for(size_t i=0; i<count; ++i) {
       flat[i].sType         = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO_KHR;
       flat[i].pNext         = nullptr;
-      flat[i].commandBuffer = node->val[i%cmd.chunks.chunkSize].impl;
       flat[i].deviceMask    = 0;
-      if(i+1==cmd.chunks.chunkSize)
+      if(i<first) {
+        flat[i].commandBuffer = profReset;
+        continue;
+        }
+      flat[i].commandBuffer = node->val[(i-first)%cmd.chunks.chunkSize].impl;
+      if(i-first+1==cmd.chunks.chunkSize)
         node = node->next;
       }
 
     VkSubmitInfo2KHR submitInfo = {};
     submitInfo.sType                  = VK_STRUCTURE_TYPE_SUBMIT_INFO_2_KHR;
-    submitInfo.commandBufferInfoCount = uint32_t(cmd.chunks.size());
+    submitInfo.commandBufferInfoCount = uint32_t(count);
     submitInfo.pCommandBufferInfos    = flat.get();
     submitInfo.waitSemaphoreInfoCount = uint32_t(waitCnt);
     submitInfo.pWaitSemaphoreInfos    = wait2.get();
@@ -560,16 +713,20 @@ void VDevice::submit(VCommandBuffer& cmd, VFence* sync) {
       waitStages[i] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
       }
 
-    SmallArray<VkCommandBuffer,MaxCmdChunks> flat(cmd.chunks.size());
+    SmallArray<VkCommandBuffer,MaxCmdChunks> flat(count);
     auto node = cmd.chunks.begin();
-    for(size_t i=0; i<cmd.chunks.size(); ++i) {
-      flat[i] = node->val[i%cmd.chunks.chunkSize].impl;
-      if(i+1==cmd.chunks.chunkSize)
+    for(size_t i=0; i<count; ++i) {
+      if(i<first) {
+        flat[i] = profReset;
+        continue;
+        }
+      flat[i] = node->val[(i-first)%cmd.chunks.chunkSize].impl;
+      if(i-first+1==cmd.chunks.chunkSize)
         node = node->next;
       }
     VkSubmitInfo submitInfo = {};
     submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = uint32_t(cmd.chunks.size());
+    submitInfo.commandBufferCount = uint32_t(count);
     submitInfo.pCommandBuffers    = flat.get();
     submitInfo.waitSemaphoreCount = uint32_t(waitCnt);
     submitInfo.pWaitSemaphores    = wait.get();
@@ -577,6 +734,16 @@ void VDevice::submit(VCommandBuffer& cmd, VFence* sync) {
 
     graphicsQueue->submit(1,&submitInfo,fence);
     }
+
+  if(profReset!=VK_NULL_HANDLE) {
+    // empty submit: fence is signaled, once all previous work on queue is complete
+    graphicsQueue->submit(0,static_cast<const VkSubmitInfo*>(nullptr),gpuProf->fence(*cmd.prof));
+    }
+
+  for(auto& t:cmd.tlasState) {
+    t.tlas->numInstances = t.count;
+    t.tlas->built        = true;
+    }
   }
 
 void VDevice::Queue::waitIdle() {
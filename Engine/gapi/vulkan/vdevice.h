@@ -4,11 +4,13 @@
 #include <Tempest/RenderState>
 #include <Tempest/AccelerationStructure>
 #include <stdexcept>
+#include <unordered_set>
 #include "gapi/vulkan/vbuffer.h"
 #include "vulkan_sdk.h"
 
 #include "vallocator.h"
 #include "vcommandbuffer.h"
+#include "vdescriptorarray.h"
 #include "vswapchain.h"
 #include "vfence.h"
 #include "vulkanapi_impl.h"
@@ -24,6 +26,8 @@ namespace Detail {
 class VFence;
 class VTexture;
 class VMeshletHelper;
+class VProfiler;
+class VDescriptorArray;
 
 inline void vkAssert(VkResult code){
   if(T_LIKELY(code==VkResult::VK_SUCCESS))
@@ -98,6 +102,14 @@ inline VkFormat nativeFormat(TextureFormat f) {
       return VK_FORMAT_B10G11R11_UFLOAT_PACK32;
     case TextureFormat::RGBA16F:
       return VK_FORMAT_R16G16B16A16_SFLOAT;
+    case TextureFormat::BC4:
+      return VK_FORMAT_BC4_UNORM_BLOCK;
+    case TextureFormat::BC5:
+      return VK_FORMAT_BC5_UNORM_BLOCK;
+    case TextureFormat::BC6H:
+      return VK_FORMAT_BC6H_UFLOAT_BLOCK;
+    case TextureFormat::BC7:
+      return VK_FORMAT_BC7_UNORM_BLOCK;
     }
   return VK_FORMAT_UNDEFINED;
   }
@@ -352,6 +364,12 @@ class VDevice : public AbstractGraphicsApi::Device {
     std::mutex                      meshSync;
     std::unique_ptr<VMeshletHelper> meshHelper;
 
+    std::unique_ptr<VProfiler>      gpuProf;
+
+    // descriptor sets, that reference movable buffers; patched by defragment
+    std::mutex                           descSync;
+    std::unordered_set<VDescriptorArray*> descMovable;
+
     VkProps                 props={};
 
     PFN_vkGetBufferMemoryRequirements2KHR vkGetBufferMemoryRequirements2 = nullptr;
@@ -370,14 +388,25 @@ class VDevice : public AbstractGraphicsApi::Device {
     PFN_vkDestroyAccelerationStructureKHR       vkDestroyAccelerationStructure       = nullptr;
     PFN_vkGetAccelerationStructureBuildSizesKHR vkGetAccelerationStructureBuildSizes = nullptr;
     PFN_vkCmdBuildAccelerationStructuresKHR     vkCmdBuildAccelerationStructures     = nullptr;
+    PFN_vkCmdCopyAccelerationStructureKHR       vkCmdCopyAccelerationStructure       = nullptr;
+    PFN_vkCmdWriteAccelerationStructuresPropertiesKHR vkCmdWriteAccelerationStructuresProperties = nullptr;
 
     PFN_vkCmdDrawMeshTasksEXT                   vkCmdDrawMeshTasks = nullptr;
     PFN_vkCmdDrawMeshTasksIndirectEXT           vkCmdDrawMeshTasksIndirect = nullptr;
 
+    PFN_vkGetPhysicalDeviceMemoryProperties2KHR vkGetPhysicalDeviceMemoryProperties2 = nullptr;
+
     PFN_vkCmdDebugMarkerBeginEXT                vkCmdDebugMarkerBegin = nullptr;
     PFN_vkCmdDebugMarkerEndEXT                  vkCmdDebugMarkerEnd   = nullptr;
 
     void                    waitIdle() override;
+    GpuProfiler*            profiler() override;
+    bool                    memoryStats(MemoryStats& out) override;
+    bool                    setMemoryCallback(std::function<void(const MemoryEvent&)> cb) override;
+    size_t                  defragment(size_t maxBytes) override;
+    bool                    setMemoryPageSize(size_t size) override;
+    // movable buffer is about to be destroyed: descriptor sets must not patch it anymore
+    void                    onMovableDestroyed(const VBuffer& buf);
     void                    submit(VCommandBuffer& cmd, VFence* sync);
 
     VkSurfaceKHR            createSurface(void* hwnd);
@@ -398,6 +427,18 @@ class VDevice : public AbstractGraphicsApi::Device {
     std::mutex              syncSsbo;
     VBuffer                 dummySsboVal;
 
+    // storage, replaced by defragment; released, once copy batch and work submitted before it are complete
+    struct DefragPass {
+      std::unique_ptr<DataMgr::Commands>     cmd;
+      std::vector<VBuffer*>                  moved; // sorted
+      std::vector<VBuffer>                   old;
+      std::vector<VDescriptorArray::Retired> desc;
+      };
+    std::mutex              defragSync;
+    std::vector<DefragPass> defragPending;
+
+    void                    retireDefrag(bool wait);
+
     void                    waitIdleSync(Queue* q, size_t n);
 
     void                    implInit(VulkanInstance& api, VkPhysicalDevice pdev);
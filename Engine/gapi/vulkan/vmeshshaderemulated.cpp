@@ -55,7 +55,6 @@ VMeshShaderEmulated::VMeshShaderEmulated(VDevice& device, const void *source, si
   assert(code.findExecutionModel()==spv::ExecutionModelMeshEXT);
 
   MeshConverter conv(code);
-  // conv.options.deferredMeshShading = true;
   // conv.options.varyingInSharedMem  = true;
   conv.exec();
 
@@ -87,10 +86,50 @@ VMeshShaderEmulated::VMeshShaderEmulated(VDevice& device, const void *source, si
   createInfo.pCode    = comp.opcodes();
   if(vkCreateShaderModule(device.device.impl,&createInfo,nullptr,&compPass)!=VK_SUCCESS)
     throw std::system_error(Tempest::GraphicsErrc::InvalidShaderModule);
+
+  if(device.props.deferredMeshShading) {
+    try {
+      initDeferred(device,code);
+      }
+    catch(...) {
+      vkDestroyShaderModule(device.device.impl,compPass,nullptr);
+      throw;
+      }
+    }
   }
 
 VMeshShaderEmulated::~VMeshShaderEmulated() {
   vkDestroyShaderModule(device,compPass,nullptr);
+  if(compPassDeferred!=VK_NULL_HANDLE)
+    vkDestroyShaderModule(device,compPassDeferred,nullptr);
+  if(vertDeferred!=VK_NULL_HANDLE)
+    vkDestroyShaderModule(device,vertDeferred,nullptr);
+  }
+
+void VMeshShaderEmulated::initDeferred(VDevice& device, libspirv::MutableBytecode& code) {
+  MeshConverter conv(code);
+  conv.options.deferredMeshShading = true;
+  conv.exec();
+  if(!conv.options.deferredMeshShading)
+    return; // not compatible - regular emulation only
+
+  auto& comp = conv.computeShader();
+  auto& vert = conv.vertexPassthrough();
+
+  VkShaderModuleCreateInfo createInfo = {};
+  createInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+  createInfo.codeSize = vert.size()*4u;
+  createInfo.pCode    = vert.opcodes();
+  if(vkCreateShaderModule(device.device.impl,&createInfo,nullptr,&vertDeferred)!=VK_SUCCESS)
+    throw std::system_error(Tempest::GraphicsErrc::InvalidShaderModule);
+
+  createInfo.codeSize = comp.size()*4u;
+  createInfo.pCode    = comp.opcodes();
+  if(vkCreateShaderModule(device.device.impl,&createInfo,nullptr,&compPassDeferred)!=VK_SUCCESS) {
+    vkDestroyShaderModule(device.device.impl,vertDeferred,nullptr);
+    vertDeferred = VK_NULL_HANDLE;
+    throw std::system_error(Tempest::GraphicsErrc::InvalidShaderModule);
+    }
   }
 
 #endif
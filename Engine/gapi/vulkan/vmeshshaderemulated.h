@@ -6,6 +6,10 @@
 #include "vshader.h"
 #include "vulkan_sdk.h"
 
+namespace libspirv {
+class MutableBytecode;
+}
+
 namespace Tempest {
 namespace Detail {
 
@@ -25,6 +29,13 @@ class VMeshShaderEmulated : public VShader {
     ~VMeshShaderEmulated();
 
     VkShaderModule compPass = VK_NULL_HANDLE;
+
+    // deferred variant: only indices are written by compute pass, vertices are recomputed in vertex stage
+    VkShaderModule compPassDeferred = VK_NULL_HANDLE;
+    VkShaderModule vertDeferred     = VK_NULL_HANDLE;
+
+  private:
+    void           initDeferred(VDevice& device, libspirv::MutableBytecode& code);
   };
 
 }}
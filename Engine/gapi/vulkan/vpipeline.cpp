@@ -111,7 +111,11 @@ VPipeline::VPipeline(VDevice& device, const RenderState& st, Topology tp,
         info.flags        = 0;
         info.stage.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
         info.stage.stage  = VK_SHADER_STAGE_COMPUTE_BIT;
-        info.stage.module = reinterpret_cast<const VMeshShaderEmulated*>(ms)->compPass;
+        auto& emu = *reinterpret_cast<const VMeshShaderEmulated*>(ms);
+        // deferred mode can't recover task-shader payload in vertex stage
+        this->ms.deferred = (emu.compPassDeferred!=VK_NULL_HANDLE && findShader(ShaderReflection::Stage::Task)==nullptr);
+
+        info.stage.module = this->ms.deferred ? emu.compPassDeferred : emu.compPass;
         info.stage.pName  = "main";
         info.layout       = this->ms.pipelineLayout;
         vkAssert(vkCreateComputePipelines(device.device.impl, VK_NULL_HANDLE, 1, &info, nullptr, &this->ms.compuePipeline));
@@ -297,7 +301,7 @@ VkPipeline VPipeline::initGraphicsPipeline(VkDevice device, VkPipelineLayout lay
     sh.pName  = "main";
     if(auto ms = dynamic_cast<const VMeshShaderEmulated*>(shaders[i].handler)) {
       sh.stage  = VK_SHADER_STAGE_VERTEX_BIT;
-      sh.module = ms->impl;
+      sh.module = this->ms.deferred ? ms->vertDeferred : ms->impl;
       }
     stagesCnt++;
     }
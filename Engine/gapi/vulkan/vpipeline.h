@@ -54,6 +54,7 @@ class VPipeline : public AbstractGraphicsApi::Pipeline {
 
     VkPipeline         meshPipeline() const;
     VkPipelineLayout   meshPipelineLayout() const;
+    bool               isMeshDeferred() const { return ms.deferred; }
 
   private:
     struct InstRp : Inst {
@@ -85,6 +86,7 @@ class VPipeline : public AbstractGraphicsApi::Pipeline {
     struct MeshEmulation {
       VkPipelineLayout                     pipelineLayout = VK_NULL_HANDLE;
       VkPipeline                           compuePipeline = VK_NULL_HANDLE;
+      bool                                 deferred       = false;
       };
     MeshEmulation                          ms, ts;
 
@@ -0,0 +1,253 @@
+#if defined(TEMPEST_BUILD_VULKAN)
+
+#include "vprofiler.h"
+
+#include "vdevice.h"
+
+#include <limits>
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+static const VkQueryPipelineStatisticFlags statsFlags =
+    VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+VProfiler::VProfiler(VDevice& dev)
+  :dev(dev), pool(dev,0) {
+  if(dev.props.hasPipelineStats)
+    features = features | ProfilingFlags::PipelineStatistics;
+  if(dev.props.timestampValidBits<64)
+    tsMask = (uint64_t(1) << dev.props.timestampValidBits) - 1;
+  tsPeriod = dev.props.timestampPeriod;
+  }
+
+VProfiler::~VProfiler() {
+  auto device = dev.device.impl;
+  for(auto& b:batches) {
+    vkDestroyFence(device,b->fence,nullptr);
+    vkDestroyQueryPool(device,b->ts,nullptr);
+    if(b->stats!=VK_NULL_HANDLE)
+      vkDestroyQueryPool(device,b->stats,nullptr);
+    }
+  }
+
+bool VProfiler::isSupported(const VDevice& dev) {
+  return dev.props.timestampPeriod>0 && dev.props.timestampValidBits>0;
+  }
+
+ProfilingFlags VProfiler::caps() const {
+  return features;
+  }
+
+VProfiler::Batch* VProfiler::attach() {
+  const auto flg = flags();
+  if(flg==ProfilingFlags::None)
+    return nullptr;
+
+  std::lock_guard<std::mutex> guard(sync);
+  Batch* ret = nullptr;
+  for(auto& b:batches)
+    if(!b->attached && !b->pending) {
+      ret = b.get();
+      break;
+      }
+  if(ret==nullptr) {
+    batches.emplace_back(createBatch());
+    ret = batches.back().get();
+    }
+
+  ret->attached   = true;
+  ret->withStats  = (flg & ProfilingFlags::PipelineStatistics)==ProfilingFlags::PipelineStatistics;
+  ret->tsCount    = 0;
+  ret->statsCount = 0;
+  ret->zones.clear();
+  return ret;
+  }
+
+void VProfiler::detach(Batch* b) {
+  if(b==nullptr)
+    return;
+  std::lock_guard<std::mutex> guard(sync);
+  b->attached = false;
+  }
+
+VkCommandBuffer VProfiler::onSubmit(Batch& b) {
+  std::lock_guard<std::mutex> guard(sync);
+  if(b.tsCount==0 && b.statsCount==0)
+    return VK_NULL_HANDLE;
+
+  if(b.pending) {
+    // resubmission, before previous results were collected: previous results are lost
+    std::vector<GpuZone> none;
+    onResolved(b.frame,none);
+    b.pending = false;
+    }
+  if(b.fenced) {
+    // command buffer can't be pending twice, so previous submission is complete, or about to be
+    auto device = dev.device.impl;
+    vkAssert(vkWaitForFences(device,1,&b.fence,VK_TRUE,std::numeric_limits<uint64_t>::max()));
+    vkAssert(vkResetFences(device,1,&b.fence));
+    }
+  b.fenced = true;
+
+  b.frame = GpuProfiler::onSubmit();
+  if(b.frame!=uint64_t(-1))
+    b.pending = true;
+  return b.reset;
+  }
+
+uint32_t VProfiler::beginZone(Batch& b, VkCommandBuffer cmd, std::string_view name, uint32_t depth) {
+  if(b.tsCount+2>MaxTimestamps)
+    return uint32_t(-1);
+
+  Zone z;
+  z.name  = std::string(name);
+  z.depth = depth;
+  z.ts    = b.tsCount;
+  b.tsCount += 2;
+
+  vkCmdWriteTimestamp(cmd,VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,b.ts,z.ts);
+  b.zones.push_back(std::move(z));
+  return uint32_t(b.zones.size()-1);
+  }
+
+void VProfiler::endZone(Batch& b, VkCommandBuffer cmd, uint32_t zone) {
+  if(zone==uint32_t(-1))
+    return;
+  vkCmdWriteTimestamp(cmd,VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,b.ts,b.zones[zone].ts+1);
+  }
+
+bool VProfiler::beginStats(Batch& b, VkCommandBuffer cmd, uint32_t zone) {
+  if(!b.withStats || zone==uint32_t(-1) || b.statsCount>=MaxStatsQuery)
+    return false;
+  auto& z = b.zones[zone];
+  if(z.statsCount==0)
+    z.statsFirst = b.statsCount;
+  z.statsCount++;
+
+  vkCmdBeginQuery(cmd,b.stats,b.statsCount,0);
+  b.statsCount++;
+  return true;
+  }
+
+void VProfiler::endStats(Batch& b, VkCommandBuffer cmd) {
+  vkCmdEndQuery(cmd,b.stats,b.statsCount-1);
+  }
+
+void VProfiler::poll() {
+  std::lock_guard<std::mutex> guard(sync);
+  for(auto& b:batches) {
+    if(!b->pending)
+      continue;
+    std::vector<GpuZone> zones;
+    if(!resolve(*b,zones))
+      continue;
+    b->pending = false;
+    onResolved(b->frame,zones);
+    }
+  }
+
+bool VProfiler::resolve(Batch& b, std::vector<GpuZone>& out) {
+  auto device = dev.device.impl;
+
+  // until reset command buffer is executed, pools still hold results of previous use of this batch
+  VkResult status = vkGetFenceStatus(device,b.fence);
+  if(status==VK_NOT_READY)
+    return false;
+  vkAssert(status);
+
+  std::vector<uint64_t> ts(b.tsCount);
+  if(b.tsCount>0) {
+    // no VK_QUERY_RESULT_WAIT_BIT: VK_NOT_READY, while submission is in flight
+    VkResult code = vkGetQueryPoolResults(device,b.ts,0,b.tsCount,ts.size()*sizeof(uint64_t),ts.data(),
+                                          sizeof(uint64_t),VK_QUERY_RESULT_64_BIT);
+    if(code==VK_NOT_READY)
+      return false;
+    vkAssert(code);
+    }
+
+  std::vector<uint64_t> stats(b.statsCount*StatsCount);
+  if(b.statsCount>0) {
+    VkResult code = vkGetQueryPoolResults(device,b.stats,0,b.statsCount,stats.size()*sizeof(uint64_t),stats.data(),
+                                          StatsCount*sizeof(uint64_t),VK_QUERY_RESULT_64_BIT);
+    if(code==VK_NOT_READY)
+      return false;
+    vkAssert(code);
+    }
+
+  out.resize(b.zones.size());
+  for(size_t i=0; i<b.zones.size(); ++i) {
+    auto& z = b.zones[i];
+    auto& r = out[i];
+    r.name  = z.name;
+    r.depth = z.depth;
+    r.begin = uint64_t(double(ts[z.ts  ]&tsMask)*tsPeriod);
+    r.end   = uint64_t(double(ts[z.ts+1]&tsMask)*tsPeriod);
+    if(r.end<r.begin)
+      r.end = r.begin;
+
+    r.hasStats = z.statsCount>0;
+    for(uint32_t q=z.statsFirst; q<z.statsFirst+z.statsCount; ++q) {
+      // results are in order of VkQueryPipelineStatisticFlagBits
+      const uint64_t* s = &stats[q*StatsCount];
+      r.stats.inputVertices   += s[0];
+      r.stats.inputPrimitives += s[1];
+      r.stats.vsInvocations   += s[2];
+      r.stats.clipPrimitives  += s[3];
+      r.stats.fsInvocations   += s[4];
+      r.stats.csInvocations   += s[5];
+      }
+    }
+  return true;
+  }
+
+auto VProfiler::createBatch() -> std::unique_ptr<Batch> {
+  auto device = dev.device.impl;
+  std::unique_ptr<Batch> b(new Batch());
+
+  VkQueryPoolCreateInfo info = {};
+  info.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+  info.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+  info.queryCount = MaxTimestamps;
+  vkAssert(vkCreateQueryPool(device,&info,nullptr,&b->ts));
+
+  if((features & ProfilingFlags::PipelineStatistics)==ProfilingFlags::PipelineStatistics) {
+    VkQueryPoolCreateInfo sinfo = {};
+    sinfo.sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    sinfo.queryType          = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+    sinfo.queryCount         = MaxStatsQuery;
+    sinfo.pipelineStatistics = statsFlags;
+    vkAssert(vkCreateQueryPool(device,&sinfo,nullptr,&b->stats));
+    }
+
+  VkCommandBufferAllocateInfo allocInfo = {};
+  allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.commandPool        = pool.impl;
+  allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandBufferCount = 1;
+  vkAssert(vkAllocateCommandBuffers(device,&allocInfo,&b->reset));
+
+  VkFenceCreateInfo finfo = {};
+  finfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+  vkAssert(vkCreateFence(device,&finfo,nullptr,&b->fence));
+
+  // recorded once; same command buffer can be pending on queue more than once
+  VkCommandBufferBeginInfo beginInfo = {};
+  beginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags            = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+  beginInfo.pInheritanceInfo = nullptr;
+  vkAssert(vkBeginCommandBuffer(b->reset,&beginInfo));
+  vkCmdResetQueryPool(b->reset,b->ts,0,MaxTimestamps);
+  if(b->stats!=VK_NULL_HANDLE)
+    vkCmdResetQueryPool(b->reset,b->stats,0,MaxStatsQuery);
+  vkAssert(vkEndCommandBuffer(b->reset));
+
+  return b;
+  }
+
+#endif
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <Tempest/AbstractGraphicsApi>
+#include "vulkan_sdk.h"
+
+#include "gapi/gpuprofiler.h"
+#include "vcommandpool.h"
+
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace Tempest {
+namespace Detail {
+
+class VDevice;
+
+// timestamp and pipeline-statistics queries; one batch of query pools per recorded command buffer
+class VProfiler : public GpuProfiler {
+  public:
+    enum {
+      MaxTimestamps = 512,
+      MaxStatsQuery = 64,
+      StatsCount    = 6,
+      };
+
+    struct Zone {
+      std::string name;
+      uint32_t    depth      = 0;
+      uint32_t    ts         = 0; // begin; end is ts+1
+      uint32_t    statsFirst = 0;
+      uint32_t    statsCount = 0;
+      };
+
+    struct Batch {
+      VkQueryPool       ts         = VK_NULL_HANDLE;
+      VkQueryPool       stats      = VK_NULL_HANDLE;
+      // resets both pools; submitted in front of every submission, that uses this batch
+      VkCommandBuffer   reset      = VK_NULL_HANDLE;
+      // signaled, once last submission of this batch is complete; queries are not read before that
+      VkFence           fence      = VK_NULL_HANDLE;
+      bool              fenced     = false;
+
+      uint32_t          tsCount    = 0;
+      uint32_t          statsCount = 0;
+      std::vector<Zone> zones;
+
+      uint64_t          frame      = 0;
+      bool              withStats  = false;
+      bool              attached   = false;
+      bool              pending    = false;
+      };
+
+    explicit VProfiler(VDevice& dev);
+    ~VProfiler() override;
+
+    static bool     isSupported(const VDevice& dev);
+
+    // batch for command buffer recording; nullptr, if profiling is disabled
+    Batch*          attach();
+    void            detach(Batch* b);
+    // reset command buffer, to be submitted in front of command buffer; VK_NULL_HANDLE, if batch is empty
+    VkCommandBuffer onSubmit(Batch& b);
+    // fence, to be submitted right after command buffer, if onSubmit returned reset command buffer
+    VkFence         fence(Batch& b) const { return b.fence; }
+
+    uint32_t        beginZone(Batch& b, VkCommandBuffer cmd, std::string_view name, uint32_t depth);
+    void            endZone  (Batch& b, VkCommandBuffer cmd, uint32_t zone);
+    bool            beginStats(Batch& b, VkCommandBuffer cmd, uint32_t zone);
+    void            endStats  (Batch& b, VkCommandBuffer cmd);
+
+  protected:
+    void            poll() override;
+    ProfilingFlags  caps() const override;
+
+  private:
+    std::unique_ptr<Batch> createBatch();
+    bool            resolve(Batch& b, std::vector<GpuZone>& out);
+
+    VDevice&        dev;
+    VCommandPool    pool;
+    std::mutex      sync;
+    std::vector<std::unique_ptr<Batch>> batches;
+
+    ProfilingFlags  features      = ProfilingFlags::Timestamps;
+    uint64_t        tsMask        = uint64_t(-1);
+    double          tsPeriod      = 1;
+  };
+
+}}
@@ -42,8 +42,10 @@ bool VulkanInstance::VkProp::hasFilteredFormat(TextureFormat f) const {
   return (filteredLinearFormat&m)!=0;
   }
 
-VulkanInstance::VulkanInstance(bool validation)
-  :validation(validation) {
+VulkanInstance::VulkanInstance(ApiFlags flags)
+  :validation         ((flags&ApiFlags::Validation)==ApiFlags::Validation),
+   meshEmulation      ((flags&ApiFlags::MeshEmulation)==ApiFlags::MeshEmulation),
+   deferredMeshShading((flags&ApiFlags::DeferredMeshShading)==ApiFlags::DeferredMeshShading) {
   std::initializer_list<const char*> validationLayers={};
   if(validation) {
     validationLayers = checkValidationLayerSupport();
@@ -214,6 +216,9 @@ void VulkanInstance::deviceProps(VkPhysicalDevice physicalDevice, VkProp& c) con
   c.bufferImageGranularity = size_t(prop.limits.bufferImageGranularity);
   if(c.bufferImageGranularity==0)
     c.bufferImageGranularity=1;
+
+  if(prop.limits.timestampComputeAndGraphics!=VK_FALSE)
+    c.timestampPeriod = prop.limits.timestampPeriod;
   }
 
 void VulkanInstance::devicePropsShort(VkPhysicalDevice physicalDevice, VkProp& props) const {
@@ -263,6 +268,9 @@ void VulkanInstance::devicePropsShort(VkPhysicalDevice physicalDevice, VkProp& p
   if(checkForExt(ext,VK_EXT_DEBUG_MARKER_EXTENSION_NAME)) {
     props.hasDebugMarker = true;
     }
+  if(hasDeviceFeatures2 && checkForExt(ext,VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) {
+    props.hasMemoryBudget = true;
+    }
 
   VkPhysicalDeviceProperties devP={};
   vkGetPhysicalDeviceProperties(physicalDevice,&devP);
@@ -383,6 +391,7 @@ void VulkanInstance::devicePropsShort(VkPhysicalDevice physicalDevice, VkProp& p
     props.hasDynRendering         = (dynRendering.dynamicRendering==VK_TRUE);
     props.hasDeviceAddress        = (bdaFeatures.bufferDeviceAddress==VK_TRUE);
     props.raytracing.rayQuery     = (rayQueryFeatures.rayQuery==VK_TRUE);
+    props.raytracing.compaction   = props.raytracing.rayQuery;
     props.meshlets.taskShader     = (meshFeatures.taskShader==VK_TRUE);
     props.meshlets.meshShader     = (meshFeatures.meshShader==VK_TRUE);
     props.meshlets.maxGroups.x    = meshProperties.maxMeshWorkGroupCount[0];
@@ -395,8 +404,9 @@ void VulkanInstance::devicePropsShort(VkPhysicalDevice physicalDevice, VkProp& p
     props.accelerationStructureScratchOffsetAlignment = asProperties.minAccelerationStructureScratchOffsetAlignment;
 
     //props.meshlets.meshShader = false;
-    if(!props.meshlets.meshShader && props.hasSpirv_1_4 && false) {
+    if(!props.meshlets.meshShader && props.hasSpirv_1_4 && meshEmulation) {
       props.meshlets.meshShaderEmulated = true;
+      props.deferredMeshShading         = deferredMeshShading;
       if(props.meshlets.meshShaderEmulated) {
         props.meshlets.maxGroups.x      = devP.limits.maxComputeWorkGroupCount[0];
         props.meshlets.maxGroups.y      = devP.limits.maxComputeWorkGroupCount[1];
@@ -461,6 +471,8 @@ void VulkanInstance::devicePropsShort(VkPhysicalDevice physicalDevice, VkProp& p
   props.storeAndAtomicVs  = supportedFeatures.vertexPipelineStoresAndAtomics;
   props.storeAndAtomicFs  = supportedFeatures.fragmentStoresAndAtomics;
 
+  props.hasPipelineStats  = supportedFeatures.pipelineStatisticsQuery;
+
   props.mrt.maxColorAttachments = devP.limits.maxColorAttachments;
 
   props.compute.maxGroups.x = devP.limits.maxComputeWorkGroupCount[0];
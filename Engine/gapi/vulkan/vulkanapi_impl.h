@@ -16,7 +16,7 @@ class VFence;
 
 class VulkanInstance {
   public:
-    VulkanInstance(bool enableValidationLayers=true);
+    explicit VulkanInstance(ApiFlags flags);
     ~VulkanInstance();
 
     std::vector<AbstractGraphicsApi::Props> devices() const;
@@ -32,6 +32,10 @@ class VulkanInstance {
       size_t   bufferImageGranularity = 0;
       size_t   accelerationStructureScratchOffsetAlignment = 0;
 
+      // ns per tick; zero, if timestamps are not supported
+      float    timestampPeriod    = 0;
+      uint32_t timestampValidBits = 0;
+
       uint64_t filteredLinearFormat = 0;
       bool     hasFilteredFormat(TextureFormat f) const;
 
@@ -45,6 +49,10 @@ class VulkanInstance {
       bool     hasSpirv_1_4       = false;
       bool     hasDebugMarker     = false;
       bool     hasRobustness2     = false;
+      bool     hasPipelineStats   = false;
+      bool     hasMemoryBudget    = false;
+
+      bool     deferredMeshShading = false;
       };
 
     static bool checkForExt(const std::vector<VkExtensionProperties>& list, const char* name);
@@ -69,7 +77,9 @@ class VulkanInstance {
         const char*                 pMessage,
         void*                       pUserData);
 
-    const bool                                      validation = false;
+    const bool                                      validation          = false;
+    const bool                                      meshEmulation       = false;
+    const bool                                      deferredMeshShading = false;
     VkDebugReportCallbackEXT                        callback   = VK_NULL_HANDLE;
     PFN_vkDestroyDebugReportCallbackEXT             vkDestroyDebugReportCallbackEXT = nullptr;
   };
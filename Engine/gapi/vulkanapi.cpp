@@ -16,6 +16,7 @@
 #include "vulkan/vaccelerationstructure.h"
 
 #include "shaderreflection.h"
+#include "formats/texturefile.h"
 
 #include <Tempest/Pixmap>
 #include <Tempest/Log>
@@ -32,7 +33,7 @@ struct Tempest::VulkanApi::Impl : public VulkanInstance {
   };
 
 VulkanApi::VulkanApi(ApiFlags f) {
-  impl.reset(new Impl(ApiFlags::Validation==(f&ApiFlags::Validation)));
+  impl.reset(new Impl(f));
   }
 
 VulkanApi::~VulkanApi(){
@@ -121,17 +122,23 @@ AbstractGraphicsApi::PBuffer VulkanApi::createBuffer(AbstractGraphicsApi::Device
     return PBuffer(new VBuffer(std::move(buf)));
     }
 
-  VBuffer buf = dx.allocator.alloc(nullptr, size, usage|MemUsage::TransferDst|MemUsage::TransferSrc, BufferHeap::Device);
+  VBuffer  buf = dx.allocator.alloc(nullptr, size, usage|MemUsage::TransferDst|MemUsage::TransferSrc, BufferHeap::Device);
+  VBuffer* ret = new VBuffer(std::move(buf));
+  // acceleration structures and scratch are referenced by device address
+  if(MemUsage::ScratchBuffer!=(usage & MemUsage::ScratchBuffer) &&
+     MemUsage::AsStorage    !=(usage & MemUsage::AsStorage))
+    dx.allocator.setMovable(*ret);
+
   if(mem==nullptr && (usage&MemUsage::Initialized)==MemUsage::Initialized) {
-    DSharedPtr<VBuffer*> pbuf(new VBuffer(std::move(buf)));
+    DSharedPtr<VBuffer*> pbuf(ret);
     pbuf.handler->fill(0x0,0,size);
     return PBuffer(pbuf.handler);
     }
   if(mem==nullptr) {
-    return PBuffer(new VBuffer(std::move(buf)));
+    return PBuffer(ret);
     }
 
-  DSharedPtr<Buffer*> pbuf(new VBuffer(std::move(buf)));
+  DSharedPtr<Buffer*> pbuf(ret);
   pbuf.handler->update(mem,0,size);
   return PBuffer(pbuf.handler);
   }
@@ -140,10 +147,9 @@ AbstractGraphicsApi::PTexture VulkanApi::createTexture(AbstractGraphicsApi::Devi
   Detail::VDevice& dx     = *reinterpret_cast<Detail::VDevice*>(d);
 
   const uint32_t   size   = uint32_t(p.dataSize());
-  VkFormat         format = Detail::nativeFormat(frm);
 
   Detail::VBuffer  stage  = dx.allocator.alloc(p.data(),size,MemUsage::TransferSrc,BufferHeap::Upload);
-  Detail::VTexture buf    = dx.allocator.alloc(p,mipCnt,format);
+  Detail::VTexture buf    = dx.allocator.alloc(p.w(),p.h(),mipCnt,frm);
 
   Detail::DSharedPtr<Buffer*>  pstage(new Detail::VBuffer (std::move(stage)));
   Detail::DSharedPtr<Texture*> pbuf  (new Detail::VTexture(std::move(buf)));
@@ -182,6 +188,58 @@ AbstractGraphicsApi::PTexture VulkanApi::createTexture(AbstractGraphicsApi::Devi
   return PTexture(pbuf.handler);
   }
 
+AbstractGraphicsApi::PTexture VulkanApi::createTexture(AbstractGraphicsApi::Device* d, Detail::TextureFile& f, uint32_t mipCnt) {
+  Detail::VDevice&    dx     = *reinterpret_cast<Detail::VDevice*>(d);
+  const TextureFormat frm    = f.format();
+  const uint32_t      upload = std::min(f.mipCount(),mipCnt);
+
+  // first layer only; offsets are aligned for vkCmdCopyBufferToImage
+  size_t offset[32] = {};
+  size_t size       = 0;
+  for(uint32_t i=0; i<upload; ++i) {
+    offset[i] = size;
+    size      = ((size + f.level(0,i).size + 15)/16)*16;
+    }
+
+  Detail::VBuffer  stage = dx.allocator.alloc(nullptr,size,MemUsage::TransferSrc,BufferHeap::Upload);
+  Detail::VTexture buf   = dx.allocator.alloc(f.w(),f.h(),mipCnt,frm);
+
+  // file -> staging memory, without intermediate copy
+  const bool ok = dx.allocator.stream(stage,0,size,[&f,&offset,upload](uint8_t* mem) {
+    for(auto i:f.readOrder()) {
+      if(i>=upload)
+        continue;
+      auto& l = f.level(0,i);
+      if(!f.read(mem+offset[i],l.offset,l.size))
+        return false;
+      }
+    return true;
+    });
+  if(!ok)
+    throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+
+  Detail::DSharedPtr<Buffer*>  pstage(new Detail::VBuffer (std::move(stage)));
+  Detail::DSharedPtr<Texture*> pbuf  (new Detail::VTexture(std::move(buf)));
+
+  auto cmd = dx.dataMgr().get();
+  cmd->begin();
+  cmd->hold(pstage);
+  cmd->hold(pbuf);
+
+  cmd->barrier(*pbuf.handler, ResourceAccess::None, ResourceAccess::TransferDst, uint32_t(-1));
+  for(uint32_t i=0; i<upload; ++i) {
+    auto& l = f.level(0,i);
+    cmd->copy(*pbuf.handler,l.w,l.h,i,*pstage.handler,offset[i]);
+    }
+  cmd->barrier(*pbuf.handler, ResourceAccess::TransferDst, ResourceAccess::Sampler, uint32_t(-1));
+  if(upload<mipCnt)
+    cmd->generateMipmap(*pbuf.handler, f.w(), f.h(), mipCnt);
+  cmd->end();
+  dx.dataMgr().submit(std::move(cmd));
+
+  return PTexture(pbuf.handler);
+  }
+
 AbstractGraphicsApi::PTexture VulkanApi::createTexture(AbstractGraphicsApi::Device *d,
                                                        const uint32_t w, const uint32_t h, uint32_t mipCnt,
                                                        TextureFormat frm) {
@@ -236,11 +294,22 @@ AbstractGraphicsApi::AccelerationStructure* VulkanApi::createBottomAccelerationS
   return new VAccelerationStructure(dx, geom, size);
   }
 
+void VulkanApi::createBottomAccelerationStructs(Device* d, const RtGeometry* geom, const size_t* geomSize, size_t count,
+                                                bool compact, Detail::DSharedPtr<AccelerationStructure*>* out) {
+  auto& dx = *reinterpret_cast<VDevice*>(d);
+  VAccelerationStructure::build(dx, geom, geomSize, count, compact, out);
+  }
+
 AbstractGraphicsApi::AccelerationStructure* VulkanApi::createTopAccelerationStruct(Device* d, const RtInstance* inst, AccelerationStructure*const* as, size_t size) {
   auto& dx = *reinterpret_cast<VDevice*>(d);
   return new VTopAccelerationStructure(dx, inst, as, size);
   }
 
+AbstractGraphicsApi::AccelerationStructure* VulkanApi::createTopAccelerationStruct(Device* d, size_t maxInstances) {
+  auto& dx = *reinterpret_cast<VDevice*>(d);
+  return new VTopAccelerationStructure(dx, maxInstances);
+  }
+
 void VulkanApi::readPixels(AbstractGraphicsApi::Device *d, Pixmap& out, const PTexture t,
                            TextureFormat frm, const uint32_t w, const uint32_t h, uint32_t mip, bool storageImg) {
   auto&           dx     = *reinterpret_cast<VDevice*>(d);
@@ -36,12 +36,16 @@ class VulkanApi : public AbstractGraphicsApi {
 
     PBuffer        createBuffer (Device* d, const void *mem, size_t size, MemUsage usage, BufferHeap flg) override;
     PTexture       createTexture(Device* d, const Pixmap& p, TextureFormat frm, uint32_t mips) override;
+    PTexture       createTexture(Device* d, Detail::TextureFile& f, uint32_t mips) override;
     PTexture       createTexture(Device* d, const uint32_t w, const uint32_t h, uint32_t mips, TextureFormat frm) override;
     PTexture       createStorage(Device* d, const uint32_t w, const uint32_t h, uint32_t mips, TextureFormat frm) override;
     PTexture       createStorage(Device* d, const uint32_t w, const uint32_t h, const uint32_t depth, uint32_t mips, TextureFormat frm) override;
 
     AccelerationStructure* createBottomAccelerationStruct(Device* d, const RtGeometry* geom, size_t size) override;
+    void                   createBottomAccelerationStructs(Device* d, const RtGeometry* geom, const size_t* geomSize, size_t count,
+                                                           bool compact, Detail::DSharedPtr<AccelerationStructure*>* out) override;
     AccelerationStructure* createTopAccelerationStruct(Device* d, const RtInstance* inst, AccelerationStructure*const* as, size_t size) override;
+    AccelerationStructure* createTopAccelerationStruct(Device* d, size_t maxInstances) override;
 
     void           readPixels(Device *d, Pixmap &out, const PTexture t, TextureFormat frm,
                               const uint32_t w, const uint32_t h, uint32_t mip, bool storageImg) override;
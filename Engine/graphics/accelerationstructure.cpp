@@ -9,3 +9,37 @@ AccelerationStructure::AccelerationStructure(Device& dev, AbstractGraphicsApi::A
 bool Tempest::AccelerationStructure::isEmpty() const {
   return impl.handler==nullptr;
   }
+
+uint64_t AccelerationStructure::deviceAddress() const {
+  if(impl.handler==nullptr)
+    return 0;
+  return impl.handler->deviceAddress();
+  }
+
+uint64_t AccelerationStructure::byteSize() const {
+  if(impl.handler==nullptr)
+    return 0;
+  return impl.handler->byteSize();
+  }
+
+static_assert(sizeof(RtInstanceDesc)==64, "RtInstanceDesc must match native instance layout");
+
+RtInstanceDesc::RtInstanceDesc(const RtInstance& inst) {
+  for(int x=0; x<3; ++x)
+    for(int y=0; y<4; ++y)
+      mat[x][y] = inst.mat.at(y,x);
+
+  // same bits in Vulkan and DX12
+  uint32_t f = 0;
+  if((inst.flags & RtInstanceFlags::NonOpaque)==RtInstanceFlags::NonOpaque)
+    f |= 0x8; else
+    f |= 0x4;
+  if((inst.flags & RtInstanceFlags::CullDisable)==RtInstanceFlags::CullDisable)
+    f |= 0x1;
+  if((inst.flags & RtInstanceFlags::CullFlip)==RtInstanceFlags::CullFlip)
+    f |= 0x2;
+
+  idMask = (inst.id & 0xFFFFFF) | (uint32_t(inst.mask) << 24);
+  flags  = (f << 24);
+  blas   = inst.blas!=nullptr ? inst.blas->deviceAddress() : 0;
+  }
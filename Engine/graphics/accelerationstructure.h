@@ -30,6 +30,19 @@ inline RtInstanceFlags operator & (RtInstanceFlags a, RtInstanceFlags b){
   return RtInstanceFlags(uint16_t(a)&uint16_t(b));
   }
 
+enum class RtBuildFlags : uint8_t {
+  None    = 0x0,
+  Compact = 0x1, // query compacted size after build and copy into tight allocation
+  };
+
+inline RtBuildFlags operator | (RtBuildFlags a, RtBuildFlags b){
+  return RtBuildFlags(uint16_t(a)|uint16_t(b));
+  }
+
+inline RtBuildFlags operator & (RtBuildFlags a, RtBuildFlags b){
+  return RtBuildFlags(uint16_t(a)&uint16_t(b));
+  }
+
 class RtInstance {
   public:
   Tempest::Matrix4x4           mat   = Matrix4x4::mkIdentity();
@@ -39,6 +52,18 @@ class RtInstance {
   const AccelerationStructure* blas  = nullptr;
   };
 
+// GPU layout of TLAS instance, as consumed by Encoder::updateTlas (matches VkAccelerationStructureInstanceKHR)
+class RtInstanceDesc {
+  public:
+  RtInstanceDesc() = default;
+  RtInstanceDesc(const RtInstance& inst);
+
+  float                        mat[3][4] = {}; // row-major 3x4 transform
+  uint32_t                     idMask    = 0;  // id:24, mask:8
+  uint32_t                     flags     = 0;  // hit-group offset:24, flags:8
+  uint64_t                     blas      = 0;  // AccelerationStructure::deviceAddress()
+  };
+
 class RtGeometry {
   public:
   RtGeometry() = default;
@@ -66,7 +91,11 @@ class AccelerationStructure final {
     ~AccelerationStructure()=default;
     AccelerationStructure& operator=(AccelerationStructure&&)=default;
 
-    bool isEmpty() const;
+    bool     isEmpty() const;
+    // address of BLAS, to be written into RtInstanceDesc
+    uint64_t deviceAddress() const;
+    // size of BLAS/TLAS storage in GPU memory
+    uint64_t byteSize() const;
 
   private:
     AccelerationStructure(Tempest::Device& dev, AbstractGraphicsApi::AccelerationStructure* impl);
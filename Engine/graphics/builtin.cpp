@@ -2,6 +2,7 @@
 
 #include <Tempest/Device>
 #include <Tempest/PaintDevice>
+#include <Tempest/Except>
 
 #include "builtin_shader.h"
 
@@ -48,3 +49,46 @@ Builtin::Item Builtin::mkShaderSet(bool textures) {
   ret.brushA = device.pipeline(Triangles,stAlpha,vs,fs);
   return ret;
   }
+
+const ComputePipeline& Builtin::mipmaps(TextureFormat frm) const {
+  switch(frm) {
+    case TextureFormat::RGBA8:
+      return mkCompute(mips[0],mipmap_rgba8_comp_sprv,   sizeof(mipmap_rgba8_comp_sprv));
+    case TextureFormat::RGBA16:
+      return mkCompute(mips[1],mipmap_rgba16_comp_sprv,  sizeof(mipmap_rgba16_comp_sprv));
+    case TextureFormat::RGBA16F:
+      return mkCompute(mips[2],mipmap_rgba16f_comp_sprv, sizeof(mipmap_rgba16f_comp_sprv));
+    case TextureFormat::RGBA32F:
+      return mkCompute(mips[3],mipmap_rgba32f_comp_sprv, sizeof(mipmap_rgba32f_comp_sprv));
+    case TextureFormat::R32F:
+      return mkCompute(mips[4],mipmap_r32f_comp_sprv,    sizeof(mipmap_r32f_comp_sprv));
+    case TextureFormat::R11G11B10UF:
+      return mkCompute(mips[5],mipmap_rg11b10f_comp_sprv,sizeof(mipmap_rg11b10f_comp_sprv));
+    default:
+      break;
+    }
+  throw std::system_error(Tempest::GraphicsErrc::UnsupportedTextureFormat, formatName(frm));
+  }
+
+const ComputePipeline& Builtin::bcDecode(TextureFormat frm) const {
+  switch(frm) {
+    case TextureFormat::DXT1:
+      return mkCompute(bc[0],bc1_comp_sprv,sizeof(bc1_comp_sprv));
+    case TextureFormat::DXT3:
+      return mkCompute(bc[1],bc2_comp_sprv,sizeof(bc2_comp_sprv));
+    case TextureFormat::DXT5:
+      return mkCompute(bc[2],bc3_comp_sprv,sizeof(bc3_comp_sprv));
+    default:
+      break;
+    }
+  throw std::system_error(Tempest::GraphicsErrc::UnsupportedTextureFormat, formatName(frm));
+  }
+
+const ComputePipeline& Builtin::mkCompute(ComputePipeline& pso, const void* sprv, size_t size) const {
+  std::lock_guard<std::mutex> guard(syncCs);
+  if(pso.isEmpty()) {
+    auto cs = device.shader(sprv,size);
+    pso = device.pipeline(cs);
+    }
+  return pso;
+  }
@@ -6,6 +6,8 @@
 #include <Tempest/Shader>
 #include <Tempest/PipelineLayout>
 
+#include <mutex>
+
 namespace Tempest {
 
 class Device;
@@ -29,13 +31,24 @@ class Builtin final {
     const Item& texture2d() const { return brushT2; }
     const Item& empty    () const { return brushE;  }
 
+    // single pass downsampler for storage image of format 'frm'
+    const ComputePipeline& mipmaps (TextureFormat frm) const;
+    // DXT1/DXT3/DXT5 to RGBA8 storage image
+    const ComputePipeline& bcDecode(TextureFormat frm) const;
+
   private:
     Item            mkShaderSet(bool textures);
+    const ComputePipeline& mkCompute(ComputePipeline& pso, const void* sprv, size_t size) const;
 
     Device&         device;
     Item            brushT2;
     Item            brushE;
 
+    // compute pipelines are created on first use
+    mutable std::mutex      syncCs;
+    mutable ComputePipeline mips[6];
+    mutable ComputePipeline bc[3];
+
   friend class Device;
   };
 
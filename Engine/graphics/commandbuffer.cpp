@@ -4,6 +4,7 @@
 #include <Tempest/RenderPipeline>
 #include <Tempest/Encoder>
 #include <Tempest/Except>
+#include <Tempest/Readback>
 
 using namespace Tempest;
 
@@ -22,5 +23,6 @@ Encoder<CommandBuffer> CommandBuffer::startEncoding(Device& device) {
     *this  = device.commandBuffer();
     dev    = &device;
     }
+  readback.clear();
   return Encoder<CommandBuffer>(this);
   }
@@ -4,8 +4,15 @@
 #include <Tempest/Encoder>
 #include "../utility/dptr.h"
 
+#include <memory>
+#include <vector>
+
 namespace Tempest {
 
+namespace Detail {
+struct ReadbackState;
+}
+
 class Device;
 class Frame;
 class RenderPipeline;
@@ -32,6 +39,8 @@ class CommandBuffer final {
 
     Tempest::Device*                                    dev=nullptr;
     Detail::DPtr<AbstractGraphicsApi::CommandBuffer*>   impl;
+    // readbacks recorded since last submit
+    mutable std::vector<std::shared_ptr<Detail::ReadbackState>> readback;
 
   friend class Tempest::Device;
   friend class Tempest::Encoder<CommandBuffer>;
@@ -5,9 +5,13 @@
 #include <Tempest/PipelineLayout>
 #include <Tempest/UniformBuffer>
 #include <Tempest/File>
+#include <Tempest/IDevice>
 #include <Tempest/Pixmap>
 #include <Tempest/Except>
 
+#include "formats/texturefile.h"
+#include "gapi/gpuprofiler.h"
+
 #include <mutex>
 #include <cassert>
 
@@ -70,18 +74,56 @@ void Device::waitIdle() {
   }
 
 void Device::submit(const CommandBuffer &cmd) {
+  if(!cmd.readback.empty()) {
+    implSubmitReadback(cmd,nullptr);
+    return;
+    }
   api.submit(dev,cmd.impl.handler,nullptr);
   }
 
 void Device::submit(const CommandBuffer &cmd, Fence &fdone) {
+  if(!cmd.readback.empty()) {
+    implSubmitReadback(cmd,&fdone);
+    return;
+    }
   api.submit(dev,cmd.impl.handler,fdone.impl.handler);
   }
 
+void Device::implSubmitReadback(const CommandBuffer& cmd, Fence* fdone) {
+  auto sync = std::make_shared<Detail::ReadbackSync>();
+  sync->fence = fence();
+  if(fdone==nullptr) {
+    api.submit(dev,cmd.impl.handler,sync->fence.impl.handler);
+    } else {
+    // caller owns 'fdone' and may reset it any time: readbacks are tracked by a trailing empty submission
+    api.submit(dev,cmd.impl.handler,fdone->impl.handler);
+    {
+    auto enc = sync->cmd.startEncoding(*this);
+    }
+    api.submit(dev,sync->cmd.impl.handler,sync->fence.impl.handler);
+    }
+
+  for(auto& i:cmd.readback)
+    i->sync = sync;
+  cmd.readback.clear();
+  }
+
 void Device::present(Swapchain& sw) {
   api.present(dev,sw.impl.handler);
-  }
+  nextProfilingFrame();
+  }
+
+Shader Device::shader(IDevice &file) {
+  // spir-v is consumed in place, if device is memory backed and aligned
+  size_t      avail = 0;
+  const void* view  = file.view(avail);
+  if(view!=nullptr && reinterpret_cast<uintptr_t>(view)%alignof(uint32_t)==0) {
+    Shader f(*this,api.createShader(dev,view,avail));
+    if(file.seek(avail)!=avail)
+      throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+    return f;
+    }
 
-Shader Device::shader(RFile &file) {
   const size_t fileSize=file.size();
 
   std::unique_ptr<uint8_t[]> buffer(new uint8_t[fileSize]);
@@ -94,12 +136,12 @@ Shader Device::shader(RFile &file) {
   }
 
 Shader Device::shader(const char *filename) {
-  Tempest::RFile file(filename);
+  Tempest::MappedFile file(filename);
   return shader(file);
   }
 
 Shader Device::shader(const char16_t *filename) {
-  Tempest::RFile file(filename);
+  Tempest::MappedFile file(filename);
   return shader(file);
   }
 
@@ -145,9 +187,18 @@ Texture2d Device::texture(const Pixmap &pm, const bool mips) {
     throw std::system_error(Tempest::GraphicsErrc::TooLargeTexture, std::to_string(std::max(pm.w(),pm.h())));
 
   if(isCompressedFormat(format)){
-    if(devProps.hasSamplerFormat(format) && (!mips || pm.mipCount()>1)){
+    // no decoder for BC4-BC7: mips can't be generated
+    const bool decodable = (format==TextureFormat::DXT1 || format==TextureFormat::DXT3 || format==TextureFormat::DXT5);
+    if(devProps.hasSamplerFormat(format) && (!mips || pm.mipCount()>1 || !decodable)){
       mipCnt = pm.mipCount();
-      } else {
+      }
+    else if(!decodable) {
+      throw std::system_error(Tempest::GraphicsErrc::UnsupportedTextureFormat, formatName(format));
+      }
+    else if(devProps.hasStorageFormat(TextureFormat::RGBA8)) {
+      return implDecodeTexture(pm,mips);
+      }
+    else {
       alt    = Pixmap(pm,TextureFormat::RGBA8);
       p      = &alt;
       format = TextureFormat::RGBA8;
@@ -179,6 +230,80 @@ Texture2d Device::texture(const Pixmap &pm, const bool mips) {
   return t;
   }
 
+Texture2d Device::implDecodeTexture(const Pixmap& pm, const bool mips) {
+  // NOTE: must match bcn.comp
+  struct Push {
+    int32_t  w, h;
+    uint32_t offset;
+    };
+
+  const TextureFormat frm    = pm.format();
+  auto&               pso    = builtins.bcDecode(frm);
+  StorageImage        img    = image2d(TextureFormat::RGBA8,uint32_t(pm.w()),uint32_t(pm.h()),mips);
+  StorageBuffer       blocks = ssbo(pm.data(),pm.dataSize());
+  const uint32_t      upload = std::min(pm.mipCount(),img.mipCount());
+
+  std::vector<DescriptorSet> desc(upload);
+  auto cmd = commandBuffer();
+  {
+    auto     enc    = cmd.startEncoding(*this);
+    uint32_t w      = uint32_t(pm.w());
+    uint32_t h      = uint32_t(pm.h());
+    size_t   offset = 0;
+    for(uint32_t i=0; i<upload; ++i) {
+      desc[i] = descriptors(pso);
+      desc[i].set(0,blocks);
+      desc[i].set(1,img,Sampler::nearest(),i);
+
+      Push push = {int32_t(w), int32_t(h), uint32_t(offset/4)};
+      enc.setUniforms(pso,desc[i],&push,sizeof(push));
+
+      const Size bsz = Pixmap::blockCount(frm,w,h);
+      enc.dispatchThreads(size_t(bsz.w),size_t(bsz.h));
+
+      offset += size_t(bsz.w*bsz.h)*Pixmap::blockSizeForFormat(frm);
+      w = std::max(1u,w/2);
+      h = std::max(1u,h/2);
+      }
+    if(upload<img.mipCount())
+      enc.generateMipmaps(img);
+  }
+
+  auto sync = fence();
+  submit(cmd,sync);
+  sync.wait();
+  return std::move(img.tImpl);
+  }
+
+Texture2d Device::texture(IDevice& file, const bool mips) {
+  uint8_t head[12] = {};
+  size_t  sz       = file.read(head,sizeof(head));
+  if(file.unget(sz)!=sz)
+    throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+  if(!Detail::TextureFile::isTextureFile(head,sz))
+    return texture(Pixmap(file),mips);
+
+  Detail::TextureFile tex(file);
+  const TextureFormat format = tex.format();
+
+  if(tex.w()>devProps.tex2d.maxSize || tex.h()>devProps.tex2d.maxSize)
+    throw std::system_error(Tempest::GraphicsErrc::TooLargeTexture, std::to_string(std::max(tex.w(),tex.h())));
+
+  if(!devProps.hasSamplerFormat(format)) {
+    // slow path: decode on cpu, if device can rewind
+    if(file.unget(tex.position())==tex.position())
+      return texture(Pixmap(file),mips);
+    throw std::system_error(Tempest::GraphicsErrc::UnsupportedTextureFormat, formatName(format));
+    }
+
+  uint32_t mipCnt = mips ? mipCount(tex.w(),tex.h()) : 1;
+  if(isCompressedFormat(format) || tex.mipCount()>1)
+    mipCnt = mips ? tex.mipCount() : 1;
+
+  Texture2d t(*this,api.createTexture(dev,tex,mipCnt),tex.w(),tex.h(),format);
+  return t;
+  }
+
 StorageImage Device::image2d(TextureFormat frm, const uint32_t w, const uint32_t h, const bool mips) {
   if(!devProps.hasStorageFormat(frm))
     throw std::system_error(Tempest::GraphicsErrc::UnsupportedTextureFormat, formatName(frm));
@@ -231,6 +356,50 @@ AccelerationStructure Device::blas(const RtGeometry* geom, size_t geomSize) {
   return AccelerationStructure(*this,blas);
   }
 
+std::vector<AccelerationStructure> Device::blas(const std::vector<std::vector<RtGeometry>>& mesh, RtBuildFlags flags) {
+  return blas(mesh.data(), mesh.size(), flags);
+  }
+
+std::vector<AccelerationStructure> Device::blas(const std::vector<RtGeometry>* mesh, size_t meshSize, RtBuildFlags flags) {
+  if(!properties().raytracing.rayQuery)
+    throw std::system_error(Tempest::GraphicsErrc::UnsupportedExtension, "rayQuery");
+
+  size_t total = 0;
+  for(size_t i=0; i<meshSize; ++i)
+    total += mesh[i].size();
+
+  std::vector<AbstractGraphicsApi::RtGeometry> g(total);
+  std::vector<size_t>                          gSize(meshSize);
+  size_t                                       at = 0;
+  for(size_t i=0; i<meshSize; ++i) {
+    gSize[i] = mesh[i].size();
+    for(auto& geom:mesh[i]) {
+      const uint32_t stride = uint32_t(geom.vboStride);
+      assert(3*sizeof(float)<=stride); // float3 positions, no overlap
+
+      auto& gx = g[at];
+      gx.vbo     = geom.vbo->impl.impl.handler;
+      gx.vboSz   = geom.vbo->byteSize()/stride;
+      gx.stride  = geom.vboStride;
+      gx.ibo     = geom.ibo->impl.impl.handler;
+      gx.iboSz   = geom.iboSize;
+      gx.ioffset = geom.iboOffset;
+      gx.icls    = geom.icls;
+      ++at;
+      }
+    }
+
+  const bool compact = (flags & RtBuildFlags::Compact)==RtBuildFlags::Compact;
+  std::vector<Detail::DSharedPtr<AbstractGraphicsApi::AccelerationStructure*>> as(meshSize);
+  api.createBottomAccelerationStructs(dev, g.data(), gSize.data(), meshSize, compact, as.data());
+
+  std::vector<AccelerationStructure> ret;
+  ret.reserve(meshSize);
+  for(auto& i:as)
+    ret.emplace_back(AccelerationStructure(*this,i.handler));
+  return ret;
+  }
+
 AccelerationStructure Device::tlas(std::initializer_list<RtInstance> geom) {
   return tlas(geom.begin(),geom.size());
   }
@@ -252,6 +421,13 @@ AccelerationStructure Device::tlas(const RtInstance* geom, size_t geomSize) {
   return AccelerationStructure(*this,tlas);
   }
 
+AccelerationStructure Device::tlas(size_t maxInstances) {
+  if(!properties().raytracing.rayQuery)
+    throw std::system_error(Tempest::GraphicsErrc::UnsupportedExtension, "rayQuery");
+  auto tlas = api.createTopAccelerationStruct(dev,maxInstances);
+  return AccelerationStructure(*this,tlas);
+  }
+
 Pixmap Device::readPixels(const Texture2d &t, uint32_t mip) {
   Pixmap pm;
   api.readPixels(dev,pm,t.impl,t.format(),uint32_t(t.w()),uint32_t(t.h()),mip,false);
@@ -287,6 +463,42 @@ void Device::readBytes(const StorageBuffer& ssbo, void* out, size_t size) {
   api.readBytes(dev,ssbo.impl.impl.handler,out,size);
   }
 
+Readback Device::readPixelsAsync(Encoder<CommandBuffer>& enc, const Texture2d& t, uint32_t mip) {
+  const uint32_t      w    = std::max(uint32_t(t.w())>>mip, 1u);
+  const uint32_t      h    = std::max(uint32_t(t.h())>>mip, 1u);
+  const TextureFormat frm  = t.format();
+  const Size          bsz  = Pixmap::blockCount(frm,w,h);
+  const size_t        size = size_t(bsz.w)*size_t(bsz.h)*Pixmap::blockSizeForFormat(frm);
+
+  auto st = implReadback(size);
+  st->frm = frm;
+  st->w   = w;
+  st->h   = h;
+  enc.copy(t,mip,st->stage,0);
+  enc.owner->readback.push_back(st);
+  return Readback(std::move(st));
+  }
+
+Readback Device::readPixelsAsync(Encoder<CommandBuffer>& enc, const Attachment& t, uint32_t mip) {
+  return readPixelsAsync(enc,textureCast(t),mip);
+  }
+
+Readback Device::readBytesAsync(Encoder<CommandBuffer>& enc, const StorageBuffer& ssbo, size_t offset, size_t size) {
+  auto st = implReadback(size);
+  enc.copy(ssbo,offset,st->stage,0,size);
+  enc.owner->readback.push_back(st);
+  return Readback(std::move(st));
+  }
+
+std::shared_ptr<Detail::ReadbackState> Device::implReadback(size_t size) {
+  auto st = std::make_shared<Detail::ReadbackState>();
+  st->dev   = this;
+  st->pool  = readbackPool;
+  st->stage = readbackPool->alloc(*this,size);
+  st->size  = size;
+  return st;
+  }
+
 Fence Device::fence() {
   Fence f(*this,api.createFence(dev));
   return f;
@@ -349,6 +561,55 @@ const Builtin& Device::builtin() const {
   return builtins;
   }
 
+void Device::setProfiling(ProfilingFlags flg, std::function<void(const GpuFrame&)> onFrame) {
+  auto prof = dev->profiler();
+  if(prof==nullptr) {
+    if(flg==ProfilingFlags::None)
+      return;
+    throw std::system_error(Tempest::GraphicsErrc::UnsupportedExtension);
+    }
+  prof->setup(flg,std::move(onFrame));
+  }
+
+void Device::nextProfilingFrame() {
+  if(auto prof = dev->profiler())
+    prof->nextFrame();
+  }
+
+void Device::saveProfilingTrace(const char* path) {
+  WFile f(path);
+  saveProfilingTrace(f);
+  }
+
+void Device::saveProfilingTrace(ODevice& fout) {
+  auto prof = dev->profiler();
+  if(prof==nullptr)
+    throw std::system_error(Tempest::GraphicsErrc::UnsupportedExtension);
+  prof->saveTrace(fout);
+  }
+
+MemoryStats Device::memoryStats() const {
+  MemoryStats ret;
+  if(!dev->memoryStats(ret))
+    throw std::system_error(Tempest::GraphicsErrc::UnsupportedExtension);
+  return ret;
+  }
+
+void Device::setMemoryCallback(std::function<void(const MemoryEvent&)> cb) {
+  const bool empty = (cb==nullptr);
+  if(!dev->setMemoryCallback(std::move(cb)) && !empty)
+    throw std::system_error(Tempest::GraphicsErrc::UnsupportedExtension);
+  }
+
+size_t Device::defragment(size_t maxBytes) {
+  return dev->defragment(maxBytes);
+  }
+
+void Device::setMemoryPageSize(size_t size) {
+  if(!dev->setMemoryPageSize(size))
+    throw std::system_error(Tempest::GraphicsErrc::UnsupportedExtension);
+  }
+
 Detail::VideoBuffer Device::createVideoBuffer(const void *data, size_t size, MemUsage usage, BufferHeap flg) {
   Detail::VideoBuffer buf(api.createBuffer(dev,data,size,usage,flg), size);
   return  buf;
@@ -17,19 +17,24 @@
 #include <Tempest/Builtin>
 #include <Tempest/Swapchain>
 #include <Tempest/UniformBuffer>
+#include <Tempest/Readback>
+#include <Tempest/GpuZone>
+#include <Tempest/MemoryStats>
 #include <Tempest/Except>
 
 #include "videobuffer.h"
 
+#include <functional>
 #include <memory>
 #include <vector>
 
 namespace Tempest {
 
 class Fence;
+class ODevice;
 
 class CommandPool;
-class RFile;
+class IDevice;
 
 class Pixmap;
 
@@ -57,7 +62,7 @@ class Device {
 
     Swapchain             swapchain(SystemApi::Window* w) const;
 
-    Shader                shader(RFile&          file);
+    Shader                shader(IDevice&        file);
     Shader                shader(const char*     filename);
     Shader                shader(const char16_t* filename);
     Shader                shader(const void* source, const size_t length);
@@ -125,6 +130,8 @@ class Device {
     DescriptorSet         descriptors(const PipelineLayout&  lay);
 
     Texture2d             texture    (const Pixmap& pm, const bool mips = true);
+    // DDS/KTX2 data is uploaded without conversion; other images are decoded via Pixmap
+    Texture2d             texture    (IDevice& file,    const bool mips = true);
     Attachment            attachment (TextureFormat frm, const uint32_t w, const uint32_t h, const bool mips = false);
     ZBuffer               zbuffer    (TextureFormat frm, const uint32_t w, const uint32_t h);
     StorageImage          image2d    (TextureFormat frm, const uint32_t w, const uint32_t h, const bool mips = false);
@@ -133,6 +140,9 @@ class Device {
     AccelerationStructure blas(const std::vector<RtGeometry>& geom);
     AccelerationStructure blas(std::initializer_list<RtGeometry> geom);
     AccelerationStructure blas(const RtGeometry* geom, size_t geomSize);
+    // builds many BLAS'es at once: one submit, shared scratch memory; mesh[i] -> result[i]
+    std::vector<AccelerationStructure> blas(const std::vector<std::vector<RtGeometry>>& mesh, RtBuildFlags flags = RtBuildFlags::None);
+    std::vector<AccelerationStructure> blas(const std::vector<RtGeometry>* mesh, size_t meshSize, RtBuildFlags flags = RtBuildFlags::None);
 
     template<class V, class I>
     AccelerationStructure blas(const VertexBuffer<V>& vbo, const IndexBuffer<I>& ibo);
@@ -142,12 +152,19 @@ class Device {
     AccelerationStructure tlas(std::initializer_list<RtInstance> geom);
     AccelerationStructure tlas(const std::vector<RtInstance>& geom);
     AccelerationStructure tlas(const RtInstance* geom, size_t geomSize);
+    // empty TLAS with storage for up to maxInstances; filled on GPU with Encoder::updateTlas
+    AccelerationStructure tlas(size_t maxInstances);
 
     Pixmap                readPixels(const Texture2d&    t, uint32_t mip=0);
     Pixmap                readPixels(const Attachment&   t, uint32_t mip=0);
     Pixmap                readPixels(const StorageImage& t, uint32_t mip=0);
     void                  readBytes (const StorageBuffer& ssbo, void* out, size_t size);
 
+    // copy is recorded into 'enc'; result is available, once command buffer is submitted and completed
+    Readback              readPixelsAsync(Encoder<CommandBuffer>& enc, const Texture2d&  t, uint32_t mip=0);
+    Readback              readPixelsAsync(Encoder<CommandBuffer>& enc, const Attachment& t, uint32_t mip=0);
+    Readback              readBytesAsync (Encoder<CommandBuffer>& enc, const StorageBuffer& ssbo, size_t offset, size_t size);
+
     RenderPipeline        pipeline(Topology tp,const RenderState& st, const Shader &vs, const Shader &fs);
     RenderPipeline        pipeline(Topology tp,const RenderState& st, const Shader &vs, const Shader &tc, const Shader &te, const Shader &fs);
     RenderPipeline        pipeline(Topology tp,const RenderState& st, const Shader &vs, const Shader &gs, const Shader &fs);
@@ -160,6 +177,26 @@ class Device {
 
     const Builtin&        builtin() const;
 
+    // GPU zones, recorded with Encoder::beginZone/endZone; results are collected a few frames later, without stalls
+    void                  setProfiling(ProfilingFlags flg, std::function<void(const GpuFrame&)> onFrame = nullptr);
+    // frame boundary for profiler; called by present(), offscreen applications should call it explicitly
+    void                  nextProfilingFrame();
+    // Chrome trace (chrome://tracing, ui.perfetto.dev) of recently collected frames
+    void                  saveProfilingTrace(const char* path);
+    void                  saveProfilingTrace(ODevice& fout);
+
+    // per-heap and per-memory-type usage; budget comes from VK_EXT_memory_budget, when available
+    MemoryStats           memoryStats() const;
+    // invoked on every device-memory allocation/release, with allocator lock held: must not create or destroy resources
+    void                  setMemoryCallback(std::function<void(const MemoryEvent&)> cb);
+    // moves up to 'maxBytes' of device-local buffers out of sparse memory pages, so pages can be released;
+    // copy runs on GPU without stalls, previous storage is released by later defragment() or waitIdle(), once work
+    // submitted before it is complete. Command buffers, recorded before, must be re-recorded.
+    // Returns bytes moved; 0 if nothing to do, or not supported by backend
+    size_t                defragment(size_t maxBytes);
+    // size of device-memory pages, allocated from now on; small pages are released and defragmented at finer grain
+    void                  setMemoryPageSize(size_t size);
+
   private:
     struct Impl {
       Impl(AbstractGraphicsApi& api, std::string_view name);
@@ -175,14 +212,19 @@ class Device {
     AbstractGraphicsApi::Device*    dev=nullptr;
     Props                           devProps;
     Tempest::Builtin                builtins;
+    std::shared_ptr<Detail::ReadbackPool> readbackPool = std::make_shared<Detail::ReadbackPool>();
 
     Detail::VideoBuffer   createVideoBuffer(const void* data, size_t size, MemUsage usage, BufferHeap flg);
     RenderPipeline        implPipeline(const RenderState &st, const Shader* shaders[], Topology tp);
+    Texture2d             implDecodeTexture(const Pixmap& pm, const bool mips);
     template<class T>
     UniformBuffer<T>      implUbo(BufferHeap ht, const void* data);
 
     static TextureFormat  formatOf(const Attachment& a);
 
+    std::shared_ptr<Detail::ReadbackState> implReadback(size_t size);
+    void                  implSubmitReadback(const CommandBuffer& cmd, Fence* fdone);
+
   friend class RenderPipeline;
   friend class Painter;
   friend class Shader;
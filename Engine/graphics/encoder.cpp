@@ -3,6 +3,8 @@
 #include <Tempest/Attachment>
 #include <Tempest/ZBuffer>
 #include <Tempest/Texture2d>
+#include <Tempest/StorageImage>
+#include <Tempest/Device>
 #include <cassert>
 
 #include "utility/compiller_hints.h"
@@ -20,16 +22,18 @@ static uint32_t mipCount(uint32_t w, uint32_t h) {
   }
 
 Encoder<Tempest::CommandBuffer>::Encoder(Tempest::CommandBuffer* ow)
-  :impl(ow->impl.handler) {
+  :dev(ow->dev), owner(ow), impl(ow->impl.handler) {
   impl->begin();
   }
 
 Encoder<CommandBuffer>::Encoder(Encoder<CommandBuffer> &&e)
-  :impl(e.impl),state(std::move(e.state)) {
+  :dev(e.dev),owner(e.owner),impl(e.impl),state(std::move(e.state)) {
   e.impl  = nullptr;
   }
 
 Encoder<CommandBuffer> &Encoder<CommandBuffer>::operator =(Encoder<CommandBuffer> &&e) {
+  dev    = e.dev;
+  owner  = e.owner;
   impl   = e.impl;
   state  = std::move(e.state);
 
@@ -65,6 +69,19 @@ void Encoder<Tempest::CommandBuffer>::setDebugMarker(std::string_view tag) {
   impl->setDebugMarker(tag);
   }
 
+void Encoder<Tempest::CommandBuffer>::beginZone(std::string_view name) {
+  impl->beginZone(name);
+  }
+
+void Encoder<Tempest::CommandBuffer>::endZone() {
+  impl->endZone();
+  }
+
+Encoder<Tempest::CommandBuffer>::Zone Encoder<Tempest::CommandBuffer>::zone(std::string_view name) {
+  beginZone(name);
+  return Zone(this);
+  }
+
 void Encoder<Tempest::CommandBuffer>::setUniforms(const RenderPipeline& p, const DescriptorSet &ubo, const void* data, size_t sz) {
   setUniforms(p);
   if(sz>0)
@@ -279,7 +296,7 @@ void Tempest::Encoder<Tempest::CommandBuffer>::implSetFramebuffer(const Attachme
 void Encoder<CommandBuffer>::copy(const Attachment& src, uint32_t mip, StorageBuffer& dest, size_t offset) {
   if(offset%4!=0)
     throw std::system_error(Tempest::GraphicsErrc::InvalidStorageBuffer);
-  uint32_t w = src.w(), h = src.h();
+  uint32_t w = std::max(uint32_t(src.w())>>mip, 1u), h = std::max(uint32_t(src.h())>>mip, 1u);
   auto& tx = *textureCast(src).impl.handler;
   impl->copy(*dest.impl.impl.handler,offset,tx,w,h,mip);
   }
@@ -287,13 +304,90 @@ void Encoder<CommandBuffer>::copy(const Attachment& src, uint32_t mip, StorageBu
 void Encoder<CommandBuffer>::copy(const Texture2d& src, uint32_t mip, StorageBuffer& dest, size_t offset) {
   if(offset%4!=0)
     throw std::system_error(Tempest::GraphicsErrc::InvalidStorageBuffer);
-  uint32_t w = src.w(), h = src.h();
+  uint32_t w = std::max(uint32_t(src.w())>>mip, 1u), h = std::max(uint32_t(src.h())>>mip, 1u);
   auto& tx = *src.impl.handler;
   impl->copy(*dest.impl.impl.handler,offset,tx,w,h,mip);
   }
 
+void Encoder<CommandBuffer>::copy(const StorageBuffer& src, size_t offset, StorageBuffer& dest, size_t offsetDest, size_t size) {
+  if(offset%4!=0 || offsetDest%4!=0 || size%4!=0)
+    throw std::system_error(Tempest::GraphicsErrc::InvalidStorageBuffer);
+  if(offset+size>src.byteSize() || offsetDest+size>dest.byteSize())
+    throw std::system_error(Tempest::GraphicsErrc::InvalidStorageBuffer);
+  if(size==0)
+    return;
+  if(state.stage==Rendering)
+    throw std::system_error(Tempest::GraphicsErrc::ComputeCallInRenderPass);
+  impl->copy(*dest.impl.impl.handler,offsetDest,*src.impl.impl.handler,offset,size);
+  }
+
+void Encoder<CommandBuffer>::updateTlas(AccelerationStructure& tlas, const StorageBuffer& instances, size_t offset, size_t count, bool refit) {
+  if(tlas.isEmpty())
+    throw std::system_error(Tempest::GraphicsErrc::InvalidAccelerationStructure);
+  if(offset%16!=0 || offset+count*sizeof(RtInstanceDesc)>instances.byteSize())
+    throw std::system_error(Tempest::GraphicsErrc::InvalidStorageBuffer);
+  if(state.stage==Rendering)
+    throw std::system_error(Tempest::GraphicsErrc::ComputeCallInRenderPass);
+  impl->updateTlas(*tlas.impl.handler,*instances.impl.impl.handler,offset,count,refit);
+  }
+
 void Encoder<CommandBuffer>::generateMipmaps(Attachment& tex) {
   uint32_t w = tex.w(), h = tex.h();
   impl->generateMipmap(*textureCast(tex).impl.handler,w,h,mipCount(w,h));
   }
 
+
+void Encoder<CommandBuffer>::generateMipmaps(StorageImage& tex) {
+  // NOTE: must match mipmap.comp
+  struct Push {
+    int32_t w, h;
+    int32_t mipCount;
+    int32_t groupCount;
+    int32_t pass;
+    };
+
+  const uint32_t mipCnt = tex.mipCount();
+  if(mipCnt<=1)
+    return;
+
+  auto& pso = dev->builtin().mipmaps(tex.format());
+
+  // each pass makes up to 12 mips; mip 6 must fit into one 64x64 tile
+  Push     push[4] = {};
+  uint32_t passes  = 0;
+  for(uint32_t src=0; src+1<mipCnt; ++passes) {
+    uint32_t w = std::max(1u, uint32_t(tex.w())>>src);
+    uint32_t h = std::max(1u, uint32_t(tex.h())>>src);
+    uint32_t n = std::min(std::max(w,h)>4096 ? 6u : 12u, mipCnt-1-src);
+
+    auto& p = push[passes];
+    p.w          = int32_t(w);
+    p.h          = int32_t(h);
+    p.mipCount   = int32_t(n);
+    p.groupCount = int32_t(((w+63)/64) * ((h+63)/64));
+    p.pass       = int32_t(passes);
+    src += n;
+    }
+
+  if(tex.mipSets.size()!=passes) {
+    tex.mipSets.clear();
+    uint32_t zero[4] = {};
+    tex.mipCounter = dev->ssbo(zero,sizeof(zero));
+    for(uint32_t i=0, src=0; i<passes; ++i) {
+      auto set = dev->descriptors(pso);
+      uint32_t n = uint32_t(push[i].mipCount);
+      set.set(0, tex, Sampler::nearest(), src);
+      // unused bindings point to the last mip of the pass; shader doesn't access them
+      for(uint32_t r=1; r<=12; ++r)
+        set.set(r, tex, Sampler::nearest(), src+std::min(r,n));
+      set.set(13, tex.mipCounter);
+      tex.mipSets.emplace_back(std::move(set));
+      src += n;
+      }
+    }
+
+  for(uint32_t i=0; i<passes; ++i) {
+    setUniforms(pso, tex.mipSets[i], &push[i], sizeof(push[i]));
+    dispatch(size_t((push[i].w+63)/64), size_t((push[i].h+63)/64));
+    }
+  }
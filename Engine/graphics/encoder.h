@@ -14,6 +14,9 @@ template<class T>
 class IndexBuffer;
 
 class CommandBuffer;
+class Device;
+class StorageImage;
+class AccelerationStructure;
 
 template<class T>
 class Encoder;
@@ -46,6 +49,24 @@ class Encoder<Tempest::CommandBuffer> {
 
     void setDebugMarker(std::string_view tag);
 
+    // GPU profiling zone, see Device::setProfiling; zones can be nested and may span render passes
+    void beginZone(std::string_view name);
+    void endZone();
+
+    class Zone final {
+      public:
+        Zone(Zone&& z):enc(z.enc) { z.enc = nullptr; }
+        ~Zone() { if(enc!=nullptr) enc->endZone(); }
+
+      private:
+        explicit Zone(Encoder* enc):enc(enc) {}
+        Encoder* enc = nullptr;
+
+      friend class Encoder;
+      };
+    // scoped beginZone/endZone; must not outlive encoder
+    Zone zone(std::string_view name);
+
     // non-indexed + empty vbo
     void draw(std::nullptr_t vbo, size_t offset, size_t count) { implDraw({},0,offset,count,0,1); }
     void draw(std::nullptr_t vbo, size_t offset, size_t count, size_t firstInstance, size_t instanceCount) { implDraw({},0,offset,count,firstInstance,instanceCount); }
@@ -100,8 +121,14 @@ class Encoder<Tempest::CommandBuffer> {
 
     void copy(const Attachment& src, uint32_t mip, StorageBuffer& dest, size_t offset);
     void copy(const Texture2d&  src, uint32_t mip, StorageBuffer& dest, size_t offset);
+    void copy(const StorageBuffer& src, size_t offset, StorageBuffer& dest, size_t offsetDest, size_t size);
+
+    // rebuilds TLAS in place from RtInstanceDesc array; refits, if 'refit' and instance count is unchanged
+    void updateTlas(AccelerationStructure& tlas, const StorageBuffer& instances, size_t offset, size_t count, bool refit = true);
 
     void generateMipmaps(Attachment& tex);
+    // compute based; works for formats, that can't be blitted with linear filter
+    void generateMipmaps(StorageImage& tex);
 
   private:
     explicit Encoder(CommandBuffer* ow);
@@ -118,7 +145,9 @@ class Encoder<Tempest::CommandBuffer> {
       Stage                                    stage       = None;
       };
 
-    AbstractGraphicsApi::CommandBuffer* impl = nullptr;
+    Device*                             dev   = nullptr;
+    CommandBuffer*                      owner = nullptr;
+    AbstractGraphicsApi::CommandBuffer* impl  = nullptr;
     State                               state;
 
     void         implSetFramebuffer(const AttachmentDesc* rt, size_t rtSize, const AttachmentDesc* zs);
@@ -127,6 +156,7 @@ class Encoder<Tempest::CommandBuffer> {
                           size_t offset, size_t size, size_t firstInstance, size_t instanceCount);
 
   friend class CommandBuffer;
+  friend class Device;
   };
 }
 
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Tempest {
+
+enum class ProfilingFlags : uint8_t {
+  None               = 0x0,
+  Timestamps         = 0x1,
+  PipelineStatistics = 0x2, // top-level zones only
+  };
+
+inline ProfilingFlags operator | (ProfilingFlags a, ProfilingFlags b){
+  return ProfilingFlags(uint16_t(a)|uint16_t(b));
+  }
+
+inline ProfilingFlags operator & (ProfilingFlags a, ProfilingFlags b){
+  return ProfilingFlags(uint16_t(a)&uint16_t(b));
+  }
+
+// GPU timing of Encoder::beginZone/endZone pair, or of engine internal pass
+class GpuZone {
+  public:
+    struct Stats {
+      uint64_t inputVertices   = 0;
+      uint64_t inputPrimitives = 0;
+      uint64_t vsInvocations   = 0;
+      uint64_t clipPrimitives  = 0;
+      uint64_t fsInvocations   = 0;
+      uint64_t csInvocations   = 0;
+      };
+
+    std::string name;
+    uint32_t    depth    = 0;
+    // GPU clock, nanoseconds
+    uint64_t    begin    = 0;
+    uint64_t    end      = 0;
+    bool        hasStats = false;
+    Stats       stats;
+
+    double      duration() const { return double(end-begin)/1000000.0; } // ms
+  };
+
+class GpuFrame {
+  public:
+    uint64_t             id = 0;
+    // sorted by begin time
+    std::vector<GpuZone> zones;
+  };
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Tempest {
+
+// device memory, as seen by engine allocator and by driver
+class MemoryStats {
+  public:
+    struct Usage {
+      // device memory, owned by allocator
+      uint64_t allocated        = 0;
+      // bytes of live allocations
+      uint64_t used             = 0;
+      uint32_t pages            = 0;
+      // pages, that hold single dedicated allocation
+      uint32_t dedicated        = 0;
+      uint64_t largestFreeBlock = 0;
+      };
+
+    struct Heap : Usage {
+      uint64_t size        = 0;
+      // VK_EXT_memory_budget; heap size, if budget is not reported
+      uint64_t budget      = 0;
+      // process-wide usage, reported by driver; same as 'allocated', if budget is not reported
+      uint64_t usage       = 0;
+      bool     deviceLocal = false;
+
+      uint64_t headroom() const { return budget>usage ? budget-usage : 0; }
+      };
+
+    struct Type : Usage {
+      uint32_t heapId      = 0;
+      bool     deviceLocal = false;
+      bool     hostVisible = false;
+      };
+
+    std::vector<Heap> heaps;
+    std::vector<Type> types;
+    bool              hasBudget = false;
+  };
+
+// device memory allocation event, for tooling
+struct MemoryEvent {
+  enum Type : uint8_t {
+    Allocate,
+    Free,
+    PageAllocate,
+    PageFree,
+    };
+
+  Type     type      = Allocate;
+  uint32_t heapId    = 0;
+  uint32_t typeId    = 0;
+  uint64_t size      = 0;
+  bool     dedicated = false;
+  };
+
+}
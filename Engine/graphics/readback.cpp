@@ -0,0 +1,94 @@
+#include "readback.h"
+
+#include <Tempest/Device>
+#include <Tempest/Pixmap>
+#include <Tempest/Except>
+
+#include <stdexcept>
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+ReadbackSync::~ReadbackSync() {
+  // 'cmd' must not be destroyed, while in flight
+  fence.wait();
+  }
+
+StorageBuffer ReadbackPool::alloc(Device& dev, size_t size) {
+  size_t cls = MinSize;
+  while(cls<size)
+    cls *= 2;
+
+  {
+  std::lock_guard<std::mutex> guard(sync);
+  for(size_t i=0; i<buf.size(); ++i) {
+    if(buf[i].byteSize()!=cls)
+      continue;
+    StorageBuffer ret = std::move(buf[i]);
+    buf[i] = std::move(buf.back());
+    buf.pop_back();
+    return ret;
+    }
+  }
+  return dev.ssbo(BufferHeap::Readback,Uninitialized,cls);
+  }
+
+void ReadbackPool::free(StorageBuffer&& b) {
+  std::lock_guard<std::mutex> guard(sync);
+  if(buf.size()<MaxFree)
+    buf.emplace_back(std::move(b));
+  }
+
+ReadbackState::~ReadbackState() {
+  if(stage.isEmpty())
+    return;
+  // buffer can be reused only after copy is finished
+  if(sync!=nullptr)
+    sync->fence.wait();
+  if(auto p = pool.lock())
+    p->free(std::move(stage));
+  }
+
+
+Readback::Readback(std::shared_ptr<Detail::ReadbackState> s)
+  :state(std::move(s)) {
+  }
+
+Readback::~Readback() {
+  }
+
+bool Readback::isReady() const {
+  if(state==nullptr || state->sync==nullptr)
+    return false;
+  return state->sync->fence.wait(0);
+  }
+
+void Readback::wait() const {
+  if(state==nullptr)
+    return;
+  if(state->sync==nullptr)
+    throw std::logic_error("readback: command buffer is not submitted");
+  state->sync->fence.wait();
+  }
+
+size_t Readback::byteSize() const {
+  return state==nullptr ? 0 : state->size;
+  }
+
+Pixmap Readback::pixmap() const {
+  if(state==nullptr || state->frm==TextureFormat::Undefined)
+    return Pixmap();
+  wait();
+  Pixmap pm(state->w,state->h,state->frm);
+  state->dev->readBytes(state->stage,pm.data(),state->size);
+  return pm;
+  }
+
+void Readback::read(void* out, size_t size) const {
+  if(state==nullptr || size==0)
+    return;
+  if(size>state->size)
+    throw std::system_error(Tempest::GraphicsErrc::InvalidStorageBuffer);
+  wait();
+  state->dev->readBytes(state->stage,out,size);
+  }
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <Tempest/AbstractGraphicsApi>
+#include <Tempest/CommandBuffer>
+#include <Tempest/Fence>
+#include <Tempest/StorageBuffer>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Tempest {
+
+class Device;
+class Pixmap;
+
+namespace Detail {
+
+// completion of a submission, that carries one or more readbacks
+struct ReadbackSync {
+  ~ReadbackSync();
+
+  Fence         fence;
+  // empty submission, signaling 'fence', if caller did submit with own fence
+  CommandBuffer cmd;
+  };
+
+// recycled readback-heap buffers; size classes are powers of two
+class ReadbackPool {
+  public:
+    StorageBuffer alloc(Device& dev, size_t size);
+    void          free (StorageBuffer&& buf);
+
+  private:
+    enum {
+      MinSize = 64*1024,
+      MaxFree = 16,
+      };
+    std::mutex                 sync;
+    std::vector<StorageBuffer> buf;
+  };
+
+struct ReadbackState {
+  ~ReadbackState();
+
+  Device*                       dev  = nullptr;
+  std::weak_ptr<ReadbackPool>   pool;
+  StorageBuffer                 stage;
+  size_t                        size = 0;
+
+  TextureFormat                 frm  = TextureFormat::Undefined;
+  uint32_t                      w    = 0;
+  uint32_t                      h    = 0;
+
+  std::shared_ptr<ReadbackSync> sync;
+  };
+}
+
+// GPU to CPU copy, recorded into user command buffer. Result is available, after command buffer is submitted and executed
+class Readback final {
+  public:
+    Readback() = default;
+    Readback(Readback&&) = default;
+    Readback& operator = (Readback&&) = default;
+    ~Readback();
+
+    bool   isEmpty()  const { return state==nullptr; }
+    // non-blocking; false, while command buffer is not submitted yet
+    bool   isReady()  const;
+    void   wait()     const;
+    size_t byteSize() const;
+
+    // blocking calls
+    Pixmap pixmap() const;
+    void   read(void* out, size_t size) const;
+
+  private:
+    explicit Readback(std::shared_ptr<Detail::ReadbackState> s);
+
+    std::shared_ptr<Detail::ReadbackState> state;
+
+  friend class Tempest::Device;
+  };
+
+}
@@ -2,6 +2,8 @@
 
 #include <Tempest/AbstractGraphicsApi>
 #include <Tempest/Texture2d>
+#include <Tempest/DescriptorSet>
+#include <Tempest/StorageBuffer>
 #include "../utility/dptr.h"
 
 namespace Tempest {
@@ -23,7 +25,10 @@ class StorageImage final {
   private:
     StorageImage(Texture2d&& t):tImpl(std::move(t)){}
 
-    Tempest::Texture2d tImpl;
+    Tempest::Texture2d         tImpl;
+    // Encoder::generateMipmaps state: descriptors and group counters, one per pass
+    std::vector<DescriptorSet> mipSets;
+    StorageBuffer              mipCounter;
 
   friend class Tempest::Device;
   friend class Tempest::DescriptorSet;
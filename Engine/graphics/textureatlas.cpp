@@ -4,9 +4,22 @@
 #include <Tempest/Log>
 #include <cstring>
 
+#include "formats/pixelconv.h"
 #include "thirdparty/squish/squish.h"
 
 using namespace Tempest;
+using namespace Tempest::Detail;
+
+// single channel sprites are alpha masks, two channels are luminance-alpha
+static const int8_t* atlasSwizzle(uint8_t comp) {
+  static const int8_t map[4][4] = {
+    {PixelConv::One, PixelConv::One, PixelConv::One, 0},
+    {0, 0, 0, 1},
+    {0, 1, 2, PixelConv::One},
+    {0, 1, 2, 3},
+    };
+  return map[comp-1];
+  }
 
 TextureAtlas::TextureAtlas(Device& device)
   :device(device),alloc(provider) {
@@ -46,59 +59,23 @@ void TextureAtlas::emplace(TextureAtlas::Allocation &dest, const void* img,
       break;
     case TextureFormat::DXT1:
     case TextureFormat::DXT3:
-    case TextureFormat::DXT5:{
+    case TextureFormat::DXT5:
+    case TextureFormat::BC4:
+    case TextureFormat::BC5:
+    case TextureFormat::BC6H:
+    case TextureFormat::BC7:{
       Log::d("compressed sprites are not implemented");
       break;
       }
-    case TextureFormat::RGBA16: {
-      for(uint32_t iy=0;iy<sh;++iy){
-        auto data0=data+((y+iy)*dw+dx);
-        auto src0 =reinterpret_cast<const uint16_t*>(src+iy*sw);
-        for(uint32_t ix=0,dx=0;ix<sw;dx+=4,ix+=4){
-          data0[dx  ]=src0[ix  ]/256;
-          data0[dx+1]=src0[ix+1]/256;
-          data0[dx+2]=src0[ix+2]/256;
-          data0[dx+3]=src0[ix+3]/256;
-          }
-        }
-      break;
-      }
-    case TextureFormat::RGB16: {
-      for(uint32_t iy=0;iy<sh;++iy){
-        auto data0=data+((y+iy)*dw+dx);
-        auto src0 =reinterpret_cast<const uint16_t*>(src+iy*sw);
-        for(uint32_t ix=0,dx=0;ix<sw;dx+=4,ix+=3){
-          data0[dx  ]=src0[ix  ]/256;
-          data0[dx+1]=src0[ix+1]/256;
-          data0[dx+2]=src0[ix+2]/256;
-          data0[dx+3]=255;
-          }
-        }
-      break;
-      }
-    case TextureFormat::RG16: {
-      for(uint32_t iy=0;iy<sh;++iy){
-        auto data0=data+((y+iy)*dw+dx);
-        auto src0 =reinterpret_cast<const uint16_t*>(src+iy*sw);
-        for(uint32_t ix=0,dx=0;ix<sw;dx+=4,ix+=3){
-          data0[dx  ]=src0[ix  ]/256;
-          data0[dx+1]=src0[ix  ]/256;
-          data0[dx+2]=src0[ix  ]/256;
-          data0[dx+3]=src0[ix+1]/256;
-          }
-        }
-      break;
-      }
+    case TextureFormat::RGBA16:
+    case TextureFormat::RGB16:
+    case TextureFormat::RG16:
     case TextureFormat::R16: {
+      const uint8_t        comp = Pixmap::componentCount(format);
+      std::vector<uint8_t> row(size_t(pw)*comp);
       for(uint32_t iy=0;iy<sh;++iy){
-        auto data0=data+((y+iy)*dw+dx);
-        auto src0 =reinterpret_cast<const uint16_t*>(src+iy*sw);
-        for(uint32_t ix=0,dx=0;ix<sw;dx+=4,ix++){
-          data0[dx  ]=255;
-          data0[dx+1]=255;
-          data0[dx+2]=255;
-          data0[dx+3]=src0[ix]/256;
-          }
+        PixelConv::unorm16ToUnorm8(row.data(),reinterpret_cast<const uint16_t*>(src+iy*sw),row.size());
+        PixelConv::swizzle8(data+((y+iy)*dw+dx),4,row.data(),comp,atlasSwizzle(comp),pw);
         }
       break;
       }
@@ -107,43 +84,12 @@ void TextureAtlas::emplace(TextureAtlas::Allocation &dest, const void* img,
         std::memcpy(data+((y+iy)*dw+dx),src+iy*sw,sw);
       break;
       }
-    case TextureFormat::RGB8: {
-      for(uint32_t iy=0;iy<sh;++iy){
-        auto data0=data+((y+iy)*dw+dx);
-        auto src0 =src+iy*sw;
-        for(uint32_t ix=0,dx=0;ix<sw;dx+=4,ix+=3){
-          data0[dx  ]=src0[ix  ];
-          data0[dx+1]=src0[ix+1];
-          data0[dx+2]=src0[ix+2];
-          data0[dx+3]=255;
-          }
-        }
-      break;
-      }
-    case TextureFormat::RG8: {
-      for(uint32_t iy=0;iy<sh;++iy){
-        auto data0=data+((y+iy)*dw+dx);
-        auto src0 =src+iy*sw;
-        for(uint32_t ix=0,dx=0;ix<sw;dx+=4,ix+=2){
-          data0[dx  ]=src0[ix  ];
-          data0[dx+1]=src0[ix  ];
-          data0[dx+2]=src0[ix  ];
-          data0[dx+3]=src0[ix+1];
-          }
-        }
-      break;
-      }
+    case TextureFormat::RGB8:
+    case TextureFormat::RG8:
     case TextureFormat::R8: {
-      for(uint32_t iy=0;iy<sh;++iy){
-        auto data0=data+((y+iy)*dw+dx);
-        auto src0 =src+iy*sw;
-        for(uint32_t ix=0,dx=0;ix<sw;dx+=4,ix++){
-          data0[dx  ]=255;
-          data0[dx+1]=255;
-          data0[dx+2]=255;
-          data0[dx+3]=src0[ix];
-          }
-        }
+      const uint8_t comp = Pixmap::componentCount(format);
+      for(uint32_t iy=0;iy<sh;++iy)
+        PixelConv::swizzle8(data+((y+iy)*dw+dx),4,src+iy*sw,comp,atlasSwizzle(comp),pw);
       break;
       }
     }
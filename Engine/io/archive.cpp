@@ -0,0 +1,497 @@
+#include "archive.h"
+
+#include <Tempest/Dir>
+#include <Tempest/Except>
+#include <Tempest/ODevice>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <thread>
+
+using namespace Tempest;
+
+namespace {
+
+static const char     PakMagic[4]  = {'T','P','A','K'};
+static const uint32_t PakVersion   = 1;
+static const uint64_t PakAlignment = 16;
+// worst case of deflate: ~1032:1; anything above is a corrupted index
+static const uint64_t MaxDeflateRatio = 1032;
+
+struct PakHeader {
+  char     magic[4];
+  uint32_t version;
+  uint32_t count;
+  uint32_t namesSize;
+  };
+
+struct PakEntry {
+  uint64_t offset;
+  uint64_t packedSize;
+  uint64_t size;
+  uint32_t name;
+  uint16_t nameLen;
+  uint8_t  compression;
+  uint8_t  padding;
+  };
+
+static_assert(sizeof(PakHeader)==16, "invalid archive header size");
+static_assert(sizeof(PakEntry) ==32, "invalid archive entry size");
+
+static uint64_t alignUp(uint64_t v) {
+  return (v+PakAlignment-1) & ~(PakAlignment-1);
+  }
+
+// pool, which callback on this thread is invoked from
+static thread_local const void* callbackPool = nullptr;
+
+}
+
+ArchiveFile::ArchiveFile(ArchiveFile&& other)
+  :storage(std::move(other.storage)), ptr(other.ptr), sz(other.sz), pos(other.pos), open(other.open) {
+  other.ptr  = nullptr;
+  other.sz   = 0;
+  other.pos  = 0;
+  other.open = false;
+  }
+
+ArchiveFile& ArchiveFile::operator =(ArchiveFile&& other) {
+  std::swap(storage,other.storage);
+  std::swap(ptr,    other.ptr);
+  std::swap(sz,     other.sz);
+  std::swap(pos,    other.pos);
+  std::swap(open,   other.open);
+  return *this;
+  }
+
+size_t ArchiveFile::read(void* dest, size_t count) {
+  const size_t c = std::min(count, sz-pos);
+  if(c>0)
+    std::memcpy(dest, ptr+pos, c);
+  pos += c;
+  return c;
+  }
+
+size_t ArchiveFile::size() const {
+  return sz;
+  }
+
+uint8_t ArchiveFile::peek() {
+  if(pos==sz)
+    return 0;
+  return ptr[pos];
+  }
+
+size_t ArchiveFile::seek(size_t advance) {
+  const size_t c = std::min(advance, sz-pos);
+  pos += c;
+  return c;
+  }
+
+size_t ArchiveFile::unget(size_t advance) {
+  const size_t c = std::min(advance, pos);
+  pos -= c;
+  return c;
+  }
+
+const void* ArchiveFile::view(size_t& available) {
+  available = sz-pos;
+  return ptr+pos;
+  }
+
+
+struct Archive::Task {
+  std::string                     name;
+  const Entry*                    entry = nullptr;
+  std::shared_ptr<const Callback> callback;
+  };
+
+struct Archive::Pool {
+  explicit Pool(Archive& owner) {
+    const uint32_t cnt = std::max(1u, std::min(std::thread::hardware_concurrency(), 4u));
+    for(uint32_t i=0; i<cnt; ++i)
+      th.emplace_back([this,&owner](){ owner.workerLoop(*this); });
+    }
+
+  ~Pool() {
+    {
+    std::lock_guard<std::mutex> guard(sync);
+    exit = true;
+    }
+    wake.notify_all();
+    for(auto& i:th)
+      i.join();
+    }
+
+  std::mutex               sync;
+  std::condition_variable  wake, idle;
+  std::deque<Task>         queue;
+  size_t                   active = 0;
+  bool                     exit   = false;
+  std::exception_ptr       error;
+  std::vector<std::thread> th;
+  };
+
+
+Archive::Archive(const char* path)
+  :file(path) {
+  implLoad();
+  }
+
+Archive::Archive(const std::string& path)
+  :file(path) {
+  implLoad();
+  }
+
+Archive::Archive(const char16_t* path)
+  :file(path) {
+  implLoad();
+  }
+
+Archive::Archive(const std::u16string& path)
+  :file(path) {
+  implLoad();
+  }
+
+Archive::~Archive() {
+  try {
+    wait();
+    }
+  catch(...) {
+    // nobody to report callback error to
+    }
+  pool.reset();
+  }
+
+void Archive::implLoad() {
+  const uint8_t* src = file.data();
+  const uint64_t fsz = file.size();
+
+  PakHeader head = {};
+  if(fsz<sizeof(head))
+    throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+  std::memcpy(&head,src,sizeof(head));
+  if(std::memcmp(head.magic,PakMagic,sizeof(PakMagic))!=0 || head.version!=PakVersion)
+    throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+
+  const uint64_t names = sizeof(PakHeader) + uint64_t(head.count)*sizeof(PakEntry);
+  if(names+head.namesSize>fsz)
+    throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+
+  index.resize(head.count);
+  for(size_t i=0; i<index.size(); ++i) {
+    PakEntry e = {};
+    std::memcpy(&e,src+sizeof(PakHeader)+i*sizeof(PakEntry),sizeof(e));
+    if(uint64_t(e.name)+e.nameLen>head.namesSize ||
+       e.offset>fsz || e.packedSize>fsz-e.offset ||
+       e.compression>Deflate)
+      throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+
+    auto& r = index[i];
+    r.name        = std::string_view(reinterpret_cast<const char*>(src+names+e.name),e.nameLen);
+    r.offset      = e.offset;
+    r.packedSize  = e.packedSize;
+    r.size        = e.size;
+    r.compression = Compression(e.compression);
+    if(r.compression==Store && r.size!=r.packedSize)
+      throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+    // size is used for allocation on open: must be reachable from packed data in this archive
+    if(r.compression==Deflate && r.size>r.packedSize*MaxDeflateRatio)
+      throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+    if(i>0 && !(index[i-1].name<r.name))
+      throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+    }
+  }
+
+const Archive::Entry* Archive::find(std::string_view name) const {
+  auto it = std::lower_bound(index.begin(),index.end(),name,[](const Entry& e, std::string_view n){
+    return e.name<n;
+    });
+  if(it==index.end() || it->name!=name)
+    return nullptr;
+  return &(*it);
+  }
+
+ArchiveFile Archive::open(std::string_view name) const {
+  if(auto e = find(name))
+    return open(*e);
+  throw std::system_error(Tempest::SystemErrc::UnableToOpenFile);
+  }
+
+ArchiveFile Archive::open(const Entry& e) const {
+  ArchiveFile f;
+  const uint8_t* src = file.data()+e.offset;
+  if(e.compression==Store) {
+    f.ptr  = src;
+    f.sz   = size_t(e.size);
+    f.open = true;
+    return f;
+    }
+
+  if(e.size>std::numeric_limits<uLong>::max() || e.packedSize>std::numeric_limits<uLong>::max())
+    throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+  f.storage.resize(size_t(e.size));
+  uLongf dsz = uLongf(e.size);
+  if(uncompress(f.storage.data(),&dsz,src,uLong(e.packedSize))!=Z_OK || dsz!=e.size)
+    throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+  f.ptr  = f.storage.data();
+  f.sz   = f.storage.size();
+  f.open = true;
+  return f;
+  }
+
+Archive::Pool& Archive::workers() {
+  std::lock_guard<std::mutex> guard(poolSync);
+  if(pool==nullptr)
+    pool.reset(new Pool(*this));
+  return *pool;
+  }
+
+void Archive::readAsync(std::string name, Callback callback) {
+  std::vector<std::string> names;
+  names.emplace_back(std::move(name));
+  readAsync(std::move(names),std::move(callback));
+  }
+
+void Archive::readAsync(std::vector<std::string> names, Callback callback) {
+  if(names.empty())
+    return;
+
+  auto cb = std::make_shared<const Callback>(std::move(callback));
+  std::vector<Task> tasks(names.size());
+  for(size_t i=0; i<names.size(); ++i) {
+    tasks[i].entry    = find(names[i]);
+    tasks[i].name     = std::move(names[i]);
+    tasks[i].callback = cb;
+    }
+  // issue in file order: neighbouring entries share pages of the mapping
+  std::stable_sort(tasks.begin(),tasks.end(),[](const Task& l, const Task& r){
+    const uint64_t lo = l.entry!=nullptr ? l.entry->offset : 0;
+    const uint64_t ro = r.entry!=nullptr ? r.entry->offset : 0;
+    return lo<ro;
+    });
+
+  auto& p = workers();
+  {
+  std::lock_guard<std::mutex> guard(p.sync);
+  for(auto& i:tasks)
+    p.queue.emplace_back(std::move(i));
+  }
+  if(tasks.size()==1)
+    p.wake.notify_one(); else
+    p.wake.notify_all();
+  }
+
+void Archive::wait() {
+  Pool* p = nullptr;
+  {
+  std::lock_guard<std::mutex> guard(poolSync);
+  p = pool.get();
+  }
+  if(p==nullptr)
+    return;
+  // would wait for itself to complete
+  assert(callbackPool!=p);
+
+  std::exception_ptr err;
+  {
+  std::unique_lock<std::mutex> lck(p->sync);
+  p->idle.wait(lck,[p](){ return p->queue.empty() && p->active==0; });
+  std::swap(err,p->error);
+  }
+  if(err!=nullptr)
+    std::rethrow_exception(err);
+  }
+
+void Archive::workerLoop(Pool& p) {
+  std::unique_lock<std::mutex> lck(p.sync);
+  while(true) {
+    p.wake.wait(lck,[&p](){ return p.exit || !p.queue.empty(); });
+    if(p.queue.empty())
+      return;
+
+    Task t = std::move(p.queue.front());
+    p.queue.pop_front();
+    p.active++;
+    lck.unlock();
+
+    ArchiveFile f;
+    if(t.entry!=nullptr) {
+      try {
+        f = open(*t.entry);
+        }
+      catch(...) {
+        f = ArchiveFile();
+        }
+      }
+    std::exception_ptr err;
+    callbackPool = &p;
+    try {
+      (*t.callback)(t.name,f);
+      }
+    catch(...) {
+      err = std::current_exception();
+      }
+    callbackPool = nullptr;
+
+    lck.lock();
+    if(err!=nullptr && p.error==nullptr)
+      p.error = std::move(err);
+    p.active--;
+    if(p.active==0 && p.queue.empty())
+      p.idle.notify_all();
+    }
+  }
+
+
+void ArchiveWriter::add(std::string name, const void* data, size_t size, Archive::Compression c) {
+  std::replace(name.begin(),name.end(),'\\','/');
+  if(name.size()>std::numeric_limits<uint16_t>::max())
+    throw std::system_error(Tempest::SystemErrc::UnableToSaveAsset);
+
+  Entry e;
+  e.name        = std::move(name);
+  e.size        = size;
+  e.compression = Archive::Store;
+
+  auto src = reinterpret_cast<const uint8_t*>(data);
+  if(c==Archive::Deflate && size>0 && size<=std::numeric_limits<uLong>::max()) {
+    uLongf dsz = compressBound(uLong(size));
+    e.data.resize(dsz);
+    if(compress2(e.data.data(),&dsz,src,uLong(size),Z_BEST_COMPRESSION)==Z_OK && dsz<size) {
+      e.data.resize(dsz);
+      e.compression = Archive::Deflate;
+      }
+    }
+  if(e.compression==Archive::Store)
+    e.data.assign(src,src+size);
+  entries.emplace_back(std::move(e));
+  }
+
+void ArchiveWriter::add(std::string name, IDevice& dev, Archive::Compression c) {
+  size_t      avail = 0;
+  const void* view  = dev.view(avail);
+  if(view!=nullptr) {
+    add(std::move(name),view,avail,c);
+    return;
+    }
+
+  std::vector<uint8_t> data(dev.size());
+  size_t sz = 0;
+  while(sz<data.size()) {
+    const size_t rd = dev.read(data.data()+sz,data.size()-sz);
+    if(rd==0)
+      break;
+    sz += rd;
+    }
+  add(std::move(name),data.data(),sz,c);
+  }
+
+bool ArchiveWriter::addDirectory(const std::string& path, Archive::Compression c) {
+  return implAddDirectory(path,"",c);
+  }
+
+bool ArchiveWriter::implAddDirectory(const std::string& path, const std::string& prefix, Archive::Compression c) {
+  std::vector<std::string> dirs, files;
+  const bool ok = Dir::scan(path,[&](const std::string& n, Dir::FileType t){
+    std::string name(n.c_str()); // win32 scan reports names with trailing '\0'
+    if(name=="." || name=="..")
+      return;
+    if(t==Dir::FT_Dir)
+      dirs.emplace_back(std::move(name)); else
+      files.emplace_back(std::move(name));
+    });
+  if(!ok)
+    return false;
+
+  for(auto& i:files) {
+    MappedFile f(path+"/"+i);
+    add(prefix+i,f,c);
+    }
+  for(auto& i:dirs)
+    if(!implAddDirectory(path+"/"+i,prefix+i+"/",c))
+      return false;
+  return true;
+  }
+
+void ArchiveWriter::save(const char* path) {
+  WFile f(path);
+  save(f);
+  }
+
+void ArchiveWriter::save(const std::string& path) {
+  WFile f(path);
+  save(f);
+  }
+
+void ArchiveWriter::save(const char16_t* path) {
+  WFile f(path);
+  save(f);
+  }
+
+void ArchiveWriter::save(const std::u16string& path) {
+  WFile f(path);
+  save(f);
+  }
+
+void ArchiveWriter::save(ODevice& out) {
+  // sorted index; duplicated names - last one wins
+  std::vector<const Entry*> ent(entries.size());
+  for(size_t i=0; i<entries.size(); ++i)
+    ent[i] = &entries[entries.size()-i-1];
+  std::stable_sort(ent.begin(),ent.end(),[](const Entry* l, const Entry* r){ return l->name<r->name; });
+  ent.erase(std::unique(ent.begin(),ent.end(),[](const Entry* l, const Entry* r){ return l->name==r->name; }),ent.end());
+
+  std::vector<PakEntry> index(ent.size());
+  std::string           names;
+  for(size_t i=0; i<ent.size(); ++i) {
+    index[i].name    = uint32_t(names.size());
+    index[i].nameLen = uint16_t(ent[i]->name.size());
+    names += ent[i]->name;
+    }
+  if(ent.size()>std::numeric_limits<uint32_t>::max() || names.size()>std::numeric_limits<uint32_t>::max())
+    throw std::system_error(Tempest::SystemErrc::UnableToSaveAsset);
+
+  uint64_t offset = alignUp(sizeof(PakHeader) + index.size()*sizeof(PakEntry) + names.size());
+  for(size_t i=0; i<ent.size(); ++i) {
+    index[i].offset      = offset;
+    index[i].packedSize  = ent[i]->data.size();
+    index[i].size        = ent[i]->size;
+    index[i].compression = ent[i]->compression;
+    offset = alignUp(offset+ent[i]->data.size());
+    }
+
+  PakHeader head = {};
+  std::memcpy(head.magic,PakMagic,sizeof(PakMagic));
+  head.version   = PakVersion;
+  head.count     = uint32_t(index.size());
+  head.namesSize = uint32_t(names.size());
+
+  static const uint8_t zero[PakAlignment] = {};
+  uint64_t written = 0;
+  auto write = [&](const void* data, size_t size) {
+    if(out.write(data,size)!=size)
+      throw std::system_error(Tempest::SystemErrc::UnableToSaveAsset);
+    written += size;
+    };
+  auto pad = [&]() {
+    write(zero,size_t(alignUp(written)-written));
+    };
+
+  write(&head,sizeof(head));
+  write(index.data(),index.size()*sizeof(PakEntry));
+  write(names.data(),names.size());
+  for(auto i:ent) {
+    pad();
+    write(i->data.data(),i->data.size());
+    }
+  if(!out.flush())
+    throw std::system_error(Tempest::SystemErrc::UnableToSaveAsset);
+  }
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <Tempest/IDevice>
+#include <Tempest/File>
+#include <Tempest/Platform>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Tempest {
+
+class ODevice;
+class Archive;
+
+// Single entry of an Archive. Stored entries are read straight from the archive mapping,
+// compressed entries are inflated on open. Must not outlive the archive.
+class ArchiveFile : public Tempest::IDevice {
+  public:
+    ArchiveFile() = default;
+    ArchiveFile(ArchiveFile&& other);
+    ArchiveFile& operator = (ArchiveFile&& other);
+
+    bool    isOpen() const { return open; }
+
+    size_t  read(void* to,size_t size) override;
+    size_t  size() const override;
+
+    uint8_t peek() override;
+    size_t  seek(size_t advance) override;
+    size_t  unget(size_t advance) override;
+    const void* view(size_t& available) override;
+
+    const uint8_t* data() const { return ptr; }
+
+  private:
+    std::vector<uint8_t> storage;
+    const uint8_t*       ptr  = nullptr;
+    size_t               sz   = 0;
+    size_t               pos  = 0;
+    bool                 open = false;
+
+  friend class Archive;
+  };
+
+// Read-only pack of many small files, with sorted index and optional per-entry deflate compression.
+// Layout: header, index (sorted by name), names, data.
+class Archive final {
+  public:
+    enum Compression : uint8_t {
+      Store   = 0,
+      Deflate = 1,
+      };
+
+    struct Entry {
+      std::string_view name;
+      uint64_t         offset      = 0;
+      uint64_t         packedSize  = 0;
+      uint64_t         size        = 0;
+      Compression      compression = Store;
+      };
+
+    // invoked on a worker thread; file is not open, if entry is missing or corrupted
+    using Callback = std::function<void(const std::string& name, ArchiveFile& file)>;
+
+    explicit Archive(const char*     path);
+    explicit Archive(const std::string& path);
+    explicit Archive(const char16_t* path);
+    explicit Archive(const std::u16string& path);
+    Archive(const Archive&) = delete;
+    ~Archive();
+
+    Archive& operator = (const Archive&) = delete;
+
+    size_t       count() const { return index.size(); }
+    const Entry& entry(size_t i) const { return index[i]; }
+    const Entry* find(std::string_view name) const;
+    bool         contains(std::string_view name) const { return find(name)!=nullptr; }
+
+    ArchiveFile  open(std::string_view name) const;
+    ArchiveFile  open(const Entry& e) const;
+
+    // queued reads, serviced by a worker pool; batches are issued in file order
+    void         readAsync(std::string name, Callback callback);
+    void         readAsync(std::vector<std::string> names, Callback callback);
+    // blocks until queue is drained; rethrows first exception, escaped from a callback.
+    // Must not be called from inside of a callback
+    void         wait();
+
+  private:
+    struct Pool;
+    struct Task;
+
+    MappedFile            file;
+    std::vector<Entry>    index;
+
+    std::mutex            poolSync;
+    std::unique_ptr<Pool> pool;
+
+    void                  implLoad();
+    Pool&                 workers();
+    void                  workerLoop(Pool& p);
+  };
+
+// Builds an Archive; entries are kept in memory until save
+class ArchiveWriter final {
+  public:
+    ArchiveWriter() = default;
+
+    void   add(std::string name, const void* data, size_t size, Archive::Compression c = Archive::Deflate);
+    void   add(std::string name, IDevice& dev, Archive::Compression c = Archive::Deflate);
+    // packs directory recursively; entry names are relative to path, with '/' as separator
+    bool   addDirectory(const std::string& path, Archive::Compression c = Archive::Deflate);
+
+    size_t count() const { return entries.size(); }
+
+    void   save(ODevice& out);
+    void   save(const char*     path);
+    void   save(const std::string& path);
+    void   save(const char16_t* path);
+    void   save(const std::u16string& path);
+
+  private:
+    struct Entry {
+      std::string          name;
+      std::vector<uint8_t> data;
+      uint64_t             size        = 0;
+      Archive::Compression compression = Archive::Store;
+      };
+    std::vector<Entry> entries;
+
+    bool   implAddDirectory(const std::string& path, const std::string& prefix, Archive::Compression c);
+  };
+
+}
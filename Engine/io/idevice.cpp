@@ -4,3 +4,8 @@ using namespace Tempest;
 
 IDevice::~IDevice() {
   }
+
+const void* IDevice::view(size_t& available) {
+  available = 0;
+  return nullptr;
+  }
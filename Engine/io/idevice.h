@@ -19,6 +19,10 @@ class IDevice {
     T_NODISCARD virtual uint8_t peek ()=0;
     T_NODISCARD virtual size_t  seek (size_t advance)=0;
     T_NODISCARD virtual size_t  unget(size_t advance)=0;
+
+    // contiguous view of not yet consumed bytes, if device is memory backed; nullptr otherwise
+    // pointer stays valid for lifetime of device; use seek() to consume
+    T_NODISCARD virtual const void* view(size_t& available);
   };
 
 }
@@ -0,0 +1,208 @@
+#include "mappedfile.h"
+
+#include <Tempest/TextCodec>
+#include <Tempest/Except>
+
+#ifdef __WINDOWS__
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+using namespace Tempest;
+
+MappedFile::MappedFile(const char *name) {
+#ifdef __WINDOWS__
+  std::wstring path;
+  const int len=MultiByteToWideChar(CP_UTF8,0,name,-1,nullptr,0);
+  if(len>1){
+    path.resize(size_t(len-1));
+    MultiByteToWideChar(CP_UTF8,0,name,-1,&path[0],int(path.size()));
+    }
+  implMap(path.c_str());
+#else
+  implMap(name);
+#endif
+  }
+
+MappedFile::MappedFile(const std::string &path)
+  :MappedFile(path.c_str()){
+  }
+
+MappedFile::MappedFile(const char16_t *path) {
+#ifdef __WINDOWS__
+  implMap(reinterpret_cast<const wchar_t*>(path));
+#else
+  implMap(TextCodec::toUtf8(path).c_str());
+#endif
+  }
+
+MappedFile::MappedFile(const std::u16string &path)
+  :MappedFile(path.c_str()){
+  }
+
+MappedFile::MappedFile(MappedFile &&other)
+  :ptr(other.ptr), sz(other.sz), pos(other.pos), mapped(other.mapped) {
+  other.ptr    = nullptr;
+  other.sz     = 0;
+  other.pos    = 0;
+  other.mapped = false;
+  }
+
+MappedFile::~MappedFile() {
+  implUnmap();
+  }
+
+MappedFile &MappedFile::operator =(MappedFile &&other) {
+  std::swap(ptr,   other.ptr);
+  std::swap(sz,    other.sz);
+  std::swap(pos,   other.pos);
+  std::swap(mapped,other.mapped);
+  return *this;
+  }
+
+#if defined(__WINDOWS__)
+void MappedFile::implMap(const wchar_t *wstr) {
+  HANDLE fn = CreateFileW(wstr,GENERIC_READ,FILE_SHARE_READ,nullptr,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,nullptr);
+  if(fn==HANDLE(LONG_PTR(-1)))
+    throw std::system_error(Tempest::SystemErrc::UnableToOpenFile);
+
+  LARGE_INTEGER fsz = {};
+  if(!GetFileSizeEx(fn,&fsz)) {
+    CloseHandle(fn);
+    throw std::system_error(Tempest::SystemErrc::UnableToOpenFile);
+    }
+  sz = size_t(fsz.QuadPart);
+  if(sz==0) {
+    CloseHandle(fn);
+    return;
+    }
+
+  // view keeps mapping object alive, handles can be closed right away
+  if(HANDLE map = CreateFileMappingW(fn,nullptr,PAGE_READONLY,0,0,nullptr)) {
+    ptr    = reinterpret_cast<uint8_t*>(MapViewOfFile(map,FILE_MAP_READ,0,0,0));
+    mapped = (ptr!=nullptr);
+    CloseHandle(map);
+    }
+
+  if(!mapped) {
+    ptr = reinterpret_cast<uint8_t*>(std::malloc(sz));
+    DWORD rd = 0;
+    if(ptr==nullptr || !ReadFile(fn,ptr,DWORD(sz),&rd,nullptr) || rd!=sz) {
+      std::free(ptr);
+      ptr = nullptr;
+      CloseHandle(fn);
+      throw std::system_error(Tempest::SystemErrc::UnableToOpenFile);
+      }
+    }
+  CloseHandle(fn);
+  }
+
+void MappedFile::implUnmap() {
+  if(ptr==nullptr)
+    return;
+  if(mapped)
+    UnmapViewOfFile(ptr); else
+    std::free(ptr);
+  ptr = nullptr;
+  }
+#else
+
+#if !defined(__IOS__)
+int MappedFile::implOpen(const char *cstr) {
+  return ::open(cstr,O_RDONLY | O_CLOEXEC);
+  }
+#else
+// mappedfile.mm
+#endif
+
+void MappedFile::implMap(const char *cstr) {
+  const int fd = implOpen(cstr);
+  if(fd<0)
+    throw std::system_error(Tempest::SystemErrc::UnableToOpenFile);
+
+  struct stat st = {};
+  if(fstat(fd,&st)!=0) {
+    ::close(fd);
+    throw std::system_error(Tempest::SystemErrc::UnableToOpenFile);
+    }
+  sz = size_t(st.st_size);
+  if(sz==0) {
+    ::close(fd);
+    return;
+    }
+
+  void* p = mmap(nullptr,sz,PROT_READ,MAP_PRIVATE,fd,0);
+  if(p!=MAP_FAILED) {
+    ptr    = reinterpret_cast<uint8_t*>(p);
+    mapped = true;
+    ::close(fd);
+    return;
+    }
+
+  ptr = reinterpret_cast<uint8_t*>(std::malloc(sz));
+  for(size_t rd=0; ptr!=nullptr && rd<sz;) {
+    const ssize_t r = ::read(fd,ptr+rd,sz-rd);
+    if(r<=0) {
+      std::free(ptr);
+      ptr = nullptr;
+      break;
+      }
+    rd += size_t(r);
+    }
+  ::close(fd);
+  if(ptr==nullptr)
+    throw std::system_error(Tempest::SystemErrc::UnableToOpenFile);
+  }
+
+void MappedFile::implUnmap() {
+  if(ptr==nullptr)
+    return;
+  if(mapped)
+    munmap(ptr,sz); else
+    std::free(ptr);
+  ptr = nullptr;
+  }
+#endif
+
+size_t MappedFile::read(void *dest, size_t count) {
+  const size_t c = std::min(count, sz-pos);
+  if(c>0)
+    std::memcpy(dest, ptr+pos, c);
+  pos += c;
+  return c;
+  }
+
+size_t MappedFile::size() const {
+  return sz;
+  }
+
+uint8_t MappedFile::peek() {
+  if(pos==sz)
+    return 0;
+  return ptr[pos];
+  }
+
+size_t MappedFile::seek(size_t advance) {
+  const size_t c = std::min(advance, sz-pos);
+  pos += c;
+  return c;
+  }
+
+size_t MappedFile::unget(size_t advance) {
+  const size_t c = std::min(advance, pos);
+  pos -= c;
+  return c;
+  }
+
+const void* MappedFile::view(size_t& available) {
+  available = sz-pos;
+  return ptr+pos;
+  }
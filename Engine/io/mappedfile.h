@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Tempest/IDevice>
+#include <Tempest/Platform>
+#include <string>
+
+namespace Tempest {
+
+// Read-only file, mapped into memory as a whole. Falls back to a heap copy, if file can't be mapped
+class MappedFile : public Tempest::IDevice {
+  public:
+    explicit MappedFile(const char*     path);
+    explicit MappedFile(const std::string& path);
+    explicit MappedFile(const char16_t* path);
+    explicit MappedFile(const std::u16string& path);
+    MappedFile(MappedFile&& other);
+    ~MappedFile() override;
+
+    MappedFile& operator = (MappedFile&& other);
+
+    // entire file content
+    const uint8_t* data() const { return ptr; }
+
+    size_t  read(void* to,size_t size) override;
+    size_t  size() const override;
+
+    uint8_t peek() override;
+    size_t  seek(size_t advance) override;
+    size_t  unget(size_t advance) override;
+    const void* view(size_t& available) override;
+
+    size_t  cursorPosition() const { return pos; }
+
+  private:
+    uint8_t* ptr    = nullptr;
+    size_t   sz     = 0;
+    size_t   pos    = 0;
+    bool     mapped = false;
+
+#ifdef __WINDOWS__
+    void        implMap(const wchar_t* wstr);
+#else
+    static int  implOpen(const char* cstr);
+    void        implMap(const char* cstr);
+#endif
+    void        implUnmap();
+  };
+
+}
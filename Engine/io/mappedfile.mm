@@ -0,0 +1,24 @@
+#include "mappedfile.h"
+
+#if defined(__IOS__)
+
+#include <fcntl.h>
+
+#import  <UIKit/UIKit.h>
+
+using namespace Tempest;
+
+int MappedFile::implOpen(const char *cstr) {
+  if(cstr==nullptr || cstr[0]=='/')
+    return ::open(cstr,O_RDONLY | O_CLOEXEC);
+
+  @autoreleasepool {
+    NSString *dir = [[NSBundle mainBundle] resourcePath];
+    std::string full = [dir UTF8String];
+    full += "/";
+    full += cstr;
+    return implOpen(full.c_str());
+    }
+  }
+
+#endif
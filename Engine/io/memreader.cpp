@@ -51,3 +51,8 @@ size_t MemReader::unget(size_t advance) {
   pos-=advance;
   return advance;
   }
+
+const void* MemReader::view(size_t& available) {
+  available = sz-pos;
+  return vec+pos;
+  }
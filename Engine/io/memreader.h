@@ -18,6 +18,7 @@ class MemReader : public IDevice {
     uint8_t peek() override;
     size_t  seek(size_t advance) override;
     size_t  unget(size_t advance) override;
+    const void* view(size_t& available) override;
     size_t  cursorPosition() const { return pos; }
 
   private:
@@ -121,12 +121,13 @@ uint8_t RFile::peek() {
   SetFilePointer(fn,current,nullptr,FILE_BEGIN);
   return 0;
 #else
-  uint8_t ch=0;
-  if(fread(&ch,1,1,reinterpret_cast<FILE*>(handle))==0)
+  // push back into stdio buffer, instead of seeking
+  FILE*     f  = reinterpret_cast<FILE*>(handle);
+  const int ch = fgetc(f);
+  if(ch==EOF)
     return 0;
-  if(fseek(reinterpret_cast<FILE*>(handle),-1,SEEK_CUR)==0)
-    return ch;
-  return 0;
+  ungetc(ch,f);
+  return uint8_t(ch);
 #endif
   }
 
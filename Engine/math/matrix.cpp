@@ -3,11 +3,20 @@
 #include <cmath>
 #include <algorithm>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+#  define TEMPEST_MATRIX_SSE2
+#  include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#  define TEMPEST_MATRIX_NEON
+#  include <arm_neon.h>
+#endif
+
 //#include <thirdparty/nv_math/nv_matrix.h>
 // code is based on NvMath
 #define KD_FLT_EPSILON 1.19209290E-07F
 #define KD_DEG_TO_RAD_F 0.0174532924F
 
+#if !defined(TEMPEST_MATRIX_SSE2) && !defined(TEMPEST_MATRIX_NEON)
 static void NvInvMat4x4f(float r[4][4], const float m[4][4])
 {
     float d =
@@ -151,56 +160,6 @@ static void NvInvMat4x4f(float r[4][4], const float m[4][4])
                -m[0][2] * m[1][1] * m[2][0]) / d;
 }
 
-static void NvMultMat3x3f(float r[4][4], const float a[4][4], const float b[4][4])
-{
-    //assert(NvDifferentMatsf(r, a) && NvDifferentMatsf(r, b));
-
-    r[0][0] = a[0][0]*b[0][0] + a[1][0]*b[0][1] + a[2][0]*b[0][2];
-    r[0][1] = a[0][1]*b[0][0] + a[1][1]*b[0][1] + a[2][1]*b[0][2];
-    r[0][2] = a[0][2]*b[0][0] + a[1][2]*b[0][1] + a[2][2]*b[0][2];
-    r[0][3] = 0.0f;
-
-    r[1][0] = a[0][0]*b[1][0] + a[1][0]*b[1][1] + a[2][0]*b[1][2];
-    r[1][1] = a[0][1]*b[1][0] + a[1][1]*b[1][1] + a[2][1]*b[1][2];
-    r[1][2] = a[0][2]*b[1][0] + a[1][2]*b[1][1] + a[2][2]*b[1][2];
-    r[1][3] = 0.0f;
-
-    r[2][0] = a[0][0]*b[2][0] + a[1][0]*b[2][1] + a[2][0]*b[2][2];
-    r[2][1] = a[0][1]*b[2][0] + a[1][1]*b[2][1] + a[2][1]*b[2][2];
-    r[2][2] = a[0][2]*b[2][0] + a[1][2]*b[2][1] + a[2][2]*b[2][2];
-    r[2][3] = 0.0f;
-
-    r[3][0] = 0.0f;
-    r[3][1] = 0.0f;
-    r[3][2] = 0.0f;
-    r[3][3] = 1.0f;
-}
-
-static void NvMultMat4x3f(float r[4][4], const float a[4][4], const float b[4][4])
-{
-    //assert(NvDifferentMatsf(r, a) && NvDifferentMatsf(r, b));
-
-    r[0][0] = a[0][0]*b[0][0] + a[1][0]*b[0][1] + a[2][0]*b[0][2];
-    r[0][1] = a[0][1]*b[0][0] + a[1][1]*b[0][1] + a[2][1]*b[0][2];
-    r[0][2] = a[0][2]*b[0][0] + a[1][2]*b[0][1] + a[2][2]*b[0][2];
-    r[0][3] = 0.0f;
-
-    r[1][0] = a[0][0]*b[1][0] + a[1][0]*b[1][1] + a[2][0]*b[1][2];
-    r[1][1] = a[0][1]*b[1][0] + a[1][1]*b[1][1] + a[2][1]*b[1][2];
-    r[1][2] = a[0][2]*b[1][0] + a[1][2]*b[1][1] + a[2][2]*b[1][2];
-    r[1][3] = 0.0f;
-
-    r[2][0] = a[0][0]*b[2][0] + a[1][0]*b[2][1] + a[2][0]*b[2][2];
-    r[2][1] = a[0][1]*b[2][0] + a[1][1]*b[2][1] + a[2][1]*b[2][2];
-    r[2][2] = a[0][2]*b[2][0] + a[1][2]*b[2][1] + a[2][2]*b[2][2];
-    r[2][3] = 0.0f;
-
-    r[3][0] = a[0][0]*b[3][0] + a[1][0]*b[3][1] + a[2][0]*b[3][2] + a[3][0];
-    r[3][1] = a[0][1]*b[3][0] + a[1][1]*b[3][1] + a[2][1]*b[3][2] + a[3][1];
-    r[3][2] = a[0][2]*b[3][0] + a[1][2]*b[3][1] + a[2][2]*b[3][2] + a[3][2];
-    r[3][3] = 1.0f;
-}
-
 static void NvMultMat4x4f(float r[4][4], const float a[4][4], const float b[4][4])
 {
     //assert(NvDifferentMatsf(r, a) && NvDifferentMatsf(r, b));
@@ -226,49 +185,170 @@ static void NvMultMat4x4f(float r[4][4], const float a[4][4], const float b[4][4
     r[3][3] = a[0][3]*b[3][0]+a[1][3]*b[3][1]+a[2][3]*b[3][2]+a[3][3]*b[3][3];
 }
 
-static void NvMultMatf(float result[4][4], const float a[4][4], const float b[4][4])
-{
-    /*
-      Use a temporary matrix for the result and copy the temporary
-      into the result when finished. Doing this instead of writing
-      the result directly guarantees that the routine will work even
-      if the result overlaps one or more of the arguments in
-      memory.
-    */
-
-    float r[4][4];
-
-    if ((a[0][3]==0.0f) &&
-        (a[1][3]==0.0f) &&
-        (a[2][3]==0.0f) &&
-        (a[2][3]==1.0f) &&
-        (b[0][3]==0.0f) &&
-        (b[1][3]==0.0f) &&
-        (b[2][3]==0.0f) &&
-        (b[2][3]==1.0f))
-    {
-        if ((a[3][0]==0.0f) &&
-            (a[3][1]==0.0f) &&
-            (a[3][2]==0.0f) &&
-            (b[3][0]==0.0f) &&
-            (b[3][1]==0.0f) &&
-            (b[3][2]==0.0f))
-        {
-            NvMultMat3x3f(r, a, b);
-        }
-        else
-        {
-            NvMultMat4x3f(r, a, b);
-        }
+#endif
+
+// matrices are column-major: m[i] is a column, so r[i] = a*b[i] and
+// a column can be processed as one 4-wide vector
+static void mulMat(float r[4][4], const float a[4][4], const float b[4][4]) {
+#if defined(TEMPEST_MATRIX_SSE2)
+  const __m128 a0 = _mm_loadu_ps(a[0]);
+  const __m128 a1 = _mm_loadu_ps(a[1]);
+  const __m128 a2 = _mm_loadu_ps(a[2]);
+  const __m128 a3 = _mm_loadu_ps(a[3]);
+  for(int i=0; i<4; ++i) {
+    // 'b[i]' is read before 'r[i]' is written, so 'r' may alias 'a' or 'b'
+    const __m128 bi = _mm_loadu_ps(b[i]);
+    __m128 v =          _mm_mul_ps(a0,_mm_shuffle_ps(bi,bi,_MM_SHUFFLE(0,0,0,0)));
+    v = _mm_add_ps(v,   _mm_mul_ps(a1,_mm_shuffle_ps(bi,bi,_MM_SHUFFLE(1,1,1,1))));
+    v = _mm_add_ps(v,   _mm_mul_ps(a2,_mm_shuffle_ps(bi,bi,_MM_SHUFFLE(2,2,2,2))));
+    v = _mm_add_ps(v,   _mm_mul_ps(a3,_mm_shuffle_ps(bi,bi,_MM_SHUFFLE(3,3,3,3))));
+    _mm_storeu_ps(r[i],v);
     }
-    else
-    {
-         NvMultMat4x4f(r, a, b);
+#elif defined(TEMPEST_MATRIX_NEON)
+  const float32x4_t a0 = vld1q_f32(a[0]);
+  const float32x4_t a1 = vld1q_f32(a[1]);
+  const float32x4_t a2 = vld1q_f32(a[2]);
+  const float32x4_t a3 = vld1q_f32(a[3]);
+  for(int i=0; i<4; ++i) {
+    const float32x4_t bi = vld1q_f32(b[i]);
+    float32x4_t v = vmulq_laneq_f32(a0,bi,0);
+    v = vfmaq_laneq_f32(v,a1,bi,1);
+    v = vfmaq_laneq_f32(v,a2,bi,2);
+    v = vfmaq_laneq_f32(v,a3,bi,3);
+    vst1q_f32(r[i],v);
     }
+#else
+  float t[4][4];
+  NvMultMat4x4f(t,a,b);
+  std::memcpy(r,t,sizeof(t));
+#endif
+  }
 
-    std::memcpy(result, r, sizeof(r));
-}
+static void projectVec(const float m[4][4], float v[4]) {
+#if defined(TEMPEST_MATRIX_SSE2)
+  __m128 r =        _mm_mul_ps(_mm_loadu_ps(m[0]),_mm_set1_ps(v[0]));
+  r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(m[1]),_mm_set1_ps(v[1])));
+  r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(m[2]),_mm_set1_ps(v[2])));
+  r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(m[3]),_mm_set1_ps(v[3])));
+  _mm_storeu_ps(v,r);
+#elif defined(TEMPEST_MATRIX_NEON)
+  const float32x4_t a = vld1q_f32(v);
+  float32x4_t r = vmulq_laneq_f32(vld1q_f32(m[0]),a,0);
+  r = vfmaq_laneq_f32(r,vld1q_f32(m[1]),a,1);
+  r = vfmaq_laneq_f32(r,vld1q_f32(m[2]),a,2);
+  r = vfmaq_laneq_f32(r,vld1q_f32(m[3]),a,3);
+  vst1q_f32(v,r);
+#else
+  const float a[4] = {v[0],v[1],v[2],v[3]};
+  v[0] = m[0][0] * a[0] + m[1][0] * a[1] + m[2][0] * a[2] + m[3][0] * a[3];
+  v[1] = m[0][1] * a[0] + m[1][1] * a[1] + m[2][1] * a[2] + m[3][1] * a[3];
+  v[2] = m[0][2] * a[0] + m[1][2] * a[1] + m[2][2] * a[2] + m[3][2] * a[3];
+  v[3] = m[0][3] * a[0] + m[1][3] * a[1] + m[2][3] * a[2] + m[3][3] * a[3];
+#endif
+  }
 
+// adjugate from 2x2 minors of first (s) and last (c) two columns:
+//   P[k] = { a1k,-a0k, a3k,-a2k }, C[n] = { c[n], c[n], s[n], s[n] }
+//   r0 =  P1*C5 - P2*C4 + P3*C3      r2 =  P0*C4 - P1*C2 + P3*C0
+//   r1 = -P0*C5 + P2*C2 - P3*C1      r3 = -P0*C3 + P1*C1 - P2*C0
+static void invMat(float r[4][4], const float a[4][4]) {
+#if defined(TEMPEST_MATRIX_SSE2)
+  const __m128 m0 = _mm_loadu_ps(a[0]);
+  const __m128 m1 = _mm_loadu_ps(a[1]);
+  const __m128 m2 = _mm_loadu_ps(a[2]);
+  const __m128 m3 = _mm_loadu_ps(a[3]);
+
+  // minors for pairs (0,1) (0,2) (0,3) (1,2) and (1,3) (2,3)
+  const __m128 s03 = _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(m0,m0,_MM_SHUFFLE(1,0,0,0)),_mm_shuffle_ps(m1,m1,_MM_SHUFFLE(2,3,2,1))),
+                                _mm_mul_ps(_mm_shuffle_ps(m1,m1,_MM_SHUFFLE(1,0,0,0)),_mm_shuffle_ps(m0,m0,_MM_SHUFFLE(2,3,2,1))));
+  const __m128 s45 = _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(m0,m0,_MM_SHUFFLE(2,1,2,1)),_mm_shuffle_ps(m1,m1,_MM_SHUFFLE(3,3,3,3))),
+                                _mm_mul_ps(_mm_shuffle_ps(m1,m1,_MM_SHUFFLE(2,1,2,1)),_mm_shuffle_ps(m0,m0,_MM_SHUFFLE(3,3,3,3))));
+  const __m128 c03 = _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(m2,m2,_MM_SHUFFLE(1,0,0,0)),_mm_shuffle_ps(m3,m3,_MM_SHUFFLE(2,3,2,1))),
+                                _mm_mul_ps(_mm_shuffle_ps(m3,m3,_MM_SHUFFLE(1,0,0,0)),_mm_shuffle_ps(m2,m2,_MM_SHUFFLE(2,3,2,1))));
+  const __m128 c45 = _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(m2,m2,_MM_SHUFFLE(2,1,2,1)),_mm_shuffle_ps(m3,m3,_MM_SHUFFLE(3,3,3,3))),
+                                _mm_mul_ps(_mm_shuffle_ps(m3,m3,_MM_SHUFFLE(2,1,2,1)),_mm_shuffle_ps(m2,m2,_MM_SHUFFLE(3,3,3,3))));
+
+  const __m128 C0 = _mm_shuffle_ps(c03,s03,_MM_SHUFFLE(0,0,0,0));
+  const __m128 C1 = _mm_shuffle_ps(c03,s03,_MM_SHUFFLE(1,1,1,1));
+  const __m128 C2 = _mm_shuffle_ps(c03,s03,_MM_SHUFFLE(2,2,2,2));
+  const __m128 C3 = _mm_shuffle_ps(c03,s03,_MM_SHUFFLE(3,3,3,3));
+  const __m128 C4 = _mm_shuffle_ps(c45,s45,_MM_SHUFFLE(0,0,0,0));
+  const __m128 C5 = _mm_shuffle_ps(c45,s45,_MM_SHUFFLE(1,1,1,1));
+
+  __m128 t0 = m0, t1 = m1, t2 = m2, t3 = m3;
+  _MM_TRANSPOSE4_PS(t0,t1,t2,t3);
+  const __m128 sign = _mm_set_ps(-0.f,0.f,-0.f,0.f);
+  const __m128 P0 = _mm_xor_ps(_mm_shuffle_ps(t0,t0,_MM_SHUFFLE(2,3,0,1)),sign);
+  const __m128 P1 = _mm_xor_ps(_mm_shuffle_ps(t1,t1,_MM_SHUFFLE(2,3,0,1)),sign);
+  const __m128 P2 = _mm_xor_ps(_mm_shuffle_ps(t2,t2,_MM_SHUFFLE(2,3,0,1)),sign);
+  const __m128 P3 = _mm_xor_ps(_mm_shuffle_ps(t3,t3,_MM_SHUFFLE(2,3,0,1)),sign);
+
+  __m128 r0 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(P1,C5),_mm_mul_ps(P2,C4)),_mm_mul_ps(P3,C3));
+  __m128 r1 = _mm_sub_ps(_mm_sub_ps(_mm_mul_ps(P2,C2),_mm_mul_ps(P0,C5)),_mm_mul_ps(P3,C1));
+  __m128 r2 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(P0,C4),_mm_mul_ps(P1,C2)),_mm_mul_ps(P3,C0));
+  __m128 r3 = _mm_sub_ps(_mm_sub_ps(_mm_mul_ps(P1,C1),_mm_mul_ps(P0,C3)),_mm_mul_ps(P2,C0));
+
+  // det = dot(a[0], first components of r0..r3)
+  const __m128 col = _mm_movelh_ps(_mm_unpacklo_ps(r0,r1),_mm_unpacklo_ps(r2,r3));
+  __m128 d = _mm_mul_ps(m0,col);
+  d = _mm_add_ps(d,_mm_shuffle_ps(d,d,_MM_SHUFFLE(2,3,0,1)));
+  d = _mm_add_ps(d,_mm_shuffle_ps(d,d,_MM_SHUFFLE(1,0,3,2)));
+  const __m128 id = _mm_div_ps(_mm_set1_ps(1.f),d);
+
+  _mm_storeu_ps(r[0],_mm_mul_ps(r0,id));
+  _mm_storeu_ps(r[1],_mm_mul_ps(r1,id));
+  _mm_storeu_ps(r[2],_mm_mul_ps(r2,id));
+  _mm_storeu_ps(r[3],_mm_mul_ps(r3,id));
+#elif defined(TEMPEST_MATRIX_NEON)
+  float s[6], c[6];
+  s[0] = a[0][0]*a[1][1] - a[1][0]*a[0][1];
+  s[1] = a[0][0]*a[1][2] - a[1][0]*a[0][2];
+  s[2] = a[0][0]*a[1][3] - a[1][0]*a[0][3];
+  s[3] = a[0][1]*a[1][2] - a[1][1]*a[0][2];
+  s[4] = a[0][1]*a[1][3] - a[1][1]*a[0][3];
+  s[5] = a[0][2]*a[1][3] - a[1][2]*a[0][3];
+  c[0] = a[2][0]*a[3][1] - a[3][0]*a[2][1];
+  c[1] = a[2][0]*a[3][2] - a[3][0]*a[2][2];
+  c[2] = a[2][0]*a[3][3] - a[3][0]*a[2][3];
+  c[3] = a[2][1]*a[3][2] - a[3][1]*a[2][2];
+  c[4] = a[2][1]*a[3][3] - a[3][1]*a[2][3];
+  c[5] = a[2][2]*a[3][3] - a[3][2]*a[2][3];
+  const float det = s[0]*c[5] - s[1]*c[4] + s[2]*c[3] + s[3]*c[2] - s[4]*c[1] + s[5]*c[0];
+
+  float32x4_t C[6];
+  for(int i=0; i<6; ++i)
+    C[i] = vcombine_f32(vdup_n_f32(c[i]),vdup_n_f32(s[i]));
+
+  // vld4 deinterleaves columns into rows
+  const float32x4x4_t t    = vld4q_f32(&a[0][0]);
+  const float         sg[4] = {1.f,-1.f,1.f,-1.f};
+  const float32x4_t   sign = vld1q_f32(sg);
+  const float32x4_t   P0   = vmulq_f32(vrev64q_f32(t.val[0]),sign);
+  const float32x4_t   P1   = vmulq_f32(vrev64q_f32(t.val[1]),sign);
+  const float32x4_t   P2   = vmulq_f32(vrev64q_f32(t.val[2]),sign);
+  const float32x4_t   P3   = vmulq_f32(vrev64q_f32(t.val[3]),sign);
+
+  const float32x4_t r0 = vfmaq_f32(vfmsq_f32(vmulq_f32(P1,C[5]),P2,C[4]),P3,C[3]);
+  const float32x4_t r1 = vfmsq_f32(vfmsq_f32(vmulq_f32(P2,C[2]),P0,C[5]),P3,C[1]);
+  const float32x4_t r2 = vfmaq_f32(vfmsq_f32(vmulq_f32(P0,C[4]),P1,C[2]),P3,C[0]);
+  const float32x4_t r3 = vfmsq_f32(vfmsq_f32(vmulq_f32(P1,C[1]),P0,C[3]),P2,C[0]);
+
+  const float id = 1.f/det;
+  vst1q_f32(r[0],vmulq_n_f32(r0,id));
+  vst1q_f32(r[1],vmulq_n_f32(r1,id));
+  vst1q_f32(r[2],vmulq_n_f32(r2,id));
+  vst1q_f32(r[3],vmulq_n_f32(r3,id));
+#else
+  float t[4][4], ret[4][4];
+  for(int i=0; i<4; ++i)
+    for(int j=0; j<4; ++j)
+      t[i][j] = a[j][i];
+  NvInvMat4x4f(ret,t);
+  for(int i=0; i<4; ++i)
+    for(int j=0; j<4; ++j)
+      r[i][j] = ret[j][i];
+#endif
+  }
 
 using namespace Tempest;
 
@@ -452,20 +532,27 @@ void Matrix4x4::transpose(){
   }
 
 void Matrix4x4::inverse(){
-  for( int i=0; i<4; ++i )
-    for( int r=0; r<i; ++r )
-      std::swap( m[i][r], m[r][i] );
-  float ret[4][4];
-  NvInvMat4x4f( ret, m );
-  std::memcpy(m,ret,sizeof(ret));
-  //NvInvMatf( m, m );
-  for( int i=0; i<4; ++i )
-    for( int r=0; r<i; ++r )
-      std::swap( m[i][r], m[r][i] );
+  invMat(m,m);
   }
 
 void Matrix4x4::mul( const Matrix4x4& other ){
-  NvMultMatf( m, m, other.m );
+  mulMat(m,m,other.m);
+  }
+
+void Matrix4x4::mul(Matrix4x4* out, const Matrix4x4* a, const Matrix4x4* b, size_t count) {
+  for(size_t i=0; i<count; ++i)
+    mulMat(out[i].m,a[i].m,b[i].m);
+  }
+
+void Matrix4x4::mul(Matrix4x4* out, const Matrix4x4& a, const Matrix4x4* b, size_t count) {
+  const Matrix4x4 pa = a; // 'a' may be part of 'out'
+  for(size_t i=0; i<count; ++i)
+    mulMat(out[i].m,pa.m,b[i].m);
+  }
+
+void Matrix4x4::inverse(Matrix4x4* out, const Matrix4x4* in, size_t count) {
+  for(size_t i=0; i<count; ++i)
+    invMat(out[i].m,in[i].m);
   }
 
 void Matrix4x4::setData( float a11, float a12, float a13, float a14,
@@ -497,11 +584,12 @@ void Matrix4x4::setData( float a11, float a12, float a13, float a14,
 void Matrix4x4::project( float   x, float   y, float   z, float   w,
                          float &ox, float &oy, float &oz, float &ow ) const {
   float a[4] = {x,y,z,w};
+  projectVec(m,a);
 
-  ox = m[0][0] * a[0] + m[1][0] * a[1] + m[2][0] * a[2] + m[3][0] * a[3];
-  oy = m[0][1] * a[0] + m[1][1] * a[1] + m[2][1] * a[2] + m[3][1] * a[3];
-  oz = m[0][2] * a[0] + m[1][2] * a[1] + m[2][2] * a[2] + m[3][2] * a[3];
-  ow = m[0][3] * a[0] + m[1][3] * a[1] + m[2][3] * a[2] + m[3][3] * a[3];
+  ox = a[0];
+  oy = a[1];
+  oz = a[2];
+  ow = a[3];
   }
 
 void Matrix4x4::perspective(float angle, float aspect, float zNear, float zFar) {
@@ -539,38 +627,7 @@ void Matrix4x4::ortho(int width,int height,float zNear, float zFar) {
 
 Matrix4x4 Matrix4x4::operator * (const Matrix4x4& other) const {
   Matrix4x4 r;
-
-  auto& a = m;
-  auto& b = other.m;
-
-  if ((a[0][3]==0.0f) &&
-      (a[1][3]==0.0f) &&
-      (a[2][3]==0.0f) &&
-      (a[2][3]==1.0f) &&
-      (b[0][3]==0.0f) &&
-      (b[1][3]==0.0f) &&
-      (b[2][3]==0.0f) &&
-      (b[2][3]==1.0f))
-  {
-      if ((a[3][0]==0.0f) &&
-          (a[3][1]==0.0f) &&
-          (a[3][2]==0.0f) &&
-          (b[3][0]==0.0f) &&
-          (b[3][1]==0.0f) &&
-          (b[3][2]==0.0f))
-      {
-          NvMultMat3x3f(r.m, a, b);
-      }
-      else
-      {
-          NvMultMat4x3f(r.m, a, b);
-      }
-  }
-  else
-  {
-       NvMultMat4x4f(r.m, a, b);
-  }
-
+  mulMat(r.m,m,other.m);
   return r;
   }
 
@@ -580,11 +637,11 @@ void Tempest::Matrix4x4::project(float &x, float &y, float &z, float &w) const {
   }
 
 void Matrix4x4::project(float &x, float &y, float &z) const {
-  float w = 1;
-  project(x,y,z,w);
-  x /= w;
-  y /= w;
-  z /= w;
+  float a[4] = {x,y,z,1};
+  projectVec(m,a);
+  x = a[0]/a[3];
+  y = a[1]/a[3];
+  z = a[2]/a[3];
   }
 
 void Matrix4x4::project(Vec4& v) const {
@@ -594,3 +651,97 @@ void Matrix4x4::project(Vec4& v) const {
 void Matrix4x4::project(Vec3& v) const {
   project(v.x,v.y,v.z);
   }
+
+void Matrix4x4::project(Vec4* out, const Vec4* in, size_t count) const {
+#if defined(TEMPEST_MATRIX_SSE2)
+  const __m128 c0 = _mm_loadu_ps(m[0]);
+  const __m128 c1 = _mm_loadu_ps(m[1]);
+  const __m128 c2 = _mm_loadu_ps(m[2]);
+  const __m128 c3 = _mm_loadu_ps(m[3]);
+  for(size_t i=0; i<count; ++i) {
+    const __m128 v = _mm_loadu_ps(&in[i].x);
+    __m128 r =        _mm_mul_ps(c0,_mm_shuffle_ps(v,v,_MM_SHUFFLE(0,0,0,0)));
+    r = _mm_add_ps(r, _mm_mul_ps(c1,_mm_shuffle_ps(v,v,_MM_SHUFFLE(1,1,1,1))));
+    r = _mm_add_ps(r, _mm_mul_ps(c2,_mm_shuffle_ps(v,v,_MM_SHUFFLE(2,2,2,2))));
+    r = _mm_add_ps(r, _mm_mul_ps(c3,_mm_shuffle_ps(v,v,_MM_SHUFFLE(3,3,3,3))));
+    _mm_storeu_ps(&out[i].x,r);
+    }
+#elif defined(TEMPEST_MATRIX_NEON)
+  const float32x4_t c0 = vld1q_f32(m[0]);
+  const float32x4_t c1 = vld1q_f32(m[1]);
+  const float32x4_t c2 = vld1q_f32(m[2]);
+  const float32x4_t c3 = vld1q_f32(m[3]);
+  for(size_t i=0; i<count; ++i) {
+    const float32x4_t v = vld1q_f32(&in[i].x);
+    float32x4_t r = vmulq_laneq_f32(c0,v,0);
+    r = vfmaq_laneq_f32(r,c1,v,1);
+    r = vfmaq_laneq_f32(r,c2,v,2);
+    r = vfmaq_laneq_f32(r,c3,v,3);
+    vst1q_f32(&out[i].x,r);
+    }
+#else
+  for(size_t i=0; i<count; ++i) {
+    out[i] = in[i];
+    project(out[i]);
+    }
+#endif
+  }
+
+void Matrix4x4::project(Vec3* out, const Vec3* in, size_t count) const {
+  size_t i = 0;
+#if defined(TEMPEST_MATRIX_SSE2) || defined(TEMPEST_MATRIX_NEON)
+  // structure-of-arrays: 4 points per iteration, one lane per point
+  alignas(16) float x[4], y[4], z[4];
+#endif
+#if defined(TEMPEST_MATRIX_SSE2)
+  __m128 k[4][4];
+  for(int c=0; c<4; ++c)
+    for(int r=0; r<4; ++r)
+      k[c][r] = _mm_set1_ps(m[c][r]);
+  const __m128 one = _mm_set1_ps(1.f);
+  for(; i+4<=count; i+=4) {
+    const Vec3*  v  = in+i;
+    const __m128 vx = _mm_set_ps(v[3].x,v[2].x,v[1].x,v[0].x);
+    const __m128 vy = _mm_set_ps(v[3].y,v[2].y,v[1].y,v[0].y);
+    const __m128 vz = _mm_set_ps(v[3].z,v[2].z,v[1].z,v[0].z);
+    __m128 o[4];
+    for(int r=0; r<4; ++r)
+      o[r] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(k[0][r],vx),_mm_mul_ps(k[1][r],vy)),
+                        _mm_add_ps(_mm_mul_ps(k[2][r],vz),k[3][r]));
+    const __m128 iw = _mm_div_ps(one,o[3]);
+    _mm_store_ps(x,_mm_mul_ps(o[0],iw));
+    _mm_store_ps(y,_mm_mul_ps(o[1],iw));
+    _mm_store_ps(z,_mm_mul_ps(o[2],iw));
+    for(int l=0; l<4; ++l)
+      out[i+l] = Vec3(x[l],y[l],z[l]);
+    }
+#elif defined(TEMPEST_MATRIX_NEON)
+  float32x4_t k[4][4];
+  for(int c=0; c<4; ++c)
+    for(int r=0; r<4; ++r)
+      k[c][r] = vdupq_n_f32(m[c][r]);
+  for(; i+4<=count; i+=4) {
+    for(int l=0; l<4; ++l) {
+      x[l] = in[i+l].x;
+      y[l] = in[i+l].y;
+      z[l] = in[i+l].z;
+      }
+    const float32x4_t vx = vld1q_f32(x);
+    const float32x4_t vy = vld1q_f32(y);
+    const float32x4_t vz = vld1q_f32(z);
+    float32x4_t o[4];
+    for(int r=0; r<4; ++r)
+      o[r] = vfmaq_f32(vfmaq_f32(vfmaq_f32(k[3][r],k[0][r],vx),k[1][r],vy),k[2][r],vz);
+    const float32x4_t iw = vdivq_f32(vdupq_n_f32(1.f),o[3]);
+    vst1q_f32(x,vmulq_f32(o[0],iw));
+    vst1q_f32(y,vmulq_f32(o[1],iw));
+    vst1q_f32(z,vmulq_f32(o[2],iw));
+    for(int l=0; l<4; ++l)
+      out[i+l] = Vec3(x[l],y[l],z[l]);
+    }
+#endif
+  for(; i<count; ++i) {
+    out[i] = in[i];
+    project(out[i]);
+    }
+  }
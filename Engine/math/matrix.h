@@ -82,12 +82,19 @@ class Matrix4x4 final {
     void inverse();
     void mul(const Matrix4x4& other);
 
+    // batch versions; 'out' may be the same array as input
+    static void mul    (Matrix4x4* out, const Matrix4x4* a, const Matrix4x4* b, size_t count);
+    static void mul    (Matrix4x4* out, const Matrix4x4& a, const Matrix4x4* b, size_t count);
+    static void inverse(Matrix4x4* out, const Matrix4x4* in, size_t count);
+
     void project(float   x, float   y, float   z, float   w,
                  float &ox, float &oy, float &oz, float &ow ) const;
     void project(float & x, float & y, float & z, float & w ) const;
     void project(float & x, float & y, float & z ) const;
     void project(Vec4& v) const;
     void project(Vec3& v) const;
+    void project(Vec4* out, const Vec4* in, size_t count) const;
+    void project(Vec3* out, const Vec3* in, size_t count) const;
 
     void perspective( float angle, float aspect, float zNear, float zFar);
     void ortho(int width, int height, float zNear, float zFar);
@@ -0,0 +1,306 @@
+#include "adpcm.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+#  define TEMPEST_ADPCM_SSE2
+#  include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  define TEMPEST_ADPCM_NEON
+#  include <arm_neon.h>
+#endif
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+const uint16_t AdPcm::stepTable[89] = {
+  7, 8, 9, 10, 11, 12, 13, 14,
+  16, 17, 19, 21, 23, 25, 28, 31,
+  34, 37, 41, 45, 50, 55, 60, 66,
+  73, 80, 88, 97, 107, 118, 130, 143,
+  157, 173, 190, 209, 230, 253, 279, 307,
+  337, 371, 408, 449, 494, 544, 598, 658,
+  724, 796, 876, 963, 1060, 1166, 1282, 1411,
+  1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024,
+  3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484,
+  7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+  15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+  32767
+  };
+
+const int32_t AdPcm::indexTable[8] = {
+  /* adpcm data size is 4 */
+  -1, -1, -1, -1, 2, 4, 6, 8
+  };
+
+namespace {
+
+enum {
+  SimdLanes          = 4,
+  MinBlocksPerThread = 64,
+  };
+
+// one channel of one block
+struct Lane {
+  const uint8_t* src  = nullptr; // first 4-byte chunk of this channel
+  int16_t*       dst  = nullptr; // first frame after header sample
+  int32_t        pred = 0;
+  int32_t        idx  = 0;
+  };
+
+}
+
+#if defined(TEMPEST_ADPCM_SSE2)
+static void decodeLanes(const Lane* ln, uint32_t chunks, uint16_t channels, const uint16_t* stepTable) {
+  alignas(16) int32_t tmp[SimdLanes] = {};
+  const size_t  srcStride = size_t(channels)*4;
+
+  const __m128i zero  = _mm_setzero_si128();
+  const __m128i c1    = _mm_set1_epi32(1);
+  const __m128i c2    = _mm_set1_epi32(2);
+  const __m128i c3    = _mm_set1_epi32(3);
+  const __m128i c4    = _mm_set1_epi32(4);
+  const __m128i c7    = _mm_set1_epi32(7);
+  const __m128i c8    = _mm_set1_epi32(8);
+  const __m128i c15   = _mm_set1_epi32(15);
+  const __m128i c88   = _mm_set1_epi32(88);
+  const __m128i cm1   = _mm_set1_epi32(-1);
+
+  __m128i pred  = _mm_setr_epi32(ln[0].pred, ln[1].pred, ln[2].pred, ln[3].pred);
+  __m128i index = _mm_setr_epi32(ln[0].idx,  ln[1].idx,  ln[2].idx,  ln[3].idx);
+
+  for(uint32_t k=0; k<chunks; ++k) {
+    int32_t code[SimdLanes];
+    for(int l=0; l<SimdLanes; ++l)
+      std::memcpy(&code[l], ln[l].src + k*srcStride, 4);
+    __m128i codes = _mm_setr_epi32(code[0], code[1], code[2], code[3]);
+
+    const size_t frame = size_t(k)*8;
+    for(int j=0; j<8; ++j) {
+      _mm_store_si128(reinterpret_cast<__m128i*>(tmp), index);
+      const __m128i step = _mm_setr_epi32(stepTable[tmp[0]], stepTable[tmp[1]], stepTable[tmp[2]], stepTable[tmp[3]]);
+      const __m128i nib  = _mm_and_si128(codes, c15);
+      codes = _mm_srli_epi32(codes, 4);
+
+      __m128i delta = _mm_srai_epi32(step, 3);
+      delta = _mm_add_epi32(delta, _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(nib,c1),c1), _mm_srai_epi32(step,2)));
+      delta = _mm_add_epi32(delta, _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(nib,c2),c2), _mm_srai_epi32(step,1)));
+      delta = _mm_add_epi32(delta, _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(nib,c4),c4), step));
+      const __m128i sign = _mm_cmpeq_epi32(_mm_and_si128(nib,c8), c8);
+      delta = _mm_sub_epi32(_mm_xor_si128(delta,sign), sign);
+
+      // clamp to int16 by saturating pack and sign-extend back
+      pred = _mm_add_epi32(pred, delta);
+      const __m128i p16 = _mm_packs_epi32(pred, pred);
+      pred = _mm_srai_epi32(_mm_unpacklo_epi16(p16,p16), 16);
+
+      // indexTable: -1 for 0..3, (v-3)*2 for 4..7
+      const __m128i v   = _mm_and_si128(nib, c7);
+      const __m128i big = _mm_cmpgt_epi32(v, c3);
+      const __m128i inc = _mm_or_si128(_mm_and_si128(big, _mm_slli_epi32(_mm_sub_epi32(v,c3),1)), _mm_andnot_si128(big, cm1));
+      index = _mm_add_epi32(index, inc);
+      // values are in [-1..96]: 16-bit min/max is exact for both halves
+      index = _mm_min_epi16(_mm_max_epi16(index, zero), c88);
+
+      _mm_store_si128(reinterpret_cast<__m128i*>(tmp), pred);
+      for(int l=0; l<SimdLanes; ++l)
+        ln[l].dst[(frame+size_t(j))*channels] = int16_t(tmp[l]);
+      }
+    }
+  }
+#elif defined(TEMPEST_ADPCM_NEON)
+static void decodeLanes(const Lane* ln, uint32_t chunks, uint16_t channels, const uint16_t* stepTable) {
+  int32_t      tmp[SimdLanes] = {};
+  const size_t srcStride = size_t(channels)*4;
+
+  int32x4_t pred  = {ln[0].pred, ln[1].pred, ln[2].pred, ln[3].pred};
+  int32x4_t index = {ln[0].idx,  ln[1].idx,  ln[2].idx,  ln[3].idx };
+
+  for(uint32_t k=0; k<chunks; ++k) {
+    uint32_t code[SimdLanes];
+    for(int l=0; l<SimdLanes; ++l)
+      std::memcpy(&code[l], ln[l].src + k*srcStride, 4);
+    uint32x4_t codes = vld1q_u32(code);
+
+    const size_t frame = size_t(k)*8;
+    for(int j=0; j<8; ++j) {
+      vst1q_s32(tmp, index);
+      const int32_t   st[SimdLanes] = {stepTable[tmp[0]], stepTable[tmp[1]], stepTable[tmp[2]], stepTable[tmp[3]]};
+      const int32x4_t step = vld1q_s32(st);
+      const int32x4_t nib  = vreinterpretq_s32_u32(vandq_u32(codes, vdupq_n_u32(15)));
+      codes = vshrq_n_u32(codes, 4);
+
+      int32x4_t delta = vshrq_n_s32(step, 3);
+      delta = vaddq_s32(delta, vandq_s32(vreinterpretq_s32_u32(vtstq_s32(nib, vdupq_n_s32(1))), vshrq_n_s32(step,2)));
+      delta = vaddq_s32(delta, vandq_s32(vreinterpretq_s32_u32(vtstq_s32(nib, vdupq_n_s32(2))), vshrq_n_s32(step,1)));
+      delta = vaddq_s32(delta, vandq_s32(vreinterpretq_s32_u32(vtstq_s32(nib, vdupq_n_s32(4))), step));
+      const int32x4_t sign = vreinterpretq_s32_u32(vtstq_s32(nib, vdupq_n_s32(8)));
+      delta = vsubq_s32(veorq_s32(delta,sign), sign);
+
+      pred = vaddq_s32(pred, delta);
+      pred = vmaxq_s32(vminq_s32(pred, vdupq_n_s32(32767)), vdupq_n_s32(-32768));
+
+      const int32x4_t  v   = vandq_s32(nib, vdupq_n_s32(7));
+      const uint32x4_t big = vcgtq_s32(v, vdupq_n_s32(3));
+      const int32x4_t  inc = vbslq_s32(big, vshlq_n_s32(vsubq_s32(v,vdupq_n_s32(3)),1), vdupq_n_s32(-1));
+      index = vaddq_s32(index, inc);
+      index = vminq_s32(vmaxq_s32(index, vdupq_n_s32(0)), vdupq_n_s32(88));
+
+      vst1q_s32(tmp, pred);
+      for(int l=0; l<SimdLanes; ++l)
+        ln[l].dst[(frame+size_t(j))*channels] = int16_t(tmp[l]);
+      }
+    }
+  }
+#endif
+
+uint32_t AdPcm::framesPerBlock(uint16_t blockAlign, uint16_t channels) {
+  if(channels==0 || channels>2 || blockAlign<channels*4)
+    return 0;
+  return uint32_t(blockAlign-channels*4)*uint32_t(channels^3)+1;
+  }
+
+bool AdPcm::isValidHeader(const uint8_t* in, uint16_t channels) {
+  for(uint16_t ch=0; ch<channels; ++ch) {
+    if(in[ch*4+2]>88 || in[ch*4+3]!=0)
+      return false;
+    }
+  return true;
+  }
+
+uint32_t AdPcm::decodeBlock(int16_t *outbuf, const uint8_t *inbuf, size_t inbufsize, uint16_t channels) {
+  int32_t samples = 1;
+  int32_t pcmdata[2]={};
+  int8_t  index[2]={};
+
+  if(inbufsize<channels * 4 || channels>2)
+    return 0;
+
+  for(int ch=0; ch<channels; ch++) {
+    *outbuf++ = int16_t(pcmdata[ch] = int16_t(inbuf [0] | (inbuf [1] << 8)));
+    index[ch] = int8_t(inbuf[2]);
+
+    if(index[ch]<0 || index[ch]>88 || inbuf[3])     // sanitize the input a little...
+      return 0;
+
+    inbufsize -= 4;
+    inbuf     += 4;
+    }
+
+  int32_t chunks = int32_t(inbufsize/(channels*4));
+  samples += chunks*8;
+
+  while(chunks--) {
+    for(int ch=0; ch<channels; ++ch) {
+      for(int i=0; i<4; ++i) {
+        int step = stepTable[index [ch]], delta = step >> 3;
+
+        if (*inbuf & 1) delta += (step >> 2);
+        if (*inbuf & 2) delta += (step >> 1);
+        if (*inbuf & 4) delta += step;
+        if (*inbuf & 8) delta = -delta;
+
+        pcmdata[ch] += delta;
+        index  [ch] = int8_t(index[ch] + indexTable[*inbuf & 0x7]);
+        index  [ch] = std::min<int8_t>(std::max<int8_t>(index[ch],0),88);
+        pcmdata[ch] = std::min(std::max(pcmdata[ch],-32768),32767);
+        outbuf[i*2*channels] = int16_t(pcmdata[ch]);
+
+        step  = stepTable[index[ch]];
+        delta = step >> 3;
+
+        if (*inbuf & 0x10) delta += (step >> 2);
+        if (*inbuf & 0x20) delta += (step >> 1);
+        if (*inbuf & 0x40) delta += step;
+        if (*inbuf & 0x80) delta = -delta;
+
+        pcmdata[ch] += delta;
+        index  [ch] = int8_t(index[ch] + indexTable[(*inbuf >> 4) & 0x7]);
+        index  [ch] = std::min<int8_t>(std::max<int8_t>(index[ch],0),88);
+        pcmdata[ch] = std::min(std::max(pcmdata[ch],-32768),32767);
+        outbuf [(i*2+1)*channels] = int16_t(pcmdata[ch]);
+
+        inbuf++;
+        }
+      outbuf++;
+      }
+    outbuf += channels*7;
+    }
+  return uint32_t(samples);
+  }
+
+void AdPcm::decodeRange(int16_t* out, const uint8_t* in, size_t count, uint16_t blockAlign, uint16_t channels) {
+  const size_t   outStride = size_t(framesPerBlock(blockAlign,channels))*channels;
+#if defined(TEMPEST_ADPCM_SSE2) || defined(TEMPEST_ADPCM_NEON)
+  const uint32_t chunks    = uint32_t((blockAlign-channels*4)/(channels*4));
+  Lane           ln[SimdLanes];
+  size_t         lanes     = 0;
+  size_t         pending[SimdLanes] = {};
+  size_t         pendingCount = 0;
+
+  for(size_t b=0; b<count; ++b) {
+    const uint8_t* src = in  + b*blockAlign;
+    int16_t*       dst = out + b*outStride;
+    if(!isValidHeader(src,channels)) {
+      decodeBlock(dst, src, blockAlign, channels);
+      continue;
+      }
+    pending[pendingCount++] = b;
+    for(uint16_t ch=0; ch<channels; ++ch) {
+      Lane& l = ln[lanes++];
+      l.pred   = int16_t(src[ch*4+0] | (src[ch*4+1] << 8));
+      l.idx    = src[ch*4+2];
+      l.src    = src + channels*4 + ch*4;
+      l.dst    = dst + channels + ch;
+      dst[ch]  = int16_t(l.pred);
+      }
+    if(lanes==SimdLanes) {
+      decodeLanes(ln, chunks, channels, stepTable);
+      lanes        = 0;
+      pendingCount = 0;
+      }
+    }
+
+  // tail, that doesn't fill simd register
+  for(size_t i=0; i<pendingCount; ++i) {
+    const size_t b = pending[i];
+    decodeBlock(out + b*outStride, in + b*blockAlign, blockAlign, channels);
+    }
+#else
+  for(size_t b=0; b<count; ++b)
+    decodeBlock(out + b*outStride, in + b*blockAlign, blockAlign, channels);
+#endif
+  }
+
+void AdPcm::decodeBlocks(int16_t* out, const uint8_t* in, size_t count, uint16_t blockAlign, uint16_t channels, uint32_t threads) {
+  if(framesPerBlock(blockAlign,channels)==0 || count==0)
+    return;
+
+  if(threads==0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = uint32_t(std::min<size_t>(threads, count/MinBlocksPerThread));
+    }
+  if(threads<=1) {
+    decodeRange(out, in, count, blockAlign, channels);
+    return;
+    }
+
+  // blocks are independent: split evenly, first range runs on the calling thread
+  const size_t outStride = size_t(framesPerBlock(blockAlign,channels))*channels;
+  const size_t perThread = (count+threads-1)/threads;
+
+  std::vector<std::thread> th;
+  th.reserve(threads-1);
+  for(size_t first=perThread; first<count; first+=perThread) {
+    const size_t n = std::min(perThread, count-first);
+    th.emplace_back([=]() {
+      decodeRange(out + first*outStride, in + first*blockAlign, n, blockAlign, channels);
+      });
+    }
+  decodeRange(out, in, std::min(perThread,count), blockAlign, channels);
+  for(auto& i:th)
+    i.join();
+  }
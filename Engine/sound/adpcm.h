@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Tempest {
+namespace Detail {
+
+// IMA-ADPCM (WAVE_FORMAT_IMA_ADPCM) decoder, mono or stereo
+class AdPcm final {
+  public:
+    // frames per block, including header sample
+    static uint32_t framesPerBlock(uint16_t blockAlign, uint16_t channels);
+
+    // reference decoder: one block into interleaved pcm; returns frames count, 0 on malformed block
+    static uint32_t decodeBlock(int16_t* out, const uint8_t* in, size_t inSize, uint16_t channels);
+
+    // decodes 'count' consecutive blocks into out[count*framesPerBlock*channels]
+    // blocks are decoded 4 channel-streams per simd register; threads==0 picks a count automatically
+    static void     decodeBlocks(int16_t* out, const uint8_t* in, size_t count, uint16_t blockAlign, uint16_t channels,
+                                 uint32_t threads = 0);
+
+  private:
+    static void     decodeRange(int16_t* out, const uint8_t* in, size_t count, uint16_t blockAlign, uint16_t channels);
+    static bool     isValidHeader(const uint8_t* in, uint16_t channels);
+
+    static const uint16_t stepTable[89];
+    static const int32_t  indexTable[8];
+  };
+
+}
+}
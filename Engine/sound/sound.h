@@ -23,11 +23,12 @@ class Sound final {
     struct Header;
     struct WAVEHeader;
     struct FmtChunk;
+    struct Stream;
 
-    std::unique_ptr<char[]> readWAVFull(Tempest::IDevice& d, WAVEHeader &header, FmtChunk& fmt, size_t& dataSize);
+    const char*             readWAVFull(Tempest::IDevice& d, WAVEHeader &header, FmtChunk& fmt, size_t& dataSize,
+                                        std::unique_ptr<char[]>& storage);
     void                    initData(const char* data, int format, size_t size, size_t rate);
-    void                    decodeAdPcm(const FmtChunk& fmt, const uint8_t *src, uint32_t dataSize, uint32_t maxSamples);
-    static int              decodeAdPcmBlock(int16_t *outbuf, const uint8_t *inbuf, size_t inbufsize, uint16_t channels);
+    void                    decodeAdPcm(const FmtChunk& fmt, const uint8_t *src, uint32_t dataSize);
     void                    implLoad(IDevice& input);
 
     struct Data {
@@ -37,9 +38,6 @@ class Sound final {
       };
     std::shared_ptr<Data> data;
 
-    static const uint16_t stepTable[89];
-    static const int32_t  indexTable[];
-
   friend class SoundDevice;
   friend class SoundEffect;
   };
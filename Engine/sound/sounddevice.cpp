@@ -15,9 +15,13 @@
 #include <Tempest/Except>
 #include <Tempest/Log>
 
+#include "soundstream.h"
+#include "voicepool.h"
+
 #include <vector>
 #include <mutex>
 #include <cstring>
+#include <algorithm>
 
 using namespace Tempest;
 
@@ -30,8 +34,9 @@ enum class LogLevel {
 extern LogLevel gLogLevel; // HACK: openal spams too much
 
 struct SoundDevice::Data {
-  std::shared_ptr<Device> dev;
-  ALCcontext*             context;
+  std::shared_ptr<Device>            dev;
+  ALCcontext*                        context = nullptr;
+  std::unique_ptr<Detail::VoicePool> voices;
   };
 
 struct SoundDevice::Device {
@@ -43,11 +48,25 @@ struct SoundDevice::Device {
     if(dev==nullptr)
       throw std::system_error(Tempest::SoundErrc::NoDevice);
     }
+  Device(const Loopback& desc):loopback(true) {
+    gLogLevel = LogLevel::Error;
+    if(desc.channels!=1 && desc.channels!=2)
+      throw std::system_error(Tempest::SoundErrc::InvalidChannelsCount);
+    dev = alcLoopbackOpenDeviceSOFT(nullptr);
+    if(dev==nullptr)
+      throw std::system_error(Tempest::SoundErrc::NoDevice);
+    const ALCenum ch = (desc.channels==2 ? ALC_STEREO_SOFT : ALC_MONO_SOFT);
+    if(!alcIsRenderFormatSupportedSOFT(dev, ALCsizei(desc.frequency), ch, ALC_SHORT_SOFT)) {
+      alcCloseDevice(dev);
+      throw std::system_error(Tempest::SoundErrc::NoDevice);
+      }
+    }
   ~Device(){
     alcCloseDevice(dev);
     }
 
-  ALCdevice*  dev = nullptr;
+  ALCdevice*  dev      = nullptr;
+  const bool  loopback = false;
   };
 
 #if 0
@@ -66,6 +85,15 @@ struct SoundDevice::BufferContext {
   };
 #endif
 
+static uint32_t maxVoices(ALCdevice* dev) {
+  // real voices are preallocated once and reused by all effects
+  ALCint mono = 0;
+  alcGetIntegerv(dev, ALC_MONO_SOURCES, 1, &mono);
+  if(mono<=0)
+    mono = 32;
+  return uint32_t(std::min(mono, 256));
+  }
+
 struct SoundDevice::PhysicalDeviceList {
   std::mutex                         sync;
   std::weak_ptr<SoundDevice::Device> val;
@@ -101,6 +129,29 @@ struct SoundDevice::PhysicalDeviceList {
 SoundDevice::SoundDevice():SoundDevice("") {
   }
 
+SoundDevice::SoundDevice(const Loopback& desc):data(new Data()) {
+  // loopback devices are never shared: each one owns its own mixer
+  data->dev = std::make_shared<Device>(desc);
+
+  const ALCint attr[] = {
+    ALC_FORMAT_CHANNELS_SOFT, (desc.channels==2 ? ALC_STEREO_SOFT : ALC_MONO_SOFT),
+    ALC_FORMAT_TYPE_SOFT,     ALC_SHORT_SOFT,
+    ALC_FREQUENCY,            ALCint(desc.frequency),
+    0
+    };
+  data->context = alcCreateContext(data->dev->dev,attr);
+  if(data->context==nullptr)
+    throw std::system_error(Tempest::SoundErrc::NoDevice);
+
+  alDistanceModelDirect(data->context, AL_LINEAR_DISTANCE);
+  alListenerfDirect(data->context, AL_METERS_PER_UNIT, 100.f);
+  uint32_t count = maxVoices(data->dev->dev);
+  if(desc.voices>0)
+    count = std::min(count, desc.voices);
+  data->voices.reset(new Detail::VoicePool(data->context, count));
+  process();
+  }
+
 SoundDevice::SoundDevice(std::string_view name):data(new Data()) {
   data->dev = PhysicalDeviceList::inst().device(name);
 
@@ -174,10 +225,12 @@ SoundDevice::SoundDevice(std::string_view name):data(new Data()) {
   alDisableDirect(data->context, AL_STOP_SOURCES_ON_DISCONNECT_SOFT);
   // TODO: api
   alListenerfDirect(data->context, AL_METERS_PER_UNIT, 100.f);
+  data->voices.reset(new Detail::VoicePool(data->context, maxVoices(data->dev->dev)));
   process();
   }
 
 SoundDevice::~SoundDevice() {
+  data->voices.reset();
   if(data->context)
     alcDestroyContext(data->context);
   }
@@ -215,7 +268,17 @@ SoundEffect SoundDevice::load(std::unique_ptr<SoundProducer>&& p) {
   return SoundEffect(*this,std::move(p));
   }
 
+SoundEffect SoundDevice::loadStream(const char* fname) {
+  return loadStream(std::make_unique<Tempest::RFile>(fname));
+  }
+
+SoundEffect SoundDevice::loadStream(std::unique_ptr<IDevice>&& d) {
+  auto s = std::make_unique<Sound::Stream>(std::move(d));
+  return SoundEffect(*this,std::move(s));
+  }
+
 void SoundDevice::process() {
+  data->voices->update();
   alcProcessContext(data->context);
   }
 
@@ -223,14 +286,24 @@ void SoundDevice::suspend() {
   alcSuspendContext(data->context);
   }
 
+bool SoundDevice::isLoopback() const {
+  return data->dev->loopback;
+  }
+
+void SoundDevice::renderSamples(int16_t* out, size_t frames) {
+  if(!data->dev->loopback)
+    return;
+  alcRenderSamplesSOFT(data->dev->dev, out, ALCsizei(frames));
+  }
+
 void SoundDevice::setListenerPosition(const Vec3& p) {
-  float xyz[] = {p.x,p.y,p.z};
-  alListenerfvDirect(data->context, AL_POSITION, xyz);
+  setListenerPosition(p.x,p.y,p.z);
   }
 
 void SoundDevice::setListenerPosition(float x, float y, float z) {
   float xyz[] = {x,y,z};
   alListenerfvDirect(data->context, AL_POSITION, xyz);
+  data->voices->setListener(x,y,z);
   }
 
 void SoundDevice::setListenerDirection(const Vec3& f, const Vec3& up) {
@@ -250,6 +323,10 @@ void* SoundDevice::context() {
   return data->context;
   }
 
+Detail::VoicePool& SoundDevice::voices() {
+  return *data->voices;
+  }
+
 #if 0
 void* SoundDevice::bufferContext() {
   auto& d = PhysicalDeviceList::inst().buf;
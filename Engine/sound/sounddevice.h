@@ -2,6 +2,8 @@
 
 #include <Tempest/Vec>
 
+#include <cstdint>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <mutex>
@@ -13,17 +15,30 @@ class SoundProducer;
 class SoundEffect;
 class IDevice;
 
+namespace Detail {
+class VoicePool;
+}
+
 class SoundDevice final {
   public:
+    struct Props {
+      char name[256] = {};
+      };
+
+    // offline device, mixed by explicit renderSamples calls (ALC_SOFT_loopback)
+    struct Loopback {
+      uint32_t frequency = 44100;
+      uint16_t channels  = 2;
+      // size of real voice pool; 0 - as many, as device allows
+      uint32_t voices    = 0;
+      };
+
     SoundDevice ();
     SoundDevice (std::string_view name);
+    explicit SoundDevice (const Loopback& desc);
     SoundDevice (const SoundDevice&) = delete;
     ~SoundDevice();
 
-    struct Props {
-      char name[256] = {};
-      };
-
     static std::vector<Props> devices();
 
     SoundDevice& operator = ( const SoundDevice& s) = delete;
@@ -33,9 +48,18 @@ class SoundDevice final {
     SoundEffect load(const Sound& snd);
     SoundEffect load(std::unique_ptr<SoundProducer> &&p);
 
+    // WAV/IMA-ADPCM, decoded incrementally while playing
+    SoundEffect loadStream(const char* fname);
+    SoundEffect loadStream(std::unique_ptr<Tempest::IDevice>&& d);
+
+    // updates virtual voices; to be called once per frame
     void process();
     void suspend();
 
+    bool isLoopback() const;
+    // mix next frames into interleaved 16-bit PCM; no-op for hardware devices
+    void renderSamples(int16_t* out, size_t frames);
+
     void setListenerPosition(const Tempest::Vec3& p);
     void setListenerPosition(float x,float y,float z);
 
@@ -53,6 +77,7 @@ class SoundDevice final {
     std::unique_ptr<Data> data;
 
     void*                               context();
+    Detail::VoicePool&                  voices();
 #if 0
     void*                               bufferContext();
     static void*                        bufferContextSt();
@@ -10,6 +10,9 @@
 #include <Tempest/Except>
 #include <Tempest/Log>
 
+#include "soundstream.h"
+#include "voicepool.h"
+
 using namespace Tempest;
 
 struct SoundEffect::Impl {
@@ -24,14 +27,10 @@ struct SoundEffect::Impl {
     :dev(&dev), data(src.data) {
     if(data==nullptr)
       return;
-    ALCcontext* ctx = context();
-
-    auto guard = SoundDevice::globalLock(); // for alGetError
-    alGenSourcesDirect(ctx, 1, &source);
-    alSourceiDirect(ctx, source, AL_BUFFER, data->buffer);
-    alSourceiDirect(ctx, source, AL_SOURCE_SPATIALIZE_SOFT, AL_TRUE);
-    if(alGetErrorDirect(ctx)!=AL_NO_ERROR)
-      throw std::bad_alloc();
+    voice.buffer     = data->buffer;
+    voice.spatialize = AL_TRUE;
+    voice.length     = data->timeLength();
+    pool().add(voice);
     }
 
   Impl(SoundDevice &dev, std::unique_ptr<SoundProducer> &&psrc)
@@ -39,7 +38,21 @@ struct SoundEffect::Impl {
     SoundProducer& src    = *producer;
     ALsizei        freq   = src.frequency;
     ALenum         frm    = src.channels==2 ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16;
-    ALCcontext*    ctx    = reinterpret_cast<ALCcontext*>(dev.context());
+    initStream(frm, freq, bufferCallback);
+    }
+
+  Impl(SoundDevice &dev, std::unique_ptr<Sound::Stream> &&wsrc)
+    :dev(&dev), data(nullptr), wav(std::move(wsrc)) {
+    if(wav==nullptr || wav->isEmpty())
+      return;
+    ALsizei        freq   = ALsizei(wav->frequency());
+    ALenum         frm    = wav->channels()==2 ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16;
+    voice.length = wav->timeLength();
+    initStream(frm, freq, wavCallback);
+    }
+
+  void initStream(ALenum frm, ALsizei freq, ALBUFFERCALLBACKTYPESOFT callback) {
+    ALCcontext*    ctx    = context();
 
     auto guard = SoundDevice::globalLock(); // for alGetError
 #if 1
@@ -48,35 +61,26 @@ struct SoundEffect::Impl {
     ALCcontext*    bufCtx = reinterpret_cast<ALCcontext*>(dev.bufferContext());
     alGenBuffersDirect(bufCtx, 1, &stream);
     alcSetThreadContext(bufCtx);
-    alBufferCallbackSOFT(stream, frm, freq, bufferCallback, this);
+    alBufferCallbackSOFT(stream, frm, freq, callback, this);
     alcSetThreadContext(nullptr);
 #endif
-    alBufferCallbackDirectSOFT(ctx, stream, frm, freq, bufferCallback, this);
+    alBufferCallbackDirectSOFT(ctx, stream, frm, freq, callback, this);
     if(alGetErrorDirect(ctx)!=AL_NO_ERROR) {
       throw std::bad_alloc();
       }
 
-    alGenSourcesDirect(ctx, 1, &source);
-    if(alGetErrorDirect(ctx)!=AL_NO_ERROR) {
-#if 1
-      alDeleteBuffersHost(1, &stream);
-#else
-      alDeleteBuffersDirect(bufCtx, 1, &stream);
-#endif
-      throw std::bad_alloc();
-      }
-
-    alSourceiDirect(ctx, source, AL_BUFFER, stream);
-    alSourcefDirect(ctx, source, AL_REFERENCE_DISTANCE, 0);
+    voice.buffer     = stream;
+    voice.streamed   = true;
+    voice.spatialize = AL_AUTO_SOFT;
+    voice.refDist    = 0;
+    pool().add(voice);
     }
 
   ~Impl() {
-    if(source==0)
+    if(voice.buffer==0)
       return;
-    auto* ctx    = reinterpret_cast<ALCcontext*>(dev->context());
-
-    alSourcePausevDirect(ctx, 1, &source);
-    alDeleteSourcesDirect(ctx, 1, &source);
+    // returns source to the pool, before stream buffer is gone
+    pool().remove(voice);
     if(stream!=0) {
 #if 1
       alDeleteBuffersHost(1, &stream);
@@ -93,6 +97,14 @@ struct SoundEffect::Impl {
     return numbytes;
     }
 
+  static ALsizei wavCallback(ALvoid *userptr, ALvoid *sampledata, ALsizei numbytes) noexcept {
+    auto&        self  = *reinterpret_cast<Impl*>(userptr);
+    const size_t frame = self.wav->channels()*sizeof(int16_t);
+    const size_t n     = self.wav->read(reinterpret_cast<int16_t*>(sampledata), size_t(numbytes)/frame);
+    // short read stops the source, once remaining samples are played
+    return ALsizei(n*frame);
+    }
+
   void renderSound(int16_t* data, size_t sz) noexcept {
     auto& src = *producer;
     src.renderSound(data,sz);
@@ -102,12 +114,17 @@ struct SoundEffect::Impl {
     return reinterpret_cast<ALCcontext*>(dev->context());
     }
 
+  Detail::VoicePool& pool() {
+    return dev->voices();
+    }
+
   SoundDevice*                   dev    = nullptr;
   std::shared_ptr<Sound::Data>   data;
-  uint32_t                       source = 0;
+  Detail::Voice                  voice;
   uint32_t                       stream = 0;
 
   std::unique_ptr<SoundProducer> producer;
+  std::unique_ptr<Sound::Stream> wav;
   };
 
 SoundProducer::SoundProducer(uint16_t frequency, uint16_t channels)
@@ -124,6 +141,10 @@ SoundEffect::SoundEffect(SoundDevice &dev, std::unique_ptr<SoundProducer> &&src)
   :impl(new Impl(dev,std::move(src))) {
   }
 
+SoundEffect::SoundEffect(SoundDevice &dev, std::unique_ptr<Sound::Stream> &&src)
+  :impl(new Impl(dev,std::move(src))) {
+  }
+
 SoundEffect::SoundEffect()
   :impl(new Impl()){
   }
@@ -141,70 +162,56 @@ SoundEffect &SoundEffect::operator=(Tempest::SoundEffect &&s){
   }
 
 void SoundEffect::play() {
-  if(impl->source==0)
+  if(impl->voice.buffer==0)
     return;
-  ALCcontext* ctx = impl->context();
-  alSourcePlayvDirect(ctx, 1, &impl->source);
+  impl->pool().play(impl->voice);
   }
 
 void SoundEffect::pause() {
-  if(impl->source==0)
+  if(impl->voice.buffer==0)
     return;
-  ALCcontext* ctx = impl->context();
-  alSourcePausevDirect(ctx, 1, &impl->source);
+  impl->pool().pause(impl->voice);
   }
 
 bool SoundEffect::isEmpty() const {
-  return impl->source==0;
+  return impl->voice.buffer==0;
   }
 
 bool SoundEffect::isFinished() const {
-  if(impl->source==0)
+  if(impl->voice.buffer==0)
     return true;
-  int32_t state=0;
-  ALCcontext* ctx = impl->context();
-  alGetSourceivDirect(ctx, impl->source, AL_SOURCE_STATE, &state);
-  return state==AL_STOPPED || state==AL_INITIAL;
+  return impl->pool().isFinished(impl->voice);
+  }
+
+bool SoundEffect::isVirtual() const {
+  if(impl->voice.buffer==0)
+    return false;
+  return impl->pool().isVirtual(impl->voice);
   }
 
 uint64_t Tempest::SoundEffect::timeLength() const {
-  if(impl->data)
-    return impl->data->timeLength();
-  return 0;
+  return impl->voice.length;
   }
 
 uint64_t Tempest::SoundEffect::currentTime() const {
-  if(impl->source==0)
+  if(impl->voice.buffer==0)
     return 0;
-  float result=0;
-  ALCcontext* ctx = impl->context();
-  alGetSourcefvDirect(ctx, impl->source, AL_SEC_OFFSET, &result);
-  return uint64_t(result*1000);
+  return impl->pool().currentTime(impl->voice);
   }
 
 void SoundEffect::setPosition(const Vec3& p) {
-  float v[3]={p.x,p.y,p.z};
-  if(impl->source==0)
-    return;
-  ALCcontext* ctx = impl->context();
-  alSourcefvDirect(ctx, impl->source, AL_POSITION, v);
+  setPosition(p.x,p.y,p.z);
   }
 
 void SoundEffect::setPosition(float x, float y, float z) {
-  float p[3]={x,y,z};
-  if(impl->source==0)
+  if(impl->voice.buffer==0)
     return;
-  ALCcontext* ctx = impl->context();
-  alSourcefvDirect(ctx, impl->source, AL_POSITION, p);
+  impl->pool().setPosition(impl->voice,x,y,z);
   }
 
 Vec3 SoundEffect::position() const {
-  float v[3] = {};
-  if(impl->source==0)
-    return Vec3();
-  ALCcontext* ctx = impl->context();
-  alGetSourcefvDirect(ctx, impl->source, AL_POSITION, v);
-  return Vec3(v[0],v[1],v[2]);
+  auto& p = impl->voice.pos;
+  return Vec3(p[0],p[1],p[2]);
   }
 
 float SoundEffect::x() const {
@@ -220,26 +227,31 @@ float SoundEffect::z() const {
   }
 
 void SoundEffect::setMaxDistance(float dist) {
-  if(impl->source==0)
+  if(impl->voice.buffer==0)
     return;
-  ALCcontext* ctx = impl->context();
-  alSourcefvDirect(ctx, impl->source, AL_MAX_DISTANCE, &dist);
+  impl->pool().setMaxDistance(impl->voice,dist);
   }
 
 void SoundEffect::setVolume(float val) {
-  if(impl->source==0)
+  if(impl->voice.buffer==0)
     return;
-  ALCcontext* ctx = impl->context();
-  alSourcefvDirect(ctx, impl->source, AL_GAIN, &val);
+  impl->pool().setGain(impl->voice,val);
   }
 
 float SoundEffect::volume() const {
-  if(impl->source==0)
+  if(impl->voice.buffer==0)
     return 0;
-  float val=0;
-  ALCcontext* ctx = impl->context();
-  alGetSourcefvDirect(ctx, impl->source, AL_GAIN, &val);
-  return val;
+  return impl->voice.gain;
+  }
+
+void SoundEffect::setPriority(int32_t p) {
+  if(impl->voice.buffer==0)
+    return;
+  impl->pool().setPriority(impl->voice,p);
+  }
+
+int32_t SoundEffect::priority() const {
+  return impl->voice.priority;
   }
 
 #endif
@@ -35,6 +35,8 @@ class SoundEffect final {
 
     bool     isEmpty()     const;
     bool     isFinished()  const;
+    // playing, but not mixed: out of real voices, or inaudible; streams, once mixed, are never evicted
+    bool     isVirtual()   const;
     uint64_t timeLength()  const;
     uint64_t currentTime() const;
 
@@ -43,6 +45,9 @@ class SoundEffect final {
     void     setMaxDistance(float dist);
     void     setVolume(float val);
     float    volume() const;
+    // higher priority voices are mixed first, when device runs out of real voices
+    void     setPriority(int32_t p);
+    int32_t  priority() const;
 
     Tempest::Vec3 position() const;
     float    x() const;
@@ -52,6 +57,7 @@ class SoundEffect final {
   private:
     SoundEffect(SoundDevice& dev,const Sound &src);
     SoundEffect(SoundDevice& dev,std::unique_ptr<SoundProducer>&& src);
+    SoundEffect(SoundDevice& dev,std::unique_ptr<Sound::Stream>&& src);
 
     struct Impl;
     std::unique_ptr<Impl> impl;
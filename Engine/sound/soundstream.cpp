@@ -0,0 +1,227 @@
+#if defined(TEMPEST_BUILD_AUDIO)
+
+#include "soundstream.h"
+#include "adpcm.h"
+
+#include <Tempest/Except>
+
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+
+using namespace Tempest;
+
+Sound::Stream::Stream(std::unique_ptr<IDevice>&& in)
+  :input(std::move(in)) {
+  FmtChunk fmt = {};
+  if(!readHeader(fmt) || !isValid(fmt)) {
+    chan = 0;
+    return;
+    }
+  if(fmt.channels!=1 && fmt.channels!=2)
+    throw std::system_error(Tempest::SoundErrc::InvalidChannelsCount);
+
+  bitsPerSample = fmt.bitsPerSample;
+  blockAlign    = fmt.blockAlign;
+  chan          = fmt.channels;
+  freq          = fmt.samplesPerSec;
+
+  if(bitsPerSample==4) {
+    framesPerBlock = Detail::AdPcm::framesPerBlock(blockAlign,chan)*AdPcmBlocks;
+    framesTotal    = (dataRemain/blockAlign)*Detail::AdPcm::framesPerBlock(blockAlign,chan);
+    raw.resize(size_t(blockAlign)*AdPcmBlocks);
+    } else {
+    framesPerBlock = PcmBlockFrames;
+    framesTotal    = dataRemain/blockAlign;
+    raw.resize(size_t(PcmBlockFrames)*blockAlign);
+    }
+  framesRemain = framesTotal;
+
+  for(auto& b:ring)
+    b.pcm.resize(size_t(framesPerBlock)*chan);
+
+  // prime the ring, so playback doesn't start with underrun
+  for(uint32_t i=0; i<RingSize; ++i)
+    if(!decodeNext())
+      return;
+  worker = std::thread(&Stream::workerFunc,this);
+  }
+
+Sound::Stream::~Stream() {
+  {
+  std::lock_guard<std::mutex> guard(sync);
+  stop = true;
+  }
+  wake.notify_one();
+  if(worker.joinable())
+    worker.join();
+  }
+
+bool Sound::Stream::readHeader(FmtChunk& fmt) {
+  auto& f = *input;
+
+  WAVEHeader header = {};
+  if(f.read(&header,sizeof(WAVEHeader))!=sizeof(WAVEHeader))
+    return false;
+  if(std::memcmp("RIFF",header.riff,4)!=0 ||
+     std::memcmp("WAVE",header.wave,4)!=0)
+    return false;
+
+  bool hasFmt = false;
+  while(true) {
+    Header head={};
+    if(f.read(&head,sizeof(head))!=sizeof(head))
+      return false;
+
+    if(head.is("data")) {
+      // samples are decoded on demand; chunks after data are ignored
+      dataRemain = head.size;
+      break;
+      }
+    if(head.is("fmt ")) {
+      size_t sz=std::min<size_t>(head.size,sizeof(fmt));
+      if(f.read(&fmt,sz)!=sz)
+        return false;
+      size_t remain = head.size-sz;
+      if(f.seek(remain)!=remain)
+        return false;
+      hasFmt = true;
+      }
+    else if(f.seek(head.size)!=head.size)
+      return false;
+
+    if(head.size%2!=0 && f.seek(1)!=1)
+      return false;
+    }
+
+  return hasFmt;
+  }
+
+bool Sound::Stream::isValid(const FmtChunk& fmt) const {
+  if(fmt.samplesPerSec==0 || fmt.channels==0)
+    return false;
+
+  switch(fmt.format) {
+    case WAVE_FORMAT_PCM:
+      if(fmt.bitsPerSample!=8 && fmt.bitsPerSample!=16)
+        return false;
+      return fmt.blockAlign==fmt.channels*(fmt.bitsPerSample/8);
+    case WAVE_FORMAT_IMA_ADPCM:
+      if(fmt.bitsPerSample!=4)
+        return false;
+      if(fmt.channels>2)
+        return true; // reported as InvalidChannelsCount
+      if(fmt.blockAlign<=fmt.channels*4)
+        return false;
+      // nibbles are interleaved by 4 bytes per channel
+      return (fmt.blockAlign-fmt.channels*4)%(fmt.channels*4)==0;
+    }
+  return false;
+  }
+
+uint64_t Sound::Stream::timeLength() const {
+  if(freq==0)
+    return 0;
+  return (framesTotal*1000)/freq;
+  }
+
+size_t Sound::Stream::read(int16_t* out, size_t frames) noexcept {
+  size_t done = 0;
+  while(done<frames) {
+    const uint32_t h = head.load(std::memory_order_relaxed);
+    if(h==tail.load(std::memory_order_acquire)) {
+      // tail is published before eof
+      if(eof.load(std::memory_order_acquire) && h==tail.load(std::memory_order_acquire))
+        break;
+      // decoder is behind: keep source playing
+      std::memset(out+done*chan, 0, (frames-done)*chan*sizeof(int16_t));
+      done = frames;
+      break;
+      }
+
+    const Block& b = ring[h%RingSize];
+    const size_t n = std::min(frames-done, b.size-readAt);
+    std::memcpy(out+done*chan, b.pcm.data()+readAt*chan, n*chan*sizeof(int16_t));
+    readAt += n;
+    done   += n;
+    if(readAt==b.size) {
+      readAt = 0;
+      head.store(h+1, std::memory_order_release);
+      // no lock in mixer thread: worker also wakes up by timeout
+      wake.notify_one();
+      }
+    }
+  return done;
+  }
+
+void Sound::Stream::workerFunc() {
+  while(true) {
+    {
+    std::unique_lock<std::mutex> guard(sync);
+    wake.wait_for(guard, std::chrono::milliseconds(10), [this](){
+      return stop || tail.load(std::memory_order_relaxed)-head.load(std::memory_order_acquire)<RingSize;
+      });
+    if(stop)
+      return;
+    }
+    while(tail.load(std::memory_order_relaxed)-head.load(std::memory_order_acquire)<RingSize) {
+      if(!decodeNext())
+        return;
+      }
+    }
+  }
+
+bool Sound::Stream::decodeNext() {
+  const uint32_t t = tail.load(std::memory_order_relaxed);
+  bool ok = false;
+  try {
+    ok = decodeBlock(ring[t%RingSize]);
+    }
+  catch(...) {
+    // io error: end the stream
+    ok = false;
+    }
+  if(!ok) {
+    eof.store(true, std::memory_order_release);
+    return false;
+    }
+  tail.store(t+1, std::memory_order_release);
+  return true;
+  }
+
+bool Sound::Stream::decodeBlock(Block& dst) {
+  dst.size = 0;
+  if(framesRemain==0 || dataRemain==0)
+    return false;
+
+  const size_t sz  = size_t(std::min<uint64_t>(dataRemain, raw.size()));
+  const size_t got = input->read(raw.data(), sz);
+  dataRemain = (got==sz) ? dataRemain-sz : 0;
+
+  switch(bitsPerSample) {
+    case 4: {
+      // single thread: one stream is decoded by one worker
+      const size_t blocks = got/blockAlign;
+      Detail::AdPcm::decodeBlocks(dst.pcm.data(), raw.data(), blocks, blockAlign, chan, 1);
+      dst.size = blocks*Detail::AdPcm::framesPerBlock(blockAlign,chan);
+      break;
+      }
+    case 8: {
+      dst.size = got/chan;
+      for(size_t i=0; i<dst.size*chan; ++i)
+        dst.pcm[i] = int16_t((int32_t(raw[i])-128)*256);
+      break;
+      }
+    case 16: {
+      dst.size = got/(chan*sizeof(int16_t));
+      std::memcpy(dst.pcm.data(), raw.data(), dst.size*chan*sizeof(int16_t));
+      break;
+      }
+    }
+
+  dst.size      = size_t(std::min<uint64_t>(dst.size, framesRemain));
+  framesRemain -= dst.size;
+  return dst.size>0;
+  }
+
+#endif
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <Tempest/IDevice>
+#include <Tempest/Sound>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+namespace Tempest {
+
+struct Sound::Header final {
+  char     id[4];
+  uint32_t size;
+  bool     is(const char* n) const { return std::memcmp(id,n,4)==0; }
+  };
+
+struct Sound::WAVEHeader final {
+  char     riff[4];  //'RIFF'
+  uint32_t riffSize;
+  char     wave[4];  //'WAVE'
+  };
+
+struct Sound::FmtChunk final {
+  uint16_t format;
+  uint16_t channels;
+  uint32_t samplesPerSec;
+  uint32_t bytesPerSec;
+  uint16_t blockAlign;
+  uint16_t bitsPerSample;
+  };
+
+// incremental WAV decoder: worker thread keeps a small ring of decoded blocks ahead of the mixer
+struct Sound::Stream final {
+  public:
+    explicit Stream(std::unique_ptr<IDevice>&& input);
+    ~Stream();
+
+    bool     isEmpty()   const { return chan==0; }
+    uint32_t frequency() const { return freq;  }
+    uint16_t channels()  const { return chan;  }
+    uint64_t timeLength() const;
+
+    // mixer thread: only copies decoded frames, never waits for io or decoder.
+    // Returns count of frames written, less than requested only at the end of stream; underrun is filled with silence
+    size_t   read(int16_t* out, size_t frames) noexcept;
+
+  private:
+    enum {
+      PcmBlockFrames = 4096,
+      AdPcmBlocks    = 4, // one simd register worth of mono blocks
+      RingSize       = 4,
+      };
+
+    enum FormatTag : uint16_t {
+      WAVE_FORMAT_PCM       = 0x0001,
+      WAVE_FORMAT_IMA_ADPCM = 0x0011,
+      };
+
+    struct Block {
+      std::vector<int16_t> pcm;
+      size_t               size = 0; // in frames
+      };
+
+    bool     readHeader(FmtChunk& fmt);
+    bool     isValid(const FmtChunk& fmt) const;
+    bool     decodeBlock(Block& dst);
+    bool     decodeNext();
+    void     workerFunc();
+
+    std::unique_ptr<IDevice> input;
+    uint16_t                 bitsPerSample  = 0;
+    uint16_t                 blockAlign     = 0;
+    uint16_t                 chan           = 0;
+    uint32_t                 freq           = 0;
+    uint32_t                 framesPerBlock = 0;
+    uint64_t                 dataRemain     = 0;
+    uint64_t                 framesRemain   = 0;
+    uint64_t                 framesTotal    = 0;
+
+    // worker thread
+    std::vector<uint8_t>     raw;
+
+    // single producer (worker), single consumer (mixer)
+    Block                    ring[RingSize];
+    std::atomic<uint32_t>    head{0};   // next block to be played
+    std::atomic<uint32_t>    tail{0};   // next block to be decoded
+    std::atomic_bool         eof{false};
+    size_t                   readAt = 0; // in frames, within ring[head]
+
+    std::mutex               sync;
+    std::condition_variable  wake;
+    bool                     stop = false;
+    std::thread              worker;
+  };
+
+}
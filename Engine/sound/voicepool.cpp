@@ -0,0 +1,317 @@
+#if defined(TEMPEST_BUILD_AUDIO)
+
+#include "voicepool.h"
+
+#include <AL/al.h>
+#include <AL/alc.h>
+#include <AL/alext.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+VoicePool::VoicePool(ALCcontext* ctx, uint32_t count)
+  :ctx(ctx) {
+  sources.resize(count);
+  alGenSourcesDirect(ctx, ALsizei(count), sources.data());
+  if(alGetErrorDirect(ctx)!=AL_NO_ERROR) {
+    // device may have fewer sources, than requested
+    sources.clear();
+    for(uint32_t i=0; i<count; ++i) {
+      ALuint s = 0;
+      alGenSourcesDirect(ctx, 1, &s);
+      if(alGetErrorDirect(ctx)!=AL_NO_ERROR)
+        break;
+      sources.push_back(s);
+      }
+    }
+  freeSrc.assign(sources.rbegin(), sources.rend());
+  }
+
+VoicePool::~VoicePool() {
+  if(!sources.empty())
+    alDeleteSourcesDirect(ctx, ALsizei(sources.size()), sources.data());
+  }
+
+uint64_t VoicePool::clock() {
+  auto t = std::chrono::steady_clock::now().time_since_epoch();
+  return uint64_t(std::chrono::duration_cast<std::chrono::milliseconds>(t).count());
+  }
+
+void VoicePool::add(Voice& v) {
+  std::lock_guard<std::mutex> guard(sync);
+  v.id = voices.size();
+  voices.push_back(&v);
+  }
+
+void VoicePool::remove(Voice& v) {
+  std::lock_guard<std::mutex> guard(sync);
+  v.state = Voice::Stopped;
+  unbind(v);
+  if(v.id<voices.size()) {
+    voices[v.id]     = voices.back();
+    voices[v.id]->id = v.id;
+    voices.pop_back();
+    }
+  v.id = size_t(-1);
+  }
+
+void VoicePool::play(Voice& v) {
+  std::lock_guard<std::mutex> guard(sync);
+  if(v.buffer==0)
+    return;
+  if(v.state!=Voice::Paused)
+    v.offset = 0;
+  v.started = clock();
+  v.state   = Voice::Playing;
+
+  if(v.source==0) {
+    acquire(v);
+    return;
+    }
+  if(!v.streamed) {
+    // same as alSourcePlay on playing source: restart
+    alSourceRewindDirect(ctx, v.source);
+    }
+  alSourcePlayDirect(ctx, v.source);
+  }
+
+void VoicePool::pause(Voice& v) {
+  std::lock_guard<std::mutex> guard(sync);
+  if(v.state!=Voice::Playing || !syncState(v))
+    return;
+  if(v.source!=0 && v.streamed) {
+    alSourcePauseDirect(ctx, v.source);
+    v.state = Voice::Paused;
+    return;
+    }
+  v.offset = currentTimeImpl(v);
+  unbind(v);
+  v.state  = Voice::Paused;
+  }
+
+bool VoicePool::isFinished(Voice& v) {
+  std::lock_guard<std::mutex> guard(sync);
+  if(v.state==Voice::Playing)
+    syncState(v);
+  return v.state==Voice::Initial || v.state==Voice::Stopped;
+  }
+
+bool VoicePool::isVirtual(Voice& v) {
+  std::lock_guard<std::mutex> guard(sync);
+  if(v.state==Voice::Playing)
+    syncState(v);
+  return v.state==Voice::Playing && v.source==0;
+  }
+
+uint64_t VoicePool::currentTime(Voice& v) {
+  std::lock_guard<std::mutex> guard(sync);
+  return currentTimeImpl(v);
+  }
+
+uint64_t VoicePool::currentTimeImpl(const Voice& v) const {
+  switch(v.state) {
+    case Voice::Initial:
+    case Voice::Stopped:
+      return 0;
+    case Voice::Paused:
+      if(v.source==0)
+        return v.offset;
+      break;
+    case Voice::Playing:
+      if(v.source==0) {
+        uint64_t t = v.offset + (clock()-v.started);
+        return v.length>0 ? std::min(t,v.length) : t;
+        }
+      break;
+    }
+  float result = 0;
+  alGetSourcefvDirect(ctx, v.source, AL_SEC_OFFSET, &result);
+  return uint64_t(result*1000);
+  }
+
+void VoicePool::setPosition(Voice& v, float x, float y, float z) {
+  std::lock_guard<std::mutex> guard(sync);
+  v.pos[0] = x;
+  v.pos[1] = y;
+  v.pos[2] = z;
+  if(v.source!=0)
+    alSourcefvDirect(ctx, v.source, AL_POSITION, v.pos);
+  }
+
+void VoicePool::setGain(Voice& v, float g) {
+  std::lock_guard<std::mutex> guard(sync);
+  v.gain = g;
+  if(v.source!=0)
+    alSourcefDirect(ctx, v.source, AL_GAIN, g);
+  }
+
+void VoicePool::setMaxDistance(Voice& v, float d) {
+  std::lock_guard<std::mutex> guard(sync);
+  v.maxDist = d;
+  if(v.source!=0)
+    alSourcefDirect(ctx, v.source, AL_MAX_DISTANCE, d);
+  }
+
+void VoicePool::setPriority(Voice& v, int32_t p) {
+  std::lock_guard<std::mutex> guard(sync);
+  v.priority = p;
+  }
+
+void VoicePool::setListener(float x, float y, float z) {
+  std::lock_guard<std::mutex> guard(sync);
+  listener[0] = x;
+  listener[1] = y;
+  listener[2] = z;
+  }
+
+void VoicePool::update() {
+  std::lock_guard<std::mutex> guard(sync);
+
+  active.clear();
+  for(auto i:voices) {
+    if(i->state!=Voice::Playing)
+      continue;
+    if(!syncState(*i))
+      continue;
+    active.push_back(i);
+    }
+
+  std::sort(active.begin(), active.end(), [this](const Voice* a, const Voice* b){
+    return isLess(*b,*a);
+    });
+
+  // paused and streamed voices keep their sources: stream callbacks can't skip ahead,
+  // so a stream, that got a source is never evicted; streams beyond pool size wait virtual
+  size_t budget = sources.size();
+  for(auto i:voices)
+    if(isPinned(*i))
+      budget--;
+
+  // release sources first, so the most important voices can take them
+  size_t real = 0;
+  for(auto i:active) {
+    if(isPinned(*i))
+      continue;
+    if(real<budget && isAudible(*i))
+      real++; else
+      unbind(*i);
+    }
+  real = 0;
+  for(auto i:active) {
+    if(real>=budget)
+      break;
+    if(isPinned(*i) || !isAudible(*i))
+      continue;
+    bind(*i);
+    real++;
+    }
+  }
+
+float VoicePool::audibility(const Voice& v) const {
+  const float dx = v.pos[0]-listener[0];
+  const float dy = v.pos[1]-listener[1];
+  const float dz = v.pos[2]-listener[2];
+  const float d  = std::sqrt(dx*dx + dy*dy + dz*dz);
+
+  // AL_LINEAR_DISTANCE
+  float att = 1.f;
+  if(v.maxDist<=v.refDist)
+    att = (d<=v.refDist) ? 1.f : 0.f;
+  else if(d>v.refDist)
+    att = 1.f - (std::min(d,v.maxDist)-v.refDist)/(v.maxDist-v.refDist);
+  return v.gain*att;
+  }
+
+bool VoicePool::isAudible(const Voice& v) const {
+  return v.streamed || audibility(v)>0.f;
+  }
+
+bool VoicePool::isPinned(const Voice& v) const {
+  return v.source!=0 && (v.streamed || v.state==Voice::Paused);
+  }
+
+bool VoicePool::isLess(const Voice& a, const Voice& b) const {
+  if(a.streamed!=b.streamed)
+    return b.streamed;
+  if(a.priority!=b.priority)
+    return a.priority<b.priority;
+  return audibility(a)<audibility(b);
+  }
+
+bool VoicePool::syncState(Voice& v) {
+  if(v.source!=0) {
+    ALint st = AL_STOPPED;
+    alGetSourceiDirect(ctx, v.source, AL_SOURCE_STATE, &st);
+    if(st==AL_STOPPED && v.state==Voice::Playing) {
+      v.state = Voice::Stopped;
+      unbind(v);
+      }
+    }
+  else if(v.state==Voice::Playing && v.length>0 && v.offset+(clock()-v.started)>=v.length) {
+    v.state = Voice::Stopped;
+    }
+  return v.state==Voice::Playing || v.state==Voice::Paused;
+  }
+
+void VoicePool::bind(Voice& v) {
+  if(v.source!=0 || freeSrc.empty())
+    return;
+  const uint64_t at = currentTimeImpl(v);
+
+  v.source = freeSrc.back();
+  freeSrc.pop_back();
+
+  alSourceiDirect (ctx, v.source, AL_BUFFER,                 ALint(v.buffer));
+  alSourceiDirect (ctx, v.source, AL_SOURCE_SPATIALIZE_SOFT, v.spatialize);
+  alSourcefvDirect(ctx, v.source, AL_POSITION,               v.pos);
+  alSourcefDirect (ctx, v.source, AL_GAIN,                   v.gain);
+  alSourcefDirect (ctx, v.source, AL_MAX_DISTANCE,           v.maxDist);
+  alSourcefDirect (ctx, v.source, AL_REFERENCE_DISTANCE,     v.refDist);
+  if(!v.streamed)
+    alSourcefDirect(ctx, v.source, AL_SEC_OFFSET, float(at)/1000.f);
+  if(v.state==Voice::Playing)
+    alSourcePlayDirect(ctx, v.source);
+  }
+
+void VoicePool::unbind(Voice& v) {
+  if(v.source==0)
+    return;
+  if(v.state==Voice::Playing) {
+    // keep playhead running while virtual
+    float sec = 0;
+    alGetSourcefvDirect(ctx, v.source, AL_SEC_OFFSET, &sec);
+    v.offset  = uint64_t(sec*1000);
+    v.started = clock();
+    }
+  alSourceStopDirect(ctx, v.source);
+  alSourceiDirect   (ctx, v.source, AL_BUFFER, 0);
+  freeSrc.push_back(v.source);
+  v.source = 0;
+  }
+
+bool VoicePool::acquire(Voice& v) {
+  if(!isAudible(v))
+    return false;
+  if(freeSrc.empty()) {
+    // steal a source from the least important real voice
+    Voice* weak = nullptr;
+    for(auto i:voices) {
+      if(i->source==0 || i->streamed || i->state!=Voice::Playing)
+        continue;
+      if(weak==nullptr || isLess(*i,*weak))
+        weak = i;
+      }
+    // sources held by streams are not stolen: a streamed voice waits for update() to free one
+    if(weak==nullptr || !isLess(*weak,v))
+      return false;
+    unbind(*weak);
+    }
+  bind(v);
+  return v.source!=0;
+  }
+
+#endif
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+typedef struct ALCcontext ALCcontext;
+
+namespace Tempest {
+namespace Detail {
+
+// playback state of one SoundEffect; bound to a real source only while audible
+struct Voice {
+  enum State : uint8_t {
+    Initial,
+    Playing,
+    Paused,
+    Stopped,
+    };
+
+  uint32_t source     = 0;   // 0, if voice is virtual
+  uint32_t buffer     = 0;
+  int32_t  spatialize = 0;   // AL_SOURCE_SPATIALIZE_SOFT value
+  bool     streamed   = false;
+  State    state      = Initial;
+  int32_t  priority   = 0;
+
+  float    pos[3]     = {};
+  float    gain       = 1.f;
+  float    maxDist    = std::numeric_limits<float>::max();
+  float    refDist    = 1.f;
+
+  uint64_t length     = 0;   // ms, 0 if unknown
+  uint64_t offset     = 0;   // ms, position at 'started' time
+  uint64_t started    = 0;   // ms, clock value when virtual playback was (re)started
+
+  size_t   id         = size_t(-1);
+  };
+
+class VoicePool final {
+  public:
+    VoicePool(ALCcontext* ctx, uint32_t count);
+    ~VoicePool();
+
+    void     add   (Voice& v);
+    void     remove(Voice& v);
+
+    void     play  (Voice& v);
+    void     pause (Voice& v);
+    bool     isFinished (Voice& v);
+    bool     isVirtual  (Voice& v);
+    uint64_t currentTime(Voice& v);
+
+    void     setPosition   (Voice& v, float x, float y, float z);
+    void     setGain       (Voice& v, float g);
+    void     setMaxDistance(Voice& v, float d);
+    void     setPriority   (Voice& v, int32_t p);
+
+    void     setListener(float x, float y, float z);
+    // re-evaluate, which voices are mixed and which are virtual
+    void     update();
+
+  private:
+    ALCcontext*           ctx = nullptr;
+    std::mutex            sync;
+    std::vector<uint32_t> sources;
+    std::vector<uint32_t> freeSrc;
+    std::vector<Voice*>   voices;
+    std::vector<Voice*>   active;
+    float                 listener[3] = {};
+
+    static uint64_t       clock();
+    float                 audibility(const Voice& v) const;
+    bool                  isAudible (const Voice& v) const;
+    bool                  isPinned  (const Voice& v) const;
+    bool                  isLess    (const Voice& a, const Voice& b) const;
+    uint64_t              currentTimeImpl(const Voice& v) const;
+    bool                  syncState(Voice& v);
+    void                  bind     (Voice& v);
+    void                  unbind   (Voice& v);
+    bool                  acquire  (Voice& v);
+  };
+
+}
+}
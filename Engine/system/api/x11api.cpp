@@ -6,6 +6,7 @@
 #include <Tempest/Window>
 #include <Tempest/Log>
 
+#include <algorithm>
 #include <atomic>
 #include <stdexcept>
 #include <cstring>
@@ -13,6 +14,8 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include <sys/select.h>
+
 #include <X11/X.h>
 #include <X11/Xlib.h>
 #include <X11/Xcursor/Xcursor.h>
@@ -540,12 +543,34 @@ void X11Api::implProcessEvents(SystemApi::AppCallBack &cb) {
     } else {
     if(cb.onTimer()==0)
       std::this_thread::yield();
+    bool render = false;
     for(auto& i:windows) {
       if(i.second==nullptr)
         continue;
+      render |= (i.second->w()>0 && i.second->h()>0);
       SystemApi::dispatchRender(*i.second);
       }
+    if(!render)
+      implWaitEvents(cb.nextTimer());
     }
   }
 
+void X11Api::implWaitEvents(uint64_t msec) {
+  // nothing to render: sleep until X-event or closest timer
+  static const uint64_t maxWait = 100; // keep 'exit' from other threads responsive
+  if(XPending(dpy)>0)
+    return;
+  msec = std::min(msec,maxWait);
+
+  const int fd = ConnectionNumber(dpy);
+  fd_set    fds;
+  FD_ZERO(&fds);
+  FD_SET(fd,&fds);
+
+  timeval tv = {};
+  tv.tv_sec  = time_t(msec/1000);
+  tv.tv_usec = suseconds_t((msec%1000)*1000);
+  select(fd+1,&fds,nullptr,nullptr,&tv);
+  }
+
 #endif
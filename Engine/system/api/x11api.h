@@ -29,6 +29,7 @@ class X11Api final: SystemApi {
     int      implExec(AppCallBack& cb) override;
     void     implProcessEvents(AppCallBack& cb) override;
     bool     implIsRunning() override;
+    void     implWaitEvents(uint64_t msec);
 
     void     alignGeometry(Window *w, Tempest::Window& owner);
 
@@ -10,14 +10,14 @@
 #include <chrono>
 
 #include "utility/spinlock.h"
+#include "timerqueue.h"
 #include "builtin_fonts.h"
 
 using namespace Tempest;
 using namespace Tempest::Detail;
 
 struct Application::Impl : SystemApi::AppCallBack {
-  std::vector<Timer*> timer;
-  size_t              timerI=size_t(-1);
+  TimerQueue          timer;
 
   const Style*        style=nullptr;
   Font                font;
@@ -41,29 +41,12 @@ struct Application::Impl : SystemApi::AppCallBack {
     return fontDef;
     }
 
-  void addTimer(Timer& t){
-    timer.push_back(&t);
-    }
-
-  void delTimer(Timer& t){
-    for(size_t i=0;i<timer.size();++i)
-      if(timer[i]==&t){
-        timer.erase(timer.begin()+int(i));
-        if(timerI>=i)
-          timerI--;
-        return;
-        }
+  uint32_t onTimer() override {
+    return timer.process(Application::tickCount());
     }
 
-  uint32_t onTimer() override {
-    auto now = Application::tickCount();
-    size_t count=0;
-    for(timerI=0;timerI<timer.size();++timerI){
-      Timer& t = *timer[timerI];
-      if(t.process(now))
-        count++;
-      }
-    return uint32_t(count);
+  uint64_t nextTimer() override {
+    return timer.next(Application::tickCount());
     }
 
   void setStyle(const Style* s) {
@@ -144,9 +127,17 @@ const Font& Application::defaultFont() {
   }
 
 void Application::implAddTimer(Timer &t) {
-  impl.addTimer(t);
+  impl.timer.add(t);
   }
 
 void Application::implDelTimer(Timer &t) {
-  impl.delTimer(t);
+  impl.timer.del(t);
+  }
+
+void Application::implDropTimer(Timer& t) {
+  impl.timer.drop(t);
+  }
+
+TimerQueue& TimerQueue::global() {
+  return Application::impl.timer;
   }
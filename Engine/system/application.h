@@ -9,6 +9,10 @@ class Timer;
 class Style;
 class Font;
 
+namespace Detail {
+class TimerQueue;
+}
+
 class Application {
   public:
     Application();
@@ -35,8 +39,10 @@ class Application {
 
     static void     implAddTimer(Timer& t);
     static void     implDelTimer(Timer& t);
+    static void     implDropTimer(Timer& t);
 
   friend class Timer;
+  friend class Detail::TimerQueue;
   };
 
 }
@@ -15,6 +15,8 @@ EventDispatcher::EventDispatcher(Widget &root)
   }
 
 void EventDispatcher::dispatchMouseDown(Widget& wnd, MouseEvent &e) {
+  // hit-test needs up to date geometry
+  wnd.flushLayout();
   ++mouseEvCount;
   const uint64_t prevEvCount = mouseEvCount;
 
@@ -75,6 +77,7 @@ void EventDispatcher::dispatchMouseUp(Widget& /*wnd*/, MouseEvent &e) {
   }
 
 void EventDispatcher::dispatchMouseMove(Widget& wnd, MouseEvent &e) {
+  wnd.flushLayout();
   if(auto w = lock(mouseUp)) {
     auto p = e.pos() - w->widget->mapToRoot(Point());
     MouseEvent e0( p.x,
@@ -128,6 +131,7 @@ void EventDispatcher::dispatchMouseMove(Widget& wnd, MouseEvent &e) {
 void EventDispatcher::dispatchMouseWheel(Widget& wnd, MouseEvent &e) {
   if(e.delta==0)
     return;
+  wnd.flushLayout();
   MouseEvent e1( e.x,
                  e.y,
                  e.button,
@@ -440,6 +444,8 @@ void EventDispatcher::implSetMouseOver(const std::shared_ptr<Widget::Ref> &wptr,
 void EventDispatcher::implExcMouseOver(Widget* w, Widget* old) {
   auto* wx = old;
   while(wx!=nullptr) {
+    if(wx->wstate.moveOver)
+      wx->update();
     wx->wstate.moveOver = false;
     wx = wx->owner();
     }
@@ -455,6 +461,8 @@ void EventDispatcher::implExcMouseOver(Widget* w, Widget* old) {
       r->implShowCursor(w->wstate.cursor);
     }
   while(wx!=nullptr) {
+    if(!wx->wstate.moveOver)
+      wx->update();
     wx->wstate.moveOver = true;
     wx = wx->owner();
     }
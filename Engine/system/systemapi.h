@@ -62,6 +62,8 @@ class SystemApi {
     struct AppCallBack {
       virtual ~AppCallBack()=default;
       virtual uint32_t onTimer()=0;
+      // milliseconds, until closest timer is due; uint64_t(-1), if there are no timers
+      virtual uint64_t nextTimer()=0;
       };
 
     SystemApi();
@@ -9,10 +9,17 @@ Timer::Timer() {
 
 Timer::~Timer() {
   setRunning(false);
+  Application::implDropTimer(*this);
   }
 
 void Timer::start(uint64_t t) {
   m.interval = t;
+  if(m.running) {
+    // deadline has changed - reinsert
+    Application::implDelTimer(*this);
+    Application::implAddTimer(*this);
+    return;
+    }
   setRunning(true);
   }
 
@@ -24,19 +31,10 @@ void Timer::setRunning(bool b) {
   if(m.running==b)
     return;
   if(b) {
-    Application::implAddTimer(*this);
     m.lastEmit = Application::tickCount();
+    Application::implAddTimer(*this);
     } else {
     Application::implDelTimer(*this);
     }
   m.running = b;
   }
-
-bool Timer::process(uint64_t now) {
-  if(now>=m.lastEmit && now-m.lastEmit>=m.interval){
-    m.lastEmit += m.interval;
-    timeout();
-    return true;
-    }
-  return false;
-  }
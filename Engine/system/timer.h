@@ -5,6 +5,10 @@
 
 namespace Tempest {
 
+namespace Detail {
+class TimerQueue;
+}
+
 class Timer final {
   public:
     Timer();
@@ -20,15 +24,17 @@ class Timer final {
 
   private:
     void     setRunning(bool b);
-    bool     process(uint64_t now);
+    uint64_t deadline() const { return m.lastEmit+m.interval; }
 
     struct {
       uint64_t interval=0;
       uint64_t lastEmit=0;
+      size_t   heapId=size_t(-1); // position in Application timer queue
       bool     running=false;
       } m;
 
   friend class Application;
+  friend class Detail::TimerQueue;
   };
 
 }
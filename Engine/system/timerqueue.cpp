@@ -0,0 +1,108 @@
+#include "timerqueue.h"
+
+#include <Tempest/Timer>
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+void TimerQueue::add(Timer& t) {
+  timer.push_back(&t);
+  siftUp(timer.size()-1);
+  }
+
+void TimerQueue::del(Timer& t) {
+  const size_t id = t.m.heapId;
+  if(id>=timer.size() || timer[id]!=&t)
+    return;
+  t.m.heapId = size_t(-1);
+
+  Timer* last = timer.back();
+  timer.pop_back();
+  if(id==timer.size())
+    return;
+  timer[id] = last;
+  if(id>0 && last->deadline()<timer[(id-1)/2]->deadline())
+    siftUp(id); else
+    siftDown(id);
+  }
+
+void TimerQueue::drop(Timer& t) {
+  del(t);
+  for(auto f:firing)
+    for(auto& i:*f)
+      if(i==&t)
+        i = nullptr;
+  }
+
+uint32_t TimerQueue::process(uint64_t now) {
+  // local list: callback may re-enter process, and collect it's own due timers
+  std::vector<Timer*> fire;
+  while(timer.size()>0 && timer[0]->deadline()<=now) {
+    Timer& t = *timer[0];
+    del(t);
+    fire.push_back(&t);
+    }
+  // late timer catches up on next calls
+  for(auto t:fire) {
+    t->m.lastEmit += t->m.interval;
+    add(*t);
+    }
+
+  struct Guard {
+    Guard(TimerQueue& q, std::vector<Timer*>& f):q(q) { q.firing.push_back(&f); }
+    ~Guard() { q.firing.pop_back(); }
+    TimerQueue& q;
+    };
+  Guard guard(*this,fire);
+
+  // callbacks may start, stop or delete timers; stopped one is skipped, restarted one keeps it's tick
+  uint32_t count=0;
+  for(size_t i=0; i<fire.size(); ++i) {
+    if(fire[i]==nullptr || !fire[i]->m.running)
+      continue;
+    fire[i]->timeout();
+    count++;
+    }
+  return count;
+  }
+
+uint64_t TimerQueue::next(uint64_t now) const {
+  if(timer.size()==0)
+    return uint64_t(-1);
+  const auto dt = timer[0]->deadline();
+  return dt<=now ? 0 : dt-now;
+  }
+
+void TimerQueue::siftUp(size_t i) {
+  Timer* t = timer[i];
+  while(i>0) {
+    size_t p = (i-1)/2;
+    if(!(t->deadline()<timer[p]->deadline()))
+      break;
+    place(i,timer[p]);
+    i = p;
+    }
+  place(i,t);
+  }
+
+void TimerQueue::siftDown(size_t i) {
+  Timer*       t = timer[i];
+  const size_t n = timer.size();
+  while(true) {
+    size_t c = i*2+1;
+    if(c>=n)
+      break;
+    if(c+1<n && timer[c+1]->deadline()<timer[c]->deadline())
+      c++;
+    if(!(timer[c]->deadline()<t->deadline()))
+      break;
+    place(i,timer[c]);
+    i = c;
+    }
+  place(i,t);
+  }
+
+void TimerQueue::place(size_t i, Timer* t) {
+  timer[i]    = t;
+  t->m.heapId = i;
+  }
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace Tempest {
+
+class Timer;
+
+namespace Detail {
+
+// running timers of Application: binary min-heap, ordered by deadline
+class TimerQueue final {
+  public:
+    TimerQueue() = default;
+    TimerQueue(const TimerQueue&) = delete;
+    TimerQueue& operator = (const TimerQueue&) = delete;
+
+    // queue, that Timer registers in
+    static TimerQueue& global();
+
+    void     add (Timer& t);
+    void     del (Timer& t);
+    // timer is destroyed: must not be fired by process call in progress
+    void     drop(Timer& t);
+
+    // fires due timers, each at most once per call; returns count of fired timers
+    uint32_t process(uint64_t now);
+    uint64_t next   (uint64_t now) const;
+
+  private:
+    std::vector<Timer*>               timer;
+    // due timers of process calls in progress; callbacks may re-enter via Application::processEvents
+    std::vector<std::vector<Timer*>*> firing;
+
+    void     siftUp  (size_t i);
+    void     siftDown(size_t i);
+    void     place   (size_t i, Timer* t);
+  };
+
+}
+}
@@ -3,7 +3,7 @@
 using namespace Tempest;
 
 ListView::ListView(Orientation ori)
-  : sc(ori) {
+  : sc(*this,ori), orient(ori) {
   sc.scrollAfterEndV(true);
   sc.setMargins(Margin(0));
   addWidget(&sc);
@@ -41,9 +41,30 @@ void ListView::removeDelegate() {
   }
 
 void ListView::setLayout(Orientation ori) {
+  orient  = ori;
+  itemEst = 0;
   sc.setLayout(ori);
   }
 
+void ListView::setVirtualized(bool v, int itemSize) {
+  if(virt==v && itemSz==itemSize)
+    return;
+  if(delegate!=nullptr) {
+    auto& w = sc.centralWidget();
+    while(w.widgetsCount()>0) {
+      size_t i=w.widgetsCount()-1;
+      auto wx = w.takeWidget(&w.widget(i));
+      delegate->removeView(wx,virt ? first+i : i);
+      }
+    }
+  virt    = v;
+  itemSz  = itemSize;
+  itemEst = 0;
+  first   = 0;
+  if(delegate!=nullptr)
+    updateView();
+  }
+
 void ListView::setDefaultItemRole(ListDelegate::Role role) {
   if(role==defaultRole)
     return;
@@ -56,14 +77,23 @@ void ListView::invalidateView(){
   while(w.widgetsCount()>0) {
     size_t i=w.widgetsCount()-1;
     auto wx = w.takeWidget(&w.widget(i));
-    delegate->removeView(wx,i);
+    delegate->removeView(wx,virt ? first+i : i);
     }
+  itemEst = 0;
 
   updateView();
   onItemListChanged();
   }
 
 void ListView::updateView() {
+  if(virt) {
+    // all live views are refreshed on next layout
+    virtDirty = true;
+    sc.applyLayout();
+    onItemListChanged();
+    return;
+    }
+
   auto&  w      = sc.centralWidget();
   size_t cnt    = delegate->size();
   size_t wcount = w.widgetsCount();
@@ -89,3 +119,131 @@ void ListView::updateView() {
 
   onItemListChanged();
   }
+
+int ListView::implItemSize() {
+  if(itemSz>0)
+    return itemSz;
+  if(itemEst<=0 && delegate!=nullptr && delegate->size()>0) {
+    Widget* wx  = delegate->createView(0,defaultRole);
+    Size    sz  = wx->sizeHint();
+    Size    min = wx->minSize();
+    itemEst = orient==Vertical ? std::max(sz.h,min.h) : std::max(sz.w,min.w);
+    delegate->removeView(wx,0);
+    }
+  return itemEst>0 ? itemEst : DefaultItemSize;
+  }
+
+Size ListView::implContentSize(bool inParent) {
+  auto&         cen   = sc.centralWidget();
+  const Margin& m     = cen.margins();
+  const size_t  count = delegate==nullptr ? 0 : delegate->size();
+  const int     item  = implItemSize();
+
+  int len = 0;
+  if(count>0)
+    len = int(count)*item + int(count-1)*cen.spacing();
+
+  int cross = 0;
+  for(size_t i=0; i<cen.widgetsCount(); ++i) {
+    auto& wx = cen.widget(i);
+    cross = std::max(cross,orient==Vertical ? wx.sizeHint().w : wx.sizeHint().h);
+    }
+
+  if(orient==Vertical) {
+    if(inParent)
+      cross = std::max(cross,sc.w());
+    return Size(cross,len+m.yMargin());
+    }
+  if(inParent)
+    cross = std::max(cross,sc.h());
+  return Size(len+m.xMargin(),cross);
+  }
+
+Widget* ListView::implItemView(std::vector<std::pair<Widget*,size_t>>& spare, size_t position) {
+  if(spare.empty())
+    return delegate->createView(position,defaultRole);
+  Widget* wx = spare.back().first;
+  spare.pop_back();
+  return delegate->update(wx,position);
+  }
+
+void ListView::implLayoutItems() {
+  if(!virt || delegate==nullptr || virtBusy)
+    return;
+  virtBusy = true;
+
+  auto&         cen    = sc.centralWidget();
+  const Margin& m      = cen.margins();
+  const bool    vert   = orient==Vertical;
+  const size_t  count  = delegate->size();
+  const size_t  live   = cen.widgetsCount();
+  const int     item   = implItemSize();
+  const int     step   = item + cen.spacing();
+
+  // visible range, plus overscan
+  const int     offset = vert ? sc.scrollV()-m.top : sc.scrollH()-m.left;
+  const int     extent = vert ? sc.h() : sc.w();
+  size_t        begin  = offset<=0 ? 0 : size_t(offset/step);
+  size_t        end    = size_t(std::max(0,offset+extent)/step)+1;
+  begin = std::min(begin>size_t(Overscan) ? begin-Overscan : 0, count);
+  end   = std::min(end+Overscan, count);
+
+  // views, that are still visible, are kept as is
+  size_t keepB = std::max(begin,first);
+  size_t keepE = std::min(end,  first+live);
+  if(virtDirty || keepB>=keepE)
+    keepB = keepE = end;
+
+  std::vector<std::pair<Widget*,size_t>> spare;
+  while(first+cen.widgetsCount()>keepE && cen.widgetsCount()>0) {
+    size_t i  = cen.widgetsCount()-1;
+    auto   wx = cen.takeWidget(&cen.widget(i));
+    spare.emplace_back(wx,first+i);
+    }
+  while(first<keepB && cen.widgetsCount()>0) {
+    auto wx = cen.takeWidget(&cen.widget(0));
+    spare.emplace_back(wx,first);
+    ++first;
+    }
+
+  for(size_t i=begin; i<keepB; ++i)
+    cen.addWidget(implItemView(spare,i),i-begin);
+  for(size_t i=keepE; i<end; ++i)
+    cen.addWidget(implItemView(spare,i));
+  for(auto& i:spare)
+    delegate->removeView(i.first,i.second);
+  first     = begin;
+  virtDirty = false;
+
+  for(size_t i=0; i<cen.widgetsCount(); ++i) {
+    auto&     wx  = cen.widget(i);
+    const int pos = int(first+i)*step;
+    if(vert)
+      wx.setGeometry(m.left,m.top+pos,cen.w()-m.xMargin(),item); else
+      wx.setGeometry(m.left+pos,m.top,item,cen.h()-m.yMargin());
+    }
+  virtBusy = false;
+  }
+
+Size ListView::View::contentAreaSize() {
+  if(!owner.virt)
+    return ScrollWidget::contentAreaSize();
+  return owner.implContentSize(true);
+  }
+
+Size ListView::View::contentSize() {
+  if(!owner.virt)
+    return ScrollWidget::contentSize();
+  return owner.implContentSize(false);
+  }
+
+void ListView::View::layoutContent() {
+  if(!owner.virt)
+    return ScrollWidget::layoutContent();
+  owner.implLayoutItems();
+  }
+
+void ListView::View::viewportChanged() {
+  if(owner.virt)
+    applyLayout();
+  }
@@ -5,6 +5,8 @@
 #include <Tempest/ListDelegate>
 #include <Tempest/Layout>
 
+#include <vector>
+
 namespace Tempest {
 
 class ListView : public Widget {
@@ -29,15 +31,48 @@ class ListView : public Widget {
     void setDefaultItemRole(ListDelegate::Role role);
     auto defaultItemRole() const -> ListDelegate::Role { return defaultRole; }
 
+    // create views only for visible items, plus a few extra; all items are expected to be of same size.
+    // itemSize==0 - estimate size from view of first item
+    void setVirtualized(bool v, int itemSize = 0);
+    bool isVirtualized() const { return virt; }
+
     void invalidateView();
     void updateView();
 
   private:
-    void implSetDelegate(ListDelegate* d);
+    struct View : ScrollWidget {
+      View(ListView& owner, Orientation ori):ScrollWidget(ori),owner(owner){}
+
+      Size contentAreaSize() override;
+      Size contentSize() override;
+      void layoutContent() override;
+      void viewportChanged() override;
+
+      ListView& owner;
+      };
 
-    ScrollWidget                   sc;
+    enum {
+      Overscan        = 4,
+      DefaultItemSize = 24,
+      };
+
+    void    implSetDelegate(ListDelegate* d);
+    int     implItemSize();
+    Size    implContentSize(bool inParent);
+    void    implLayoutItems();
+    Widget* implItemView(std::vector<std::pair<Widget*,size_t>>& spare, size_t position);
+
+    View                           sc;
     std::unique_ptr<ListDelegate>  delegate;
     ListDelegate::Role             defaultRole = ListDelegate::R_ListItem;
+    Orientation                    orient      = Vertical;
+
+    bool                           virt        = false;
+    bool                           virtDirty   = false;
+    bool                           virtBusy    = false;
+    int                            itemSz      = 0;
+    int                            itemEst     = 0;
+    size_t                         first       = 0;
   };
 
 }
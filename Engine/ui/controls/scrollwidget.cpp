@@ -122,7 +122,7 @@ bool ScrollWidget::updateScrolls(Orientation orient,bool noRetry) {
   const Widget* first = findFirst();
   const Widget* last  = findLast();
 
-  Size content = cenLay->wrapContent(cen,orient,false);
+  Size content = contentSize();
   Size hint    = cen.sizeHint();
 
   const bool needScH = (hor ==AlwaysOn || content.w>helper.w());
@@ -323,11 +323,13 @@ void ScrollWidget::mouseMoveEvent(Tempest::MouseEvent &e) {
 void ScrollWidget::scrollH( int v ) {
   sbH.setValue( v );
   cen.setPosition(-sbH.value(), cen.y());
+  viewportChanged();
   }
 
 void ScrollWidget::scrollV(int v) {
   sbV.setValue( v );
   cen.setPosition(cen.x(), -sbV.value());
+  viewportChanged();
   }
 
 int ScrollWidget::scrollH() const {
@@ -352,7 +354,7 @@ void ScrollWidget::complexLayout() {
   for(int i=1;i<=tryCound;++i)
     if(updateScrolls(orient,i==tryCound))
       break;
-  cenLay->commitLayout();
+  layoutContent();
   layoutBusy=false;
   }
 
@@ -376,3 +378,14 @@ void ScrollWidget::wrapContent() {
 Size ScrollWidget::contentAreaSize() {
   return cenLay->wrapContent(cen,cenLay->orientation(),true);
   }
+
+Size ScrollWidget::contentSize() {
+  return cenLay->wrapContent(cen,cenLay->orientation(),false);
+  }
+
+void ScrollWidget::layoutContent() {
+  cenLay->commitLayout();
+  }
+
+void ScrollWidget::viewportChanged() {
+  }
@@ -51,6 +51,12 @@ class ScrollWidget : public Tempest::Widget {
     void    mouseMoveEvent(Tempest::MouseEvent &e);
 
     virtual Size contentAreaSize();
+    // size of content, not stretched to the viewport
+    virtual Size contentSize();
+    // places widgets inside of central widget
+    virtual void layoutContent();
+    // central widget has been scrolled
+    virtual void viewportChanged();
 
   private:
     struct BoxLayout;
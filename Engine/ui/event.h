@@ -8,6 +8,17 @@ namespace Tempest {
 class PaintDevice;
 class TextureAtlas;
 class Painter;
+class VectorImage;
+
+namespace Detail {
+// output of previous frame, used to reuse geometry of unchanged widgets
+struct PaintCache {
+  VectorImage*       dst       = nullptr;
+  const VectorImage* prev      = nullptr;
+  uint64_t           frame     = 0;
+  uint64_t           prevFrame = 0;
+  };
+}
 
 class Event {
   public:
@@ -187,9 +198,15 @@ class PaintEvent: public Event {
       setType( Paint );
       }
 
+    // paint, reusing geometry of unchanged widgets from cache.prev
+    PaintEvent(PaintDevice & p,TextureAtlas& ta,int32_t w,int32_t h,Detail::PaintCache& cache)
+      : PaintEvent(p,ta,w,h) {
+      this->cache = &cache;
+      }
+
     PaintEvent(PaintEvent& parent,int32_t dx,int32_t dy,int32_t x,int32_t y,int32_t w,int32_t h)
       : dev(parent.dev),ta(parent.ta),outW(parent.outW),outH(parent.outH),
-        dp(parent.dp.x+dx,parent.dp.y+dy),vp(x,y,w,h){
+        dp(parent.dp.x+dx,parent.dp.y+dy),vp(x,y,w,h),cache(parent.cache){
       setType( Paint );
       }
 
@@ -209,9 +226,13 @@ class PaintEvent: public Event {
     Point         dp;
     Rect          vp;
 
+    Detail::PaintCache* cache = nullptr;
+
     using Event::accept;
 
   friend class Painter;
+  friend class Widget;
+  friend class Window;
   };
 
 /*!
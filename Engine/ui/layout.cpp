@@ -66,7 +66,7 @@ Widget *Layout::takeWidget(size_t i) {
     Widget* wx=w->wx[i];
     w->wx.erase(w->wx.begin()+int(i));
     wx->ow=nullptr;
-    applyLayout();
+    w->applyLayout();
     return wx;
     }
   return nullptr;
@@ -78,7 +78,7 @@ Widget *Layout::takeWidget(Widget *wx) {
 
 void Layout::bind(Widget *wx) {
   w = wx;
-  applyLayout();
+  w->applyLayout();
   }
 
 void LinearLayout::applyLayout(Widget &w, Orientation ori) {
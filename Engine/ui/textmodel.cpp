@@ -4,6 +4,8 @@
 #include <Tempest/Painter>
 #include <Tempest/TextCodec>
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include "utility/utf8_helper.h"
 
@@ -91,32 +93,20 @@ void TextModel::CommandErase::undo(TextModel& subj) {
   }
 
 
-TextModel::TextModel(const char *str)
-  :txt(std::strlen(str)+1){
-  std::memcpy(txt.data(),str,txt.size());
-  buildIndex();
+TextModel::TextModel(const char *str) {
+  implSetText(str,std::strlen(str));
   }
 
 void TextModel::setText(const char *str) {
-  txt.resize(std::strlen(str)+1);
-  std::memcpy(txt.data(),str,txt.size());
-  buildIndex();
-  sz.actual=false;
+  implSetText(str,std::strlen(str));
   }
 
 void TextModel::insert(const char* t, Cursor where) {
-  if(txt.size()==0) {
+  if(!init) {
     setText(t);
     return;
     }
-  size_t at  = cursorCast(where);
-  size_t len = std::strlen(t);
-
-  txt.insert(txt.begin()+at,t,t+len);
-  buildIndex();
-  sz.actual=false;
-
-  cursorCast(at+len);
+  implInsert(cursorCast(where),t,std::strlen(t));
   }
 
 void TextModel::erase(Cursor cs, Cursor ce) {
@@ -124,10 +114,7 @@ void TextModel::erase(Cursor cs, Cursor ce) {
   size_t e = cursorCast(ce);
   if(e<s)
     std::swap(s,e);
-
-  txt.erase(txt.begin()+s,txt.begin()+e);
-  buildIndex();
-  sz.actual=false;
+  implErase(s,e);
   }
 
 void TextModel::erase(TextModel::Cursor s, size_t count) {
@@ -136,21 +123,16 @@ void TextModel::erase(TextModel::Cursor s, size_t count) {
   }
 
 void TextModel::replace(const char* t, TextModel::Cursor cs, TextModel::Cursor ce) {
-  if(txt.size()==0) {
+  if(!init) {
     setText(t);
     return;
     }
   size_t s   = cursorCast(cs);
   size_t e   = cursorCast(ce);
-  size_t len = std::strlen(t);
   if(e<s)
     std::swap(s,e);
-
-  txt.erase (txt.begin()+s,txt.begin()+e);
-  txt.insert(txt.begin()+s,t,t+len);
-
-  buildIndex();
-  sz.actual=false;
+  implErase (s,e);
+  implInsert(s,t,std::strlen(t));
   }
 
 void TextModel::fetch(TextModel::Cursor cs, TextModel::Cursor ce, std::string& buf) {
@@ -161,7 +143,7 @@ void TextModel::fetch(TextModel::Cursor cs, TextModel::Cursor ce, std::string& b
   if(e<s)
     std::swap(s,e);
   buf.resize(e-s);
-  std::memcpy(&buf[0],&txt[s],buf.size());
+  copy(s,e,&buf[0]);
   }
 
 void TextModel::fetch(TextModel::Cursor cs, TextModel::Cursor ce, char* buf) {
@@ -171,35 +153,38 @@ void TextModel::fetch(TextModel::Cursor cs, TextModel::Cursor ce, char* buf) {
     return;
   if(e<s)
     std::swap(s,e);
-  std::memcpy(&buf[0],&txt[s],e-s);
+  copy(s,e,buf);
   }
 
 TextModel::Cursor TextModel::advance(TextModel::Cursor src, int32_t offset) const {
+  if(!init)
+    return Cursor();
   size_t c = cursorCast(src);
   if(offset>0) {
-    const char* str = txt.data()+c, *end = txt.data()+txt.size()-(txt.size() ? 1 : 0);
-    for(int32_t i=0;i<offset && str<end;++i) {
-      const auto l = Detail::utf8LetterLength(str);
-      str+=l;
+    const size_t end = size();
+    for(int32_t i=0;i<offset && c<end;++i) {
+      const char ch = byteAt(c);
+      const auto l  = Detail::utf8LetterLength(&ch);
+      c += std::max<size_t>(l,1);
       }
-    return cursorCast(std::distance(txt.data(),str));
+    return cursorCast(std::min(c,end));
     } else {
     offset = -offset;
-    const char* str = txt.data()+c, *begin = txt.data();
     for(int32_t i=0;i<offset;++i) {
-      while(str!=begin) {
-        str--;
-        if((uint8_t(*str) >> 6) != 0x2)
+      while(c!=0) {
+        c--;
+        if((uint8_t(byteAt(c)) >> 6) != 0x2)
           break;
         }
       }
-    return cursorCast(std::distance(txt.data(),str));
+    return cursorCast(c);
     }
   }
 
 void TextModel::setFont(const Font &f) {
   fnt      =f;
   sz.actual=false;
+  std::fill(lineW.begin(),lineW.end(),-1.f);
   }
 
 const Font& TextModel::font() const {
@@ -219,7 +204,7 @@ Size TextModel::wrapSize() const {
   }
 
 bool TextModel::isEmpty() const {
-  return txt.size()<=1;
+  return size()==0;
   }
 
 void TextModel::paint(Painter& p, const Color& color, int x, int y) const {
@@ -227,97 +212,293 @@ void TextModel::paint(Painter& p, const Color& color, int x, int y) const {
   }
 
 void TextModel::paint(Painter &p, const Font& fnt, const Color& color, int fx, int fy) const {
-  float x = float(fx);
-  float y = float(fy);
-
-  auto pb=p.brush();
-  Utf8Iterator i(txt.data());
-  while(i.hasData()) {
-    auto ch=i.next();
-    if(ch=='\0'){
-      p.setBrush(pb);
-      return;
-      }
-    if(ch=='\n'){
-      x =  0;
-      y += fnt.pixelSize();
-      continue;
-      }
+  const float lnH   = fnt.pixelSize();
+  const size_t n    = lineCount();
+  size_t       first = 0, last = n;
+  if(lnH>0) {
+    // only lines, that may intersect with scissor; one line of margin for glyphs above baseline
+    const Rect   sc = p.scissor();
+    const double b  = std::floor(double(sc.y     -fy)/lnH) - 1.0;
+    const double e  = std::ceil (double(sc.y+sc.h-fy)/lnH) + 1.0;
+    if(b>0)
+      first = size_t(b);
+    if(e<0)
+      last = 0; else
+    if(e<double(n))
+      last = size_t(e);
+    }
 
-    auto l=fnt.letter(ch,p);
-    if(!l.view.isEmpty()) {
-      p.setBrush(Brush(l.view,color,PaintDevice::Alpha));
-      p.drawRect(int(x+l.dpos.x),int(y+l.dpos.y),l.view.w(),l.view.h());
+  auto        pb=p.brush();
+  std::string tmp;
+  for(size_t ln=first; ln<last; ++ln) {
+    size_t      len = 0;
+    const char* str = lineView(ln,len,tmp);
+    float       x   = float(fx);
+    float       y   = float(fy)+float(ln)*lnH;
+
+    Utf8Iterator i(str,len);
+    while(i.hasData()) {
+      auto ch=i.next();
+      if(ch=='\0')
+        break;
+      auto l=fnt.letter(ch,p);
+      if(!l.view.isEmpty()) {
+        p.setBrush(Brush(l.view,color,PaintDevice::Alpha));
+        p.drawRect(int(x+l.dpos.x),int(y+l.dpos.y),l.view.w(),l.view.h());
+        }
+      x += l.advance.x;
       }
-
-    x += l.advance.x;
     }
   p.setBrush(pb);
   }
 
 void TextModel::calcSize() const {
-  sz = calcSize(fnt);
-  }
-
-TextModel::Sz TextModel::calcSize(const Font& fnt) const {
-  float x=0, w=0;
-  int   y=0, top=0;
+  const size_t n = lineCount();
+  float        w = 0;
+  std::string  tmp;
+  for(size_t ln=0; ln<n; ++ln) {
+    if(lineW[ln]<0) {
+      size_t      len = 0;
+      const char* str = lineView(ln,len,tmp);
+      float       x   = 0;
+      Utf8Iterator i(str,len);
+      while(i.hasData()) {
+        auto l=fnt.letterGeometry(i.next());
+        x += l.advance.x;
+        }
+      lineW[ln] = x;
+      }
+    w = std::max(w,lineW[ln]);
+    }
 
-  Utf8Iterator i(txt.data());
-  while(i.hasData()){
-    char32_t ch = i.next();
-    if(ch=='\n'){
-      w = std::max(w,x);
-      x = 0;
-      y = 0;
-      top+=int(fnt.pixelSize());
-      } else {
-      auto l=fnt.letterGeometry(ch);
-      x += l.advance.x;
-      y =  std::max(-l.dpos.y,y);
+  // wrap height depends only on glyphs of the last line
+  int y = 0;
+  if(n>0) {
+    size_t      len = 0;
+    const char* str = lineView(n-1,len,tmp);
+    Utf8Iterator i(str,len);
+    while(i.hasData()) {
+      auto l=fnt.letterGeometry(i.next());
+      y = std::max(-l.dpos.y,y);
       }
     }
-  w = std::max(w,x);
 
-  Sz sz;
-  sz.wrapHeight=y+top;
-  sz.sizeHint  =Size(int(std::ceil(w)),top+int(fnt.pixelSize()));
-  return sz;
+  const int top = n>0 ? int(n-1)*int(fnt.pixelSize()) : 0;
+  sz.wrapHeight = y+top;
+  sz.sizeHint   = Size(int(std::ceil(w)),top+int(fnt.pixelSize()));
+  sz.actual     = true;
   }
 
-void TextModel::buildIndex() {
-  if(txt.size()==0) {
-    line.clear();
-    return;
+size_t TextModel::lineCount() const {
+  if(!init)
+    return 0;
+  return pLine.back()+1;
+  }
+
+size_t TextModel::lineOf(size_t at) const {
+  const size_t i = findPiece(at);
+  if(i>=piece.size())
+    return pLine.back();
+  auto&  p  = piece[i];
+  auto&  nl = buf[p.buf].nl;
+  auto   b  = std::lower_bound(nl.begin(),nl.end(),p.start);
+  auto   e  = std::lower_bound(b,nl.end(),p.start+(at-pOff[i]));
+  return pLine[i]+size_t(std::distance(b,e));
+  }
+
+size_t TextModel::lineStart(size_t ln) const {
+  if(ln==0)
+    return 0;
+  // piece, that contains newline number 'ln-1'
+  const size_t k = ln-1;
+  const size_t i = size_t(std::distance(pLine.begin(),std::upper_bound(pLine.begin(),pLine.end(),k)))-1;
+  auto&  p  = piece[i];
+  auto&  nl = buf[p.buf].nl;
+  auto   b  = std::lower_bound(nl.begin(),nl.end(),p.start);
+  size_t at = *(b+std::ptrdiff_t(k-pLine[i]));
+  return pOff[i]+(at-p.start)+1;
+  }
+
+size_t TextModel::lineSize(size_t ln) const {
+  const size_t s = lineStart(ln);
+  if(ln+1<lineCount())
+    return lineStart(ln+1)-1-s;
+  return size()-s;
+  }
+
+const char* TextModel::lineView(size_t ln, size_t& len, std::string& tmp) const {
+  const size_t s = lineStart(ln);
+  len = lineSize(ln);
+  if(len==0)
+    return "";
+  const size_t i = findPiece(s);
+  auto&        p = piece[i];
+  if(s+len<=pOff[i+1])
+    return buf[p.buf].data.data()+p.start+(s-pOff[i]);
+  tmp.resize(len);
+  copy(s,s+len,&tmp[0]);
+  return tmp.data();
+  }
+
+size_t TextModel::findPiece(size_t at) const {
+  return size_t(std::distance(pOff.begin(),std::upper_bound(pOff.begin(),pOff.end(),at)))-1;
+  }
+
+char TextModel::byteAt(size_t at) const {
+  const size_t i = findPiece(at);
+  auto&        p = piece[i];
+  return buf[p.buf].data[p.start+(at-pOff[i])];
+  }
+
+void TextModel::copy(size_t s, size_t e, char* out) const {
+  for(size_t i=findPiece(s); s<e; ++i) {
+    auto&  p   = piece[i];
+    size_t off = s-pOff[i];
+    size_t n   = std::min(p.len-off,e-s);
+    std::memcpy(out,buf[p.buf].data.data()+p.start+off,n);
+    out += n;
+    s   += n;
     }
+  }
 
-  size_t count=0;
-  for(auto c:txt)
-    if(c=='\n')
-      count++;
-  line.resize(count+1);
+void TextModel::implSetText(const char* text, size_t len) {
+  auto& org = buf[Original];
+  org.data.assign(text,len);
+  org.nl.clear();
+  for(size_t i=0; i<len; ++i)
+    if(text[i]=='\n')
+      org.nl.push_back(i);
+  buf[Append].data.clear();
+  buf[Append].nl.clear();
+
+  piece.clear();
+  if(len>0) {
+    Piece p;
+    p.buf   = Original;
+    p.start = 0;
+    p.len   = len;
+    p.nl    = org.nl.size();
+    piece.push_back(p);
+    }
+  init = true;
+  implIndex();
 
-  size_t beg=0;
-  size_t ln =0;
-  Utf8Iterator i(txt.data());
-  while(i.hasData()){
-    char32_t ch = i.next();
-    if(ch=='\n') {
-      size_t ipos=i.pos();
-      line[ln].txt  = &txt[beg];
-      line[ln].size = ipos-1-beg;
+  lineW.assign(lineCount(),-1.f);
+  cstrActual = false;
+  sz.actual  = false;
+  }
+
+void TextModel::implInsert(size_t at, const char* text, size_t len) {
+  if(len==0)
+    return;
 
-      beg=ipos;
-      ln++;
+  auto&        add = buf[Append];
+  const size_t s0  = add.data.size();
+  add.data.append(text,len);
+  for(size_t i=0; i<len; ++i)
+    if(text[i]=='\n')
+      add.nl.push_back(s0+i);
+  const size_t nl = add.nl.size()-std::distance(add.nl.begin(),std::lower_bound(add.nl.begin(),add.nl.end(),s0));
+
+  const size_t ln = lineOf(at);
+  lineW[ln] = -1.f;
+  lineW.insert(lineW.begin()+std::ptrdiff_t(ln+1),nl,-1.f);
+
+  const size_t prev = at>0 ? findPiece(at-1) : piece.size();
+  if(prev<piece.size() && pOff[prev+1]==at &&
+     piece[prev].buf==Append && piece[prev].start+piece[prev].len==s0) {
+    // typing: grow last inserted piece
+    piece[prev].len += len;
+    piece[prev].nl  += nl;
+    for(size_t i=prev+1; i<pOff.size(); ++i) {
+      pOff [i] += len;
+      pLine[i] += nl;
       }
+    } else {
+    Piece p;
+    p.buf   = Append;
+    p.start = s0;
+    p.len   = len;
+    p.nl    = nl;
+    const size_t i = implSplit(at);
+    piece.insert(piece.begin()+std::ptrdiff_t(i),p);
+    implIndex();
     }
 
-  line[ln].txt  = txt.data()+beg;
-  line[ln].size = txt.size()-beg-1;
+  if(piece.size()>MaxPieces)
+    implCompact();
+  cstrActual = false;
+  sz.actual  = false;
+  }
+
+void TextModel::implErase(size_t s, size_t e) {
+  if(s>=e)
+    return;
+  const size_t ls = lineOf(s);
+  const size_t le = lineOf(e);
+  lineW.erase(lineW.begin()+std::ptrdiff_t(ls+1),lineW.begin()+std::ptrdiff_t(le+1));
+  lineW[ls] = -1.f;
+
+  const size_t b = implSplit(s);
+  const size_t r = implSplit(e);
+  piece.erase(piece.begin()+std::ptrdiff_t(b),piece.begin()+std::ptrdiff_t(r));
+  implIndex();
+
+  if(piece.size()>MaxPieces)
+    implCompact();
+  cstrActual = false;
+  sz.actual  = false;
+  }
+
+size_t TextModel::implSplit(size_t at) {
+  const size_t i = findPiece(at);
+  if(i>=piece.size() || pOff[i]==at)
+    return i;
+
+  Piece a = piece[i];
+  Piece b = a;
+  a.len    = at-pOff[i];
+  a.nl     = countNl(a.buf,a.start,a.len);
+  b.start += a.len;
+  b.len   -= a.len;
+  b.nl    -= a.nl;
+
+  piece[i] = a;
+  piece.insert(piece.begin()+std::ptrdiff_t(i+1),b);
+  pOff .insert(pOff .begin()+std::ptrdiff_t(i+1),at);
+  pLine.insert(pLine.begin()+std::ptrdiff_t(i+1),pLine[i]+a.nl);
+  return i+1;
+  }
+
+void TextModel::implIndex() {
+  pOff .resize(piece.size()+1);
+  pLine.resize(piece.size()+1);
+  pOff [0] = 0;
+  pLine[0] = 0;
+  for(size_t i=0; i<piece.size(); ++i) {
+    pOff [i+1] = pOff [i]+piece[i].len;
+    pLine[i+1] = pLine[i]+piece[i].nl;
+    }
+  }
+
+void TextModel::implCompact() {
+  // heavily fragmented document: flatten into new original buffer, line widths stay valid
+  std::string  txt(size(),'\0');
+  copy(0,txt.size(),&txt[0]);
+  auto lw = std::move(lineW);
+  implSetText(txt.data(),txt.size());
+  lineW = std::move(lw);
+  }
+
+size_t TextModel::countNl(BufferId b, size_t s, size_t len) const {
+  auto& nl = buf[b].nl;
+  auto  i0 = std::lower_bound(nl.begin(),nl.end(),s);
+  auto  i1 = std::lower_bound(i0,nl.end(),s+len);
+  return size_t(std::distance(i0,i1));
   }
 
 TextModel::Cursor TextModel::charAt(int x, int y) const {
-  if(line.size()==0) {
+  if(lineCount()==0) {
     Cursor c;
     c.line   = 0;
     c.offset = 0;
@@ -330,11 +511,13 @@ TextModel::Cursor TextModel::charAt(int x, int y) const {
     x=0;
   Cursor c;
   c.line   = size_t(y/fnt.pixelSize());
-  if(c.line>=line.size())
-    c.line=line.size()-1;
+  if(c.line>=lineCount())
+    c.line=lineCount()-1;
 
-  auto& ln = line[c.line];
-  Utf8Iterator i(ln.txt,ln.size);
+  std::string  tmp;
+  size_t       len = 0;
+  const char*  str = lineView(c.line,len,tmp);
+  Utf8Iterator i(str,len);
   int    px      = 0;
   size_t prevPos = 0;
   while(i.hasData()){
@@ -349,19 +532,20 @@ TextModel::Cursor TextModel::charAt(int x, int y) const {
       }
     px += l.advance.x;
     }
-  c.offset = ln.size;
+  c.offset = len;
   return c;
   }
 
 TextModel::Cursor TextModel::charAt(size_t symbol) const {
   Cursor c;
   c.line = 0;
-  for(auto& l:line) {
-    if(symbol<=l.size) {
+  for(size_t ln=0; ln<lineCount(); ++ln) {
+    const size_t l = lineSize(ln);
+    if(symbol<=l) {
       c.offset = symbol;
       return c;
       }
-    symbol -= l.size;
+    symbol -= l;
     c.line++;
     }
   c.offset = symbol;
@@ -373,9 +557,11 @@ Point TextModel::mapToCoords(Cursor c) const {
     return Point();
   Point p;
   p.y = int(c.line*fnt.pixelSize());
-  auto& ln = line[c.line];
 
-  Utf8Iterator str(ln.txt,ln.size);
+  std::string  tmp;
+  size_t       len = 0;
+  const char*  ln  = lineView(c.line,len,tmp);
+  Utf8Iterator str(ln,len);
   while(str.hasData() && str.pos()<c.offset){
     char32_t ch = str.next();
     auto l=fnt.letterGeometry(ch);
@@ -385,59 +571,56 @@ Point TextModel::mapToCoords(Cursor c) const {
   }
 
 const char* TextModel::c_str() const {
-  if(txt.size()==0)
+  if(!init)
     return "";
-  return txt.data();
+  if(!cstrActual) {
+    cstr.resize(size());
+    copy(0,cstr.size(),&cstr[0]);
+    cstrActual = true;
+    }
+  return cstr.c_str();
   }
 
 size_t TextModel::size() const {
-  if(txt.size()==0)
-    return 0;
-  return txt.size()-1;
+  return pOff.back();
   }
 
 bool TextModel::isValid(TextModel::Cursor c) const {
-  if(c.line>=line.size())
+  if(c.line>=lineCount())
     return false;
-  return c.offset<=line[c.line].size;
+  return c.offset<=lineSize(c.line);
   }
 
 TextModel::Cursor TextModel::clamp(const TextModel::Cursor& c) const {
   Cursor r;
-  if(line.size()==0) {
+  if(lineCount()==0) {
     r.line   = 0;
     r.offset = 0;
     return r;
     }
-  r.line   = std::max<size_t>(0,std::min<size_t>(c.line,line.size()-1));
-  r.offset = std::max<size_t>(0,std::min<size_t>(c.offset,line[r.offset].size));
+  r.line   = std::min<size_t>(c.line,lineCount()-1);
+  r.offset = std::min<size_t>(c.offset,lineSize(r.line));
   return r;
   }
 
 size_t TextModel::cursorCast(Cursor c) const {
-  if(line.size()==0)
+  if(lineCount()==0)
     return 0;
-  size_t r=std::distance(txt.data(),line[c.line].txt);
-  return r+c.offset;
+  return lineStart(std::min(c.line,lineCount()-1))+c.offset;
   }
 
 TextModel::Cursor TextModel::cursorCast(size_t c) const {
   Cursor cx;
-  for(size_t i=0;i<line.size();++i) {
-    size_t b = std::distance(txt.data(),line[i].txt);
-
-    if(b<=c && c<=b+line[i].size) {
-      cx.line   = i;
-      cx.offset = c-b;
-      return cx;
-      }
-    }
+  if(lineCount()==0 || c>size())
+    return cx;
+  cx.line   = lineOf(c);
+  cx.offset = c-lineStart(cx.line);
   return cx;
   }
 
 void TextModel::drawCursor(Painter& p, int x, int y,TextModel::Cursor c) const {
   if(!isValid(c) &&
-     !(txt.size()==0 && c.line==0 && c.offset==0))
+     !(!init && c.line==0 && c.offset==0))
     return;
 
   auto pos = mapToCoords(c)+Point(x,y);
@@ -457,7 +640,7 @@ void TextModel::drawCursor(Painter &p, int x, int y, Cursor s, Cursor e) const {
   if(s.line>e.line)
     std::swap(s,e);
   Cursor s1 = s;
-  s1.offset = line[s.line].size;
+  s1.offset = lineSize(s.line);
 
   int lnH = int(fnt.pixelSize());
   if(s.line!=e.line) {
@@ -470,7 +653,7 @@ void TextModel::drawCursor(Painter &p, int x, int y, Cursor s, Cursor e) const {
     for(size_t ln=s.line+1;ln<e.line;++ln) {
       Cursor cx;
       cx.line   = ln;
-      cx.offset = line[ln].size;
+      cx.offset = lineSize(ln);
       auto posLn = mapToCoords(cx);
       p.drawRect(x,y+posLn.y,posLn.x,lnH);
       }
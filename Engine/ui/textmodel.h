@@ -139,22 +139,63 @@ class TextModel final {
       bool actual=false;
       };
 
-    struct Line {
-      const char* txt =nullptr;
-      size_t      size=0;
+    // document is a piece table over immutable original text and append-only edit buffer
+    enum BufferId : uint8_t {
+      Original = 0,
+      Append   = 1,
+      };
+
+    struct Buffer {
+      std::string         data;
+      std::vector<size_t> nl; // offsets of '\n' in data
+      };
+
+    struct Piece {
+      BufferId buf   = Original;
+      size_t   start = 0;
+      size_t   len   = 0;
+      size_t   nl    = 0;
+      };
+
+    enum {
+      MaxPieces = 4096,
       };
 
     size_t      cursorCast(Cursor c) const;
     Cursor      cursorCast(size_t c) const;
 
     void        calcSize() const;
-    Sz          calcSize(const Font& fnt) const;
-    void        buildIndex();
 
-    mutable Sz        sz;
-    std::vector<char> txt;
-    std::vector<Line> line;
-    Tempest::Font     fnt;
+    size_t      lineCount() const;
+    size_t      lineOf   (size_t at) const;
+    size_t      lineStart(size_t ln) const;
+    size_t      lineSize (size_t ln) const;
+    const char* lineView (size_t ln, size_t& len, std::string& tmp) const;
+    size_t      findPiece(size_t at) const;
+    char        byteAt   (size_t at) const;
+    void        copy     (size_t s, size_t e, char* out) const;
+
+    void        implSetText(const char* text, size_t len);
+    void        implInsert (size_t at, const char* text, size_t len);
+    void        implErase  (size_t s, size_t e);
+    size_t      implSplit  (size_t at);
+    void        implIndex  ();
+    void        implCompact();
+    size_t      countNl    (BufferId b, size_t s, size_t len) const;
+
+    mutable Sz                 sz;
+    bool                       init = false;
+    Buffer                     buf[2];
+    std::vector<Piece>         piece;
+    // prefix sums of piece length and newline count; size is piece.size()+1
+    std::vector<size_t>        pOff  = {0};
+    std::vector<size_t>        pLine = {0};
+
+    // advance of each line, negative if not measured yet
+    mutable std::vector<float> lineW;
+    mutable std::string        cstr;
+    mutable bool               cstrActual = false;
+    Tempest::Font              fnt;
   };
 
 }
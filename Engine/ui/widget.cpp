@@ -4,6 +4,7 @@
 #include <Tempest/Application>
 #include <Tempest/UiOverlay>
 #include <Tempest/Window>
+#include <Tempest/VectorImage>
 
 using namespace Tempest;
 
@@ -100,7 +101,54 @@ void Widget::setLayout(Layout *l) {
   }
 
 void Widget::applyLayout() {
-  lay->applyLayout();
+  Widget* root = this;
+  while(root->ow!=nullptr)
+    root = root->ow;
+  if(!root->astate.deferLayout) {
+    lay->applyLayout();
+    return;
+    }
+  astate.layoutDirty = true;
+  implMarkLayout();
+  }
+
+void Widget::setDeferredLayout(bool d) {
+  if(astate.deferLayout==d)
+    return;
+  astate.deferLayout = d;
+  if(!d)
+    flushLayout();
+  }
+
+void Widget::flushLayout() {
+  // layout of a child may invalidate its owner again, i.e. with new size hint
+  static const int maxPasses=8;
+  for(int i=0; i<maxPasses; ++i) {
+    if(!astate.layoutDirty && !astate.layoutChild)
+      return;
+    implFlushLayout();
+    }
+  }
+
+void Widget::implFlushLayout() {
+  if(astate.layoutDirty) {
+    astate.layoutDirty = false;
+    lay->applyLayout();
+    }
+  if(!astate.layoutChild)
+    return;
+  astate.layoutChild = false;
+  Widget::Iterator it(this);
+  for(;it.hasNext();it.next()) {
+    Widget& wx=*it.get();
+    if(wx.astate.layoutDirty || wx.astate.layoutChild)
+      wx.implFlushLayout();
+    }
+  }
+
+void Widget::implMarkLayout() noexcept {
+  for(Widget* w=ow; w!=nullptr && !w->astate.layoutChild; w=w->ow)
+    w->astate.layoutChild = true;
   }
 
 void Widget::removeAllWidgets() {
@@ -153,9 +201,55 @@ void Widget::paintNested(PaintEvent& e) {
       continue;
 
     PaintEvent ex(e,wx.x(),wx.y(),sc.x,sc.y,sc.w,sc.h);
+    const bool dirty = wx.astate.needToUpdate;
     wx.astate.needToUpdate = false;
-    wx.dispatchPaintEvent(ex);
+    if(ex.cache==nullptr) {
+      wx.dispatchPaintEvent(ex);
+      continue;
+      }
+    wx.implPaintCached(ex,dirty);
+    if(it.getLast()!=&wx)
+      continue; // widget is removed, while painting
+    wx.paintRec.end = ex.cache->dst->vertexCount();
+    }
+  }
+
+void Widget::implPaintCached(PaintEvent& e, bool dirty) {
+  Detail::PaintCache& c   = *e.cache;
+  PaintRecord&        r   = paintRec;
+  const size_t        at  = c.dst->vertexCount();
+
+  if(!dirty && c.prevFrame!=0 && r.frame==c.prevFrame && r.orign==e.orign() && r.viewPort==e.viewPort() &&
+     r.w==e.w() && r.h==e.h()) {
+    // nothing changed in this subtree: splice geometry of previous frame
+    c.dst->append(*c.prev,r.begin,r.end);
+    implMovePaintRecord(c.prevFrame,c.frame,r.begin,at);
+    return;
     }
+
+  r.frame    = c.frame;
+  r.begin    = at;
+  r.orign    = e.orign();
+  r.viewPort = e.viewPort();
+  r.w        = e.w();
+  r.h        = e.h();
+  dispatchPaintEvent(e);
+  }
+
+void Widget::implInvalidatePaint() noexcept {
+  paintRec.frame = 0;
+  for(auto w:wx)
+    w->implInvalidatePaint();
+  }
+
+void Widget::implMovePaintRecord(uint64_t prevFrame, uint64_t frame, size_t from, size_t to) noexcept {
+  if(paintRec.frame!=prevFrame)
+    return;
+  paintRec.frame  = frame;
+  paintRec.begin  = paintRec.begin - from + to;
+  paintRec.end    = paintRec.end   - from + to;
+  for(auto w:wx)
+    w->implMovePaintRecord(prevFrame,frame,from,to);
   }
 
 void Widget::dispatchPolishEvent(PolishEvent& e) {
@@ -226,7 +320,11 @@ Widget& Widget::implAddWidget(Widget *w,size_t at) {
     astate.focus = w;
   if(astate.disable>0)
     implDisableSum(w,astate.disable);
-  lay->applyLayout();
+  if(w->astate.layoutDirty || w->astate.layoutChild) {
+    astate.layoutChild = true;
+    implMarkLayout();
+    }
+  applyLayout();
   update();
   return *w;
   }
@@ -292,7 +390,7 @@ void Widget::setGeometry(const Rect &rect) {
   update();
 
   if(resize) {
-    lay->applyLayout();
+    applyLayout();
     SizeEvent e(uint32_t(rect.w),uint32_t(rect.h));
     resizeEvent( e );
     }
@@ -312,7 +410,7 @@ void Widget::resize(int w, int h) {
   wrect.w=w;
   wrect.h=h;
 
-  lay->applyLayout();
+  applyLayout();
   SizeEvent e(w,h);
   resizeEvent( e );
   }
@@ -322,7 +420,7 @@ void Widget::setSizeHint(const Size &s) {
     return;
   szHint=s;
   if(ow!=nullptr)
-    ow->lay->applyLayout();
+    ow->applyLayout();
   }
 
 void Widget::setSizeHint(const Size &s, const Margin &add) {
@@ -331,6 +429,7 @@ void Widget::setSizeHint(const Size &s, const Margin &add) {
 
 void Widget::setWidgetState(const WidgetState& st) {
   wstate = st;
+  update();
   }
 
 void Widget::setSizePolicy(SizePolicyType hv) {
@@ -344,7 +443,7 @@ void Widget::setSizePolicy(SizePolicyType h, SizePolicyType v) {
   szPolicy.typeV=v;
 
   if(ow!=nullptr)
-    ow->lay->applyLayout();
+    ow->applyLayout();
   }
 
 void Widget::setSizePolicy(const SizePolicy &sp) {
@@ -352,7 +451,7 @@ void Widget::setSizePolicy(const SizePolicy &sp) {
     return;
   szPolicy=sp;
   if(ow!=nullptr)
-    ow->lay->applyLayout();
+    ow->applyLayout();
   }
 
 void Widget::setFocusPolicy(FocusPolicy f) {
@@ -362,14 +461,14 @@ void Widget::setFocusPolicy(FocusPolicy f) {
 void Widget::setMargins(const Margin &m) {
   if(marg!=m){
     marg=m;
-    lay->applyLayout();
+    applyLayout();
     }
   }
 
 void Widget::setSpacing(int s) {
   if(s!=spa){
     spa=s;
-    lay->applyLayout();
+    applyLayout();
     }
   }
 
@@ -421,6 +520,8 @@ void Widget::setEnabled(bool e) {
     wstate.disabled=false;
     implDisableSum(this,-1);
     }
+  // children are drawn as disabled too
+  implInvalidatePaint();
   update();
   }
 
@@ -529,6 +630,7 @@ void Widget::implClearFocus(Widget *wx, Widget* Additive::*add, bool WidgetState
     if(w->wstate.*flag){
       FocusEvent e(false,Event::FocusReason::UnknownReason);
       w->wstate.*flag=false;
+      w->update();
       w->focusEvent(e);
       }
     return;
@@ -593,6 +695,9 @@ void Widget::setStyle(const Style* s) {
     PolishEvent e;
     dispatchPolishEvent(e);
     }
+  // style is inherited by children
+  implInvalidatePaint();
+  update();
   }
 
 const Style& Widget::style() const {
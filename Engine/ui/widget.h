@@ -33,6 +33,11 @@ class Widget {
     void setLayout(Layout* lay);
     const Layout& layout() const { return *lay; }
     void  applyLayout();
+    // postpone layout of this tree, until flushLayout; applies to top-level widgets only.
+    // Window uses deferred layout and flushes it once per frame, before painting
+    void  setDeferredLayout(bool d);
+    bool  isDeferredLayout() const { return astate.deferLayout; }
+    void  flushLayout();
 
     size_t        widgetsCount() const   { return wx.size(); }
     Widget&       widget(size_t i)       { return *wx[i]; }
@@ -179,6 +184,20 @@ class Widget {
       Widget*  focus        = nullptr;
       uint16_t disable      = 0;
       bool     needToUpdate = false;
+      bool     deferLayout  = false;
+      bool     layoutDirty  = false;
+      bool     layoutChild  = false;
+      };
+
+    // where output of this widget and it's children is located, in cached frame
+    struct PaintRecord {
+      uint64_t      frame = 0;
+      size_t        begin = 0;
+      size_t        end   = 0;
+      Point         orign;
+      Rect          viewPort;
+      uint32_t      w = 0;
+      uint32_t      h = 0;
       };
 
     Widget*                 ow=nullptr;
@@ -193,6 +212,7 @@ class Widget {
 
     Additive                astate;
     WidgetState             wstate;
+    PaintRecord             paintRec;
 
     static std::recursive_mutex syncSCuts;
     std::vector<Shortcut*>  sCuts;
@@ -219,6 +239,12 @@ class Widget {
     void                    implAttachFocus();
 
     void                    dispatchPolishEvent(PolishEvent& e);
+    void                    implFlushLayout();
+    void                    implMarkLayout() noexcept;
+    void                    implPaintCached(Tempest::PaintEvent& e, bool dirty);
+    void                    implMovePaintRecord(uint64_t prevFrame, uint64_t frame, size_t from, size_t to) noexcept;
+    // drops cached geometry of subtree, see Window::setPaintCache
+    void                    implInvalidatePaint() noexcept;
 
     auto                    selfReference() -> const std::shared_ptr<Ref>&;
     void                    setOwner(Widget* w);
@@ -3,9 +3,14 @@
 #include <Tempest/VectorImage>
 #include <Tempest/Except>
 
+#include <atomic>
+
 using namespace Tempest;
 
+static std::atomic<uint64_t> paintFrameId{0};
+
 Window::Window() {
+  setDeferredLayout(true);
   id = Tempest::SystemApi::createWindow(this,800,600);
   if(id==nullptr)
     throw std::system_error(Tempest::SystemErrc::UnableToCreateWindow);
@@ -15,6 +20,7 @@ Window::Window() {
   }
 
 Window::Window(Window::ShowMode sm) {
+  setDeferredLayout(true);
   id = Tempest::SystemApi::createWindow(this,SystemApi::ShowMode(sm));
   if(id==nullptr)
     throw std::system_error(Tempest::SystemErrc::UnableToCreateWindow);
@@ -35,15 +41,40 @@ void Window::render() {
   }
 
 void Window::dispatchPaintEvent(VectorImage &surface,TextureAtlas& ta) {
+  flushLayout();
   surface.clear();
 
+  Detail::PaintCache cache;
+  cache.dst       = &surface;
+  cache.prev      = paintCache.get();
+  cache.prevFrame = paintFrame;
+  cache.frame     = ++paintFrameId;
+
   PaintEvent p(surface,ta,this->w(),this->h());
+  if(paintCache!=nullptr)
+    p.cache = &cache;
   this->astate.needToUpdate = false;
   Widget::dispatchPaintEvent(p);
 
+  if(paintCache!=nullptr) {
+    *paintCache = surface;
+    paintFrame  = cache.frame;
+    }
+
+  // overlays are not cached
+  p.cache = nullptr;
   SystemApi::dispatchOverlayRender(*this,p);
   }
 
+void Window::setPaintCache(bool enable) {
+  if(enable==isPaintCache())
+    return;
+  if(enable)
+    paintCache.reset(new VectorImage()); else
+    paintCache.reset();
+  paintFrame = 0;
+  }
+
 void Window::closeEvent(CloseEvent& e) {
   e.ignore();
   }
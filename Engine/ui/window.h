@@ -3,6 +3,8 @@
 #include <Tempest/SystemApi>
 #include <Tempest/Widget>
 
+#include <memory>
+
 namespace Tempest {
 
 class VectorImage;
@@ -23,6 +25,11 @@ class Window : public Widget {
 
     void setWindowTitle(const char* utf8);
 
+    // reuse geometry of widgets, that are not updated since last frame; off by default.
+    // With cache enabled, widgets must call update(), whenever their look changes
+    void setPaintCache(bool enable);
+    bool isPaintCache() const { return paintCache!=nullptr; }
+
   protected:
     virtual void render();
     using        Widget::dispatchPaintEvent;
@@ -39,6 +46,10 @@ class Window : public Widget {
 
     SystemApi::Window* id=nullptr;
 
+    // widget geometry of last frame, see Widget::paintNested
+    std::unique_ptr<VectorImage> paintCache;
+    uint64_t                     paintFrame = 0;
+
   friend class Widget;
   friend class UiOverlay;
   friend class EventDispatcher;
@@ -12,67 +12,355 @@
 #endif
 
 #include <iostream>
+#include <condition_variable>
 #include <cstdio>
 #include <cstring>
+#include <vector>
 
 using namespace Tempest;
 
+namespace {
+// single producer/single consumer byte ring; records are: header + zero-terminated text, never wrapped
+struct LogRing {
+  enum : uint32_t {
+    Capacity = 64*1024,
+    Skip     = 0xFFFF,
+    };
+  struct Header {
+    uint16_t len;
+    uint8_t  mode;
+    uint8_t  padd;
+    };
+
+  alignas(64) std::atomic<size_t> head{0};
+  alignas(64) std::atomic<size_t> tail{0};
+  std::atomic_bool                closed{false};
+  alignas(Header) uint8_t         data[Capacity];
+
+  static size_t recordSize(size_t len) {
+    return (sizeof(Header)+len+sizeof(Header)-1) & ~(sizeof(Header)-1);
+    }
+
+  bool push(Log::Mode mode, const char* text, size_t len) {
+    const size_t rec  = recordSize(len+1);
+    const size_t h    = head.load(std::memory_order_relaxed);
+    const size_t t    = tail.load(std::memory_order_acquire);
+    const size_t off  = h%Capacity;
+    const size_t room = Capacity-off;
+    const size_t need = rec + (room<rec ? room : 0);
+    if(Capacity-(h-t)<need)
+      return false;
+
+    size_t at = h;
+    if(room<rec) {
+      Header skip = {Skip,0,0};
+      std::memcpy(data+off,&skip,sizeof(skip));
+      at += room;
+      }
+    Header hdr = {uint16_t(len),uint8_t(mode),0};
+    uint8_t* dst = data+at%Capacity;
+    std::memcpy(dst,&hdr,sizeof(hdr));
+    std::memcpy(dst+sizeof(hdr),text,len);
+    dst[sizeof(hdr)+len] = '\0';
+    head.store(at+rec,std::memory_order_release);
+    return true;
+    }
+
+  template<class Fn>
+  bool drain(Fn fn) {
+    size_t       t = tail.load(std::memory_order_relaxed);
+    const size_t h = head.load(std::memory_order_acquire);
+    if(t==h)
+      return false;
+    while(t!=h) {
+      const size_t off = t%Capacity;
+      Header hdr;
+      std::memcpy(&hdr,data+off,sizeof(hdr));
+      if(hdr.len==Skip) {
+        t += Capacity-off;
+        continue;
+        }
+      fn(Log::Mode(hdr.mode),reinterpret_cast<const char*>(data+off+sizeof(hdr)),size_t(hdr.len));
+      t += recordSize(size_t(hdr.len)+1);
+      }
+    tail.store(t,std::memory_order_release);
+    return true;
+    }
+
+  bool isEmpty() const {
+    return tail.load(std::memory_order_acquire)==head.load(std::memory_order_acquire);
+    }
+  };
+
+struct LocalRing {
+  ~LocalRing() {
+    if(ring!=nullptr)
+      ring->closed.store(true);
+    }
+  std::shared_ptr<LogRing> ring;
+  };
+}
+
+struct Log::AsyncWriter {
+  std::mutex                            sync;
+  std::condition_variable               wake, done;
+  std::vector<std::shared_ptr<LogRing>> rings;
+  std::thread                           th;
+  bool                                  exit     = false;
+  bool                                  running  = false;
+  uint64_t                              request  = 0;
+  uint64_t                              complete = 0;
+
+  std::atomic_bool                      idle{false};
+  std::atomic<uint64_t>                 dropped{0};
+  uint64_t                              reported = 0;
+
+  std::string                           out, err;
+
+  ~AsyncWriter() { stop(); }
+
+  void start() {
+    std::lock_guard<std::mutex> guard(sync);
+    if(th.joinable())
+      return;
+    exit    = false;
+    running = true;
+    th      = std::thread([this](){ loop(); });
+    }
+
+  void stop() {
+    {
+    std::lock_guard<std::mutex> guard(sync);
+    exit = true;
+    }
+    wake.notify_one();
+    if(th.joinable())
+      th.join();
+    }
+
+  LogRing& local() {
+    static thread_local LocalRing l;
+    if(l.ring==nullptr) {
+      l.ring = std::make_shared<LogRing>();
+      std::lock_guard<std::mutex> guard(sync);
+      rings.push_back(l.ring);
+      }
+    return *l.ring;
+    }
+
+  void push(Log::Mode mode, const char* text, size_t len) {
+    if(!local().push(mode,text,len)) {
+      dropped.fetch_add(1,std::memory_order_relaxed);
+      return;
+      }
+    if(idle.load(std::memory_order_relaxed) && idle.exchange(false))
+      wake.notify_one();
+    }
+
+  void loop() {
+    std::vector<std::shared_ptr<LogRing>> rs;
+    std::unique_lock<std::mutex> lck(sync);
+    while(true) {
+      const uint64_t req  = request;
+      const bool     quit = exit;
+      rs = rings;
+      lck.unlock();
+
+      bool any = drainAll(rs);
+
+      lck.lock();
+      for(size_t i=0; i<rings.size();) {
+        if(rings[i]->closed.load() && rings[i]->isEmpty()) {
+          rings[i] = std::move(rings.back());
+          rings.pop_back();
+          } else {
+          ++i;
+          }
+        }
+      // everything, queued before 'req' was issued, is written by now
+      complete = req;
+      done.notify_all();
+      if(!any) {
+        if(quit) {
+          // sync, issued after this point, has nothing to wait for
+          running  = false;
+          complete = request;
+          done.notify_all();
+          break;
+          }
+        idle.store(true);
+        wake.wait_for(lck,std::chrono::milliseconds(10));
+        idle.store(false);
+        }
+      }
+    }
+
+  bool drainAll(const std::vector<std::shared_ptr<LogRing>>& rs) {
+    std::lock_guard<std::recursive_mutex> g(globals().sync);
+    auto& outFn = globals().outFn;
+    bool  any   = false;
+    for(auto& r:rs) {
+      any |= r->drain([&](Log::Mode mode, const char* text, size_t len) {
+        sink(mode,text,len);
+        if(outFn)
+          outFn(mode,text);
+        });
+      }
+
+    const uint64_t drop = dropped.load(std::memory_order_relaxed);
+    if(drop!=reported) {
+      char msg[64] = {};
+      int  len     = snprintf(msg,sizeof(msg),"log: %llu message(s) dropped",(unsigned long long)(drop-reported));
+      reported = drop;
+      sink(Log::Error,msg,size_t(len));
+      if(outFn)
+        outFn(Log::Error,msg);
+      }
+    flushSink();
+    return any;
+    }
+
+  void sink(Log::Mode mode, const char* text, size_t len) {
+#if defined(__ANDROID__) || (defined(_MSC_VER) && !defined(_NDEBUG))
+    (void)len;
+    Log::sink(mode,text);
+#else
+    auto& dst = (mode==Log::Error ? err : out);
+    dst.append(text,len);
+    dst.push_back('\n');
+#endif
+    }
+
+  void flushSink() {
+    if(!out.empty()) {
+      std::cout.write(out.data(),std::streamsize(out.size()));
+      std::cout.flush();
+      out.clear();
+      }
+    if(!err.empty()) {
+      std::cerr.write(err.data(),std::streamsize(err.size()));
+      std::cerr.flush();
+      err.clear();
+      }
+    }
+
+  void wait() {
+    std::unique_lock<std::mutex> lck(sync);
+    if(!running)
+      return;
+    // sync from output callback: would wait for itself; messages, logged by callback, are written on next round
+    if(th.get_id()==std::this_thread::get_id())
+      return;
+    const uint64_t req = ++request;
+    wake.notify_one();
+    done.wait(lck,[&](){ return complete>=req; });
+    }
+  };
+
+Log::Globals::~Globals() {
+  async.store(nullptr);
+  writer.reset();
+  }
+
 void Log::setOutputCallback(std::function<void (Mode, const char*)> f) {
   std::lock_guard<std::recursive_mutex> g(globals().sync);
   globals().outFn = f;
   }
 
+void Log::setAsync(bool a) {
+  auto& g = globals();
+  std::lock_guard<std::mutex> guard(g.asyncSync);
+  if(a) {
+    // writer is never released before exit: producers may still hold a pointer to it
+    if(g.writer==nullptr)
+      g.writer.reset(new AsyncWriter());
+    g.writer->start();
+    g.async.store(g.writer.get());
+    } else {
+    g.async.store(nullptr);
+    if(g.writer!=nullptr)
+      g.writer->stop();
+    }
+  }
+
+bool Log::isAsync() {
+  return globals().async.load()!=nullptr;
+  }
+
+void Log::sync() {
+  auto&        g = globals();
+  AsyncWriter* w = nullptr;
+  {
+  // not held while waiting: output callback may call sync as well
+  std::lock_guard<std::mutex> guard(g.asyncSync);
+  w = g.writer.get();
+  }
+  if(w!=nullptr)
+    w->wait();
+  }
+
+uint64_t Log::droppedCount() {
+  auto& g = globals();
+  std::lock_guard<std::mutex> guard(g.asyncSync);
+  if(g.writer==nullptr)
+    return 0;
+  return g.writer->dropped.load();
+  }
+
 Log::Globals& Log::globals() {
   static Globals g;
   return g;
   }
 
-void Log::flush(Context& ctx, char *&out, size_t &count) {
-  if(count==sizeof(ctx.buffer))
-    return;
-
-  std::lock_guard<std::recursive_mutex> g(globals().sync);
-  {
-    *out = '\0';
+void Log::sink(Mode mode, const char* text) {
 #ifdef __ANDROID__
-    switch(ctx.mode) {
-      case Error:
-        __android_log_print(ANDROID_LOG_ERROR, "app", "%s", ctx.buffer);
-        break;
-      case Debug:
-        __android_log_print(ANDROID_LOG_DEBUG, "app", "%s", ctx.buffer);
-        break;
-      case Info:
-      default:
-        __android_log_print(ANDROID_LOG_INFO,  "app", "%s", ctx.buffer);
-        break;
-      }
+  switch(mode) {
+    case Error:
+      __android_log_print(ANDROID_LOG_ERROR, "app", "%s", text);
+      break;
+    case Debug:
+      __android_log_print(ANDROID_LOG_DEBUG, "app", "%s", text);
+      break;
+    case Info:
+    default:
+      __android_log_print(ANDROID_LOG_INFO,  "app", "%s", text);
+      break;
+    }
 #else
 #if defined(_MSC_VER) && !defined(_NDEBUG)
-  (void)ctx;
-  OutputDebugStringA(ctx.buffer);
+  (void)mode;
+  OutputDebugStringA(text);
   OutputDebugStringA("\n");
 #else
-  if(ctx.mode==Error){
-    std::cerr << ctx.buffer << std::endl;
+  if(mode==Error){
+    std::cerr << text << std::endl;
     std::cerr.flush();
     }
     else
-    std::cout << ctx.buffer << std::endl;
+    std::cout << text << std::endl;
 #endif
 #endif
-    }
+  }
 
-  if(globals().outFn) {
-    char cpy[sizeof(ctx.buffer)] = {};
-    std::memcpy(cpy,ctx.buffer,count);
-    out   = ctx.buffer;
-    count = sizeof(ctx.buffer);
-    globals().outFn(ctx.mode,ctx.buffer);
-    } else {
+void Log::flush(Context& ctx, char *&out, size_t &count) {
+  if(count==sizeof(ctx.buffer))
+    return;
+
+  *out = '\0';
+  if(auto w = globals().async.load(std::memory_order_acquire)) {
+    w->push(ctx.mode,ctx.buffer,size_t(out-ctx.buffer));
     out   = ctx.buffer;
     count = sizeof(ctx.buffer);
+    return;
     }
+
+  std::lock_guard<std::recursive_mutex> g(globals().sync);
+  sink(ctx.mode,ctx.buffer);
+
+  out   = ctx.buffer;
+  count = sizeof(ctx.buffer);
+  if(globals().outFn)
+    globals().outFn(ctx.mode,ctx.buffer);
   }
 
 void Log::printImpl(Context& ctx, char* out, size_t count) {
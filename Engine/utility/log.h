@@ -2,6 +2,8 @@
 
 #include <sstream>
 #include <mutex>
+#include <atomic>
+#include <memory>
 #include <cstdint>
 #include <thread>
 #include <type_traits>
@@ -40,15 +42,32 @@ class Log final {
 
     static void setOutputCallback(std::function<void(Mode mode, const char* text)> f);
 
+    // async mode: messages are queued into per-thread buffers and written in batches by a background thread.
+    // Output callback is called from that thread; order is preserved only for messages of the same thread.
+    // Callback may log, but must not call setAsync
+    static void     setAsync(bool async);
+    static bool     isAsync();
+    // blocks until queued messages are written; no-op, if called from output callback
+    static void     sync();
+    // messages lost in async mode, due to full per-thread buffer
+    static uint64_t droppedCount();
+
   private:
     struct Context {
       Mode mode;
       char buffer[256];
       };
 
+    struct AsyncWriter;
+
     struct Globals {
+      ~Globals();
       std::function<void(Log::Mode, const char*)> outFn;
       std::recursive_mutex                        sync;
+
+      std::mutex                                  asyncSync;
+      std::unique_ptr<AsyncWriter>                writer;
+      std::atomic<AsyncWriter*>                   async{nullptr};
       };
 
     Log() = delete;
@@ -56,6 +75,7 @@ class Log final {
     static Globals& globals();
 
     static void flush(Context& ctx, char*& msg, size_t& count);
+    static void sink (Mode mode, const char* text);
     static void write(Context& ctx, char*& out, size_t& count, const std::string& msg);
     static void write(Context& ctx, char*& out, size_t& count, std::string_view   msg);
     static void write(Context& ctx, char*& out, size_t& count, const char*        msg);
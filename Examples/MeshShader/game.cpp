@@ -5,21 +5,32 @@
 #include <Tempest/Button>
 #include <Tempest/Painter>
 #include <Tempest/Panel>
+#include <Tempest/Log>
+#include <Tempest/SystemApi>
 
 #include "mesh.h"
 #include "shader.h"
 
 using namespace Tempest;
 
-Game::Game(Device& device)
+Game::Game(Device& device, bool benchmark)
   : Window(Maximized), device(device), swapchain(device,hwnd()), texAtlass(device) {
   for(uint8_t i=0;i<MaxFramesInFlight;++i)
     fence.emplace_back(device.fence());
   resetSwapchain();
   setupUi();
 
+  bench.enabled = benchmark;
+  if(bench.enabled) {
+    try {
+      device.setProfiling(ProfilingFlags::Timestamps,[this](const GpuFrame& f){ onGpuFrame(f); });
+      }
+    catch(const std::system_error&) {
+      Log::i("bench: gpu timestamps are not supported, only cpu frame time is measured");
+      }
+    }
   onAsset(0);
-  onShaderType(useVertex ? 1 : 0);
+  onShaderType(shaderType);
   }
 
 Game::~Game() {
@@ -31,8 +42,8 @@ void Game::setupUi() {
   p.setDragable(true);
 
   auto& cbShader = p.addWidget(new ComboBox());
-  cbShader.setItems({"Mesh shader", "Vertex shader"});
-  cbShader.setCurrentIndex(useVertex ? 1 : 0);
+  cbShader.setItems({"Mesh shader", "Vertex shader", "Mesh shader (no task)"});
+  cbShader.setCurrentIndex(shaderType);
   cbShader.onItemSelected.bind(this, &Game::onShaderType);
 
   auto& cbObj = p.addWidget(new ComboBox());
@@ -119,7 +130,8 @@ void Game::render(){
     push.meshletCount = mesh.meshletCount;
 
     {
-      auto enc = cmd.startEncoding(device);
+      auto enc  = cmd.startEncoding(device);
+      auto zone = enc.zone("frame");
       enc.setFramebuffer({{swapchain[swapchain.currentImage()],Vec4(0),Tempest::Preserve}}, {zbuffer, 1.f, Tempest::Preserve});
       enc.setUniforms(pso,desc,&push,sizeof(push));
 
@@ -132,9 +144,13 @@ void Game::render(){
         }
       enc.setViewport(256,0,256,256);
       */
-      if(useVertex) {
+      if(shaderType==Vertex) {
         enc.draw(mesh.vbo, mesh.ibo);
-        } else {
+        }
+      else if(shaderType==MeshNoTask) {
+        enc.dispatchMesh(mesh.meshletCount);
+        }
+      else {
         enc.dispatchMeshThreads(mesh.meshletCount);
         }
 
@@ -153,6 +169,8 @@ void Game::render(){
     for(auto i:frameTime)
       tx += i;
     setWindowTitle(("FPS = " + std::to_string((1000.f*std::extent<decltype(frameTime)>())/std::max<float>(1, tx))).c_str());
+    if(bench.enabled)
+      benchmarkStep(t-time);
     time = t;
     }
   catch(const Tempest::SwapchainSuboptimal&) {
@@ -168,20 +186,28 @@ void Game::resetSwapchain() {
 
 void Game::onShaderType(size_t type) {
   device.waitIdle();
-  useVertex = bool(type!=0);
+  shaderType = ShaderType(type);
 
   RenderState rs;
   rs.setCullFaceMode(RenderState::CullMode::NoCull);
   rs.setZTestMode(RenderState::ZTestMode::Less);
 
-  if(useVertex) {
+  if(shaderType==Vertex) {
     auto sh   = AppShader::get("shader.vert.sprv");
     auto vert = device.shader(sh.data, sh.len);
     sh        = AppShader::get("shader.frag.sprv");
     auto frag = device.shader(sh.data, sh.len);
 
     pso = device.pipeline(Topology::Triangles, rs, vert, frag);
-    } else {
+    }
+  else if(shaderType==MeshNoTask) {
+    auto sh   = AppShader::get("shader_notask.mesh.sprv");
+    auto mesh = device.shader(sh.data, sh.len);
+    sh        = AppShader::get("shader.frag.sprv");
+    auto frag = device.shader(sh.data, sh.len);
+    pso = device.pipeline(rs, Shader(), mesh, frag);
+    }
+  else {
     auto sh   = AppShader::get("shader.task.sprv");
     auto task = device.shader(sh.data, sh.len);
     sh        = AppShader::get("shader.mesh.sprv");
@@ -192,7 +218,7 @@ void Game::onShaderType(size_t type) {
     }
 
   desc = device.descriptors(pso);
-  if(!useVertex) {
+  if(shaderType!=Vertex) {
     desc.set(0, mesh.vbo);
     desc.set(1, mesh.ibo8);
     }
@@ -212,9 +238,54 @@ void Game::onAsset(size_t type) {
       break;
     }
 
-  if(!useVertex && !desc.isEmpty()) {
+  if(shaderType!=Vertex && !desc.isEmpty()) {
     desc.set(0, mesh.vbo);
     desc.set(1, mesh.ibo8);
     }
   }
 
+
+void Game::benchmarkStep(uint64_t dt) {
+  static const char* names[] = {"mesh+task", "vertex", "mesh"};
+
+  bench.frame++;
+  if(bench.frame<=WarmupFrames)
+    return;
+  bench.time += dt;
+  if(bench.frame<WarmupFrames+MeasureFrames)
+    return;
+
+  const float frameMs = float(bench.time)/float(MeasureFrames);
+  if(bench.gpuFrames>0) {
+    const double gpuMs = double(bench.gpuTime)/double(bench.gpuFrames)/1000000.0;
+    Log::i("bench[", names[shaderType], "]: frame = ", frameMs, " ms; gpu = ", gpuMs, " ms");
+    } else {
+    Log::i("bench[", names[shaderType], "]: frame = ", frameMs, " ms");
+    }
+
+  bench.frame     = 0;
+  bench.time      = 0;
+  bench.gpuTime   = 0;
+  bench.gpuFrames = 0;
+  bench.type++;
+  if(bench.type>=std::extent<decltype(names)>()) {
+    SystemApi::exit();
+    return;
+    }
+  static const ShaderType order[] = {MeshTask, MeshNoTask, Vertex};
+  onShaderType(order[bench.type]);
+  }
+
+void Game::onGpuFrame(const GpuFrame& f) {
+  // frames are resolved with latency; results, that belong to warmup or previous pipeline are dropped
+  if(f.zones.empty() || bench.frame<=WarmupFrames)
+    return;
+  // span of all zones: includes engine internal passes, such as mesh-shader emulation
+  uint64_t begin = f.zones[0].begin, end = f.zones[0].end;
+  for(auto& z:f.zones) {
+    begin = std::min(begin, z.begin);
+    end   = std::max(end,   z.end);
+    }
+  bench.gpuTime += end-begin;
+  bench.gpuFrames++;
+  }
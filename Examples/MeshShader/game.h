@@ -17,13 +17,19 @@
 
 class Game : public Tempest::Window {
   public:
-  Game(Tempest::Device& device);
+  Game(Tempest::Device& device, bool benchmark = false);
   ~Game();
 
   enum {
     MaxFramesInFlight = 2
     };
 
+  enum ShaderType : uint8_t {
+    MeshTask   = 0,
+    Vertex     = 1,
+    MeshNoTask = 2,
+    };
+
   private:
   void resizeEvent(Tempest::SizeEvent& event) override;
   void mouseWheelEvent(Tempest::MouseEvent& event) override;
@@ -37,6 +43,8 @@ class Game : public Tempest::Window {
 
   void onShaderType(size_t type);
   void onAsset(size_t type);
+  void benchmarkStep(uint64_t dt);
+  void onGpuFrame(const Tempest::GpuFrame& f);
 
   Tempest::Matrix4x4 projMatrix() const;
   Tempest::Matrix4x4 viewMatrix() const;
@@ -53,7 +61,7 @@ class Game : public Tempest::Window {
   Tempest::RenderPipeline     pso;
   Tempest::DescriptorSet      desc;
   Mesh                        mesh;
-  bool                        useVertex = false;
+  ShaderType                  shaderType = MeshTask;
 
   Tempest::CommandBuffer      commands[MaxFramesInFlight];
   std::vector<Tempest::Fence> fence;
@@ -65,4 +73,19 @@ class Game : public Tempest::Window {
 
   float                       frameTime[10] = {};
   uint32_t                    fpsId = 0;
+
+  enum {
+    WarmupFrames  = 60,
+    MeasureFrames = 500,
+    };
+
+  struct Benchmark {
+    bool                      enabled   = false;
+    uint8_t                   type      = 0;
+    uint32_t                  frame     = 0;
+    uint64_t                  time      = 0;
+    uint64_t                  gpuTime   = 0; // nanoseconds
+    uint32_t                  gpuFrames = 0;
+    };
+  Benchmark                   bench;
   };
@@ -6,6 +6,8 @@
 #include <Tempest/Device>
 #include <Tempest/Log>
 
+#include <cstring>
+
 #include "game.h"
 
 std::unique_ptr<Tempest::AbstractGraphicsApi> mkApi(const char* av, Tempest::ApiFlags flags) {
@@ -25,10 +27,26 @@ std::unique_ptr<Tempest::AbstractGraphicsApi> mkApi(const char* av, Tempest::Api
 int main(int argc, const char** argv) {
   Tempest::Application app;
 
-  const bool emulated = false;
+  bool emulated  = false;
+  bool deferred  = false;
+  bool benchmark = false;
+  for(int i=1; i<argc; ++i) {
+    if(std::strcmp(argv[i],"-emulated")==0)
+      emulated = true;
+    else if(std::strcmp(argv[i],"-deferred")==0)
+      emulated = deferred = true;
+    else if(std::strcmp(argv[i],"-bench")==0)
+      benchmark = true;
+    }
+
+  auto flags = benchmark ? Tempest::ApiFlags::NoFlags : Tempest::ApiFlags::Validation;
+  if(emulated)
+    flags = flags | Tempest::ApiFlags::MeshEmulation;
+  if(deferred)
+    flags = flags | Tempest::ApiFlags::DeferredMeshShading;
 
   const char* msDev = nullptr;
-  auto api = mkApi(argc>1 ? argv[1] : "", Tempest::ApiFlags::Validation);
+  auto api = mkApi(argc>1 ? argv[1] : "", flags);
   auto dev = api->devices();
   for(auto& i:dev)
     if(i.meshlets.meshShader!=emulated && i.meshlets.meshShaderEmulated==emulated) {
@@ -42,12 +60,12 @@ int main(int argc, const char** argv) {
     return 0;
 
   Tempest::Log::i(msDev);
-  Tempest::Log::i(emulated ? "mesh-shader-emulated" : "GL_EXT_mesh_shader");
+  Tempest::Log::i(emulated ? (deferred ? "mesh-shader-emulated (deferred)" : "mesh-shader-emulated") : "GL_EXT_mesh_shader");
 
   app.setFont(Tempest::Application::defaultFont());
 
   Tempest::Device device{*api,msDev};
-  Game            wx(device);
+  Game            wx(device,benchmark);
 
   return app.exec();
   }
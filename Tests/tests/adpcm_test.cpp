@@ -0,0 +1,64 @@
+#include "../sound/adpcm.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+
+#include <random>
+#include <vector>
+
+using namespace testing;
+using namespace Tempest::Detail;
+
+static std::vector<uint8_t> mkAdPcm(size_t blocks, uint16_t blockAlign, uint16_t channels, bool corrupt) {
+  std::mt19937         rng(uint32_t(blocks*31 + blockAlign + channels));
+  std::vector<uint8_t> ret(blocks*blockAlign);
+  for(auto& i:ret)
+    i = uint8_t(rng());
+  for(size_t b=0; b<blocks; ++b) {
+    uint8_t* blk = &ret[b*blockAlign];
+    for(uint16_t ch=0; ch<channels; ++ch) {
+      blk[ch*4+2] = uint8_t(rng()%89);
+      blk[ch*4+3] = 0;
+      }
+    if(corrupt && b%7==3)
+      blk[2] = 200;
+    }
+  return ret;
+  }
+
+static std::vector<int16_t> decodeReference(const std::vector<uint8_t>& src, size_t blocks, uint16_t blockAlign, uint16_t channels) {
+  const size_t         stride = size_t(AdPcm::framesPerBlock(blockAlign,channels))*channels;
+  std::vector<int16_t> ret(blocks*stride);
+  for(size_t b=0; b<blocks; ++b)
+    AdPcm::decodeBlock(&ret[b*stride], &src[b*blockAlign], blockAlign, channels);
+  return ret;
+  }
+
+TEST(main,AdPcmFramesPerBlock) {
+  EXPECT_EQ(AdPcm::framesPerBlock(512, 1),  1017u);
+  EXPECT_EQ(AdPcm::framesPerBlock(1024,2),  1017u);
+  EXPECT_EQ(AdPcm::framesPerBlock(2,   1),  0u);
+  EXPECT_EQ(AdPcm::framesPerBlock(512, 3),  0u);
+  }
+
+TEST(main,AdPcmBitExact) {
+  for(uint16_t channels:{1,2}) {
+    for(uint16_t blockAlign:{36, 256, 512, 1024, 2048}) {
+      if(blockAlign<=channels*4)
+        continue;
+      for(size_t blocks:{1, 2, 3, 5, 9, 130}) {
+        for(bool corrupt:{false, true}) {
+          auto src = mkAdPcm(blocks, blockAlign, channels, corrupt);
+          auto ref = decodeReference(src, blocks, blockAlign, channels);
+
+          for(uint32_t threads:{0u, 1u, 3u}) {
+            std::vector<int16_t> dst(ref.size());
+            AdPcm::decodeBlocks(dst.data(), src.data(), blocks, blockAlign, channels, threads);
+            ASSERT_EQ(dst, ref) << "channels=" << channels << " blockAlign=" << blockAlign
+                                << " blocks=" << blocks << " threads=" << threads;
+            }
+          }
+        }
+      }
+    }
+  }
@@ -91,3 +91,123 @@ TEST(main, DeviceAllocatorAlign1) {
   memory.free(p1);
   memory.free(p3);
   }
+
+TEST(main, DeviceAllocatorStats) {
+  using Alloc = DeviceAllocator<TestDevice>;
+  TestDevice device;
+  Alloc      memory(device);
+  memory.setDefaultPageSize(1024);
+
+  auto p1 = memory.alloc(64, 1,0,0, false);
+  auto p2 = memory.alloc(128,1,0,0, false);
+  auto p3 = memory.dedicatedAlloc(4096,1,1,2, false);
+
+  Alloc::Stats st[3] = {};
+  memory.stats(st,3);
+  EXPECT_EQ(st[0].pages,           1u);
+  EXPECT_EQ(st[0].dedicated,       0u);
+  EXPECT_EQ(st[0].allocated,       1024u);
+  EXPECT_EQ(st[0].used,            64u+128u);
+  EXPECT_EQ(st[0].largestFreeBlock,1024u-64u-128u);
+  EXPECT_EQ(st[1].pages,           0u);
+  EXPECT_EQ(st[2].pages,           1u);
+  EXPECT_EQ(st[2].dedicated,       1u);
+  EXPECT_EQ(st[2].used,            4096u);
+  EXPECT_EQ(st[2].largestFreeBlock,0u);
+
+  memory.free(p1);
+  memory.free(p3);
+
+  Alloc::Stats st2[3] = {};
+  memory.stats(st2,3);
+  EXPECT_EQ(st2[0].used,  128u);
+  EXPECT_EQ(st2[2].pages, 0u);
+
+  memory.free(p2);
+  }
+
+TEST(main, DeviceAllocatorCallback) {
+  using Alloc = DeviceAllocator<TestDevice>;
+  TestDevice device;
+  Alloc      memory(device);
+  memory.setDefaultPageSize(1024);
+
+  std::vector<Alloc::Event> ev;
+  memory.setCallback([&](const Alloc::Event& e){ ev.push_back(e); });
+
+  auto p1 = memory.alloc(64,1,0,3, false);
+  auto p2 = memory.alloc(32,1,0,3, false);
+  memory.free(p1);
+  memory.free(p2);
+
+  ASSERT_EQ(ev.size(),6u);
+  EXPECT_EQ(ev[0].type,Alloc::Event::PageAlloc);
+  EXPECT_EQ(ev[0].size,1024u);
+  EXPECT_EQ(ev[0].typeId,3u);
+  EXPECT_EQ(ev[1].type,Alloc::Event::Alloc);
+  EXPECT_EQ(ev[1].size,64u);
+  EXPECT_EQ(ev[2].type,Alloc::Event::Alloc);
+  EXPECT_EQ(ev[3].type,Alloc::Event::Free);
+  EXPECT_EQ(ev[4].type,Alloc::Event::Free);
+  EXPECT_EQ(ev[5].type,Alloc::Event::PageFree);
+  }
+
+TEST(main, DeviceAllocatorBestFit) {
+  TestDevice device;
+  DeviceAllocator<TestDevice> memory(device);
+  memory.setDefaultPageSize(1024);
+
+  auto p1 = memory.alloc(400,1,0,0, false);
+  auto p2 = memory.alloc(700,1,0,0, false);
+  EXPECT_NE(p1.page,p2.page);
+
+  // both pages have room; densest one is used
+  auto p3 = memory.alloc(100,1,0,0, false);
+  EXPECT_EQ(p3.page,p2.page);
+
+  memory.free(p1);
+  memory.free(p2);
+  memory.free(p3);
+  }
+
+TEST(main, DeviceAllocatorDefrag) {
+  using Alloc = DeviceAllocator<TestDevice>;
+  TestDevice device;
+  Alloc      memory(device);
+  memory.setDefaultPageSize(1024);
+
+  auto a = memory.alloc(300,1,0,0, false);
+  auto b = memory.alloc(300,1,0,0, false);
+  auto x = memory.alloc(500,1,0,0, false);
+  ASSERT_EQ(a.page,b.page);
+  ASSERT_NE(x.page,b.page);
+  memory.free(a);
+
+  // densest of sparse pages is kept as destination
+  EXPECT_EQ(memory.beginDefrag(0.7f),1u);
+  EXPECT_TRUE (memory.isEvacuating(b));
+  EXPECT_FALSE(memory.isEvacuating(x));
+
+  auto b2 = memory.relocate(b,b.size,1);
+  ASSERT_NE(b2.page,nullptr);
+  EXPECT_EQ(b2.page,x.page);
+  memory.free(b);
+  memory.endDefrag();
+
+  Alloc::Stats st[1] = {};
+  memory.stats(st,1);
+  EXPECT_EQ(st[0].pages,1u);
+  EXPECT_EQ(st[0].used, 800u);
+
+  // no room left: relocation doesn't create pages
+  auto z = memory.alloc(200,1,0,0, false);
+  auto w = memory.alloc(300,1,0,0, false);
+  EXPECT_EQ(z.page,x.page);
+  EXPECT_NE(w.page,x.page);
+  EXPECT_EQ(memory.relocate(w,w.size,1).page,nullptr);
+
+  memory.free(x);
+  memory.free(b2);
+  memory.free(z);
+  memory.free(w);
+  }
@@ -0,0 +1,202 @@
+#include <Tempest/Archive>
+#include <Tempest/File>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <set>
+
+using namespace testing;
+using namespace Tempest;
+
+namespace {
+
+std::vector<uint8_t> readAll(IDevice& d) {
+  std::vector<uint8_t> ret(d.size());
+  EXPECT_EQ(d.read(ret.data(),ret.size()),ret.size());
+  return ret;
+  }
+
+}
+
+TEST(main,ArchiveIO) {
+  std::vector<uint8_t> text(4096), noise(333);
+  for(size_t i=0; i<text.size(); ++i)
+    text[i] = uint8_t("tempest "[i%8]);
+  for(size_t i=0; i<noise.size(); ++i)
+    noise[i] = uint8_t(i*2654435761u >> 13);
+
+  {
+  ArchiveWriter w;
+  w.add("b/text.txt",  text.data(), text.size());
+  w.add("a\\noise.bin",noise.data(),noise.size(),Archive::Store);
+  w.add("empty",       nullptr,     0);
+  w.add("b/text.txt",  noise.data(),noise.size());
+  EXPECT_EQ(w.count(),4u);
+  w.save("ArchiveIO.pak");
+  }
+
+  Archive a("ArchiveIO.pak");
+  ASSERT_EQ(a.count(),3u);
+  EXPECT_EQ(a.entry(0).name,"a/noise.bin");
+  EXPECT_EQ(a.entry(1).name,"b/text.txt");
+  EXPECT_EQ(a.entry(2).name,"empty");
+  EXPECT_TRUE(a.contains("empty"));
+  EXPECT_FALSE(a.contains("a"));
+  EXPECT_EQ(a.find("missing"),nullptr);
+
+  // duplicate name: last one wins
+  auto f = a.open("b/text.txt");
+  EXPECT_TRUE(f.isOpen());
+  EXPECT_EQ(readAll(f),noise);
+
+  auto n = a.open("a/noise.bin");
+  EXPECT_EQ(a.find("a/noise.bin")->compression,Archive::Store);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(n.data())%16,0u);
+  EXPECT_EQ(n.peek(),noise[0]);
+  EXPECT_EQ(readAll(n),noise);
+
+  auto e = a.open("empty");
+  EXPECT_TRUE(e.isOpen());
+  EXPECT_EQ(e.size(),0u);
+
+  EXPECT_ANY_THROW(a.open("missing"));
+  }
+
+TEST(main,ArchiveCompression) {
+  std::vector<uint8_t> text(1024*64);
+  for(size_t i=0; i<text.size(); ++i)
+    text[i] = uint8_t('a'+i%7);
+
+  {
+  ArchiveWriter w;
+  w.add("text",text.data(),text.size());
+  w.save("ArchiveCompression.pak");
+  }
+
+  Archive a("ArchiveCompression.pak");
+  auto    e = a.find("text");
+  ASSERT_NE(e,nullptr);
+  EXPECT_EQ(e->compression,Archive::Deflate);
+  EXPECT_EQ(e->size,text.size());
+  EXPECT_LT(e->packedSize,text.size()/10);
+
+  auto f = a.open(*e);
+  EXPECT_EQ(readAll(f),text);
+  }
+
+TEST(main,ArchiveDirectory) {
+  ArchiveWriter w;
+  ASSERT_TRUE(w.addDirectory("assets"));
+  EXPECT_FALSE(w.addDirectory("assets/missing"));
+  w.save("ArchiveDirectory.pak");
+
+  Archive a("ArchiveDirectory.pak");
+  EXPECT_TRUE(a.contains("pixmap_io/rgba.png"));
+  EXPECT_TRUE(a.contains("gapi/tst-dxt5.dds"));
+  for(size_t i=0; i<a.count(); ++i) {
+    auto&      e = a.entry(i);
+    MappedFile src("assets/"+std::string(e.name));
+    auto       f = a.open(e);
+    ASSERT_EQ(f.size(),src.size());
+    EXPECT_EQ(std::memcmp(f.data(),src.data(),src.size()),0);
+    }
+  }
+
+TEST(main,ArchiveAsync) {
+  std::vector<std::string> names;
+  {
+  ArchiveWriter w;
+  for(uint32_t i=0; i<256; ++i) {
+    std::string name = "file" + std::to_string(i);
+    std::string data(i*7,char('a'+i%26));
+    w.add(name,data.data(),data.size(),(i%2) ? Archive::Deflate : Archive::Store);
+    names.push_back(name);
+    }
+  w.save("ArchiveAsync.pak");
+  }
+
+  Archive a("ArchiveAsync.pak");
+
+  std::mutex            sync;
+  std::set<std::string> done;
+  std::atomic_int       failed{0};
+  a.readAsync(names,[&](const std::string& name, ArchiveFile& f){
+    const uint32_t i = uint32_t(std::stoul(name.substr(4)));
+    if(!f.isOpen() || f.size()!=i*7 || (f.size()>0 && f.peek()!=char('a'+i%26)))
+      failed++;
+    std::lock_guard<std::mutex> guard(sync);
+    done.insert(name);
+    });
+  a.readAsync("missing",[&](const std::string&, ArchiveFile& f){
+    if(f.isOpen())
+      failed++;
+    std::lock_guard<std::mutex> guard(sync);
+    done.insert("missing");
+    });
+  a.wait();
+
+  EXPECT_EQ(failed.load(),0);
+  EXPECT_EQ(done.size(),names.size()+1);
+  }
+
+TEST(main,ArchiveAsyncError) {
+  {
+  ArchiveWriter w;
+  for(uint32_t i=0; i<16; ++i) {
+    std::string data(64,char('a'+i));
+    w.add("file"+std::to_string(i),data.data(),data.size());
+    }
+  w.save("ArchiveAsyncError.pak");
+  }
+
+  Archive a("ArchiveAsyncError.pak");
+
+  std::vector<std::string> names;
+  for(uint32_t i=0; i<16; ++i)
+    names.push_back("file"+std::to_string(i));
+
+  std::atomic_int done{0};
+  a.readAsync(names,[&](const std::string& name, ArchiveFile&){
+    done++;
+    if(name=="file3")
+      throw std::runtime_error("callback failure");
+    });
+  // error is passed to the caller; workers survive and drain the queue
+  EXPECT_THROW(a.wait(),std::runtime_error);
+  EXPECT_EQ(done.load(),16);
+
+  a.readAsync(names,[&](const std::string&, ArchiveFile& f){
+    if(f.isOpen())
+      done++;
+    });
+  EXPECT_NO_THROW(a.wait());
+  EXPECT_EQ(done.load(),32);
+  }
+
+TEST(main,ArchiveCorruptSize) {
+  std::vector<uint8_t> text(1024*16,uint8_t('t'));
+  {
+  ArchiveWriter w;
+  w.add("text",text.data(),text.size());
+  w.save("ArchiveCorruptSize.pak");
+  }
+
+  std::vector<uint8_t> pak;
+  {
+  RFile f("ArchiveCorruptSize.pak");
+  pak = readAll(f);
+  }
+
+  // header: 16 bytes; entry: offset, packedSize, size
+  const uint64_t size = uint64_t(1) << 60;
+  std::memcpy(&pak[16+16],&size,sizeof(size));
+  {
+  WFile f("ArchiveCorruptSize.pak");
+  f.write(pak.data(),pak.size());
+  }
+
+  EXPECT_ANY_THROW(Archive("ArchiveCorruptSize.pak"));
+  }
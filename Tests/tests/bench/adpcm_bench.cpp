@@ -0,0 +1,62 @@
+#include "../sound/adpcm.h"
+
+#include <Tempest/Log>
+
+#include <gtest/gtest.h>
+
+#include "bench.h"
+
+#include <random>
+#include <vector>
+
+using namespace testing;
+using namespace Tempest;
+using namespace Tempest::Detail;
+using Bench::measure;
+
+namespace {
+
+// ~1 minute of 44kHz audio
+constexpr size_t Frames = 44100*60;
+
+void benchAdPcm(uint16_t blockAlign, uint16_t channels) {
+  const uint32_t spb    = AdPcm::framesPerBlock(blockAlign,channels);
+  const size_t   blocks = (Frames+spb-1)/spb;
+
+  std::mt19937         rng(0);
+  std::vector<uint8_t> src(blocks*blockAlign);
+  for(auto& i:src)
+    i = uint8_t(rng());
+  for(size_t b=0; b<blocks; ++b)
+    for(uint16_t ch=0; ch<channels; ++ch) {
+      src[b*blockAlign+ch*4+2] = uint8_t(rng()%89);
+      src[b*blockAlign+ch*4+3] = 0;
+      }
+
+  std::vector<int16_t> dst(blocks*spb*channels);
+  const size_t stride = size_t(spb)*channels;
+
+  const double scalar = measure([&](){
+    for(size_t b=0; b<blocks; ++b)
+      AdPcm::decodeBlock(&dst[b*stride], &src[b*blockAlign], blockAlign, channels);
+    });
+  const double simd = measure([&](){
+    AdPcm::decodeBlocks(dst.data(), src.data(), blocks, blockAlign, channels, 1);
+    });
+  const double mt = measure([&](){
+    AdPcm::decodeBlocks(dst.data(), src.data(), blocks, blockAlign, channels);
+    });
+
+  const double mb = double(src.size())/(1024.0*1024.0);
+  Log::i("adpcm ", channels, "ch, block ", blockAlign, ": scalar = ", mb*1000.0/scalar, " MB/s; ",
+         "simd = ", mb*1000.0/simd, " MB/s; simd+threads = ", mb*1000.0/mt, " MB/s");
+  }
+
+}
+
+TEST(bench,AdPcmDecode) {
+  benchAdPcm(512,  1);
+  benchAdPcm(2048, 1);
+  benchAdPcm(1024, 2);
+  benchAdPcm(2048, 2);
+  }
@@ -0,0 +1,96 @@
+#include <Tempest/Archive>
+#include <Tempest/File>
+#include <Tempest/Log>
+
+#include <gtest/gtest.h>
+
+#include "bench.h"
+
+#include <atomic>
+#include <filesystem>
+#include <random>
+
+using namespace testing;
+using namespace Tempest;
+using Bench::measure;
+
+namespace {
+
+constexpr uint32_t FileCount = 10000;
+constexpr char     Root[]    = "archive_bench";
+
+std::vector<std::string> mkFiles() {
+  std::vector<std::string> names;
+  std::mt19937             rng(0);
+  std::vector<uint8_t>     data;
+  for(uint32_t i=0; i<FileCount; ++i) {
+    const std::string dir = std::string(Root) + "/" + std::to_string(i%64);
+    std::filesystem::create_directories(dir);
+
+    data.resize(256 + rng()%4096);
+    for(size_t r=0; r<data.size(); ++r)
+      data[r] = uint8_t("0123456789abcdef"[rng()%16]);
+
+    const std::string name = std::to_string(i%64) + "/" + std::to_string(i) + ".bin";
+    WFile f(std::string(Root) + "/" + name);
+    f.write(data.data(),data.size());
+    names.push_back(name);
+    }
+  return names;
+  }
+
+void benchArchive(const std::vector<std::string>& names, size_t bytes, Archive::Compression c, const char* name) {
+  {
+  ArchiveWriter w;
+  ASSERT_TRUE(w.addDirectory(Root,c));
+  w.save("archive_bench.pak");
+  }
+
+  Archive a("archive_bench.pak");
+  const double sync = measure([&](){
+    std::vector<uint8_t> buf;
+    for(auto& i:names) {
+      auto f = a.open(i);
+      buf.resize(f.size());
+      f.read(buf.data(),buf.size());
+      }
+    });
+
+  std::atomic<size_t> asyncBytes{0};
+  const double async = measure([&](){
+    asyncBytes = 0;
+    a.readAsync(names,[&](const std::string&, ArchiveFile& f){
+      asyncBytes += f.size();
+      });
+    a.wait();
+    });
+  EXPECT_EQ(asyncBytes.load(),bytes);
+
+  Log::i("  archive (", name, ") sync:  ", sync,  " ms");
+  Log::i("  archive (", name, ") async: ", async, " ms");
+  }
+
+}
+
+TEST(bench,Archive) {
+  const auto names = mkFiles();
+
+  size_t bytes = 0;
+  const double loose = measure([&](){
+    bytes = 0;
+    std::vector<uint8_t> buf;
+    for(auto& i:names) {
+      RFile f(std::string(Root) + "/" + i);
+      buf.resize(f.size());
+      bytes += f.read(buf.data(),buf.size());
+      }
+    });
+
+  Log::i(FileCount, " files, ", bytes/1024, " KiB:");
+  Log::i("  loose files:             ", loose, " ms");
+  benchArchive(names,bytes,Archive::Store,  "store  ");
+  benchArchive(names,bytes,Archive::Deflate,"deflate");
+
+  std::filesystem::remove_all(Root);
+  std::filesystem::remove("archive_bench.pak");
+  }
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <chrono>
+
+namespace Bench {
+
+// milliseconds of second call of 'fn'; first call warms up caches and allocators
+template<class Fn>
+double measure(Fn fn) {
+  fn(); // warmup
+  auto t = std::chrono::high_resolution_clock::now();
+  fn();
+  auto d = std::chrono::high_resolution_clock::now()-t;
+  return std::chrono::duration<double,std::milli>(d).count();
+  }
+
+}
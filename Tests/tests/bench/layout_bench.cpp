@@ -0,0 +1,58 @@
+#include <Tempest/Widget>
+#include <Tempest/Log>
+
+#include <gtest/gtest.h>
+
+#include "bench.h"
+
+#include <memory>
+
+using namespace testing;
+using namespace Tempest;
+using Bench::measure;
+
+namespace {
+
+// 10 x 10 x 100 = 10k leaves, nested in alternating linear layouts
+constexpr int Groups  = 10;
+constexpr int Rows    = 10;
+constexpr int Leaves  = 100;
+constexpr int Resizes = 20;
+
+void build(Widget& root) {
+  root.setLayout(Vertical);
+  for(int g=0; g<Groups; ++g) {
+    auto& grp = root.addWidget(new Widget());
+    grp.setLayout(Horizontal);
+    for(int r=0; r<Rows; ++r) {
+      auto& row = grp.addWidget(new Widget());
+      row.setLayout(Vertical);
+      for(int i=0; i<Leaves; ++i)
+        row.addWidget(new Widget());
+      }
+    }
+  }
+
+double benchTree(bool deferred) {
+  return measure([deferred](){
+    Widget root;
+    root.setDeferredLayout(deferred);
+    root.resize(1920,1080);
+    build(root);
+    root.flushLayout();
+    for(int i=0; i<Resizes; ++i) {
+      root.resize(1920-i*8,1080-i*4);
+      root.flushLayout(); // once per frame
+      }
+    });
+  }
+}
+
+TEST(bench,Layout) {
+  const double tImmediate = benchTree(false);
+  const double tDeferred  = benchTree(true);
+
+  Log::i("layout: ",Groups*Rows*Leaves," widgets, build + ",Resizes," resizes");
+  Log::i("  immediate : ",tImmediate," ms");
+  Log::i("  deferred  : ",tDeferred, " ms");
+  }
@@ -0,0 +1,55 @@
+#include <Tempest/Log>
+
+#include <gtest/gtest.h>
+
+#include "bench.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+using namespace testing;
+using namespace Tempest;
+using Bench::measure;
+
+namespace {
+
+constexpr uint32_t ThreadCount = 8;
+constexpr uint32_t MsgCount    = 20000;
+
+void logAll() {
+  std::thread th[ThreadCount];
+  for(uint32_t i=0; i<ThreadCount; ++i)
+    th[i] = std::thread([i](){
+      for(uint32_t r=0; r<MsgCount; ++r)
+        Log::d("thread ",i," message ",r," value ",r*0.5f);
+      });
+  for(auto& t:th)
+    t.join();
+  }
+}
+
+TEST(bench,Log) {
+  // redirect to a file: measures logger itself, not a terminal
+  std::filebuf file;
+  file.open("log_bench.txt",std::ios::out);
+  auto out = std::cout.rdbuf(&file);
+  auto err = std::cerr.rdbuf(&file);
+
+  const double tSync  = measure([](){ logAll(); });
+  Log::setAsync(true);
+  const uint64_t drop0  = Log::droppedCount();
+  const double   tAsync = measure([](){ logAll(); Log::sync(); });
+  const uint64_t drop   = Log::droppedCount()-drop0;
+  Log::setAsync(false);
+
+  std::cout.rdbuf(out);
+  std::cerr.rdbuf(err);
+  file.close();
+  std::remove("log_bench.txt");
+
+  Log::i("log: ",ThreadCount," threads x ",MsgCount," messages");
+  Log::i("  sync  : ",tSync, " ms");
+  Log::i("  async : ",tAsync," ms, dropped: ",drop," of ",2*ThreadCount*MsgCount);
+  }
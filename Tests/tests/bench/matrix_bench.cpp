@@ -0,0 +1,95 @@
+#include <Tempest/Matrix4x4>
+#include <Tempest/Log>
+
+#include <gtest/gtest.h>
+
+#include "bench.h"
+
+#include <random>
+#include <vector>
+
+using namespace testing;
+using namespace Tempest;
+using Bench::measure;
+
+namespace {
+
+// world matrices of a typical scene
+constexpr size_t Count = 50000;
+
+// scalar reference, same as pre-simd Matrix4x4::mul
+void mulScalar(Matrix4x4& r, const Matrix4x4& a, const Matrix4x4& b) {
+  float t[4][4];
+  for(int i=0; i<4; ++i)
+    for(int j=0; j<4; ++j)
+      t[i][j] = a[0][j]*b[i][0] + a[1][j]*b[i][1] + a[2][j]*b[i][2] + a[3][j]*b[i][3];
+  r.setData(&t[0][0]);
+  }
+
+void projectScalar(const Matrix4x4& m, Vec3& v) {
+  const float x = v.x, y = v.y, z = v.z;
+  const float w = m[0][3]*x + m[1][3]*y + m[2][3]*z + m[3][3];
+  v.x = (m[0][0]*x + m[1][0]*y + m[2][0]*z + m[3][0])/w;
+  v.y = (m[0][1]*x + m[1][1]*y + m[2][1]*z + m[3][1])/w;
+  v.z = (m[0][2]*x + m[1][2]*y + m[2][2]*z + m[3][2])/w;
+  }
+}
+
+TEST(bench,Matrix) {
+  std::mt19937 rnd(0);
+  std::uniform_real_distribution<float> d(-1.f,1.f);
+
+  std::vector<Matrix4x4> local(Count), world(Count);
+  std::vector<Vec3>      pos(Count), out(Count);
+  for(size_t i=0; i<Count; ++i) {
+    local[i] = Matrix4x4::mkIdentity();
+    local[i].translate(d(rnd),d(rnd),d(rnd));
+    local[i].rotateOY(d(rnd)*180.f);
+    pos[i]   = Vec3(d(rnd),d(rnd),d(rnd));
+    }
+  Matrix4x4 parent;
+  parent.perspective(60,1.5f,0.1f,100.f);
+
+  const double mulRef = measure([&](){
+    for(size_t i=0; i<Count; ++i)
+      mulScalar(world[i],parent,local[i]);
+    });
+  const double mulOne = measure([&](){
+    for(size_t i=0; i<Count; ++i)
+      world[i] = parent*local[i];
+    });
+  const double mulBatch = measure([&](){
+    Matrix4x4::mul(world.data(),parent,local.data(),Count);
+    });
+
+  const double invOne = measure([&](){
+    for(size_t i=0; i<Count; ++i) {
+      world[i] = local[i];
+      world[i].inverse();
+      }
+    });
+  const double invBatch = measure([&](){
+    Matrix4x4::inverse(world.data(),local.data(),Count);
+    });
+
+  const double prjRef = measure([&](){
+    for(size_t i=0; i<Count; ++i) {
+      out[i] = pos[i];
+      projectScalar(parent,out[i]);
+      }
+    });
+  const double prjOne = measure([&](){
+    for(size_t i=0; i<Count; ++i) {
+      out[i] = pos[i];
+      parent.project(out[i]);
+      }
+    });
+  const double prjBatch = measure([&](){
+    parent.project(out.data(),pos.data(),Count);
+    });
+
+  Log::i("matrix: ",Count," elements");
+  Log::i("  mul     : scalar = ",mulRef," ms; simd = ",mulOne," ms; batch = ",mulBatch," ms");
+  Log::i("  inverse : simd = ",invOne," ms; batch = ",invBatch," ms");
+  Log::i("  project : scalar = ",prjRef," ms; simd = ",prjOne," ms; batch = ",prjBatch," ms");
+  }
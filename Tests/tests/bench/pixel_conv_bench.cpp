@@ -0,0 +1,66 @@
+#include "../formats/pixelconv.h"
+
+#include <Tempest/Pixmap>
+#include <Tempest/Log>
+
+#include <gtest/gtest.h>
+
+#include "bench.h"
+
+#include <random>
+
+using namespace testing;
+using namespace Tempest;
+using namespace Tempest::Detail;
+using Bench::measure;
+
+namespace {
+
+constexpr uint32_t Side = 2048;
+
+Pixmap noise(TextureFormat frm) {
+  Pixmap       pm(Side,Side,frm);
+  std::mt19937 rng(0);
+  auto         px = reinterpret_cast<uint8_t*>(pm.data());
+  const size_t sz = pm.dataSize();
+  if(frm==TextureFormat::RGBA32F) {
+    auto f = reinterpret_cast<float*>(px);
+    for(size_t i=0; i<sz/4; ++i)
+      f[i] = float(rng()%1200)/1000.f;
+    return pm;
+    }
+  for(size_t i=0; i<sz; ++i)
+    px[i] = uint8_t(rng());
+  return pm;
+  }
+
+void benchConv(const Pixmap& src, TextureFormat frm, const char* name) {
+  const double mp = double(src.w())*double(src.h())/1e6;
+  const double ms = measure([&](){ Pixmap pm(src,frm); });
+  Log::i("  ", name, ": ", mp*1000.0/ms, " MPix/s");
+  }
+
+}
+
+TEST(bench,PixelConv) {
+  const Pixmap rgb8   = noise(TextureFormat::RGB8);
+  const Pixmap r8     = noise(TextureFormat::R8);
+  const Pixmap rgba8  = noise(TextureFormat::RGBA8);
+  const Pixmap rgba16 = noise(TextureFormat::RGBA16);
+  const Pixmap rgba32 = noise(TextureFormat::RGBA32F);
+
+  const PixelConv::Isa prev = PixelConv::isa();
+  for(auto i:{PixelConv::Scalar, PixelConv::Sse4, PixelConv::Avx2, PixelConv::Neon}) {
+    if(PixelConv::setIsa(i)!=i)
+      continue;
+    Log::i(PixelConv::isaName(i), " ", Side, "x", Side, ":");
+    benchConv(rgb8,   TextureFormat::RGBA8,   "rgb8    -> rgba8  ");
+    benchConv(r8,     TextureFormat::RGBA8,   "r8      -> rgba8  ");
+    benchConv(rgba8,  TextureFormat::RGB8,    "rgba8   -> rgb8   ");
+    benchConv(rgba16, TextureFormat::RGBA8,   "rgba16  -> rgba8  ");
+    benchConv(rgba32, TextureFormat::RGBA8,   "rgba32f -> rgba8  ");
+    benchConv(rgba8,  TextureFormat::RGBA32F, "rgba8   -> rgba32f");
+    benchConv(rgba32, TextureFormat::RGBA16F, "rgba32f -> rgba16f");
+    }
+  PixelConv::setIsa(prev);
+  }
@@ -0,0 +1,49 @@
+#include <Tempest/Pixmap>
+#include <Tempest/Log>
+
+#include <gtest/gtest.h>
+
+#include "bench.h"
+
+#include <random>
+#include <thread>
+
+using namespace testing;
+using namespace Tempest;
+using Bench::measure;
+
+namespace {
+
+Pixmap noise(uint32_t w, uint32_t h) {
+  // smooth gradient with some noise - close to real albedo content
+  Pixmap       pm(w,h,TextureFormat::RGBA8);
+  std::mt19937 rng(0);
+  auto         px = reinterpret_cast<uint8_t*>(pm.data());
+  for(uint32_t y=0; y<h; ++y)
+    for(uint32_t x=0; x<w; ++x) {
+      uint8_t* p = &px[(size_t(y)*w+x)*4];
+      p[0] = uint8_t((x*255)/w       + rng()%16);
+      p[1] = uint8_t((y*255)/h       + rng()%16);
+      p[2] = uint8_t(((x+y)*127)/w   + rng()%16);
+      p[3] = uint8_t(255             - rng()%32);
+      }
+  return pm;
+  }
+
+void benchCompress(const Pixmap& src, TextureFormat frm, const char* name) {
+  const double mp   = double(src.w())*double(src.h())/1e6;
+  const double one  = measure([&](){ Pixmap pm(src,frm);      });
+  const double mips = measure([&](){ Pixmap pm(src,frm,true); });
+  Log::i(name, " ", src.w(), "x", src.h(), ": ", mp*1000.0/one, " MPix/s; ",
+         "with mips = ", mp*1000.0/mips, " MPix/s");
+  }
+
+}
+
+TEST(bench,PixmapCompress) {
+  Log::i("threads: ", std::thread::hardware_concurrency());
+
+  const Pixmap src = noise(1024,1024);
+  benchCompress(src, TextureFormat::DXT1, "dxt1");
+  benchCompress(src, TextureFormat::DXT5, "dxt5");
+  }
@@ -0,0 +1,124 @@
+#include <Tempest/SoundDevice>
+#include <Tempest/SoundEffect>
+#include <Tempest/Sound>
+#include <Tempest/MemReader>
+#include <Tempest/Log>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace testing;
+using namespace Tempest;
+
+namespace {
+
+constexpr uint32_t Frequency = 44100;
+constexpr size_t   Chunk     = 1024;
+
+std::vector<uint8_t> mkWav(uint32_t frequency, float seconds, float tone) {
+  const uint32_t samples = uint32_t(float(frequency)*seconds);
+  const uint32_t dataSz  = samples*sizeof(int16_t);
+
+  std::vector<uint8_t> ret(44+dataSz);
+  auto wr32 = [&](size_t at, uint32_t v) { std::memcpy(&ret[at],&v,4); };
+  auto wr16 = [&](size_t at, uint16_t v) { std::memcpy(&ret[at],&v,2); };
+
+  std::memcpy(&ret[0], "RIFF",4);
+  wr32(4, uint32_t(ret.size()-8));
+  std::memcpy(&ret[8], "WAVEfmt ",8);
+  wr32(16,16);
+  wr16(20,1);                    // PCM
+  wr16(22,1);                    // mono
+  wr32(24,frequency);
+  wr32(28,frequency*sizeof(int16_t));
+  wr16(32,sizeof(int16_t));
+  wr16(34,16);
+  std::memcpy(&ret[36], "data",4);
+  wr32(40,dataSz);
+
+  for(uint32_t i=0; i<samples; ++i) {
+    int16_t v = int16_t(std::sin(float(i)*tone*2.f*float(M_PI)/float(frequency))*8000.f);
+    wr16(44+i*sizeof(int16_t), uint16_t(v));
+    }
+  return ret;
+  }
+
+class SineProducer : public SoundProducer {
+  public:
+    SineProducer(float tone):SoundProducer(Frequency,2), step(tone*2.f*float(M_PI)/float(Frequency)) {}
+
+    void renderSound(int16_t* out, size_t n) override {
+      for(size_t i=0; i<n; ++i) {
+        auto v = int16_t(std::sin(phase)*8000.f);
+        out[i*2+0] = v;
+        out[i*2+1] = v;
+        phase += step;
+        }
+      phase = std::fmod(phase, 2.f*float(M_PI));
+      }
+
+  private:
+    float phase = 0;
+    float step  = 0;
+  };
+
+// milliseconds of cpu time, spent to mix one second of audio
+double mixSecond(SoundDevice& dev) {
+  std::vector<int16_t> pcm(Chunk*2);
+  auto t = std::chrono::high_resolution_clock::now();
+  for(size_t i=0; i<Frequency; i+=Chunk)
+    dev.renderSamples(pcm.data(), Chunk);
+  auto d = std::chrono::high_resolution_clock::now()-t;
+  return std::chrono::duration<double,std::milli>(d).count();
+  }
+
+void benchVoices(size_t voices, bool streamed) {
+  SoundDevice dev(SoundDevice::Loopback{Frequency,2});
+  ASSERT_TRUE(dev.isLoopback());
+
+  dev.setListenerPosition(0,0,0);
+  dev.setListenerDirection(0,0,1, 0,1,0);
+
+  auto wav = mkWav(Frequency, 4.f, 440.f);
+  MemReader rd(wav.data(), wav.size());
+  Sound     snd(rd);
+
+  std::mt19937                          rng(0);
+  std::uniform_real_distribution<float> pos(-2000.f, 2000.f);
+
+  std::vector<SoundEffect> fx;
+  for(size_t i=0; i<voices; ++i) {
+    if(streamed)
+      fx.emplace_back(dev.load(std::make_unique<SineProducer>(220.f + float(i))));
+    else
+      fx.emplace_back(dev.load(snd));
+    fx.back().setPosition(pos(rng), pos(rng), pos(rng));
+    fx.back().setMaxDistance(4000.f);
+    fx.back().setPriority(int32_t(i%4));
+    fx.back().play();
+    }
+  // voices above device limit are virtualised
+  dev.process();
+
+  mixSecond(dev); // warmup
+  const double ms = mixSecond(dev);
+  Log::i("sound mixer: ", voices, (streamed ? " streamed" : " static"), " voices: ",
+         ms, " ms per second of audio (", 1000.0/std::max(ms,0.001), "x realtime)");
+  }
+
+}
+
+TEST(bench,SoundMixerStatic) {
+  for(size_t voices:{1, 16, 64, 128, 512})
+    benchVoices(voices, false);
+  }
+
+TEST(bench,SoundMixerStreamed) {
+  for(size_t voices:{1, 16, 64, 128})
+    benchVoices(voices, true);
+  }
@@ -0,0 +1,64 @@
+#include <Tempest/TextModel>
+#include <Tempest/Log>
+
+#include <gtest/gtest.h>
+
+#include "bench.h"
+
+#include <random>
+#include <string>
+
+using namespace testing;
+using namespace Tempest;
+using Bench::measure;
+
+namespace {
+
+// ~4 MiB log-like document
+constexpr int DocLines = 100000;
+constexpr int Edits    = 2000;
+
+std::string document() {
+  std::string ret;
+  for(int i=0; i<DocLines; ++i) {
+    ret += "[info] 0000000000 frame time is ";
+    ret += std::to_string(i);
+    ret += " us\n";
+    }
+  return ret;
+  }
+}
+
+TEST(bench,TextModel) {
+  const std::string doc = document();
+  TextModel         m(doc.c_str());
+  std::mt19937      rnd(1);
+
+  // typing in the middle of document, then undo of every keystroke
+  const double tType = measure([&](){
+    UndoStack<TextModel> stk;
+    auto at = m.advance(m.charAt(size_t(0)),int32_t(doc.size()/2));
+    for(int i=0; i<Edits; ++i) {
+      stk.push(m,new TextModel::CommandInsert("x",at));
+      at = m.advance(at,1);
+      }
+    for(int i=0; i<Edits; ++i)
+      stk.undo(m);
+    });
+
+  // scattered edits, with size-hint update per edit
+  const double tRandom = measure([&](){
+    auto at = m.advance(m.charAt(size_t(0)),int32_t(doc.size()/4));
+    for(int i=0; i<Edits; ++i) {
+      at = m.advance(at,int32_t(rnd()%4096));
+      if(i%2==0)
+        m.insert("word\n",at); else
+        m.erase(at,5);
+      m.sizeHint();
+      }
+    });
+
+  Log::i("textmodel: ",doc.size()/1024," KiB, ",DocLines," lines, ",Edits," edits");
+  Log::i("  typing    : ",tType,  " ms");
+  Log::i("  random    : ",tRandom," ms");
+  }
@@ -68,6 +68,12 @@ TEST(DirectX12Api,SsboCopy) {
 #endif
   }
 
+TEST(DirectX12Api,ReadbackAsync) {
+#if defined(_MSC_VER)
+  GapiTestCommon::ReadbackAsync<DirectX12Api>();
+#endif
+  }
+
 TEST(DirectX12Api,ArrayLength) {
 #if defined(_MSC_VER)
   GapiTestCommon::ArrayLength<DirectX12Api>();
@@ -147,6 +153,30 @@ TEST(DirectX12Api,Compute) {
 #endif
   }
 
+TEST(DirectX12Api,GpuProfiling) {
+#if defined(_MSC_VER)
+  GapiTestCommon::GpuProfiling<DirectX12Api>();
+#endif
+  }
+
+TEST(DirectX12Api,GpuProfilingFrames) {
+#if defined(_MSC_VER)
+  GapiTestCommon::GpuProfilingFrames<DirectX12Api>();
+#endif
+  }
+
+TEST(DirectX12Api,MemoryStats) {
+#if defined(_MSC_VER)
+  GapiTestCommon::MemoryStats<DirectX12Api>();
+#endif
+  }
+
+TEST(DirectX12Api,Defragment) {
+#if defined(_MSC_VER)
+  GapiTestCommon::Defragment<DirectX12Api>();
+#endif
+  }
+
 TEST(DirectX12Api,ComputeImage) {
 #if defined(_MSC_VER)
   GapiTestCommon::ComputeImage<DirectX12Api>("DirectX12Api_ComputeImage.png");
@@ -175,12 +205,30 @@ TEST(DirectX12Api,MipMaps) {
 #endif
   }
 
+TEST(DirectX12Api,ComputeMipMaps) {
+#if defined(_MSC_VER)
+  GapiTestCommon::ComputeMipMaps<DirectX12Api>("DirectX12Api_ComputeMipMaps.png");
+#endif
+  }
+
 TEST(DirectX12Api,S3TC) {
 #if defined(_MSC_VER)
   GapiTestCommon::S3TC<DirectX12Api>("DirectX12Api_S3TC.png");
 #endif
   }
 
+TEST(DirectX12Api,VectorImageAppend) {
+#if defined(_MSC_VER)
+  GapiTestCommon::VectorImageAppend<DirectX12Api>();
+#endif
+  }
+
+TEST(DirectX12Api,WidgetPaintCache) {
+#if defined(_MSC_VER)
+  GapiTestCommon::WidgetPaintCache<DirectX12Api>();
+#endif
+  }
+
 TEST(DirectX12Api,SsboWrite) {
 #if defined(_MSC_VER)
   GapiTestCommon::SsboWrite<DirectX12Api>();
@@ -254,6 +302,24 @@ TEST(DirectX12Api,Blas) {
 #endif
   }
 
+TEST(DirectX12Api,BlasBatch) {
+#if defined(_MSC_VER)
+  GapiTestCommon::BlasBatch<DirectX12Api>();
+#endif
+  }
+
+TEST(DirectX12Api,TlasUpdate) {
+#if defined(_MSC_VER)
+  GapiTestCommon::TlasUpdate<DirectX12Api>();
+#endif
+  }
+
+TEST(DirectX12Api,TlasRefit) {
+#if defined(_MSC_VER)
+  GapiTestCommon::TlasRefit<DirectX12Api>();
+#endif
+  }
+
 TEST(DirectX12Api,TlasEmpty) {
 #if defined(_MSC_VER)
   GapiTestCommon::TlasEmpty<DirectX12Api>();
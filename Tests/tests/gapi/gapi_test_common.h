@@ -6,7 +6,12 @@
 #include <Tempest/Pixmap>
 #include <Tempest/Log>
 #include <Tempest/Matrix4x4>
+#include <Tempest/MemWriter>
 #include <Tempest/Vec>
+#include <Tempest/VectorImage>
+#include <Tempest/Painter>
+#include <Tempest/TextureAtlas>
+#include <Tempest/Widget>
 
 #include <gtest/gtest.h>
 #include <gmock/gmock-matchers.h>
@@ -247,6 +252,72 @@ void SsboCopy() {
     }
   }
 
+template<class GraphicsApi>
+void ReadbackAsync() {
+  using namespace Tempest;
+
+  try {
+    GraphicsApi api{ApiFlags::Validation};
+    Device      device(api);
+
+    std::vector<uint32_t> ref(1024);
+    for(size_t i=0; i<ref.size(); ++i)
+      ref[i] = uint32_t(i*i);
+
+    auto ssbo = device.ssbo(ref);
+    auto src  = device.attachment(TextureFormat::RGBA8,32,16,true);
+
+    for(int frame=0; frame<3; ++frame) {
+      Readback rbBytes, rbPixels, rbMip;
+
+      auto cmd = device.commandBuffer();
+      {
+        auto enc = cmd.startEncoding(device);
+        enc.setFramebuffer({{src,Vec4(0,1,0,1),Tempest::Preserve}});
+        enc.setFramebuffer({});
+        enc.generateMipmaps(src);
+        rbBytes  = device.readBytesAsync (enc,ssbo,16,sizeof(uint32_t)*100);
+        rbPixels = device.readPixelsAsync(enc,src);
+        rbMip    = device.readPixelsAsync(enc,src,2);
+      }
+      EXPECT_FALSE(rbBytes.isReady());
+      EXPECT_ANY_THROW(rbBytes.wait());
+
+      // fence of the caller is not required to be alive, while readback is pending
+      {
+        auto sync = device.fence();
+        if(frame%2==0)
+          device.submit(cmd,sync); else
+          device.submit(cmd);
+      }
+
+      std::vector<uint32_t> data(100);
+      rbBytes.read(data.data(),data.size()*sizeof(uint32_t));
+      EXPECT_TRUE(rbBytes.isReady());
+      for(size_t i=0; i<data.size(); ++i)
+        EXPECT_EQ(data[i],ref[i+4]);
+
+      auto pm = rbPixels.pixmap();
+      ASSERT_EQ(pm.w(),32u);
+      ASSERT_EQ(pm.h(),16u);
+      auto px = reinterpret_cast<const uint8_t*>(pm.data());
+      for(size_t i=0; i<size_t(pm.w()*pm.h()); ++i) {
+        EXPECT_EQ(px[i*4+0],0);
+        EXPECT_EQ(px[i*4+1],255);
+        }
+
+      auto mip = rbMip.pixmap();
+      EXPECT_EQ(mip.w(),8u);
+      EXPECT_EQ(mip.h(),4u);
+      }
+    }
+  catch(std::system_error& e) {
+    if(e.code()==Tempest::GraphicsErrc::NoDevice)
+      Log::d("Skipping graphics testcase: ", e.what()); else
+      throw;
+    }
+  }
+
 template<class GraphicsApi>
 void ArrayLength() {
   using namespace Tempest;
@@ -918,6 +989,353 @@ void Compute() {
     }
   }
 
+template<class GraphicsApi>
+void GpuProfiling() {
+  using namespace Tempest;
+
+  try {
+    GraphicsApi api{ApiFlags::Validation};
+    Device      device(api);
+
+    // created before profiling is enabled: uploads would add zones of their own
+    Vec4 inputCpu[3] = {Vec4(0,1,2,3),Vec4(4,5,6,7),Vec4(8,9,10,11)};
+
+    auto input  = device.ssbo(inputCpu,      sizeof(inputCpu));
+    auto output = device.ssbo(Uninitialized, sizeof(inputCpu));
+
+    auto cs     = device.shader("shader/simple_test.comp.sprv");
+    auto pso    = device.pipeline(cs);
+
+    auto ubo    = device.descriptors(pso.layout());
+    ubo.set(0,input);
+    ubo.set(1,output);
+    device.waitIdle();
+
+    std::vector<GpuFrame> frames;
+    try {
+      device.setProfiling(ProfilingFlags::Timestamps | ProfilingFlags::PipelineStatistics,
+                          [&](const GpuFrame& f){ frames.push_back(f); });
+      }
+    catch(std::system_error& e) {
+      if(e.code()==Tempest::GraphicsErrc::UnsupportedExtension) {
+        Log::d("Skipping graphics testcase: ", e.what());
+        return;
+        }
+      throw;
+      }
+
+    auto cmd = device.commandBuffer();
+    {
+      auto enc = cmd.startEncoding(device);
+      enc.beginZone("frame");
+      {
+        auto z = enc.zone("dispatch");
+        enc.setUniforms(pso,ubo);
+        enc.dispatch(3,1,1);
+      }
+      enc.endZone();
+    }
+
+    auto sync = device.fence();
+    device.submit(cmd,sync);
+    sync.wait();
+    device.nextProfilingFrame();
+
+    ASSERT_EQ(frames.size(),1u);
+    auto& zones = frames[0].zones;
+    ASSERT_EQ(zones.size(),2u);
+    EXPECT_EQ(zones[0].name,"frame");
+    EXPECT_EQ(zones[0].depth,0u);
+    EXPECT_EQ(zones[1].name,"dispatch");
+    EXPECT_EQ(zones[1].depth,1u);
+    for(auto& z:zones)
+      EXPECT_LE(z.begin,z.end);
+    EXPECT_LE(zones[0].begin,zones[1].begin);
+    EXPECT_GE(zones[0].end,  zones[1].end);
+    if(zones[0].hasStats)
+      EXPECT_EQ(zones[0].stats.csInvocations,uint64_t(3*pso.workGroupSize().x));
+
+    std::vector<uint8_t> json;
+    MemWriter            w(json);
+    device.saveProfilingTrace(w);
+    const std::string str(json.begin(),json.end());
+    EXPECT_NE(str.find("traceEvents"),std::string::npos);
+    EXPECT_NE(str.find("dispatch"),   std::string::npos);
+    }
+  catch(std::system_error& e) {
+    if(e.code()==Tempest::GraphicsErrc::NoDevice)
+      Log::d("Skipping graphics testcase: ", e.what()); else
+      throw;
+    }
+  }
+
+template<class GraphicsApi>
+void GpuProfilingFrames() {
+  using namespace Tempest;
+
+  try {
+    GraphicsApi api{ApiFlags::Validation};
+    Device      device(api);
+
+    Vec4 inputCpu[3] = {Vec4(0,1,2,3),Vec4(4,5,6,7),Vec4(8,9,10,11)};
+
+    auto input  = device.ssbo(inputCpu,      sizeof(inputCpu));
+    auto output = device.ssbo(Uninitialized, sizeof(inputCpu));
+
+    auto cs     = device.shader("shader/simple_test.comp.sprv");
+    auto pso    = device.pipeline(cs);
+
+    auto ubo    = device.descriptors(pso.layout());
+    ubo.set(0,input);
+    ubo.set(1,output);
+    device.waitIdle();
+
+    std::vector<GpuFrame> frames;
+    auto callback = [&](const GpuFrame& f){ if(!f.zones.empty()) frames.push_back(f); };
+    try {
+      device.setProfiling(ProfilingFlags::Timestamps, callback);
+      }
+    catch(std::system_error& e) {
+      if(e.code()==Tempest::GraphicsErrc::UnsupportedExtension) {
+        Log::d("Skipping graphics testcase: ", e.what());
+        return;
+        }
+      throw;
+      }
+
+    auto record = [&](CommandBuffer& cmd, const std::string& name) {
+      auto enc = cmd.startEncoding(device);
+      auto z   = enc.zone(name.c_str());
+      enc.setUniforms(pso,ubo);
+      enc.dispatch(3,1,1);
+      };
+
+    // two command buffers in flight; each re-recording reuses query batch of previous frame
+    const size_t  count   = 8;
+    CommandBuffer cmd[2]  = {device.commandBuffer(), device.commandBuffer()};
+    Fence         sync[2] = {device.fence(), device.fence()};
+    for(size_t i=0; i<count; ++i) {
+      if(i>=2)
+        sync[i%2].wait();
+      record(cmd[i%2], "pass"+std::to_string(i));
+      device.submit(cmd[i%2],sync[i%2]);
+      device.nextProfilingFrame();
+      }
+    sync[0].wait();
+    sync[1].wait();
+    for(int i=0; i<4 && frames.size()<count; ++i)
+      device.nextProfilingFrame();
+
+    ASSERT_EQ(frames.size(),count);
+    for(size_t i=0; i<count; ++i) {
+      ASSERT_EQ(frames[i].zones.size(),1u);
+      auto& z = frames[i].zones[0];
+      EXPECT_EQ(z.name,"pass"+std::to_string(i));
+      EXPECT_LE(z.begin,z.end);
+      if(i>0) {
+        // same queue: stale results of previous use of a batch would go back in time
+        EXPECT_LT(frames[i-1].id,frames[i].id);
+        EXPECT_LT(frames[i-1].zones[0].begin,z.begin);
+        }
+      }
+
+    // profiling is toggled with submission in flight: its results must not leak into new frames
+    frames.clear();
+    record(cmd[0],"dropped");
+    device.submit(cmd[0],sync[0]);
+    device.setProfiling(ProfilingFlags::None, nullptr);
+    device.setProfiling(ProfilingFlags::Timestamps, callback);
+    sync[0].wait();
+
+    record(cmd[1],"after");
+    device.submit(cmd[1],sync[1]);
+    sync[1].wait();
+    for(int i=0; i<4 && frames.empty(); ++i)
+      device.nextProfilingFrame();
+
+    ASSERT_EQ(frames.size(),1u);
+    ASSERT_EQ(frames[0].zones.size(),1u);
+    EXPECT_EQ(frames[0].zones[0].name,"after");
+    }
+  catch(std::system_error& e) {
+    if(e.code()==Tempest::GraphicsErrc::NoDevice)
+      Log::d("Skipping graphics testcase: ", e.what()); else
+      throw;
+    }
+  }
+
+template<class GraphicsApi>
+void MemoryStats() {
+  using namespace Tempest;
+
+  try {
+    GraphicsApi api{ApiFlags::Validation};
+    Device      device(api);
+
+    std::vector<MemoryEvent> events;
+    try {
+      device.setMemoryCallback([&](const MemoryEvent& e){ events.push_back(e); });
+      }
+    catch(std::system_error& e) {
+      if(e.code()==Tempest::GraphicsErrc::UnsupportedExtension) {
+        Log::d("Skipping graphics testcase: ", e.what());
+        return;
+        }
+      throw;
+      }
+
+    const auto before = device.memoryStats();
+    uint64_t   used   = 0;
+    for(auto& h:before.heaps)
+      used += h.used;
+
+    std::vector<uint8_t> data(64*1024);
+    {
+      auto ssbo = device.ssbo(data);
+      bool allocated = false;
+      for(auto& e:events)
+        allocated |= (e.type==MemoryEvent::Allocate && e.size>=data.size());
+      EXPECT_TRUE(allocated);
+
+      const auto st = device.memoryStats();
+      ASSERT_FALSE(st.heaps.empty());
+      ASSERT_FALSE(st.types.empty());
+
+      uint64_t usedNow = 0;
+      for(auto& h:st.heaps) {
+        EXPECT_LE(h.used,h.allocated);
+        EXPECT_LE(h.largestFreeBlock,h.allocated);
+        if(st.hasBudget)
+          EXPECT_GT(h.budget,0u); else
+          EXPECT_EQ(h.budget,h.size);
+        usedNow += h.used;
+        }
+      EXPECT_GE(usedNow,used+data.size());
+
+      for(auto& t:st.types)
+        EXPECT_LT(t.heapId,st.heaps.size());
+      for(auto& e:events) {
+        ASSERT_LT(e.typeId,st.types.size());
+        EXPECT_LT(e.heapId,st.heaps.size());
+        EXPECT_EQ(e.heapId,st.types[e.typeId].heapId);
+        }
+    }
+
+    device.setMemoryCallback(nullptr);
+    }
+  catch(std::system_error& e) {
+    if(e.code()==Tempest::GraphicsErrc::NoDevice)
+      Log::d("Skipping graphics testcase: ", e.what()); else
+      throw;
+    }
+  }
+
+template<class GraphicsApi>
+void Defragment() {
+  using namespace Tempest;
+
+  try {
+    GraphicsApi api{ApiFlags::Validation};
+    Device      device(api);
+
+    const size_t count  = 16;
+    const size_t length = 16*1024; // 256Kb per buffer, 4 buffers per page
+
+    auto cs  = device.shader("shader/simple_test.comp.sprv");
+    auto pso = device.pipeline(cs);
+
+    try {
+      device.setMemoryPageSize(4*length*sizeof(Vec4));
+      }
+    catch(std::system_error& e) {
+      if(e.code()==Tempest::GraphicsErrc::UnsupportedExtension) {
+        Log::d("Skipping graphics testcase: ", e.what());
+        return;
+        }
+      throw;
+      }
+
+    std::vector<StorageBuffer>     ssbo;
+    std::vector<DescriptorSet>     desc;
+    std::vector<std::vector<Vec4>> data(count);
+    for(size_t i=0; i<count; ++i) {
+      data[i].resize(length);
+      for(size_t r=0; r<length; ++r)
+        data[i][r] = Vec4(float(i*length+r),float(r),float(i),1);
+      ssbo.emplace_back(device.ssbo(data[i]));
+      }
+
+    auto dst = device.ssbo(Uninitialized, length*sizeof(Vec4));
+    for(size_t i=0; i<count; ++i) {
+      desc.emplace_back(device.descriptors(pso.layout()));
+      desc.back().set(0,ssbo[i]);
+      desc.back().set(1,dst);
+      }
+
+    // leave one buffer per page; bindings of deleted buffers must be forgotten, with or without descriptor set
+    for(size_t i=0; i<count; ++i) {
+      if(i%4==0)
+        continue;
+      ssbo[i] = StorageBuffer();
+      if(i%2==0)
+        desc[i] = DescriptorSet();
+      }
+
+    auto pages = [&device]() {
+      uint64_t ret = 0;
+      for(auto& h:device.memoryStats().heaps)
+        ret += h.pages;
+      return ret;
+      };
+    const uint64_t sparse = pages();
+
+    // GPU is not idle: defragmentation must not release storage, used by work in flight
+    auto busy = device.commandBuffer();
+    {
+      auto enc = busy.startEncoding(device);
+      enc.setUniforms(pso,desc[0]);
+      enc.dispatch(length,1,1);
+    }
+    auto busySync = device.fence();
+    device.submit(busy,busySync);
+
+    const size_t moved = device.defragment(size_t(-1));
+    EXPECT_GT(moved,0u);
+    busySync.wait();
+
+    // old storage is released, once GPU is done with it
+    device.waitIdle();
+    EXPECT_LT(pages(),sparse);
+
+    std::vector<Vec4> readback(length);
+    for(size_t i=0; i<count; i+=4) {
+      std::fill(readback.begin(),readback.end(),Vec4());
+      device.readBytes(ssbo[i],readback.data(),ssbo[i].byteSize());
+      EXPECT_EQ(readback,data[i]);
+
+      // descriptor set, written before defragmentation, has to see moved buffer
+      auto cmd = device.commandBuffer();
+      {
+        auto enc = cmd.startEncoding(device);
+        enc.setUniforms(pso,desc[i]);
+        enc.dispatch(length,1,1);
+      }
+      auto sync = device.fence();
+      device.submit(cmd,sync);
+      sync.wait();
+
+      std::fill(readback.begin(),readback.end(),Vec4());
+      device.readBytes(dst,readback.data(),dst.byteSize());
+      EXPECT_EQ(readback,data[i]);
+      }
+    }
+  catch(std::system_error& e) {
+    if(e.code()==Tempest::GraphicsErrc::NoDevice)
+      Log::d("Skipping graphics testcase: ", e.what()); else
+      throw;
+    }
+  }
+
 template<class GraphicsApi>
 void ComputeImage(const char* outImage) {
   using namespace Tempest;
@@ -1030,6 +1448,52 @@ void MipMaps(const char* outImage) {
     }
   }
 
+template<class GraphicsApi>
+void ComputeMipMaps(const char* outImage) {
+  using namespace Tempest;
+
+  try {
+    GraphicsApi api{ApiFlags::Validation};
+    Device      device(api);
+
+    auto img = device.image2d(TextureFormat::RGBA8,128,128,true);
+    auto pso = device.pipeline(device.shader("shader/image_store_test.comp.sprv"));
+
+    auto ubo = device.descriptors(pso.layout());
+    ubo.set(0,img,Sampler::nearest(),0);
+
+    auto cmd = device.commandBuffer();
+    {
+      auto enc = cmd.startEncoding(device);
+      enc.setUniforms(pso,ubo);
+      enc.dispatch(img.w(),img.h(),1);
+      enc.generateMipmaps(img);
+    }
+
+    auto sync = device.fence();
+    device.submit(cmd,sync);
+    sync.wait();
+
+    auto pm = device.readPixels(img,1);
+    EXPECT_EQ(pm.w(),64);
+    EXPECT_EQ(pm.h(),64);
+    pm.save(outImage);
+
+    // average of gradient
+    auto last = device.readPixels(img,img.mipCount()-1);
+    auto px   = reinterpret_cast<const uint8_t*>(last.data());
+    EXPECT_EQ(last.w(),1);
+    EXPECT_NEAR(px[0],127,3);
+    EXPECT_NEAR(px[1],127,3);
+    EXPECT_EQ  (px[3],255);
+    }
+  catch(std::system_error& e) {
+    if(e.code()==Tempest::GraphicsErrc::NoDevice)
+      Log::d("Skipping graphics testcase: ", e.what()); else
+      throw;
+    }
+  }
+
 template<class GraphicsApi>
 void S3TC(const char* /*outImage*/) {
   using namespace Tempest;
@@ -1054,6 +1518,198 @@ void S3TC(const char* /*outImage*/) {
     }
   }
 
+template<class GraphicsApi>
+void VectorImageAppend() {
+  using namespace Tempest;
+
+  try {
+    GraphicsApi  api{ApiFlags::Validation};
+    Device       device(api);
+    TextureAtlas atlas(device);
+
+    auto fbo  = device.attachment(TextureFormat::RGBA8,64,64);
+    auto draw = [&](const VectorImage::Mesh& mesh) {
+      auto cmd = device.commandBuffer();
+      {
+        auto enc = cmd.startEncoding(device);
+        enc.setFramebuffer({{fbo,Vec4(0,0,0,1),Tempest::Preserve}});
+        mesh.draw(enc);
+      }
+      auto sync = device.fence();
+      device.submit(cmd,sync);
+      sync.wait();
+      return device.readPixels(fbo);
+      };
+    auto paint = [&](VectorImage& img, const Color& cl, int count) {
+      img.clear();
+      PaintEvent e(img,atlas,fbo.w(),fbo.h());
+      Painter    p(e);
+      for(int i=0; i<count; ++i) {
+        p.setBrush(i==1 ? cl : Color(1,0,0,1));
+        p.drawRect(i*16,0,16,64);
+        }
+      };
+    auto same = [](const Pixmap& a, const Pixmap& b) {
+      return a.dataSize()==b.dataSize() && std::memcmp(a.data(),b.data(),a.dataSize())==0;
+      };
+
+    VectorImage src;
+    paint(src,Color(0,1,0,1),2);
+    const size_t n = src.vertexCount();
+    ASSERT_GT(n,0u);
+
+    // split in the middle of a block: result must be the same geometry and state
+    VectorImage dst;
+    dst.clear();
+    dst.append(src,0,n/3);
+    dst.append(src,n/3,n);
+    EXPECT_EQ(dst.vertexCount(),n);
+
+    VectorImage::Mesh ms, md;
+    ms.update(device,src);
+    md.update(device,dst);
+    const Pixmap ref = draw(ms);
+    EXPECT_TRUE(same(ref,draw(md)));
+
+    // same vertex count, only color of second rect changes: partial upload
+    paint(src,Color(0,0,1,1),2);
+    ms.update(device,src);
+    const Pixmap part = draw(ms);
+    EXPECT_FALSE(same(ref,part));
+
+    VectorImage::Mesh fresh;
+    fresh.update(device,src);
+    EXPECT_TRUE(same(part,draw(fresh)));
+
+    // grow, then shrink back; stale tail of vbo must not be drawn
+    paint(src,Color(0,0,1,1),4);
+    ms.update(device,src);
+    fresh = VectorImage::Mesh();
+    fresh.update(device,src);
+    EXPECT_TRUE(same(draw(ms),draw(fresh)));
+
+    paint(src,Color(0,0,1,1),2);
+    ms.update(device,src);
+    EXPECT_TRUE(same(draw(ms),part));
+    }
+  catch(std::system_error& e) {
+    if(e.code()==Tempest::GraphicsErrc::NoDevice)
+      Log::d("Skipping graphics testcase: ", e.what()); else
+      throw;
+    }
+  }
+
+template<class GraphicsApi>
+void WidgetPaintCache() {
+  using namespace Tempest;
+
+  struct Box : Widget {
+    Color cl;
+    int   painted = 0;
+    void  paintEvent(PaintEvent& e) override {
+      ++painted;
+      Painter p(e);
+      p.setBrush(cl);
+      p.drawRect(0,0,w(),h());
+      }
+    };
+
+  struct Root : Widget {
+    using Widget::dispatchPaintEvent;
+    };
+
+  try {
+    GraphicsApi  api{ApiFlags::Validation};
+    Device       device(api);
+    TextureAtlas atlas(device);
+
+    auto fbo  = device.attachment(TextureFormat::RGBA8,64,64);
+    auto draw = [&](const VectorImage& img) {
+      VectorImage::Mesh mesh;
+      mesh.update(device,img);
+      auto cmd = device.commandBuffer();
+      {
+        auto enc = cmd.startEncoding(device);
+        enc.setFramebuffer({{fbo,Vec4(0,0,0,1),Tempest::Preserve}});
+        mesh.draw(enc);
+      }
+      auto sync = device.fence();
+      device.submit(cmd,sync);
+      sync.wait();
+      return device.readPixels(fbo);
+      };
+    auto same = [](const Pixmap& a, const Pixmap& b) {
+      return a.dataSize()==b.dataSize() && std::memcmp(a.data(),b.data(),a.dataSize())==0;
+      };
+
+    Root root;
+    root.resize(int(fbo.w()),int(fbo.h()));
+    root.setMargins(Margin(0));
+    root.setSpacing(0);
+    root.setLayout(Horizontal);
+    auto& a = root.addWidget(new Box());
+    auto& b = root.addWidget(new Box());
+    a.cl = Color(1,0,0,1);
+    b.cl = Color(0,1,0,1);
+
+    // same frame management, as Window::dispatchPaintEvent does
+    VectorImage prev, surface;
+    uint64_t    prevFrame = 0, frame = 0;
+    auto paintFrame = [&]() {
+      surface.clear();
+      Detail::PaintCache c;
+      c.dst       = &surface;
+      c.prev      = &prev;
+      c.prevFrame = prevFrame;
+      c.frame     = ++frame;
+      PaintEvent e(surface,atlas,fbo.w(),fbo.h(),c);
+      root.dispatchPaintEvent(e);
+      prev      = surface;
+      prevFrame = c.frame;
+      };
+    auto paintDirect = [&]() {
+      VectorImage img;
+      PaintEvent  e(img,atlas,fbo.w(),fbo.h());
+      root.dispatchPaintEvent(e);
+      return draw(img);
+      };
+
+    paintFrame();
+    EXPECT_EQ(a.painted,1);
+    EXPECT_EQ(b.painted,1);
+    const Pixmap first = draw(surface);
+
+    // nothing changed: both subtrees are spliced from previous frame
+    paintFrame();
+    EXPECT_EQ(a.painted,1);
+    EXPECT_EQ(b.painted,1);
+    EXPECT_EQ(surface.vertexCount(),prev.vertexCount());
+    EXPECT_TRUE(same(first,draw(surface)));
+
+    // only updated widget is repainted; spliced neighbour stays in place
+    b.cl = Color(0,0,1,1);
+    b.update();
+    paintFrame();
+    EXPECT_EQ(a.painted,1);
+    EXPECT_EQ(b.painted,2);
+    const Pixmap second = draw(surface);
+    EXPECT_FALSE(same(first,second));
+    EXPECT_TRUE (same(second,paintDirect()));
+
+    // disabled state is inherited: whole subtree is repainted
+    root.setEnabled(false);
+    const int pa = a.painted, pb = b.painted;
+    paintFrame();
+    EXPECT_EQ(a.painted,pa+1);
+    EXPECT_EQ(b.painted,pb+1);
+    }
+  catch(std::system_error& e) {
+    if(e.code()==Tempest::GraphicsErrc::NoDevice)
+      Log::d("Skipping graphics testcase: ", e.what()); else
+      throw;
+    }
+  }
+
 template<class GraphicsApi>
 void SsboWrite() {
   using namespace Tempest;
@@ -1660,6 +2316,103 @@ void Blas() {
     }
   }
 
+// renders tlas with ray_test.frag: rays along -Z, over [-2..2] square; miss is left as clear color
+inline Tempest::Pixmap rayQueryImage(Tempest::Device& device, const Tempest::AccelerationStructure& tlas) {
+  using namespace Tempest;
+
+  auto fsq  = device.vbo<Vertex>({{-1,-1},{ 1,-1},{ 1, 1}, {-1,-1},{ 1, 1},{-1, 1}});
+  auto vert = device.shader("shader/simple_test.vert.sprv");
+  auto frag = device.shader("shader/ray_test.frag.sprv");
+  auto pso  = device.pipeline(Topology::Triangles,RenderState(),vert,frag);
+
+  auto ubo  = device.descriptors(pso);
+  ubo.set(0, tlas);
+
+  auto tex = device.attachment(TextureFormat::RGBA8,128,128);
+  auto cmd = device.commandBuffer();
+  {
+    auto enc = cmd.startEncoding(device);
+    enc.setFramebuffer({{tex,Vec4(0,0,1,1),Tempest::Preserve}});
+    enc.setUniforms(pso,ubo);
+    enc.draw(fsq);
+  }
+  auto sync = device.fence();
+  device.submit(cmd,sync);
+  sync.wait();
+
+  return device.readPixels(tex);
+  }
+
+// ray at (x,0), x in [-2..2]; row 64 is y~0 regardless of framebuffer y-direction
+inline bool rayQueryHit(const Tempest::Pixmap& pm, float x) {
+  const uint32_t* px  = reinterpret_cast<const uint32_t*>(pm.data());
+  const int       col = int((x+2.f)*float(pm.w())/4.f);
+  return px[col + 64*pm.w()]!=0xFFFF0000;
+  }
+
+template<class GraphicsApi>
+void BlasBatch() {
+  using namespace Tempest;
+
+  try {
+    const char* rtDev = nullptr;
+
+    GraphicsApi api{ApiFlags::Validation};
+    auto dev = api.devices();
+    for(auto& i:dev)
+      if(i.raytracing.rayQuery)
+        rtDev = i.name;
+    if(rtDev==nullptr)
+      return;
+
+    Device device(api,rtDev);
+    auto vbo  = device.vbo(vboData3,3);
+    auto ibo  = device.ibo(iboData,3);
+
+    std::vector<std::vector<RtGeometry>> mesh(64);
+    for(size_t i=0; i<mesh.size(); ++i) {
+      if(i%8==7)
+        continue; // empty mesh -> empty blas
+      mesh[i].resize(i%3+1, RtGeometry(vbo,ibo));
+      }
+
+    auto full  = device.blas(mesh);
+    auto tight = device.blas(mesh,RtBuildFlags::Compact);
+    ASSERT_EQ(full .size(),mesh.size());
+    ASSERT_EQ(tight.size(),mesh.size());
+
+    uint64_t fullSz = 0, tightSz = 0;
+    for(size_t i=0; i<mesh.size(); ++i) {
+      EXPECT_EQ(full [i].isEmpty(),mesh[i].empty());
+      EXPECT_EQ(tight[i].isEmpty(),mesh[i].empty());
+      EXPECT_LE(tight[i].byteSize(),full[i].byteSize());
+      fullSz  += full [i].byteSize();
+      tightSz += tight[i].byteSize();
+      }
+    if(device.properties().raytracing.compaction)
+      EXPECT_LT(tightSz,fullSz);
+
+    // compacted copies have to be traceable: triangle covers x in [-1..1] at y=0
+    std::vector<RtInstance> inst;
+    for(size_t i=0; i<tight.size(); ++i) {
+      if(tight[i].isEmpty())
+        continue;
+      RtInstance ix;
+      ix.blas = &tight[i];
+      inst.push_back(ix);
+      }
+    auto tlas = device.tlas(inst);
+    auto pm   = rayQueryImage(device,tlas);
+    EXPECT_TRUE (rayQueryHit(pm, 0.75f));
+    EXPECT_FALSE(rayQueryHit(pm,-1.50f));
+    }
+  catch(std::system_error& e) {
+    if(e.code()==Tempest::GraphicsErrc::NoDevice)
+      Log::d("Skipping graphics testcase: ", e.what()); else
+      throw;
+    }
+  }
+
 template<class GraphicsApi>
 void TlasEmpty() {
   // NOTE: it's brutally difficult to check for empty tlas on shader side, so better to have engine-size handling
@@ -1689,6 +2442,138 @@ void TlasEmpty() {
     }
   }
 
+template<class GraphicsApi>
+void TlasUpdate() {
+  using namespace Tempest;
+
+  try {
+    const char* rtDev = nullptr;
+
+    GraphicsApi api{ApiFlags::Validation};
+    auto dev = api.devices();
+    for(auto& i:dev)
+      if(i.raytracing.rayQuery)
+        rtDev = i.name;
+    if(rtDev==nullptr)
+      return;
+
+    Device device(api,rtDev);
+    auto vbo  = device.vbo(vboData3,3);
+    auto ibo  = device.ibo(iboData,3);
+    auto blas = device.blas(vbo,ibo);
+    auto tlas = device.tlas(16);
+
+    std::vector<RtInstanceDesc> inst(8);
+    for(size_t i=0; i<inst.size(); ++i) {
+      RtInstance ix;
+      ix.mat  = Matrix4x4::mkIdentity();
+      ix.mat.translate(float(i),0,0);
+      ix.id   = uint32_t(i);
+      ix.blas = &blas;
+      inst[i] = RtInstanceDesc(ix);
+      EXPECT_EQ(inst[i].blas,blas.deviceAddress());
+      }
+    auto ssbo = device.ssbo(inst);
+
+    auto cmd = device.commandBuffer();
+    {
+      auto enc = cmd.startEncoding(device);
+      enc.updateTlas(tlas,ssbo,0,inst.size());                       // build
+      enc.updateTlas(tlas,ssbo,0,inst.size());                       // refit
+      enc.updateTlas(tlas,ssbo,sizeof(RtInstanceDesc),inst.size()-1); // rebuild, count changed
+    }
+    auto sync = device.fence();
+    device.submit(cmd,sync);
+    sync.wait();
+
+    auto cmd2 = device.commandBuffer();
+    {
+      auto enc = cmd2.startEncoding(device);
+      EXPECT_THROW(enc.updateTlas(tlas,ssbo,0,inst.size()+1), std::system_error);
+      EXPECT_THROW(enc.updateTlas(tlas,ssbo,4,1), std::system_error);
+    }
+    }
+  catch(std::system_error& e) {
+    if(e.code()==Tempest::GraphicsErrc::NoDevice)
+      Log::d("Skipping graphics testcase: ", e.what()); else
+      throw;
+    }
+  }
+
+template<class GraphicsApi>
+void TlasRefit() {
+  using namespace Tempest;
+
+  try {
+    const char* rtDev = nullptr;
+
+    GraphicsApi api{ApiFlags::Validation};
+    auto dev = api.devices();
+    for(auto& i:dev)
+      if(i.raytracing.rayQuery)
+        rtDev = i.name;
+    if(rtDev==nullptr)
+      return;
+
+    Device device(api,rtDev);
+    auto vbo  = device.vbo(vboData3,3);
+    auto ibo  = device.ibo(iboData,3);
+    auto blas = device.blas(vbo,ibo);
+    auto tlas = device.tlas(4);
+
+    // triangle covers x in [-1..1] at y=0; moved to [-2..-1] by refit
+    RtInstance ix;
+    ix.blas = &blas;
+    auto ssbo0 = device.ssbo(std::vector<RtInstanceDesc>{RtInstanceDesc(ix)});
+    ix.mat.translate(-2,0,0);
+    auto ssbo1 = device.ssbo(std::vector<RtInstanceDesc>{RtInstanceDesc(ix), RtInstanceDesc(ix)});
+
+    auto sync = device.fence();
+    auto cmd  = device.commandBuffer();
+    {
+      auto enc = cmd.startEncoding(device);
+      enc.updateTlas(tlas,ssbo0,0,1);
+    }
+    device.submit(cmd,sync);
+    sync.wait();
+
+    auto pm = rayQueryImage(device,tlas);
+    EXPECT_TRUE (rayQueryHit(pm, 0.75f));
+    EXPECT_FALSE(rayQueryHit(pm,-1.50f));
+
+    {
+      auto enc = cmd.startEncoding(device);
+      enc.updateTlas(tlas,ssbo1,0,1);
+    }
+    device.submit(cmd,sync);
+    sync.wait();
+
+    pm = rayQueryImage(device,tlas);
+    EXPECT_FALSE(rayQueryHit(pm, 0.75f));
+    EXPECT_TRUE (rayQueryHit(pm,-1.50f));
+
+    // refit is recorded against 1-instance build, but TLAS is rebuilt with 2 instances first
+    auto refit   = device.commandBuffer();
+    auto rebuild = device.commandBuffer();
+    {
+      auto enc = refit.startEncoding(device);
+      enc.updateTlas(tlas,ssbo0,0,1);
+    }
+    {
+      auto enc = rebuild.startEncoding(device);
+      enc.updateTlas(tlas,ssbo1,0,2);
+    }
+    device.submit(rebuild,sync);
+    sync.wait();
+    EXPECT_THROW(device.submit(refit,sync), std::system_error);
+    }
+  catch(std::system_error& e) {
+    if(e.code()==Tempest::GraphicsErrc::NoDevice)
+      Log::d("Skipping graphics testcase: ", e.what()); else
+      throw;
+    }
+  }
+
 template<class GraphicsApi>
 void RayQuery(const char* outImg) {
   using namespace Tempest;
@@ -43,6 +43,12 @@ TEST(MetalApi,SsboCopy) {
 #endif
   }
 
+TEST(MetalApi,ReadbackAsync) {
+#if defined(__OSX__)
+  GapiTestCommon::ReadbackAsync<MetalApi>();
+#endif
+  }
+
 TEST(MetalApi,SsboEmpty) {
 #if defined(__OSX__)
   GapiTestCommon::SsboEmpty<MetalApi>();
@@ -133,6 +139,30 @@ TEST(MetalApi,Compute) {
 #endif
   }
 
+TEST(MetalApi,GpuProfiling) {
+#if defined(__OSX__)
+  GapiTestCommon::GpuProfiling<MetalApi>();
+#endif
+  }
+
+TEST(MetalApi,GpuProfilingFrames) {
+#if defined(__OSX__)
+  GapiTestCommon::GpuProfilingFrames<MetalApi>();
+#endif
+  }
+
+TEST(MetalApi,MemoryStats) {
+#if defined(__OSX__)
+  GapiTestCommon::MemoryStats<MetalApi>();
+#endif
+  }
+
+TEST(MetalApi,Defragment) {
+#if defined(__OSX__)
+  GapiTestCommon::Defragment<MetalApi>();
+#endif
+  }
+
 TEST(MetalApi,ComputeImage) {
 #if defined(__OSX__)
   GapiTestCommon::ComputeImage<MetalApi>("MetalApi_ComputeImage.png");
@@ -153,6 +183,12 @@ TEST(MetalApi,MipMaps) {
 #endif
   }
 
+TEST(MetalApi,ComputeMipMaps) {
+#if defined(__OSX__)
+  GapiTestCommon::ComputeMipMaps<MetalApi>("MetalApi_ComputeMipMaps.png");
+#endif
+  }
+
 TEST(MetalApi,S3TC) {
 #if defined(__OSX__)
   try {
@@ -170,6 +206,18 @@ TEST(MetalApi,S3TC) {
 #endif
   }
 
+TEST(MetalApi,VectorImageAppend) {
+#if defined(__OSX__)
+  GapiTestCommon::VectorImageAppend<MetalApi>();
+#endif
+  }
+
+TEST(MetalApi,WidgetPaintCache) {
+#if defined(__OSX__)
+  GapiTestCommon::WidgetPaintCache<MetalApi>();
+#endif
+  }
+
 TEST(MetalApi,PsoTess) {
 #if defined(__OSX__)
   GapiTestCommon::PsoTess<MetalApi>();
@@ -224,6 +272,12 @@ TEST(MetalApi,Blas) {
 #endif
   }
 
+TEST(MetalApi,BlasBatch) {
+#if defined(__OSX__)
+  GapiTestCommon::BlasBatch<MetalApi>();
+#endif
+  }
+
 TEST(MetalApi,RayQuery) {
 #if defined(__OSX__)
   GapiTestCommon::RayQuery<MetalApi>("MetalApi_RayQuery.png");
@@ -56,6 +56,12 @@ TEST(VulkanApi,SsboCopy) {
 #endif
   }
 
+TEST(VulkanApi,ReadbackAsync) {
+#if !defined(__OSX__)
+  GapiTestCommon::ReadbackAsync<VulkanApi>();
+#endif
+  }
+
 TEST(VulkanApi,ArrayLength) {
 #if !defined(__OSX__)
   GapiTestCommon::ArrayLength<VulkanApi>();
@@ -147,6 +153,30 @@ TEST(VulkanApi,Compute) {
 #endif
   }
 
+TEST(VulkanApi,GpuProfiling) {
+#if !defined(__OSX__)
+  GapiTestCommon::GpuProfiling<VulkanApi>();
+#endif
+  }
+
+TEST(VulkanApi,GpuProfilingFrames) {
+#if !defined(__OSX__)
+  GapiTestCommon::GpuProfilingFrames<VulkanApi>();
+#endif
+  }
+
+TEST(VulkanApi,MemoryStats) {
+#if !defined(__OSX__)
+  GapiTestCommon::MemoryStats<VulkanApi>();
+#endif
+  }
+
+TEST(VulkanApi,Defragment) {
+#if !defined(__OSX__)
+  GapiTestCommon::Defragment<VulkanApi>();
+#endif
+  }
+
 TEST(VulkanApi,ComputeImage) {
 #if !defined(__OSX__)
   GapiTestCommon::ComputeImage<VulkanApi>("VulkanApi_ComputeImage.png");
@@ -174,12 +204,30 @@ TEST(VulkanApi,MipMaps) {
 #endif
   }
 
+TEST(VulkanApi,ComputeMipMaps) {
+#if !defined(__OSX__)
+  GapiTestCommon::ComputeMipMaps<VulkanApi>("VulkanApi_ComputeMipMaps.png");
+#endif
+  }
+
 TEST(VulkanApi,S3TC) {
 #if !defined(__OSX__)
   GapiTestCommon::S3TC<VulkanApi>("VulkanApi_S3TC.png");
 #endif
   }
 
+TEST(VulkanApi,VectorImageAppend) {
+#if !defined(__OSX__)
+  GapiTestCommon::VectorImageAppend<VulkanApi>();
+#endif
+  }
+
+TEST(VulkanApi,WidgetPaintCache) {
+#if !defined(__OSX__)
+  GapiTestCommon::WidgetPaintCache<VulkanApi>();
+#endif
+  }
+
 TEST(VulkanApi,PsoTess) {
 #if !defined(__OSX__)
   GapiTestCommon::PsoTess<VulkanApi>();
@@ -258,6 +306,24 @@ TEST(VulkanApi,Blas) {
 #endif
   }
 
+TEST(VulkanApi,BlasBatch) {
+#if !defined(__OSX__)
+  GapiTestCommon::BlasBatch<VulkanApi>();
+#endif
+  }
+
+TEST(VulkanApi,TlasUpdate) {
+#if !defined(__OSX__)
+  GapiTestCommon::TlasUpdate<VulkanApi>();
+#endif
+  }
+
+TEST(VulkanApi,TlasRefit) {
+#if !defined(__OSX__)
+  GapiTestCommon::TlasRefit<VulkanApi>();
+#endif
+  }
+
 TEST(VulkanApi,TlasEmpty) {
 #if !defined(__OSX__)
   GapiTestCommon::TlasEmpty<VulkanApi>();
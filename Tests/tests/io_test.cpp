@@ -86,3 +86,39 @@ TEST(main,FileUnget) {
   RFile fin("FileUnget.bin");
   UngetCommon(fin);
   }
+
+TEST(main,MappedFileIO) {
+  {
+  WFile fout("MappedFile.bin");
+  EXPECT_EQ(fout.write(bytes,sizeof(bytes)),sizeof(bytes));
+  }
+
+  {
+  MappedFile fin("MappedFile.bin");
+  EXPECT_EQ(fin.size(),sizeof(bytes));
+  EXPECT_EQ(std::memcmp(fin.data(),bytes,sizeof(bytes)),0);
+  UngetCommon(fin);
+  }
+
+  {
+  MappedFile fin("MappedFile.bin");
+  EXPECT_EQ(fin.seek(4),4u);
+
+  size_t      avail = 0;
+  const void* view  = fin.view(avail);
+  EXPECT_EQ(avail,sizeof(bytes)-4);
+  EXPECT_EQ(view,fin.data()+4);
+  EXPECT_EQ(fin.peek(),bytes[4]);
+  }
+
+  {
+  // fallback: no direct view for stream devices
+  RFile       fin("MappedFile.bin");
+  size_t      avail = 1;
+  const void* view  = fin.view(avail);
+  EXPECT_EQ(view,nullptr);
+  EXPECT_EQ(avail,0u);
+  }
+
+  EXPECT_ANY_THROW(MappedFile("MappedFile.missing"));
+  }
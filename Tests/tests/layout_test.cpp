@@ -68,3 +68,37 @@ TEST(main,LinearLayoutVisibility) {
     b[i]->setVisible(false);
     }
   }
+
+TEST(main,LinearLayoutDeferred) {
+  Widget w;
+  w.setDeferredLayout(true);
+  w.resize(300,300);
+  w.setSpacing(0);
+  w.setLayout(Vertical);
+
+  Widget& b0 = w.addWidget(new Widget());
+  Widget& b1 = w.addWidget(new Widget());
+  b1.setSpacing(0);
+  b1.setLayout(Horizontal);
+  Widget& c0 = b1.addWidget(new Widget());
+  Widget& c1 = b1.addWidget(new Widget());
+
+  EXPECT_EQ(b0.h(),0);
+  w.flushLayout();
+  EXPECT_EQ(b0.h(),150);
+  EXPECT_EQ(b1.h(),150);
+  EXPECT_EQ(c0.w(),150);
+  EXPECT_EQ(c1.w(),150);
+
+  w.resize(600,600);
+  EXPECT_EQ(b0.h(),150);
+  w.flushLayout();
+  EXPECT_EQ(b0.h(),300);
+  EXPECT_EQ(c0.w(),300);
+  EXPECT_EQ(c1.h(),300);
+
+  w.setDeferredLayout(false);
+  w.resize(200,200);
+  EXPECT_EQ(b0.h(),100);
+  EXPECT_EQ(c0.w(),100);
+  }
@@ -0,0 +1,63 @@
+#include <Tempest/ListView>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+
+using namespace testing;
+using namespace Tempest;
+
+namespace {
+struct Delegate : ListDelegate {
+  size_t  count   = 0;
+  size_t  created = 0;
+  size_t  live    = 0;
+
+  size_t  size() const override { return count; }
+
+  Widget* createView(size_t) override {
+    ++created;
+    ++live;
+    auto w = new Widget();
+    w->setMinimumSize(10,20);
+    return w;
+    }
+
+  void removeView(Widget* w, size_t) override {
+    --live;
+    delete w;
+    }
+
+  Widget* update(Widget* w, size_t) override {
+    return w;
+    }
+  };
+}
+
+TEST(main,ListViewVirtual) {
+  ListView list;
+  list.setVirtualized(true,20);
+  list.resize(200,400);
+
+  auto& d = *list.setDelegate(new Delegate());
+  d.count = 100000;
+  list.updateView();
+
+  auto& cen = list.centralWidget();
+  EXPECT_GT(cen.widgetsCount(),0u);
+  EXPECT_LT(cen.widgetsCount(),64u);
+  EXPECT_EQ(d.live,cen.widgetsCount());
+  EXPECT_GE(cen.h(),int(d.count)*20);
+
+  for(size_t i=1; i<cen.widgetsCount(); ++i)
+    EXPECT_GT(cen.widget(i).y(),cen.widget(i-1).y());
+
+  // recycled, not re-created
+  const size_t created = d.created;
+  list.updateView();
+  EXPECT_EQ(d.created,created);
+
+  d.count = 3;
+  list.updateView();
+  EXPECT_EQ(cen.widgetsCount(),3u);
+  EXPECT_EQ(d.live,3u);
+  }
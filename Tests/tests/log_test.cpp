@@ -3,7 +3,9 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock-matchers.h>
 
+#include <atomic>
 #include <cstring>
+#include <thread>
 
 using namespace testing;
 using namespace Tempest;
@@ -24,3 +26,55 @@ TEST(main,Logger) {
   int64_t i32 = 0;
   Log::i(i32);
   }
+
+TEST(main,LoggerAsync) {
+  std::atomic<uint32_t> received{0};
+  Log::setOutputCallback([&](Log::Mode, const char* text) {
+    if(std::strncmp(text,"async ",6)==0)
+      received.fetch_add(1);
+    });
+
+  Log::setAsync(true);
+  EXPECT_TRUE(Log::isAsync());
+
+  // counter is global for process lifetime
+  const uint64_t dropped = Log::droppedCount();
+  std::thread th[4];
+  for(auto& t:th)
+    t = std::thread([](){
+      for(int i=0; i<100; ++i)
+        Log::d("async ",i);
+      });
+  for(auto& t:th)
+    t.join();
+
+  Log::sync();
+  EXPECT_EQ(received.load()+(Log::droppedCount()-dropped),400u);
+
+  Log::setAsync(false);
+  EXPECT_FALSE(Log::isAsync());
+  Log::setOutputCallback(nullptr);
+  }
+
+TEST(main,LoggerAsyncReentrant) {
+  std::atomic<uint32_t> received{0};
+  Log::setOutputCallback([&](Log::Mode, const char* text) {
+    if(std::strcmp(text,"outer")==0) {
+      // logging and sync from output callback must not deadlock
+      Log::d("inner");
+      Log::sync();
+      }
+    if(std::strcmp(text,"inner")==0)
+      received.fetch_add(1);
+    });
+
+  Log::setAsync(true);
+  Log::d("outer");
+  Log::sync();
+  // 'inner' is queued by writer thread itself, during previous sync
+  Log::sync();
+  EXPECT_EQ(received.load(),1u);
+
+  Log::setAsync(false);
+  Log::setOutputCallback(nullptr);
+  }
@@ -0,0 +1,136 @@
+#include <Tempest/Matrix4x4>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+
+#include <random>
+#include <vector>
+
+using namespace testing;
+using namespace Tempest;
+
+namespace {
+Matrix4x4 mkRandom(std::mt19937& rnd) {
+  std::uniform_real_distribution<float> d(-1.f,1.f);
+  Matrix4x4 m;
+  for(int i=0; i<4; ++i)
+    for(int r=0; r<4; ++r)
+      m.set(i,r,d(rnd) + (i==r ? 4.f : 0.f));
+  return m;
+  }
+
+Matrix4x4 refMul(const Matrix4x4& a, const Matrix4x4& b) {
+  Matrix4x4 r;
+  for(int i=0; i<4; ++i)
+    for(int j=0; j<4; ++j) {
+      float v = 0;
+      for(int k=0; k<4; ++k)
+        v += a.at(k,j)*b.at(i,k);
+      r.set(i,j,v);
+      }
+  return r;
+  }
+
+void expectNear(const Matrix4x4& a, const Matrix4x4& b, float eps = 1e-4f) {
+  for(int i=0; i<4; ++i)
+    for(int r=0; r<4; ++r)
+      EXPECT_NEAR(a.at(i,r),b.at(i,r),eps);
+  }
+}
+
+TEST(main,MatrixMul) {
+  std::mt19937 rnd(1);
+  for(int i=0; i<16; ++i) {
+    auto a = mkRandom(rnd);
+    auto b = mkRandom(rnd);
+    auto r = refMul(a,b);
+    expectNear(a*b,r);
+
+    auto c = a;
+    c.mul(b);
+    expectNear(c,r);
+    }
+
+  std::vector<Matrix4x4> a(33), b(33), out(33);
+  for(size_t i=0; i<a.size(); ++i) {
+    a[i] = mkRandom(rnd);
+    b[i] = mkRandom(rnd);
+    }
+  Matrix4x4::mul(out.data(),a.data(),b.data(),out.size());
+  for(size_t i=0; i<out.size(); ++i)
+    expectNear(out[i],refMul(a[i],b[i]));
+
+  Matrix4x4::mul(out.data(),a[0],b.data(),out.size());
+  for(size_t i=0; i<out.size(); ++i)
+    expectNear(out[i],refMul(a[0],b[i]));
+  }
+
+TEST(main,MatrixInverse) {
+  std::mt19937 rnd(2);
+  auto id = Matrix4x4::mkIdentity();
+  for(int i=0; i<16; ++i) {
+    auto m = mkRandom(rnd);
+    auto inv = m;
+    inv.inverse();
+    expectNear(m*inv,id);
+    expectNear(inv*m,id);
+    }
+
+  Matrix4x4 tr = Matrix4x4::mkIdentity();
+  tr.translate(1,2,3);
+  tr.rotateOY(30);
+  tr.scale(2);
+  auto inv = tr;
+  inv.inverse();
+  expectNear(tr*inv,id);
+
+  std::vector<Matrix4x4> m(9);
+  for(auto& i:m)
+    i = mkRandom(rnd);
+  std::vector<Matrix4x4> out(m.size());
+  Matrix4x4::inverse(out.data(),m.data(),m.size());
+  for(size_t i=0; i<m.size(); ++i)
+    expectNear(m[i]*out[i],id);
+  }
+
+TEST(main,MatrixProject) {
+  std::mt19937 rnd(3);
+  std::uniform_real_distribution<float> d(-10.f,10.f);
+
+  Matrix4x4 m;
+  m.perspective(60,1.5f,0.1f,100.f);
+  m.translate(1,2,-30);
+  m.rotateOX(15);
+
+  std::vector<Vec4> v4(11);
+  std::vector<Vec3> v3(11);
+  for(size_t i=0; i<v4.size(); ++i) {
+    v4[i] = Vec4(d(rnd),d(rnd),d(rnd),1.f);
+    v3[i] = Vec3(d(rnd),d(rnd),d(rnd));
+    }
+
+  std::vector<Vec4> o4(v4.size());
+  std::vector<Vec3> o3(v3.size());
+  m.project(o4.data(),v4.data(),v4.size());
+  m.project(o3.data(),v3.data(),v3.size());
+  for(size_t i=0; i<v4.size(); ++i) {
+    float x = v4[i].x, y = v4[i].y, z = v4[i].z, w = v4[i].w;
+    m.project(x,y,z,w);
+    EXPECT_NEAR(o4[i].x,x,1e-4f);
+    EXPECT_NEAR(o4[i].y,y,1e-4f);
+    EXPECT_NEAR(o4[i].z,z,1e-4f);
+    EXPECT_NEAR(o4[i].w,w,1e-4f);
+
+    Vec3 p = v3[i];
+    m.project(p);
+    EXPECT_NEAR(o3[i].x,p.x,1e-4f);
+    EXPECT_NEAR(o3[i].y,p.y,1e-4f);
+    EXPECT_NEAR(o3[i].z,p.z,1e-4f);
+    }
+
+  // in-place
+  auto p3 = v3;
+  m.project(p3.data(),p3.data(),p3.size());
+  for(size_t i=0; i<v3.size(); ++i)
+    EXPECT_EQ(p3[i],o3[i]);
+  }
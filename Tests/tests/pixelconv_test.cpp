@@ -0,0 +1,165 @@
+#include "../formats/pixelconv.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace testing;
+using namespace Tempest::Detail;
+
+namespace {
+
+// runs 'fn' for every instruction set, available on this cpu
+template<class Fn>
+void forEachIsa(Fn fn) {
+  const PixelConv::Isa prev = PixelConv::isa();
+  for(auto i:{PixelConv::Scalar, PixelConv::Sse4, PixelConv::Avx2, PixelConv::Neon}) {
+    if(PixelConv::setIsa(i)!=i)
+      continue;
+    SCOPED_TRACE(PixelConv::isaName(i));
+    fn();
+    }
+  PixelConv::setIsa(prev);
+  }
+
+std::vector<uint8_t> randomBytes(size_t n) {
+  std::mt19937         rng(uint32_t(n*7+1));
+  std::vector<uint8_t> ret(n);
+  for(auto& i:ret)
+    i = uint8_t(rng());
+  return ret;
+  }
+
+}
+
+TEST(main,PixelConvSwizzle8) {
+  static const int8_t toRgba[4][4] = {
+    {0, PixelConv::Zero, PixelConv::Zero, PixelConv::One},
+    {0, 0, 0, 1},
+    {0, 1, 2, PixelConv::One},
+    {2, 1, 0, 3},
+    };
+  static const int8_t toRgb[3] = {0, 1, 2};
+
+  forEachIsa([]() {
+    for(size_t count:{0, 1, 3, 7, 16, 17, 33, 64, 101}) {
+      for(uint8_t sc=1; sc<=4; ++sc) {
+        const auto           src = randomBytes(count*sc);
+        std::vector<uint8_t> dst(count*4);
+        PixelConv::swizzle8(dst.data(),4,src.data(),sc,toRgba[sc-1],count);
+        for(size_t i=0; i<count*4; ++i) {
+          const int8_t  m   = toRgba[sc-1][i%4];
+          const uint8_t ref = m>=0 ? src[(i/4)*sc+m] : (m==PixelConv::One ? 255 : 0);
+          ASSERT_EQ(dst[i],ref) << "count=" << count << " comp=" << int(sc) << " at=" << i;
+          }
+        }
+
+      const auto           src = randomBytes(count*4);
+      std::vector<uint8_t> dst(count*3+1, 0xCD);
+      PixelConv::swizzle8(dst.data(),3,src.data(),4,toRgb,count);
+      for(size_t i=0; i<count*3; ++i)
+        ASSERT_EQ(dst[i],src[(i/3)*4+i%3]);
+      EXPECT_EQ(dst.back(),0xCD); // no overrun
+      }
+    });
+  }
+
+TEST(main,PixelConvUnorm) {
+  forEachIsa([]() {
+    for(size_t count:{0, 5, 16, 31, 32, 100}) {
+      std::vector<uint16_t> s16(count);
+      std::vector<float>    sf (count);
+      std::mt19937          rng(uint32_t(count*7+1));
+      for(size_t i=0; i<count; ++i) {
+        s16[i] = uint16_t(rng());
+        sf [i] = float(rng()%1400)/1000.f - 0.2f;
+        }
+      if(count>0)
+        sf[0] = std::nanf("");
+
+      std::vector<uint8_t> d8(count);
+      PixelConv::unorm16ToUnorm8(d8.data(),s16.data(),count);
+      for(size_t i=0; i<count; ++i)
+        ASSERT_EQ(d8[i],s16[i]/256);
+
+      PixelConv::floatToUnorm8(d8.data(),sf.data(),count);
+      for(size_t i=0; i<count; ++i)
+        ASSERT_EQ(d8[i],uint8_t(std::fmax(0.f,std::fmin(sf[i],1.f))*255.f)) << sf[i];
+
+      const auto         s8 = randomBytes(count);
+      std::vector<float> df(count);
+      PixelConv::unorm8ToFloat(df.data(),s8.data(),count);
+      for(size_t i=0; i<count; ++i)
+        ASSERT_EQ(df[i],s8[i]/255.f);
+      }
+    });
+  }
+
+TEST(main,PixelConvHalf) {
+  forEachIsa([]() {
+    // every finite half must survive round trip
+    std::vector<uint16_t> h;
+    for(uint32_t i=0; i<0x10000; ++i)
+      if(((i>>10) & 0x1F)!=0x1F)
+        h.push_back(uint16_t(i));
+    std::vector<float>    f (h.size());
+    std::vector<uint16_t> h2(h.size());
+    PixelConv::halfToFloat(f.data(),h.data(),h.size());
+    PixelConv::floatToHalf(h2.data(),f.data(),f.size());
+    EXPECT_EQ(h,h2);
+
+    const float    src[] = {1.f, -2.f, 0.5f, 65504.f, 1e6f, -1e6f, 1e-8f, 1.f+1.f/2048.f, 1.f+3.f/2048.f};
+    const uint16_t ref[] = {0x3C00, 0xC000, 0x3800, 0x7BFF, 0x7C00, 0xFC00, 0x0000, 0x3C00, 0x3C02};
+    uint16_t       dst[9] = {};
+    PixelConv::floatToHalf(dst,src,9);
+    for(size_t i=0; i<9; ++i)
+      EXPECT_EQ(dst[i],ref[i]) << src[i];
+    });
+  }
+
+TEST(main,PixelConvRgbe) {
+  forEachIsa([]() {
+    for(size_t count:{0, 1, 4, 5, 9, 17, 64}) {
+      auto rgbe = randomBytes(count*4);
+      for(size_t i=0; i<count; i+=3)
+        rgbe[i*4+3] = uint8_t(i%2==0 ? 0 : 1); // zero and denormal exponents
+
+      std::vector<float> ref(count*3);
+      for(size_t i=0; i<count; ++i) {
+        const uint8_t* p = &rgbe[i*4];
+        const float    f = p[3]==0 ? 0.f : float(std::ldexp(1.0,p[3]-136));
+        for(int c=0; c<3; ++c)
+          ref[i*3+c] = p[c]*f;
+        }
+
+      std::vector<float> dst(count*3);
+      PixelConv::rgbeToFloat(dst.data(),rgbe.data(),count);
+      EXPECT_EQ(dst,ref);
+
+      // in place: rgbe in tail of output, as HDR loader does
+      std::vector<float> buf(count*3);
+      uint8_t*           tail = reinterpret_cast<uint8_t*>(buf.data()) + count*8;
+      if(count>0)
+        std::memcpy(tail,rgbe.data(),count*4);
+      PixelConv::rgbeToFloat(buf.data(),tail,count);
+      EXPECT_EQ(buf,ref);
+      }
+    });
+  }
+
+TEST(main,PixelConvByteSwap) {
+  forEachIsa([]() {
+    std::vector<uint16_t> v(37);
+    for(size_t i=0; i<v.size(); ++i)
+      v[i] = uint16_t(0x0102*(i+1));
+    PixelConv::byteSwap16(v.data(),v.size());
+    for(size_t i=0; i<v.size(); ++i) {
+      const uint16_t x = uint16_t(0x0102*(i+1));
+      ASSERT_EQ(v[i],uint16_t((x<<8) | (x>>8)));
+      }
+    });
+  }
@@ -5,6 +5,8 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock-matchers.h>
 
+#include <cstdlib>
+
 using namespace testing;
 using namespace Tempest;
 
@@ -54,3 +56,163 @@ TEST(main,PixmapConv) {
   EXPECT_EQ(px1.format(),TextureFormat::RGBA16);
   px1.save("tst-dxt5.png");
   }
+
+TEST(main,PixmapCompress) {
+  Pixmap src("assets/pixmap_io/rgba.png");
+
+  for(auto frm:{TextureFormat::DXT1,TextureFormat::DXT3,TextureFormat::DXT5}) {
+    Pixmap pm(src,frm,true);
+    EXPECT_EQ(pm.format(),  frm);
+    EXPECT_EQ(pm.w(),       256);
+    EXPECT_EQ(pm.h(),       256);
+    EXPECT_EQ(pm.mipCount(),9);
+
+    std::vector<uint8_t> mem;
+    MemWriter wr(mem);
+    pm.save(wr,"DDS");
+
+    MemReader rd(mem);
+    Pixmap    dds(rd);
+    EXPECT_EQ(dds.format(),  frm);
+    EXPECT_EQ(dds.mipCount(),pm.mipCount());
+    EXPECT_EQ(dds.dataSize(),pm.dataSize());
+
+    Pixmap    px(dds,TextureFormat::RGBA8);
+    auto      a = reinterpret_cast<const uint8_t*>(src.data());
+    auto      b = reinterpret_cast<const uint8_t*>(px.data());
+    double    err = 0;
+    for(size_t i=0; i<src.dataSize(); i+=4)
+      for(size_t c=0; c<3; ++c)
+        err += std::abs(int(a[i+c])-int(b[i+c]));
+    err /= double(src.w()*src.h()*3);
+    EXPECT_LT(err,8.0);
+    }
+  }
+
+TEST(main,PixmapKtx2) {
+  // 16x16 BC7 with 3 mips; KTX2 stores smallest mip first
+  const uint32_t size[3] = {256, 64, 16};
+  const uint8_t  ident[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+  std::vector<uint8_t> mem;
+  MemWriter wr(mem);
+  auto u32 = [&](uint32_t v) { EXPECT_EQ(wr.write(&v,4),4u); };
+  auto u64 = [&](uint64_t v) { EXPECT_EQ(wr.write(&v,8),8u); };
+
+  EXPECT_EQ(wr.write(ident,12),12u);
+  for(uint32_t v:{145u/*BC7*/, 1u, 16u, 16u, 0u, 0u, 1u, 3u, 0u})
+    u32(v);
+  for(int i=0; i<4; ++i)
+    u32(0);
+  u64(0);
+  u64(0);
+
+  uint64_t at = 80 + 3*24;
+  uint64_t offset[3] = {};
+  for(int i=2; i>=0; --i) {
+    offset[i] = at;
+    at += size[i];
+    }
+  for(int i=0; i<3; ++i) {
+    u64(offset[i]);
+    u64(size[i]);
+    u64(size[i]);
+    }
+  for(int i=2; i>=0; --i) {
+    std::vector<uint8_t> lvl(size[i],uint8_t(i+1));
+    EXPECT_EQ(wr.write(lvl.data(),lvl.size()),lvl.size());
+    }
+
+  MemReader rd(mem);
+  Pixmap    pm(rd);
+  EXPECT_EQ(pm.format(),  TextureFormat::BC7);
+  EXPECT_EQ(pm.w(),       16);
+  EXPECT_EQ(pm.h(),       16);
+  EXPECT_EQ(pm.mipCount(),3);
+  ASSERT_EQ(pm.dataSize(),256+64+16);
+
+  // mips are repacked in Pixmap order
+  auto d = reinterpret_cast<const uint8_t*>(pm.data());
+  EXPECT_EQ(d[0],      1);
+  EXPECT_EQ(d[255],    1);
+  EXPECT_EQ(d[256],    2);
+  EXPECT_EQ(d[256+64], 3);
+  }
+
+TEST(main,PixmapCow) {
+  Pixmap a(4,4,TextureFormat::RGBA8);
+  reinterpret_cast<uint8_t*>(a.data())[0] = 1;
+
+  Pixmap b = a;
+  const Pixmap& ca = a;
+  const Pixmap& cb = b;
+  EXPECT_EQ(ca.data(),cb.data());
+
+  reinterpret_cast<uint8_t*>(b.data())[0] = 2;
+  EXPECT_NE(ca.data(),cb.data());
+  EXPECT_EQ(reinterpret_cast<const uint8_t*>(ca.data())[0],1);
+  EXPECT_EQ(reinterpret_cast<const uint8_t*>(cb.data())[0],2);
+
+  Pixmap c;
+  c = b;
+  EXPECT_EQ(cb.data(),static_cast<const Pixmap&>(c).data());
+  }
+
+TEST(main,PixmapFromBuffer) {
+  std::vector<uint8_t> px(4*4*4, 7);
+  const void* ptr = px.data();
+
+  Pixmap pm = Pixmap::fromBuffer(std::move(px),4,4,TextureFormat::RGBA8);
+  EXPECT_EQ(static_cast<const Pixmap&>(pm).data(),ptr);
+  EXPECT_EQ(pm.dataSize(),64u);
+  EXPECT_EQ(pm.format(),  TextureFormat::RGBA8);
+
+  void* mem = std::malloc(8);
+  Pixmap dxt = Pixmap::fromBuffer(mem,8,4,4,TextureFormat::DXT1);
+  EXPECT_EQ(static_cast<const Pixmap&>(dxt).data(),mem);
+
+  EXPECT_ANY_THROW(Pixmap::fromBuffer(std::vector<uint8_t>(10),4,4,TextureFormat::RGBA8));
+  }
+
+TEST(main,PixmapConvHalf) {
+  Pixmap rgb(3,1,TextureFormat::RGB8);
+  auto   px = reinterpret_cast<uint8_t*>(rgb.data());
+  for(int i=0; i<9; ++i)
+    px[i] = uint8_t(i*30);
+
+  Pixmap f16(rgb,TextureFormat::RGBA16F);
+  EXPECT_EQ(f16.format(),  TextureFormat::RGBA16F);
+  EXPECT_EQ(f16.dataSize(),3u*8u);
+  auto h = reinterpret_cast<const uint16_t*>(static_cast<const Pixmap&>(f16).data());
+  EXPECT_EQ(h[0],0x0000); // 0.0
+  EXPECT_EQ(h[3],0x3C00); // alpha 1.0
+
+  Pixmap back(f16,TextureFormat::RGBA8);
+  auto   b = reinterpret_cast<const uint8_t*>(static_cast<const Pixmap&>(back).data());
+  for(int i=0; i<3; ++i) {
+    for(int c=0; c<3; ++c)
+      EXPECT_NEAR(b[i*4+c],px[i*3+c],1);
+    EXPECT_EQ(b[i*4+3],255);
+    }
+  }
+
+TEST(main,PixmapCompressConv) {
+  Pixmap src("assets/pixmap_io/rgba.png");
+  Pixmap rgb(src,TextureFormat::RGB8);
+
+  // non-RGBA8 source goes through the same encoder
+  for(auto frm:{TextureFormat::DXT1,TextureFormat::DXT5}) {
+    Pixmap pm(rgb,frm);
+    EXPECT_EQ(pm.format(),  frm);
+    EXPECT_EQ(pm.mipCount(),1);
+
+    Pixmap px(pm,TextureFormat::RGB8);
+    auto   a   = reinterpret_cast<const uint8_t*>(rgb.data());
+    auto   b   = reinterpret_cast<const uint8_t*>(px.data());
+    double err = 0;
+    for(size_t i=0; i<rgb.dataSize(); ++i)
+      err += std::abs(int(a[i])-int(b[i]));
+    err /= double(rgb.dataSize());
+    EXPECT_LT(err,8.0);
+    }
+  }
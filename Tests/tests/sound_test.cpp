@@ -0,0 +1,301 @@
+#include <Tempest/SoundDevice>
+#include <Tempest/SoundEffect>
+#include <Tempest/Sound>
+#include <Tempest/MemReader>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+using namespace Tempest;
+
+namespace {
+
+constexpr uint32_t Frequency = 44100;
+constexpr size_t   Chunk     = 1024;
+
+struct Fmt {
+  uint16_t format     = 1;
+  uint16_t channels   = 1;
+  uint32_t frequency  = Frequency;
+  uint16_t blockAlign = 2;
+  uint16_t bits       = 16;
+  };
+
+std::vector<uint8_t> mkWav(const Fmt& fmt, const std::vector<uint8_t>& data) {
+  std::vector<uint8_t> ret(44+data.size());
+  auto wr32 = [&](size_t at, uint32_t v) { std::memcpy(&ret[at],&v,4); };
+  auto wr16 = [&](size_t at, uint16_t v) { std::memcpy(&ret[at],&v,2); };
+
+  std::memcpy(&ret[0], "RIFF",4);
+  wr32(4, uint32_t(ret.size()-8));
+  std::memcpy(&ret[8], "WAVEfmt ",8);
+  wr32(16,16);
+  wr16(20,fmt.format);
+  wr16(22,fmt.channels);
+  wr32(24,fmt.frequency);
+  wr32(28,fmt.frequency*fmt.blockAlign);
+  wr16(32,fmt.blockAlign);
+  wr16(34,fmt.bits);
+  std::memcpy(&ret[36], "data",4);
+  wr32(40,uint32_t(data.size()));
+  if(!data.empty())
+    std::memcpy(&ret[44], data.data(), data.size());
+  return ret;
+  }
+
+std::vector<uint8_t> mkTone(uint32_t samples) {
+  std::vector<uint8_t> ret(samples*sizeof(int16_t));
+  for(uint32_t i=0; i<samples; ++i) {
+    int16_t v = int16_t(std::sin(float(i)*440.f*2.f*float(M_PI)/float(Frequency))*8000.f);
+    std::memcpy(&ret[i*sizeof(int16_t)],&v,sizeof(v));
+    }
+  return ret;
+  }
+
+std::vector<uint8_t> mkAdPcm(size_t blocks, uint16_t blockAlign) {
+  std::mt19937         rng(0);
+  std::vector<uint8_t> ret(blocks*blockAlign);
+  for(auto& i:ret)
+    i = uint8_t(rng());
+  for(size_t b=0; b<blocks; ++b) {
+    ret[b*blockAlign+2] = uint8_t(rng()%89);
+    ret[b*blockAlign+3] = 0;
+    }
+  return ret;
+  }
+
+SoundDevice::Loopback mkLoopback(uint32_t voices) {
+  SoundDevice::Loopback desc;
+  desc.frequency = Frequency;
+  desc.channels  = 2;
+  desc.voices    = voices;
+  return desc;
+  }
+
+size_t countVirtual(const std::vector<SoundEffect>& fx) {
+  size_t ret = 0;
+  for(auto& i:fx)
+    if(i.isVirtual())
+      ++ret;
+  return ret;
+  }
+
+// mixes, until effect stops; returns count of frames mixed and sum of amplitudes
+size_t playToEnd(SoundDevice& dev, SoundEffect& fx, uint64_t& energy) {
+  std::vector<int16_t> pcm(Chunk*2);
+  size_t frames = 0;
+  energy = 0;
+  fx.play();
+  dev.process();
+  while(!fx.isFinished() && frames<Frequency*4) {
+    dev.renderSamples(pcm.data(), Chunk);
+    for(auto i:pcm)
+      energy += uint64_t(std::abs(int32_t(i)));
+    frames += Chunk;
+    }
+  return frames;
+  }
+
+}
+
+TEST(main,SoundStreamPcm) {
+  SoundDevice dev(SoundDevice::Loopback{Frequency,2});
+  ASSERT_TRUE(dev.isLoopback());
+
+  // longer than decoder ring: worker thread has to refill it while playing
+  auto wav = mkWav(Fmt(), mkTone(Frequency/2));
+  auto fx  = dev.loadStream(std::make_unique<MemReader>(wav.data(),wav.size()));
+  ASSERT_FALSE(fx.isEmpty());
+  EXPECT_EQ(fx.timeLength(),500u);
+
+  uint64_t     energy = 0;
+  const size_t frames = playToEnd(dev,fx,energy);
+  EXPECT_TRUE(fx.isFinished());
+  EXPECT_GE(frames,size_t(Frequency/2));
+  EXPECT_GT(energy,0u);
+  }
+
+TEST(main,SoundStreamAdPcm) {
+  SoundDevice dev(SoundDevice::Loopback{Frequency,2});
+
+  Fmt fmt;
+  fmt.format     = 0x11;
+  fmt.blockAlign = 256;
+  fmt.bits       = 4;
+  // 505 frames per block
+  auto wav = mkWav(fmt, mkAdPcm(40,fmt.blockAlign));
+  auto fx  = dev.loadStream(std::make_unique<MemReader>(wav.data(),wav.size()));
+  ASSERT_FALSE(fx.isEmpty());
+  EXPECT_EQ(fx.timeLength(),(40u*505u*1000u)/Frequency);
+
+  uint64_t     energy = 0;
+  const size_t frames = playToEnd(dev,fx,energy);
+  EXPECT_TRUE(fx.isFinished());
+  EXPECT_GE(frames,size_t(40*505));
+  EXPECT_GT(energy,0u);
+  }
+
+TEST(main,SoundStreamInvalidFormat) {
+  SoundDevice dev(SoundDevice::Loopback{Frequency,2});
+
+  std::vector<Fmt> bad(5);
+  bad[0].blockAlign = 3;                                   // pcm16 mono, frame is 2 bytes
+  bad[1].bits       = 12;                                  // unsupported pcm depth
+  bad[2].frequency  = 0;
+  bad[3].format     = 0x11;                                // adpcm, but 16 bit
+  bad[4].format     = 0x11; bad[4].bits = 4; bad[4].blockAlign = 4; // adpcm block with header only
+
+  for(auto& f:bad) {
+    auto wav = mkWav(f, mkTone(1024));
+    auto fx  = dev.loadStream(std::make_unique<MemReader>(wav.data(),wav.size()));
+    EXPECT_TRUE(fx.isEmpty());
+    EXPECT_TRUE(fx.isFinished());
+    }
+
+  Fmt  ch;
+  ch.channels   = 6;
+  ch.blockAlign = 12;
+  auto wav = mkWav(ch, mkTone(1200));
+  EXPECT_THROW(dev.loadStream(std::make_unique<MemReader>(wav.data(),wav.size())), std::system_error);
+  }
+
+TEST(main,SoundVoicePoolVirtualize) {
+  SoundDevice dev(mkLoopback(2));
+
+  auto      wav = mkWav(Fmt(), mkTone(Frequency*2));
+  MemReader rd(wav.data(),wav.size());
+  Sound     snd(rd);
+
+  std::vector<SoundEffect> fx;
+  for(int i=0; i<4; ++i)
+    fx.emplace_back(dev.load(snd));
+  for(auto& i:fx)
+    i.play();
+  dev.process();
+
+  // out of real voices: equally important voices don't steal from each other
+  EXPECT_EQ(countVirtual(fx),2u);
+  for(auto& i:fx)
+    EXPECT_FALSE(i.isFinished());
+
+  // virtual voices keep advancing the playhead without mixing
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  for(auto& i:fx)
+    if(i.isVirtual())
+      EXPECT_GE(i.currentTime(),40u);
+  }
+
+TEST(main,SoundVoicePoolPriority) {
+  SoundDevice dev(mkLoopback(2));
+
+  auto      wav = mkWav(Fmt(), mkTone(Frequency*2));
+  MemReader rd(wav.data(),wav.size());
+  Sound     snd(rd);
+
+  std::vector<SoundEffect> low;
+  for(int i=0; i<2; ++i) {
+    low.emplace_back(dev.load(snd));
+    low.back().play();
+    }
+  dev.process();
+  EXPECT_EQ(countVirtual(low),0u);
+
+  // more important voice takes a source right away
+  auto high = dev.load(snd);
+  high.setPriority(5);
+  high.play();
+  EXPECT_FALSE(high.isVirtual());
+  EXPECT_EQ(countVirtual(low),1u);
+
+  dev.process();
+  EXPECT_FALSE(high.isVirtual());
+  EXPECT_EQ(countVirtual(low),1u);
+
+  // released source is reused by evicted voice
+  high.pause();
+  dev.process();
+  EXPECT_EQ(countVirtual(low),0u);
+  for(auto& i:low)
+    EXPECT_FALSE(i.isFinished());
+  }
+
+TEST(main,SoundVoicePoolStreams) {
+  SoundDevice dev(mkLoopback(2));
+
+  auto wav = mkWav(Fmt(), mkTone(Frequency*2));
+  std::vector<SoundEffect> fx;
+  for(int i=0; i<4; ++i)
+    fx.emplace_back(dev.loadStream(std::make_unique<MemReader>(wav.data(),wav.size())));
+  for(auto& i:fx)
+    i.play();
+  dev.process();
+  EXPECT_EQ(countVirtual(fx),2u);
+
+  std::vector<bool> real;
+  for(auto& i:fx)
+    real.push_back(!i.isVirtual());
+
+  // more important stream doesn't evict a mixed one
+  for(size_t i=0; i<fx.size(); ++i)
+    if(!real[i])
+      fx[i].setPriority(5);
+  dev.process();
+  for(size_t i=0; i<fx.size(); ++i)
+    EXPECT_EQ(fx[i].isVirtual(),!real[i]);
+
+  // neither does a static voice
+  auto      wavS = mkWav(Fmt(), mkTone(Frequency*2));
+  MemReader rd(wavS.data(),wavS.size());
+  Sound     snd(rd);
+  auto      eff = dev.load(snd);
+  eff.setPriority(10);
+  eff.play();
+  dev.process();
+  EXPECT_TRUE(eff.isVirtual());
+  for(size_t i=0; i<fx.size(); ++i)
+    EXPECT_EQ(fx[i].isVirtual(),!real[i]);
+
+  // released source goes to a waiting stream first
+  for(size_t i=0; i<fx.size(); ++i)
+    if(real[i]) {
+      fx[i] = SoundEffect();
+      break;
+      }
+  dev.process();
+  EXPECT_TRUE(eff.isVirtual());
+  EXPECT_EQ(countVirtual(fx),1u);
+  }
+
+TEST(main,SoundVoicePoolDistance) {
+  SoundDevice dev(mkLoopback(4));
+  dev.setListenerPosition(0,0,0);
+
+  auto      wav = mkWav(Fmt(), mkTone(Frequency*2));
+  MemReader rd(wav.data(),wav.size());
+  Sound     snd(rd);
+
+  auto fx = dev.load(snd);
+  fx.setMaxDistance(100.f);
+  fx.setPosition(10000.f,0,0);
+  fx.play();
+  dev.process();
+  // beyond max distance: not mixed, even with free sources
+  EXPECT_TRUE (fx.isVirtual());
+  EXPECT_FALSE(fx.isFinished());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  fx.setPosition(10.f,0,0);
+  dev.process();
+  // reactivated at the offset, virtual playback reached
+  EXPECT_FALSE(fx.isVirtual());
+  EXPECT_GE(fx.currentTime(),40u);
+  }
@@ -0,0 +1,106 @@
+#include <Tempest/TextModel>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+
+#include <random>
+
+using namespace testing;
+using namespace Tempest;
+
+namespace {
+TextModel::Cursor at(const TextModel& m, size_t pos) {
+  return m.advance(m.charAt(size_t(0)),int32_t(pos));
+  }
+}
+
+TEST(main,TextModelEdit) {
+  TextModel m;
+  EXPECT_STREQ(m.c_str(),"");
+
+  m.setText("hello\nworld");
+  EXPECT_EQ(m.size(),11u);
+
+  m.insert(", big",at(m,5));
+  EXPECT_STREQ(m.c_str(),"hello, big\nworld");
+
+  m.insert("!",at(m,m.size()));
+  EXPECT_STREQ(m.c_str(),"hello, big\nworld!");
+
+  m.erase(at(m,5),at(m,10));
+  EXPECT_STREQ(m.c_str(),"hello\nworld!");
+
+  m.replace("\n\n",at(m,5),at(m,6));
+  EXPECT_STREQ(m.c_str(),"hello\n\nworld!");
+
+  auto c = at(m,7);
+  EXPECT_TRUE(m.isValid(c));
+  EXPECT_EQ(c,m.clamp(c));
+  EXPECT_EQ(m.advance(c,-1),at(m,6));
+
+  std::string s;
+  m.fetch(at(m,3),at(m,9),s);
+  EXPECT_EQ(s,"lo\n\nwo");
+  }
+
+TEST(main,TextModelUndo) {
+  TextModel            m("abc\ndef");
+  UndoStack<TextModel> stk;
+
+  stk.push(m,new TextModel::CommandInsert("1234",at(m,4)));
+  EXPECT_STREQ(m.c_str(),"abc\n1234def");
+  stk.push(m,new TextModel::CommandErase(at(m,1),at(m,6)));
+  EXPECT_STREQ(m.c_str(),"a34def");
+  stk.push(m,new TextModel::CommandReplace("xyz",at(m,2),at(m,4)));
+  EXPECT_STREQ(m.c_str(),"a3xyzef");
+
+  stk.undo(m);
+  EXPECT_STREQ(m.c_str(),"a34def");
+  stk.undo(m);
+  EXPECT_STREQ(m.c_str(),"abc\n1234def");
+  stk.undo(m);
+  EXPECT_STREQ(m.c_str(),"abc\ndef");
+  stk.redo(m);
+  EXPECT_STREQ(m.c_str(),"abc\n1234def");
+  }
+
+TEST(main,TextModelUtf8) {
+  TextModel m("\xD0\x96\xD0\x96\n\xD0\x96");
+  auto c = m.advance(at(m,0),2);
+  EXPECT_EQ(c,m.advance(at(m,3),-1));
+  m.erase(c,1);
+  EXPECT_STREQ(m.c_str(),"\xD0\x96\xD0\x96\xD0\x96");
+  m.erase(at(m,1),2);
+  EXPECT_STREQ(m.c_str(),"\xD0\x96");
+  }
+
+TEST(main,TextModelRandomEdit) {
+  std::mt19937 rnd(17);
+  std::string  ref = "first\nsecond\nthird";
+  TextModel    m(ref.c_str());
+
+  static const char* samples[] = {"a", "\n", "xy", "line\nline\n", "12345"};
+  for(int i=0; i<4000; ++i) {
+    const size_t pos = rnd()%(ref.size()+1);
+    if(rnd()%3!=0 || ref.size()<16) {
+      const char* s = samples[rnd()%(sizeof(samples)/sizeof(samples[0]))];
+      m.insert(s,at(m,pos));
+      ref.insert(pos,s);
+      } else {
+      const size_t len = std::min<size_t>(rnd()%8,ref.size()-pos);
+      m.erase(at(m,pos),len);
+      ref.erase(pos,len);
+      }
+    ASSERT_EQ(m.size(),ref.size());
+    }
+  EXPECT_EQ(std::string(m.c_str()),ref);
+
+  auto end = at(m,ref.size());
+  EXPECT_TRUE(m.isValid(end));
+  EXPECT_EQ(m.advance(end,1),end);
+  EXPECT_EQ(m.clamp(m.advance(end,1)),end);
+
+  std::string s;
+  m.fetch(at(m,0),end,s);
+  EXPECT_EQ(s,ref);
+  }
@@ -0,0 +1,132 @@
+#include <Tempest/Timer>
+#include <Tempest/Application>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+
+#include <memory>
+#include <string>
+
+#include "../system/timerqueue.h"
+
+using namespace testing;
+using namespace Tempest;
+
+namespace {
+
+template<class Fn>
+void bind(Timer& t, const Fn& fn) {
+  t.timeout.bind(&fn,&Fn::operator());
+  }
+
+}
+
+TEST(main,TimerOrder) {
+  auto&       q    = Detail::TimerQueue::global();
+  const auto  base = Application::tickCount();
+  std::string order;
+
+  auto fa = [&](){ order += 'a'; };
+  auto fb = [&](){ order += 'b'; };
+  auto fc = [&](){ order += 'c'; };
+
+  Timer a, b, c;
+  bind(a,fa);
+  bind(b,fb);
+  bind(c,fc);
+  a.start(300);
+  b.start(100);
+  c.start(200);
+
+  EXPECT_EQ(q.process(base+50), 0u);
+  EXPECT_GT(q.next(base+50),    0u);
+  // fired in deadline order
+  EXPECT_EQ(q.process(base+1000),3u);
+  EXPECT_EQ(order,"bca");
+  }
+
+TEST(main,TimerCatchUp) {
+  auto&      q    = Detail::TimerQueue::global();
+  const auto base = Application::tickCount();
+  int        cnt  = 0;
+
+  auto fn = [&](){ ++cnt; };
+
+  Timer t;
+  bind(t,fn);
+  t.start(100);
+
+  // late timer fires once per call, until it reaches current time
+  const auto now = base+550;
+  while(q.process(now)>0)
+    ;
+  EXPECT_GE(cnt,4);
+  EXPECT_LE(cnt,5);
+  EXPECT_EQ(q.process(now),0u);
+  EXPECT_GT(q.next(now),0u);
+
+  t.stop();
+  EXPECT_EQ(q.process(base+10000),0u);
+  EXPECT_EQ(q.next(base+10000),uint64_t(-1));
+  }
+
+TEST(main,TimerRestartFromCallback) {
+  auto&      q    = Detail::TimerQueue::global();
+  const auto base = Application::tickCount();
+  int        ca = 0, cb = 0, cc = 0;
+
+  auto  d = std::make_unique<Timer>();
+  Timer a, b, c;
+
+  auto fa = [&](){
+    ++ca;
+    // restarted in the same tick: still fires
+    b.stop();
+    b.start(150);
+    // stopped: skipped
+    c.stop();
+    // destroyed: skipped
+    d.reset();
+    };
+  auto fb = [&](){ ++cb; };
+  auto fc = [&](){ ++cc; };
+  auto fd = [&](){ ADD_FAILURE(); };
+  bind(a,fa);
+  bind(b,fb);
+  bind(c,fc);
+  bind(*d,fd);
+  a.start(100);
+  b.start(110);
+  c.start(120);
+  d->start(130);
+
+  EXPECT_EQ(q.process(base+200),2u);
+  EXPECT_EQ(ca,1);
+  EXPECT_EQ(cb,1);
+  EXPECT_EQ(cc,0);
+  EXPECT_EQ(d,nullptr);
+  }
+
+TEST(main,TimerReentrant) {
+  auto&      q    = Detail::TimerQueue::global();
+  const auto base = Application::tickCount();
+  int        ca = 0, cb = 0;
+
+  auto fa = [&](){
+    // as Application::processEvents from callback would do
+    if(++ca==1)
+      q.process(base+250);
+    };
+  auto fb = [&](){ ++cb; };
+
+  Timer a, b;
+  bind(a,fa);
+  bind(b,fb);
+  a.start(100);
+  b.start(200);
+
+  q.process(base+250);
+  // nested call fires 'a' once more, to catch up; 'b' is fired by outer call only
+  EXPECT_EQ(ca,2);
+  EXPECT_EQ(cb,1);
+  }
@@ -59,6 +59,10 @@ ImageValidator::Pixel ImageValidator::at(uint32_t x, uint32_t y) const {
     case TextureFormat::DXT1:
     case TextureFormat::DXT3:
     case TextureFormat::DXT5:
+    case TextureFormat::BC4:
+    case TextureFormat::BC5:
+    case TextureFormat::BC6H:
+    case TextureFormat::BC7:
       assert(false);
       break;
 